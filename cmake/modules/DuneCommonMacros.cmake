@@ -24,4 +24,5 @@ endif(Fortran_Works)
 find_package(GMP)
 find_package(Inkscape)
 include(FindMProtect)
+include(FindPerfEvent)
 include(DuneBoost)
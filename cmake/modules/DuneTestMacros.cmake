@@ -19,6 +19,12 @@
 # with all slashes replaced by underlines.
 # E.g. for dune/istl/test the target will be dune_istl_test.
 #
+# dune_add_benchmark(_program)
+#
+# Makes the target benchmark build and run the benchmark program
+# _program with the options in DUNE_BENCHMARK_FLAGS. The results
+# are written to _program.json in the current build directory.
+#
 macro(test_dep)
   dune_common_script_dir(SCRIPT_DIR)
   execute_process(COMMAND ${CMAKE_COMMAND} -D RELPATH=${CMAKE_SOURCE_DIR} -P ${SCRIPT_DIR}/FindFiles.cmake 
@@ -50,4 +56,19 @@ macro(add_directory_test_target _target)
   add_custom_target(${${_target}})
   dune_common_script_dir(SCRIPT_DIR)
   configure_file(${SCRIPT_DIR}/BuildTests.cmake.in BuildTests.cmake @ONLY)
-endmacro(add_directory_test_target)
\ No newline at end of file
+endmacro(add_directory_test_target)
+
+#
+# - Make the target benchmark run the program _program,
+# writing the results to _program.json.
+#
+macro(dune_add_benchmark _program)
+  if(NOT TARGET benchmark)
+    add_custom_target(benchmark)
+  endif(NOT TARGET benchmark)
+  separate_arguments(_flags UNIX_COMMAND "${DUNE_BENCHMARK_FLAGS}")
+  add_custom_target(run_${_program}
+    COMMAND ${_program} --json ${CMAKE_CURRENT_BINARY_DIR}/${_program}.json ${_flags}
+    DEPENDS ${_program})
+  add_dependencies(benchmark run_${_program})
+endmacro(dune_add_benchmark)
@@ -14,6 +14,7 @@
 # HAVE_VARIADIC_TEMPLATES          True if variadic templates are supprt
 # HAVE_VARIADIC_CONSTRUCTOR_SFINAE True if variadic constructor sfinae is supported
 # HAVE_RVALUE_REFERENCES           True if rvalue references are supported
+# HAVE_STD_THREAD                  True if std::thread, std::atomic and thread_local are supported
 
 include(CMakePushCheckState)
 cmake_push_check_state()
@@ -299,4 +300,29 @@ CHECK_CXX_SOURCE_COMPILES("
   }
 " HAVE_RVALUE_REFERENCES
 )
+
+# std::thread, std::atomic and thread_local
+find_package(Threads)
+set(CMAKE_REQUIRED_LIBRARIES ${CMAKE_REQUIRED_LIBRARIES} ${CMAKE_THREAD_LIBS_INIT})
+CHECK_CXX_SOURCE_COMPILES("
+  #include <thread>
+  #include <atomic>
+
+  static thread_local int counter = 0;
+  static std::atomic<int> sum(0);
+
+  void work()
+  {
+    ++counter;
+    sum.fetch_add(counter);
+  }
+
+  int main(void)
+  {
+    std::thread t(work);
+    t.join();
+    return sum.load()==1 ? 0 : 1;
+  }
+" HAVE_STD_THREAD
+)
 cmake_pop_check_state()
@@ -0,0 +1,16 @@
+#
+# Module that detects support for the Linux perf_event_open system call
+#
+# Sets the following variables
+# HAVE_PERF_EVENT
+include(CheckCSourceCompiles)
+check_c_source_compiles("
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+int main(void){
+  struct perf_event_attr attr;
+  attr.type = PERF_TYPE_HARDWARE;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}" HAVE_PERF_EVENT)
+message(STATUS HAVE_PERF_EVENT=${HAVE_PERF_EVENT})
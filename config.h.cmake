@@ -80,9 +80,15 @@
 /* Define to 1 if nullptr is supported */
 #cmakedefine HAVE_NULLPTR 1
 
+/* Define to 1 if the perf_event_open system call is available. */
+#cmakedefine HAVE_PERF_EVENT 1
+
 /* Define to 1 if static_assert is supported */
 #cmakedefine HAVE_STATIC_ASSERT 1
 
+/* Define to 1 if std::thread, std::atomic and thread_local are supported */
+#cmakedefine HAVE_STD_THREAD 1
+
 /* Define to 1 if you have the <stdint.h> header file. */
 #cmakedefine HAVE_STDINT_H 1
 
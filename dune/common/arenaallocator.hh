@@ -0,0 +1,411 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_ARENA_ALLOCATOR_HH
+#define DUNE_ARENA_ALLOCATOR_HH
+
+#include <cstdlib>
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <utility>
+
+#include "alignment.hh"
+
+/**
+ * @file
+ * @brief Monotonic allocators that release their memory all at once.
+ */
+namespace Dune
+{
+  /**
+     @ingroup Allocators
+     @brief A monotonic memory arena.
+
+     Memory is handed out by incrementing a pointer into big blocks.
+     Freeing single allocations is a no-op, except for the most recent
+     one. Instead all memory allocated after a mark() is released at
+     once by rewind(), usually through an ArenaScope. Released blocks
+     are kept for reuse, so an arena that is rewound after each element
+     of a loop does not call malloc in the steady state.
+
+     An Arena must only be used by one thread at a time. Each thread
+     has its own current arena, see current().
+   */
+  class Arena
+  {
+    /** @brief Header of a block of memory. The memory follows directly. */
+    struct Block
+    {
+      /** @brief The previously used or next spare block. */
+      Block* next_;
+      /** @brief The number of usable bytes. */
+      std::size_t size_;
+
+      char* begin()
+      {
+        return reinterpret_cast<char*>(this+1);
+      }
+
+      char* end()
+      {
+        return begin()+size_;
+      }
+    };
+
+  public:
+    /** @brief A position in the arena to rewind to. */
+    struct Marker
+    {
+      Block* block_;
+      char* top_;
+    };
+
+    /**
+     * @brief Create an arena.
+     * @param blockSize The size of the first block in bytes. Subsequent
+     * blocks grow geometrically.
+     */
+    explicit Arena(std::size_t blockSize = 16384) throw()
+      : current_(0), spare_(0), top_(0), nextBlockSize_(blockSize)
+    {}
+
+    //! free all blocks
+    ~Arena()
+    {
+      rewind(Marker());
+      freeBlocks(spare_);
+    }
+
+    /**
+     * @brief Allocate memory.
+     * @param bytes The number of bytes.
+     * @param alignment The alignment required, has to be a power of two.
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+      char* p = align(top_, alignment);
+      if(!current_ || p+bytes>current_->end()){
+        grow(bytes+alignment);
+        p = align(top_, alignment);
+      }
+      top_ = p+bytes;
+      return p;
+    }
+
+    /**
+     * @brief Free memory.
+     *
+     * Only the most recent allocation is actually reclaimed.
+     */
+    void deallocate(void* p, std::size_t bytes)
+    {
+      if(static_cast<char*>(p)+bytes==top_)
+        top_ = static_cast<char*>(p);
+    }
+
+    //! get the current position of the arena
+    Marker mark() const
+    {
+      Marker marker = { current_, top_ };
+      return marker;
+    }
+
+    /**
+     * @brief Release all memory allocated after a mark.
+     *
+     * The blocks are kept for reuse.
+     */
+    void rewind(const Marker& marker)
+    {
+      while(current_!=marker.block_){
+        Block* block = current_;
+        current_ = block->next_;
+        block->next_ = spare_;
+        spare_ = block;
+      }
+      top_ = marker.top_;
+    }
+
+    //! release all memory, the blocks are kept for reuse.
+    void reset()
+    {
+      rewind(Marker());
+    }
+
+    //! the number of bytes reserved from the system
+    std::size_t capacity() const
+    {
+      std::size_t size=0;
+      for(Block* block=current_; block; block=block->next_)
+        size+=block->size_;
+      for(Block* block=spare_; block; block=block->next_)
+        size+=block->size_;
+      return size;
+    }
+
+    /**
+     * @brief The current arena of the calling thread.
+     *
+     * This is a thread local arena unless another one is activated
+     * by an ArenaScope.
+     */
+    static Arena& current()
+    {
+      Arena* arena = currentPointer();
+      return arena ? *arena : threadArena();
+    }
+
+  private:
+    friend class ArenaScope;
+
+    // Prevent copying
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    static char* align(char* p, std::size_t alignment)
+    {
+      std::size_t address = reinterpret_cast<std::size_t>(p);
+      return p + ((alignment - address % alignment) % alignment);
+    }
+
+    /** @brief Make a block of at least the given size the current one. */
+    void grow(std::size_t bytes)
+    {
+      // Try to reuse a spare block first.
+      Block** previous = &spare_;
+      Block* block = spare_;
+      while(block && block->size_<bytes){
+        previous = &block->next_;
+        block = block->next_;
+      }
+
+      if(block)
+        *previous = block->next_;
+      else{
+        std::size_t size = nextBlockSize_ < bytes ? bytes : nextBlockSize_;
+        block = static_cast<Block*>(std::malloc(sizeof(Block)+size));
+        if(!block)
+          throw std::bad_alloc();
+        block->size_ = size;
+        nextBlockSize_ = 2*size;
+      }
+
+      block->next_ = current_;
+      current_ = block;
+      top_ = block->begin();
+    }
+
+    static void freeBlocks(Block* block)
+    {
+      while(block){
+        Block* next = block->next_;
+        std::free(block);
+        block = next;
+      }
+    }
+
+    static Arena*& currentPointer()
+    {
+#if HAVE_STD_THREAD
+      static thread_local Arena* arena = 0;
+#else
+      static Arena* arena = 0;
+#endif
+      return arena;
+    }
+
+    static Arena& threadArena()
+    {
+#if HAVE_STD_THREAD
+      static thread_local Arena arena;
+#else
+      static Arena arena;
+#endif
+      return arena;
+    }
+
+    /** @brief The block we allocate from, chained to the previous ones. */
+    Block* current_;
+    /** @brief The blocks available for reuse. */
+    Block* spare_;
+    /** @brief The first free byte in the current block. */
+    char* top_;
+    /** @brief The size of the next block to allocate. */
+    std::size_t nextBlockSize_;
+  };
+
+  /**
+     @ingroup Allocators
+     @brief Scope guard releasing all memory allocated in an arena
+     during its lifetime.
+
+     While the scope is alive the arena is the current one of the
+     calling thread, i.e. default constructed ArenaAllocators use it.
+     All containers using the arena have to be destroyed before
+     the scope ends.
+
+     \code
+     for(Iterator element = begin; element != end; ++element)
+     {
+       ArenaScope scope;
+       DynamicMatrix<double, ArenaAllocator<double> > A(n, n);
+       std::vector<int, ArenaAllocator<int> > indices;
+       ...
+     } // all memory is released here
+     \endcode
+   */
+  class ArenaScope
+  {
+  public:
+    //! guard the current arena of the thread
+    ArenaScope()
+      : arena_(Arena::current()), marker_(arena_.mark()),
+        previous_(Arena::currentPointer())
+    {
+      Arena::currentPointer() = &arena_;
+    }
+
+    //! guard and activate an arena
+    explicit ArenaScope(Arena& arena)
+      : arena_(arena), marker_(arena_.mark()),
+        previous_(Arena::currentPointer())
+    {
+      Arena::currentPointer() = &arena_;
+    }
+
+    //! release the memory and restore the previous arena
+    ~ArenaScope()
+    {
+      arena_.rewind(marker_);
+      Arena::currentPointer() = previous_;
+    }
+
+    //! the arena guarded
+    Arena& arena() const
+    {
+      return arena_;
+    }
+
+  private:
+    // Prevent copying
+    ArenaScope(const ArenaScope&);
+    ArenaScope& operator=(const ArenaScope&);
+
+    Arena& arena_;
+    Arena::Marker marker_;
+    Arena* previous_;
+  };
+
+  /**
+     @ingroup Allocators
+     @brief Allocator taking its memory from an Arena.
+
+     A default constructed allocator uses the current arena of the
+     constructing thread (see Arena::current()). Hence it can be used
+     with containers that default construct their allocator, e.g.
+     ArrayList, SLList, lru, DynamicVector and DynamicMatrix.
+     Deallocation is a no-op; the memory is released by rewinding
+     the arena, usually through an ArenaScope.
+   */
+  template <class T>
+  class ArenaAllocator {
+  public:
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T value_type;
+    template <class U> struct rebind {
+      typedef ArenaAllocator<U> other;
+    };
+
+    //! create an allocator using the current arena of the thread
+    ArenaAllocator() throw()
+      : arena_(&Arena::current())
+    {}
+    //! create an allocator using an arena
+    explicit ArenaAllocator(Arena& arena) throw()
+      : arena_(&arena)
+    {}
+    //! copy construct from an other ArenaAllocator, possibly for a different result type
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) throw()
+      : arena_(&other.arena())
+    {}
+
+    pointer address(reference x) const
+    {
+      return &x;
+    }
+    const_pointer address(const_reference x) const
+    {
+      return &x;
+    }
+
+    //! allocate n objects of type T
+    pointer allocate(size_type n,
+                     const void* = 0)
+    {
+      if (n > this->max_size())
+        throw std::bad_alloc();
+      return static_cast<pointer>(arena_->allocate(n * sizeof(T), AlignmentOf<T>::value));
+    }
+
+    //! deallocate n objects of type T at address p
+    void deallocate(pointer p, size_type n)
+    {
+      arena_->deallocate(p, n * sizeof(T));
+    }
+
+    //! max size for allocate
+    size_type max_size() const throw()
+    {
+      return size_type(-1) / sizeof(T);
+    }
+
+    //! copy-construct an object of type T (i.e. make a placement new on p)
+    void construct(pointer p, const T& val)
+    {
+      ::new((void*)p) T(val);
+    }
+#if HAVE_VARIADIC_TEMPLATES || DOXYGEN
+    //! construct an object of type T from variadic parameters
+    //! \note works only with newer C++ compilers
+    template<typename... _Args>
+    void construct(pointer p, _Args&&... __args)
+    {
+      ::new((void *)p) T(std::forward<_Args>(__args)...);
+    }
+#endif
+    //! destroy an object of type T (i.e. call the destructor)
+    void destroy(pointer p)
+    {
+      p->~T();
+    }
+
+    //! the arena we allocate from
+    Arena& arena() const
+    {
+      return *arena_;
+    }
+
+  private:
+    Arena* arena_;
+  };
+
+  template<class T1, class T2>
+  bool operator==(const ArenaAllocator<T1>& a1, const ArenaAllocator<T2>& a2)
+  {
+    return &a1.arena() == &a2.arena();
+  }
+
+  template<class T1, class T2>
+  bool operator!=(const ArenaAllocator<T1>& a1, const ArenaAllocator<T2>& a2)
+  {
+    return &a1.arena() != &a2.arena();
+  }
+}
+
+#endif // DUNE_ARENA_ALLOCATOR_HH
@@ -5,7 +5,9 @@
 
 #include<cassert>
 #include<vector>
-#include"shared_ptr.hh"
+#include<algorithm>
+#include<utility>
+#include<new>
 #include"array.hh"
 #include"iteratorfacades.hh"
 
@@ -53,6 +55,28 @@ namespace Dune
    * but our push_back method leaves all iterators valid.
    * - Additional functionality lets one delete entries before and at an 
    * iterator while moving the iterator to the next valid position.
+   *
+   * The chunks are taken from slabs holding several chunks each. The
+   * slabs grow geometrically, and chunks released by
+   * ArrayListIterator::eraseToHere are reused by push_back.
+   *
+   * The elements of a chunk are stored contiguously. Loops that should
+   * not pay for locating the chunk of each element can use for_each_span,
+   * which hands out the contiguous parts of the list:
+   * \code
+   * struct Sum
+   * {
+   *   Sum() : sum(0) {}
+   *   void operator()(const double* values, std::size_t n)
+   *   {
+   *     for(std::size_t i=0; i<n; ++i)
+   *       sum+=values[i];
+   *   }
+   *   double sum;
+   * };
+   *
+   * double sum = list.for_each_span(Sum()).sum;
+   * \endcode
    */
   template<class T, int N=100, class A=std::allocator<T> >
   class ArrayList
@@ -174,33 +198,115 @@ namespace Dune
      * @brief Purge the list.
      *
      * If there are empty chunks at the front all nonempty
-     * chunks will be moved towards the front and the capacity
-     * increases.
+     * chunks will be moved towards the front. This invalidates
+     * all iterators.
      */
     inline void purge();
     
     /**
      * @brief Delete all entries from the list.
+     *
+     * The memory of the chunks is released.
      */
     inline void clear();
+
+    /**
+     * @brief Exchange the contents with another list.
+     *
+     * Iterators stay valid but refer to the other list afterwards.
+     * @param other The list to swap with.
+     */
+    inline void swap(ArrayList& other);
+
+    /**
+     * @brief Call a functor for each contiguous part of the list.
+     *
+     * The parts are handed out in order as f(first, n), where first
+     * is a pointer to the first entry of the part and n the number
+     * of entries in it.
+     * @param f The functor.
+     * @return The functor after the last call.
+     */
+    template<class F>
+    F for_each_span(F f);
+
+    /**
+     * @brief Call a functor for each contiguous part of the list.
+     *
+     * The parts are handed out in order as f(first, n), where first
+     * is a constant pointer to the first entry of the part and n the
+     * number of entries in it.
+     * @param f The functor.
+     * @return The functor after the last call.
+     */
+    template<class F>
+    F for_each_span(F f) const;
+
     /**
-     * @brief Constructs an Array list with one chunk.
+     * @brief Constructs an empty Array list.
      */
     ArrayList();
+
+    /**
+     * @brief Copy constructor.
+     *
+     * Copies the entries, not the chunks.
+     */
+    ArrayList(const ArrayList& other);
+
+    /**
+     * @brief Assignment operator.
+     *
+     * Copies the entries, not the chunks.
+     */
+    ArrayList& operator=(const ArrayList& other);
+
+    /**
+     * @brief Destructor.
+     */
+    ~ArrayList();
     
   private:
     
     /**
-     * @brief The allocators for the smart pointer.
+     * @brief The type of a chunk.
      */
-    typedef typename A::template rebind<shared_ptr<array<MemberType,chunkSize_> > >::other
-    SmartPointerAllocator;
-    
+    typedef array<MemberType,chunkSize_> Chunk;
+
+    /**
+     * @brief The allocator for the chunks.
+     */
+    typedef typename A::template rebind<Chunk>::other ChunkAllocator;
+
+    /**
+     * @brief The allocator for the chunk pointers.
+     */
+    typedef typename A::template rebind<Chunk*>::other ChunkPointerAllocator;
+
+    /**
+     * @brief The allocator for the slab list.
+     */
+    typedef typename A::template rebind<std::pair<Chunk*,size_type> >::other SlabAllocator;
+
+    enum
+      {
+        /**
+         * @brief The maximum number of chunks allocated at once.
+         */
+        maxSlabChunks_ = 32
+      };
+
     /**
-     * @brief The allocator for the fixed array.
+     * @brief Get an unused chunk, allocating a new slab if there is none.
+     * @return The chunk with default constructed entries.
      */
-     typedef typename A::template rebind<array<MemberType,chunkSize_> >::other
-     ArrayAllocator;
+    inline Chunk* acquireChunk();
+
+    /**
+     * @brief Destroy a chunk and keep it for reuse.
+     * @param chunk The index of the chunk in chunks_.
+     */
+    inline void releaseChunk(size_type chunk);
 
     /**
      * @brief The iterator needs access to the private variables.
@@ -209,8 +315,15 @@ namespace Dune
     friend class ConstArrayListIterator<T,N,A>;
     
     /** @brief the data chunks of our list. */
-    std::vector<shared_ptr<array<MemberType,chunkSize_> >,
-                SmartPointerAllocator> chunks_;
+    std::vector<Chunk*, ChunkPointerAllocator> chunks_;
+    /** @brief The slabs the chunks are taken from and their number of chunks. */
+    std::vector<std::pair<Chunk*,size_type>, SlabAllocator> slabs_;
+    /** @brief The unused chunks of the slabs. */
+    std::vector<Chunk*, ChunkPointerAllocator> freeChunks_;
+    /** @brief The number of chunks of the next slab. */
+    size_type slabChunks_;
+    /** @brief The allocator of the slabs. */
+    ChunkAllocator allocator_;
     /** @brief The current data capacity. 
      * This is the capacity that the list could have theoretically
      * with this number of chunks. That is chunks * chunkSize.
@@ -467,17 +580,119 @@ namespace Dune
     
   template<class T, int N, class A>
   ArrayList<T,N,A>::ArrayList() 
-    : capacity_(0), size_(0), start_(0)
+    : slabChunks_(1), capacity_(0), size_(0), start_(0)
   {
     chunks_.reserve(100);
   }
 
+  template<class T, int N, class A>
+  ArrayList<T,N,A>::ArrayList(const ArrayList& other)
+    : slabChunks_(1), allocator_(other.allocator_), capacity_(0), size_(0), start_(0)
+  {
+    chunks_.reserve(other.chunks_.size());
+    for(const_iterator entry=other.begin(), end=other.end(); entry!=end; ++entry)
+      push_back(*entry);
+  }
+
+  template<class T, int N, class A>
+  ArrayList<T,N,A>& ArrayList<T,N,A>::operator=(const ArrayList& other)
+  {
+    if(this!=&other){
+      ArrayList copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  template<class T, int N, class A>
+  ArrayList<T,N,A>::~ArrayList()
+  {
+    clear();
+  }
+
   template<class T, int N, class A>
   void ArrayList<T,N,A>::clear(){
+    for(size_type chunk=0; chunk<chunks_.size(); ++chunk)
+      if(chunks_[chunk])
+        chunks_[chunk]->~Chunk();
+    for(size_type slab=0; slab<slabs_.size(); ++slab)
+      allocator_.deallocate(slabs_[slab].first, slabs_[slab].second);
+    chunks_.clear();
+    slabs_.clear();
+    freeChunks_.clear();
+    slabChunks_=1;
     capacity_=0;
     size_=0;
     start_=0;
-    chunks_.clear();
+  }
+
+  template<class T, int N, class A>
+  void ArrayList<T,N,A>::swap(ArrayList& other)
+  {
+    std::swap(chunks_, other.chunks_);
+    std::swap(slabs_, other.slabs_);
+    std::swap(freeChunks_, other.freeChunks_);
+    std::swap(slabChunks_, other.slabChunks_);
+    std::swap(allocator_, other.allocator_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(start_, other.start_);
+  }
+
+  template<class T, int N, class A>
+  typename ArrayList<T,N,A>::Chunk* ArrayList<T,N,A>::acquireChunk()
+  {
+    if(freeChunks_.empty())
+      {
+        Chunk* slab = allocator_.allocate(slabChunks_, 0);
+        slabs_.push_back(std::make_pair(slab, slabChunks_));
+        // Reversed such that consecutive chunks are adjacent in memory.
+        for(size_type chunk=slabChunks_; chunk>0; --chunk)
+          freeChunks_.push_back(slab+(chunk-1));
+        if(slabChunks_<static_cast<size_type>(maxSlabChunks_))
+          slabChunks_*=2;
+      }
+    Chunk* chunk = freeChunks_.back();
+    ::new (static_cast<void*>(chunk)) Chunk();
+    freeChunks_.pop_back();
+    return chunk;
+  }
+
+  template<class T, int N, class A>
+  void ArrayList<T,N,A>::releaseChunk(size_type chunk)
+  {
+    chunks_[chunk]->~Chunk();
+    freeChunks_.push_back(chunks_[chunk]);
+    chunks_[chunk]=0;
+  }
+
+  template<class T, int N, class A>
+  template<class F>
+  F ArrayList<T,N,A>::for_each_span(F f)
+  {
+    size_type index=start_, end=start_+size_;
+    while(index<end){
+      size_type offset=index%chunkSize_;
+      size_type n=std::min(static_cast<size_type>(chunkSize_)-offset, end-index);
+      f(&(*chunks_[index/chunkSize_])[offset], n);
+      index+=n;
+    }
+    return f;
+  }
+
+  template<class T, int N, class A>
+  template<class F>
+  F ArrayList<T,N,A>::for_each_span(F f) const
+  {
+    size_type index=start_, end=start_+size_;
+    while(index<end){
+      size_type offset=index%chunkSize_;
+      size_type n=std::min(static_cast<size_type>(chunkSize_)-offset, end-index);
+      const Chunk& chunk=*chunks_[index/chunkSize_];
+      f(&chunk[offset], n);
+      index+=n;
+    }
+    return f;
   }
 
   template<class T, int N, class A>
@@ -492,7 +707,7 @@ namespace Dune
     size_t index=start_+size_;
     if(index==capacity_)
       {
-	chunks_.push_back(shared_ptr<array<MemberType,chunkSize_> >(new array<MemberType,chunkSize_>()));
+	chunks_.push_back(acquireChunk());
         capacity_ += chunkSize_;
       }
     elementAt(index)=entry;
@@ -552,19 +767,15 @@ namespace Dune
   template<class T, int N, class A>
   void ArrayList<T,N,A>::purge()
   {
-    // Distance to copy to the left.
+    // Number of empty chunks at the front.
     size_t distance = start_/chunkSize_;
     if(distance>0){
-      // Number of chunks with entries in it;
-      size_t chunks = ((start_%chunkSize_ + size_)/chunkSize_ );
-      
-      // Copy chunks to the left.
-      std::copy(chunks_.begin()+distance, 
-		chunks_.begin()+(distance+chunks), chunks_.begin());
+      // Their memory was already released by eraseToHere.
+      chunks_.erase(chunks_.begin(), chunks_.begin()+distance);
 
       // Calculate new parameters
       start_ = start_ % chunkSize_;
-      //capacity += distance * chunkSize_;
+      capacity_ -= distance * chunkSize_;
     }
   }
 
@@ -701,7 +912,7 @@ namespace Dune
     // Deallocate memory not needed any more.
     for(size_t chunk=0; chunk<chunks;chunk++) {
         --posChunkStart;
-        list_->chunks_[posChunkStart].reset();
+        list_->releaseChunk(posChunkStart);
     }
 
     // Capacity stays the same as the chunks before us
@@ -0,0 +1,323 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "asyncdebugsink.hh"
+
+#if HAVE_STD_THREAD
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <set>
+#include <streambuf>
+#include <string>
+
+namespace Dune {
+
+  namespace {
+
+    // the sinks that are flushed when the program exits
+    struct LiveSinks
+    {
+      std::mutex mutex;
+      std::set<AsyncDebugSink*> sinks;
+    };
+
+    LiveSinks& liveSinks()
+    {
+      // never destructed, as it is used by the exit handler
+      static LiveSinks* live = new LiveSinks;
+      return *live;
+    }
+
+    void flushLiveSinks()
+    {
+      LiveSinks& live = liveSinks();
+      std::lock_guard<std::mutex> lock(live.mutex);
+      for (std::set<AsyncDebugSink*>::iterator it = live.sinks.begin(); it != live.sinks.end(); ++it)
+        (*it)->flush();
+    }
+
+    unsigned long nextSinkId()
+    {
+      static std::atomic<unsigned long> id(0);
+      return ++id;
+    }
+
+  } // end anonymous namespace
+
+  /* The stream buffer of one thread. The thread collects a line in
+     record_ and copies it to the ring buffer as soon as it is complete,
+     from which the writer thread copies it to the target. There is no
+     put area, so every newline reaches append(). head_ is only advanced
+     by the thread and tail_ only by the writer thread. */
+  class AsyncDebugSink::ThreadBuffer : public std::streambuf
+  {
+  public:
+    ThreadBuffer(AsyncDebugSink& sink, unsigned int thread)
+      : stream(this), sink_(sink), thread_(thread), ring_(sink.bufferSize_), head_(0), tail_(0)
+    {}
+
+    // moves the records in the ring buffer to the target, returns
+    // whether there were any
+    bool drain(std::ostream& target)
+    {
+      const std::size_t head = head_.load(std::memory_order_acquire);
+      const std::size_t tail = tail_.load(std::memory_order_relaxed);
+      if (head == tail)
+        return false;
+      const std::size_t begin = tail % ring_.size(), end = head % ring_.size();
+      if (begin < end)
+        target.write(&ring_[begin], end-begin);
+      else
+      {
+        target.write(&ring_[begin], ring_.size()-begin);
+        target.write(&ring_[0], end);
+      }
+      tail_.store(head, std::memory_order_release);
+      return true;
+    }
+
+    // the incomplete line, written by the destructor of the sink
+    const std::string& pending()
+    {
+      return record_;
+    }
+
+    std::ostream stream;
+
+  protected:
+    virtual int_type overflow(int_type c)
+    {
+      if (!traits_type::eq_int_type(c, traits_type::eof()))
+      {
+        const char ch = traits_type::to_char_type(c);
+        append(&ch, &ch+1);
+      }
+      return traits_type::not_eof(c);
+    }
+
+    virtual std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+      append(s, s+n);
+      return n;
+    }
+
+  private:
+    // adds the characters to the record, moving each line completed by
+    // them to the ring buffer
+    void append(const char* s, const char* end)
+    {
+      while (s != end)
+      {
+        if (record_.empty())
+          stamp();
+        const char* newline = std::find(s, end, '\n');
+        if (newline == end)
+        {
+          record_.append(s, end);
+          break;
+        }
+        record_.append(s, newline+1);
+        s = newline+1;
+        push();
+      }
+    }
+
+    // starts the record with "[seconds.micros rRANK tTHREAD] ", formatted
+    // by hand as printf is slow for floating point numbers
+    void stamp()
+    {
+      const unsigned long long micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - sink_.start_).count();
+      record_ = "[";
+      appendNumber(micros / 1000000, 4, ' ');
+      record_ += '.';
+      appendNumber(micros % 1000000, 6, '0');
+      record_ += " r";
+      if (sink_.rank_ < 0)
+        record_ += '-';
+      appendNumber(sink_.rank_ < 0 ? -(long long)sink_.rank_ : sink_.rank_, 1, '0');
+      record_ += " t";
+      appendNumber(thread_, 1, '0');
+      record_ += "] ";
+    }
+
+    void appendNumber(unsigned long long n, int width, char fill)
+    {
+      char digits[24];
+      int i = sizeof(digits);
+      do
+        digits[--i] = char('0' + n%10);
+      while (n /= 10);
+      for (; int(sizeof(digits))-i < width; --width)
+        record_ += fill;
+      record_.append(digits+i, digits+sizeof(digits));
+    }
+
+    // moves the complete line in record_ to the ring buffer
+    void push()
+    {
+      const std::size_t size = ring_.size();
+      if (record_.size() > size)
+      {
+        // too long for the ring buffer: write it directly after the
+        // records before it
+        while (tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed))
+          wait();
+        std::lock_guard<std::mutex> lock(sink_.targetMutex_);
+        sink_.target_.write(record_.data(), record_.size());
+        record_.clear();
+        return;
+      }
+      const std::size_t head = head_.load(std::memory_order_relaxed);
+      while (head + record_.size() - tail_.load(std::memory_order_acquire) > size)
+        wait();
+      const std::size_t begin = head % size;
+      const std::size_t first = std::min(record_.size(), size-begin);
+      std::copy(record_.begin(), record_.begin()+first, ring_.begin()+begin);
+      std::copy(record_.begin()+first, record_.end(), ring_.begin());
+      head_.store(head + record_.size(), std::memory_order_release);
+      record_.clear();
+    }
+
+    // the ring buffer is full, let the writer thread empty it
+    void wait()
+    {
+      sink_.wake_.notify_one();
+      std::this_thread::yield();
+    }
+
+    AsyncDebugSink& sink_;
+    const unsigned int thread_;
+    std::string record_;
+    std::vector<char> ring_;
+    std::atomic<std::size_t> head_;
+    std::atomic<std::size_t> tail_;
+  };
+
+  AsyncDebugSink::AsyncDebugSink(std::ostream& target, int rank, std::size_t bufferSize)
+    : target_(target), rank_(rank), bufferSize_(std::max<std::size_t>(bufferSize, 256)),
+      id_(nextSinkId()), start_(std::chrono::steady_clock::now()),
+      flushRequested_(0), flushDone_(0), stop_(false)
+  {
+    static bool registered = (std::atexit(flushLiveSinks), true);
+    (void)registered;
+    {
+      LiveSinks& live = liveSinks();
+      std::lock_guard<std::mutex> lock(live.mutex);
+      live.sinks.insert(this);
+    }
+    writer_ = std::thread(&AsyncDebugSink::run, this);
+  }
+
+  AsyncDebugSink::~AsyncDebugSink()
+  {
+    {
+      LiveSinks& live = liveSinks();
+      std::lock_guard<std::mutex> lock(live.mutex);
+      live.sinks.erase(this);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+
+    // the writer has written all complete lines, add the incomplete ones
+    for (std::size_t i = 0; i < buffers_.size(); ++i)
+    {
+      if (!buffers_[i]->pending().empty())
+        target_ << buffers_[i]->pending() << '\n';
+      delete buffers_[i];
+    }
+    target_.flush();
+  }
+
+  std::ostream& AsyncDebugSink::stream()
+  {
+    return threadBuffer().stream;
+  }
+
+  std::ostream& AsyncDebugSink::target()
+  {
+    return target_;
+  }
+
+  void AsyncDebugSink::flush()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const unsigned long request = ++flushRequested_;
+    wake_.notify_one();
+    while (flushDone_ < request)
+      flushed_.wait(lock);
+  }
+
+  AsyncDebugSink::ThreadBuffer& AsyncDebugSink::threadBuffer()
+  {
+    // the buffers of the calling thread, by the id of their sink
+    static thread_local std::vector<std::pair<unsigned long, ThreadBuffer*> > buffers;
+    for (std::size_t i = 0; i < buffers.size(); ++i)
+      if (buffers[i].first == id_)
+        return *buffers[i].second;
+
+    ThreadBuffer* buffer;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffer = new ThreadBuffer(*this, buffers_.size());
+      buffers_.push_back(buffer);
+    }
+    buffers.push_back(std::make_pair(id_, buffer));
+    return *buffer;
+  }
+
+  bool AsyncDebugSink::drain()
+  {
+    std::vector<ThreadBuffer*> buffers;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers = buffers_;
+    }
+    bool drained = false;
+    std::lock_guard<std::mutex> lock(targetMutex_);
+    for (std::size_t i = 0; i < buffers.size(); ++i)
+      drained = buffers[i]->drain(target_) || drained;
+    return drained;
+  }
+
+  void AsyncDebugSink::run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      // everything pushed before the request is drained below
+      const unsigned long request = flushRequested_;
+      const bool stop = stop_;
+      lock.unlock();
+      const bool drained = drain();
+      if (request != flushDone_ || stop)
+      {
+        std::lock_guard<std::mutex> targetLock(targetMutex_);
+        target_.flush();
+      }
+      lock.lock();
+      if (request != flushDone_)
+      {
+        flushDone_ = request;
+        flushed_.notify_all();
+      }
+      if (stop)
+        return;
+      if (!drained && flushRequested_ == request && !stop_)
+        wake_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+  }
+
+} // end namespace Dune
+
+#endif // HAVE_STD_THREAD
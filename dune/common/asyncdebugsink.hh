@@ -0,0 +1,115 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_ASYNCDEBUGSINK_HH
+#define DUNE_COMMON_ASYNCDEBUGSINK_HH
+
+/** \file
+ * \brief A DebugSink that buffers lines per thread and writes them from a background thread
+ */
+
+#include <cstddef>
+#include <ostream>
+
+#include <dune/common/debugstream.hh>
+
+#if HAVE_STD_THREAD || defined(DOXYGEN)
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Dune {
+
+  /**
+     \addtogroup DebugOut
+     \{
+  */
+
+  /*! \brief A DebugSink that buffers lines per thread and writes them from a background thread
+
+  Every line written to the sink becomes a record that is stamped with
+  the time since the construction of the sink, the rank and a number
+  of the writing thread:
+
+  \verbatim
+  [   0.012345 r3 t1] assembled 1024 elements
+  \endverbatim
+
+  Each thread collects its records in a ring buffer of its own, which
+  it shares only with the writer thread by atomic positions, so the
+  threads never wait for each other or for the target stream. They only
+  wait if their buffer is full. The writer thread moves whole records
+  to the target, so lines of different threads are never mixed.
+
+  flush() waits until all complete lines written so far are in the
+  target and flushes it. DebugStream::flush(), pop() and detach() call
+  it, as does the destructor of the sink and, for sinks still existing
+  then, the end of the program through std::exit(). An incomplete last
+  line of a thread is only written by the destructor.
+
+  \note Only available if the compiler supports std::thread (HAVE_STD_THREAD).
+  */
+  class AsyncDebugSink : public DebugSink
+  {
+  public:
+    /*! \brief Create a sink and start its writer thread
+
+    \param target     the stream to write to
+    \param rank       the rank stamped on the records, e.g. the MPI rank
+    \param bufferSize the size of the ring buffer of each thread in bytes
+    */
+    explicit AsyncDebugSink(std::ostream& target, int rank = 0,
+                            std::size_t bufferSize = 1<<16);
+
+    //! \brief write all lines and stop the writer thread
+    ~AsyncDebugSink();
+
+    //! \brief the stream of the calling thread
+    virtual std::ostream& stream();
+
+    //! \brief the stream the records are written to
+    virtual std::ostream& target();
+
+    //! \brief wait until all complete lines written so far are in the target
+    virtual void flush();
+
+  private:
+    class ThreadBuffer;
+    friend class ThreadBuffer;
+
+    AsyncDebugSink(const AsyncDebugSink&);
+    AsyncDebugSink& operator=(const AsyncDebugSink&);
+
+    ThreadBuffer& threadBuffer();
+    void run();
+    bool drain();
+
+    std::ostream& target_;
+    const int rank_;
+    const std::size_t bufferSize_;
+    // distinguishes the sink in the thread local buffer lists
+    const unsigned long id_;
+    const std::chrono::steady_clock::time_point start_;
+
+    // guards buffers_, the flush counters and stop_
+    std::mutex mutex_;
+    // guards the target, held by the writer thread while writing
+    std::mutex targetMutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::vector<ThreadBuffer*> buffers_;
+    unsigned long flushRequested_;
+    unsigned long flushDone_;
+    bool stop_;
+    std::thread writer_;
+  };
+
+  /** \} */
+
+} // end namespace Dune
+
+#endif // HAVE_STD_THREAD || defined(DOXYGEN)
+
+#endif // DUNE_COMMON_ASYNCDEBUGSINK_HH
@@ -0,0 +1,166 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "benchmark.hh"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <dune/common/exceptions.hh>
+
+namespace Dune {
+
+  namespace {
+
+    // the string as a JSON string literal
+    std::string quote(const std::string& s)
+    {
+      std::ostringstream out;
+      out << '"';
+      for (std::string::size_type i = 0; i < s.size(); ++i)
+      {
+        const unsigned char c = s[i];
+        if (c == '"' || c == '\\')
+          out << '\\' << c;
+        else if (c < 0x20)
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+        else
+          out << c;
+      }
+      out << '"';
+      return out.str();
+    }
+
+    // a time per call with a unit for people
+    std::string time(double seconds)
+    {
+      std::ostringstream out;
+      out << std::setprecision(4);
+      if (seconds < 1e-6)
+        out << 1e9*seconds << " ns";
+      else if (seconds < 1e-3)
+        out << 1e6*seconds << " us";
+      else if (seconds < 1)
+        out << 1e3*seconds << " ms";
+      else
+        out << seconds << " s";
+      return out.str();
+    }
+
+  } // end anonymous namespace
+
+  Benchmark::Benchmark(const std::string& suite, int argc, char** argv, bool output)
+  {
+    init(suite, argc, argv, output);
+  }
+
+  void Benchmark::init(const std::string& suite, int argc, char** argv, bool output)
+  {
+    suite_ = suite;
+    output_ = output;
+    repetitions_ = 10;
+    warmup_ = 2;
+    minTime_ = 0.01;
+    for (int i = 1; i < argc; ++i)
+    {
+      const std::string option = argv[i];
+      if (option != "--repetitions" && option != "--warmup" && option != "--min-time"
+          && option != "--filter" && option != "--json")
+        DUNE_THROW(RangeError, "Unknown benchmark option " << option << ", known are --repetitions N, "
+                   "--warmup N, --min-time SECONDS, --filter TEXT and --json FILE");
+      if (++i == argc)
+        DUNE_THROW(RangeError, "Benchmark option " << option << " needs a value");
+      const std::string value = argv[i];
+      if (option == "--repetitions")
+        repetitions_ = std::max(1, std::atoi(value.c_str()));
+      else if (option == "--warmup")
+        warmup_ = std::max(0, std::atoi(value.c_str()));
+      else if (option == "--min-time")
+        minTime_ = std::atof(value.c_str());
+      else if (option == "--filter")
+        filter_ = value;
+      else
+        json_ = value;
+    }
+  }
+
+  bool Benchmark::selected(const std::string& name) const
+  {
+    return name.find(filter_) != std::string::npos;
+  }
+
+  const Benchmark::Result& Benchmark::add(const std::string& name, std::size_t iterations,
+                                          std::vector<double>& samples, double operations)
+  {
+    results_.push_back(Result());
+    Result& r = results_.back();
+    r.name = name;
+    r.iterations = iterations;
+    r.samples = samples;
+    r.operations = operations;
+
+    std::sort(samples.begin(), samples.end());
+    const std::size_t n = samples.size();
+    r.min = samples.front();
+    r.max = samples.back();
+    r.median = n % 2 ? samples[n/2] : 0.5*(samples[n/2-1] + samples[n/2]);
+    r.mean = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      r.mean += samples[i];
+    r.mean /= n;
+    r.stddev = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      r.stddev += (samples[i] - r.mean) * (samples[i] - r.mean);
+    r.stddev = n > 1 ? std::sqrt(r.stddev / (n-1)) : 0;
+
+    if (output_)
+    {
+      std::ostringstream line;
+      line << std::left << std::setw(48) << (suite_ + "/" + name) << std::right
+           << std::setw(12) << time(r.median)
+           << "  min " << time(r.min) << ", max " << time(r.max)
+           << ", stddev " << std::setprecision(2) << std::fixed << 100*r.stddev/r.mean << "%";
+      if (operations > 0)
+        line << ", " << std::setprecision(3) << operations/r.median*1e-6 << " Mop/s";
+      std::cout << line.str() << std::endl;
+    }
+    return r;
+  }
+
+  int Benchmark::finish()
+  {
+    if (!output_ || json_.empty())
+      return 0;
+
+    std::ofstream out(json_.c_str());
+    if (!out)
+      DUNE_THROW(IOError, "Could not open " << json_ << " for the benchmark results");
+    out << std::setprecision(9);
+    out << "{\n  \"suite\": " << quote(suite_) << ",\n"
+        << "  \"repetitions\": " << repetitions_ << ",\n"
+        << "  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results_.size(); ++i)
+    {
+      const Result& r = results_[i];
+      out << (i ? ",\n" : "\n")
+          << "    {\"name\": " << quote(r.name)
+          << ", \"iterations\": " << r.iterations
+          << ", \"min\": " << r.min << ", \"median\": " << r.median << ", \"mean\": " << r.mean
+          << ", \"stddev\": " << r.stddev << ", \"max\": " << r.max
+          << ", \"operations\": " << r.operations << "}";
+    }
+    out << "\n  ]\n}\n";
+    if (!out)
+      DUNE_THROW(IOError, "Could not write the benchmark results to " << json_);
+    return 0;
+  }
+
+} // end namespace Dune
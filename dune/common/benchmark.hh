@@ -0,0 +1,231 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_BENCHMARK_HH
+#define DUNE_COMMON_BENCHMARK_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <dune/common/parallel/collectivecommunication.hh>
+#include <dune/common/profiler.hh>
+#include <dune/common/shared_ptr.hh>
+
+/** @file
+    @brief A harness for micro benchmarks with statistics and JSON output.
+*/
+
+namespace Dune {
+
+#ifndef DOXYGEN
+  namespace Detail {
+
+    // makes the processes of a parallel benchmark take the same number
+    // of calls per sample
+    struct BenchmarkAgreement
+    {
+      virtual ~BenchmarkAgreement() {}
+      virtual double max(double time) const = 0;
+    };
+
+    template<class C>
+    struct CollectiveBenchmarkAgreement : public BenchmarkAgreement
+    {
+      explicit CollectiveBenchmarkAgreement(const CollectiveCommunication<C>& c) : comm(c) {}
+
+      virtual double max(double time) const
+      {
+        return comm.max(time);
+      }
+
+      CollectiveCommunication<C> comm;
+    };
+
+  } // end namespace Detail
+#endif // DOXYGEN
+
+  /** @addtogroup Common
+   @{
+  */
+
+  /**
+   * @brief Runs micro benchmarks repeatedly and collects statistics of their run times.
+   *
+   * A benchmark is any function object without arguments. run() first
+   * calls it as often as needed for a sample to last at least the
+   * minimum time, then takes some warm-up samples that are dropped, and
+   * then the measured samples. It reports the minimum, median, mean,
+   * standard deviation and maximum of the time per call, and the rate if
+   * the number of operations per call is given:
+   *
+   * \code
+   * struct Dot
+   * {
+   *   const Dune::DynamicVector<double>& x;
+   *   Dot(const Dune::DynamicVector<double>& x_) : x(x_) {}
+   *   void operator() () const { Dune::Benchmark::doNotOptimize(x*x); }
+   * };
+   *
+   * int main(int argc, char** argv)
+   * {
+   *   Dune::Benchmark suite("vector", argc, argv);
+   *   Dune::DynamicVector<double> x(1000, 1.0);
+   *   suite.run("dot n=1000", Dot(x), 2000);
+   *   return suite.finish();
+   * }
+   * \endcode
+   *
+   * The command line options are
+   * - \c --repetitions \c N the measured samples, default 10
+   * - \c --warmup \c N the dropped samples, default 2
+   * - \c --min-time \c S the minimum seconds of a sample, default 0.01
+   * - \c --filter \c TEXT runs only the benchmarks whose names contain TEXT
+   * - \c --json \c FILE writes the results to FILE when finish() is called
+   *
+   * Benchmarks of collective operations are created with the
+   * collective communication of their processes, which then agree on
+   * the calls per sample, and only the first process reports.
+   *
+   * The results are printed to std::cout as they are taken. The compare
+   * script dune-benchmark-compare reads the JSON files of two runs and
+   * reports the benchmarks that became slower.
+   */
+  class Benchmark
+  {
+  public:
+    //! The statistics of a benchmark, times are in seconds per call
+    struct Result
+    {
+      std::string name;
+      std::size_t iterations; //!< calls per sample
+      std::vector<double> samples;
+      double min;
+      double median;
+      double mean;
+      double stddev;
+      double max;
+      double operations;      //!< operations per call, 0 if not given
+    };
+
+    /**
+     * @brief Creates a suite of benchmarks configured from the command line.
+     *
+     * @param suite  the name of the suite in the output
+     * @param argc   the number of arguments
+     * @param argv   the arguments as given to main
+     * @param output whether to print and write the results, e.g. only
+     *               on one rank of a parallel benchmark
+     * @throw RangeError for unknown or incomplete options
+     */
+    Benchmark(const std::string& suite, int argc, char** argv, bool output = true);
+
+    /**
+     * @brief Creates a suite of collective benchmarks of the processes of comm.
+     *
+     * Each benchmark is called the same number of times on all processes
+     * and the results of rank 0 are reported.
+     */
+    template<class C>
+    Benchmark(const std::string& suite, int argc, char** argv, const CollectiveCommunication<C>& comm)
+    {
+      init(suite, argc, argv, comm.rank() == 0);
+      agreement_.reset(new Detail::CollectiveBenchmarkAgreement<C>(comm));
+    }
+
+    /**
+     * @brief Measures a function object.
+     *
+     * @param name       the name of the benchmark
+     * @param f          the function object, called without arguments
+     * @param operations the operations per call, e.g. floating point
+     *                   operations or processed entries, for the rate
+     * @return the statistics, valid until the next run(), or 0 if the
+     *         benchmark was filtered out
+     */
+    template<class F>
+    const Result* run(const std::string& name, F f, double operations = 0)
+    {
+      if (!selected(name))
+        return 0;
+
+      // the calls per sample for the minimum time, growing at most
+      // tenfold per step
+      std::size_t iterations = 1;
+      for (double time = agree(sample(f, iterations)); time < minTime_;
+           time = agree(sample(f, iterations)))
+      {
+        const double factor = time > 0 ? std::min(10.0, 1.2*minTime_/time) : 10.0;
+        iterations = std::max(iterations+1, std::size_t(factor*iterations));
+      }
+
+      for (int i = 0; i < warmup_; ++i)
+        sample(f, iterations);
+      std::vector<double> samples(repetitions_);
+      for (int i = 0; i < repetitions_; ++i)
+        samples[i] = sample(f, iterations) / iterations;
+      return &add(name, iterations, samples, operations);
+    }
+
+    /**
+     * @brief Writes the results as JSON if requested.
+     *
+     * @return 0, to be returned from main
+     */
+    int finish();
+
+    //! The results so far
+    const std::vector<Result>& results() const
+    {
+      return results_;
+    }
+
+    //! Keeps the compiler from removing the computation of a value
+    template<class T>
+    static void doNotOptimize(const T& value)
+    {
+#ifdef __GNUC__
+      asm volatile ("" : : "r" (&value) : "memory");
+#else
+      static const T* volatile sink;
+      sink = &value;
+#endif
+    }
+
+  private:
+    template<class F>
+    static double sample(F& f, std::size_t iterations)
+    {
+      const double start = Profiler::wallTime();
+      for (std::size_t i = 0; i < iterations; ++i)
+        f();
+      return Profiler::wallTime() - start;
+    }
+
+    void init(const std::string& suite, int argc, char** argv, bool output);
+    bool selected(const std::string& name) const;
+
+    double agree(double time) const
+    {
+      return agreement_ ? agreement_->max(time) : time;
+    }
+
+    const Result& add(const std::string& name, std::size_t iterations,
+                      std::vector<double>& samples, double operations);
+
+    std::string suite_;
+    bool output_;
+    int repetitions_;
+    int warmup_;
+    double minTime_;
+    std::string filter_;
+    std::string json_;
+    std::vector<Result> results_;
+    shared_ptr<const Detail::BenchmarkAgreement> agreement_;
+  };
+
+  /** @} end documentation */
+
+} // end namespace Dune
+
+#endif // DUNE_COMMON_BENCHMARK_HH
@@ -6,6 +6,8 @@
 #include<iostream>
 #include<limits>
 #include<cstdlib>
+#include<cassert>
+#include<stdint.h>
 #include<dune/common/exceptions.hh>
 #include<dune/common/hash.hh>
 
@@ -28,22 +30,29 @@ namespace Dune
 #endif
 
   /**
-   * @brief Portable very large unsigned integers 
+   * @brief Portable very large unsigned integers
    *
    * Implements (arbitrarily) large unsigned integers to be used as global
    * ids in some grid managers. Size is a template parameter.
    *
+   * The number is stored in 64 bit limbs. For compatibility with the
+   * former representation by 16 bit digits, k is rounded up to a multiple
+   * of 16 and all arithmetic is performed modulo 2^digits.
+   *
    * \tparam k Number of bits of the integer type
    */
 
   template<int k>
   class bigunsignedint {
   public:
+    //! the type of a limb
+    typedef uint64_t limb_type;
 
-	// unsigned short is 16 bits wide, n is the number of digits needed
-    enum { bits=std::numeric_limits<unsigned short>::digits, n=k/bits+(k%bits!=0), 
-	   hexdigits=4, bitmask=0xFFFF, compbitmask=0xFFFF0000, 
-	   overflowmask=0x1 };
+    // n is the number of limbs needed
+    enum { bits=std::numeric_limits<limb_type>::digits,
+           digits=16*(k/16+(k%16!=0)),
+           n=digits/bits+(digits%bits!=0),
+           hexdigits=bits/4 };
 
 	//! Construct uninitialized
 	bigunsignedint ();
@@ -70,15 +79,17 @@ namespace Dune
 	bigunsignedint<k>& operator++ ();
 
 	//! divide
-        //! \warning This function is very slow and its usage should be
-        //! prevented if possible
 	bigunsignedint<k> operator/ (const bigunsignedint<k>& x) const;
 
 	//! modulo
-        //! \warning This function is very slow and its usage should be
-        //! prevented if possible
 	bigunsignedint<k> operator% (const bigunsignedint<k>& x) const;
 
+    /**
+     * @brief Compute quotient and remainder at once.
+     * @throw MathError if the divisor is zero.
+     */
+    static void divmod (const bigunsignedint<k>& x, const bigunsignedint<k>& y,
+                        bigunsignedint<k>& quotient, bigunsignedint<k>& remainder);
 
 	//! bitwise and
 	bigunsignedint<k> operator& (const bigunsignedint<k>& x) const;
@@ -129,32 +140,67 @@ namespace Dune
      */
     double todouble() const;
 
-	friend class bigunsignedint<k/2>;
     friend struct std::numeric_limits< bigunsignedint<k> >;
-    
+
 #if HAVE_DUNE_HASH
 
     inline friend std::size_t hash_value(const bigunsignedint& arg)
     {
-      return hash_range(arg.digit,arg.digit + arg.n);
+      // hash the 16 bit digits of the former representation
+      std::size_t seed = 0;
+      for (int i=0; i<digits/16; i++)
+        hash_combine(seed, static_cast<unsigned short>(arg.digit[i/4]>>(16*(i%4))));
+      return seed;
     }
 
 #endif // HAVE_DUNE_HASH
 
   private:
-	unsigned short digit[n];
+	limb_type digit[n];
 #if HAVE_MPI
     friend struct MPITraits<bigunsignedint<k> >;
 #endif
     inline void assign(std::size_t x);
-    
-    
+
+    //! the bits of the highest limb that are part of the number
+    static limb_type topmask()
+    {
+      return (digits%bits==0) ? ~limb_type(0) : (limb_type(1)<<(digits%bits))-1;
+    }
+
+    //! discard the bits beyond digits
+    void truncate()
+    {
+      digit[n-1] &= topmask();
+    }
+
+    //! the number of limbs without leading zero limbs
+    int size() const
+    {
+      int s=n;
+      while (s>0 && digit[s-1]==0) --s;
+      return s;
+    }
+
+    //! multiply two limbs, returns the lower half and stores the upper one in high
+    static limb_type multiply (limb_type a, limb_type b, limb_type& high);
+
+    /**
+     * @brief divide (high*2^bits+low) by d.
+     *
+     * Requires high<d and, without 128 bit integers, a normalized d,
+     * i.e. with its highest bit set.
+     */
+    static limb_type divide (limb_type high, limb_type low, limb_type d, limb_type& remainder);
+
+    //! the number of leading zero bits of a non-zero limb
+    static int leadingZeros (limb_type x);
   } ;
 
   // Constructors
   template<int k>
   bigunsignedint<k>::bigunsignedint ()
-  { 
+  {
     assign(0u);
   }
 
@@ -173,63 +219,111 @@ namespace Dune
   template<int k>
   void bigunsignedint<k>::assign(std::size_t x)
   {
-    int no=std::min(static_cast<int>(n),
-		    static_cast<int>(std::numeric_limits<std::size_t>::digits/bits));
-    
-    for(int i=0; i<no; ++i){
-	digit[i] = (x&bitmask);
-	x=x>>bits;
+    digit[0] = x;
+    for (unsigned int i=1; i<n; i++) digit[i]=0;
+    truncate();
+  }
+
+  // limb arithmetic
+  template<int k>
+  inline typename bigunsignedint<k>::limb_type
+  bigunsignedint<k>::multiply (limb_type a, limb_type b, limb_type& high)
+  {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = static_cast<unsigned __int128>(a)*b;
+    high = static_cast<limb_type>(product>>bits);
+    return static_cast<limb_type>(product);
+#else
+    // schoolbook multiplication of the 32 bit halves
+    const limb_type mask = 0xFFFFFFFFu;
+    limb_type a0 = a&mask, a1 = a>>32, b0 = b&mask, b1 = b>>32;
+    limb_type p00 = a0*b0, p01 = a0*b1, p10 = a1*b0, p11 = a1*b1;
+    limb_type middle = (p00>>32) + (p01&mask) + (p10&mask);
+    high = p11 + (p01>>32) + (p10>>32) + (middle>>32);
+    return (middle<<32) | (p00&mask);
+#endif
+  }
+
+  template<int k>
+  inline typename bigunsignedint<k>::limb_type
+  bigunsignedint<k>::divide (limb_type high, limb_type low, limb_type d, limb_type& remainder)
+  {
+    assert(high<d);
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 dividend = (static_cast<unsigned __int128>(high)<<bits) | low;
+    remainder = static_cast<limb_type>(dividend%d);
+    return static_cast<limb_type>(dividend/d);
+#else
+    // Divide by the 32 bit halves of the normalized divisor, see
+    // Hacker's Delight, divlu.
+    assert(d>>(bits-1));
+    const limb_type b = limb_type(1)<<32, mask = b-1;
+    limb_type d1 = d>>32, d0 = d&mask;
+    limb_type l1 = low>>32, l0 = low&mask;
+
+    limb_type q1 = high/d1, r = high - q1*d1;
+    while (q1>=b || q1*d0 > ((r<<32)|l1)){
+      --q1;
+      r += d1;
+      if (r>=b) break;
+    }
+    limb_type rest = (high<<32) + l1 - q1*d;
+
+    limb_type q0 = rest/d1;
+    r = rest - q0*d1;
+    while (q0>=b || q0*d0 > ((r<<32)|l0)){
+      --q0;
+      r += d1;
+      if (r>=b) break;
     }
-    for (unsigned int i=no; i<n; i++) digit[i]=0;
+    remainder = (rest<<32) + l0 - q0*d;
+    return (q1<<32) | q0;
+#endif
+  }
+
+  template<int k>
+  inline int bigunsignedint<k>::leadingZeros (limb_type x)
+  {
+    assert(x!=0);
+#ifdef __GNUC__
+    return __builtin_clzll(x);
+#else
+    int zeros=0;
+    while (!(x>>(bits-1))){
+      x <<= 1;
+      ++zeros;
+    }
+    return zeros;
+#endif
   }
 
   // export
   template<int k>
   inline unsigned int bigunsignedint<k>::touint () const
   {
-	return (digit[1]<<bits)+digit[0];
+	return static_cast<unsigned int>(digit[0]&0xFFFFFFFFu);
   }
 
   template<int k>
   inline double bigunsignedint<k>::todouble() const
   {
-    int firstInZeroRange=n;
-    for(int i=n-1; i>=0; --i)
-      if(digit[i]!=0)
-	break;
-      else
-	--firstInZeroRange;
-    int representableDigits=std::numeric_limits<double>::digits/bits;
-    int lastInRepresentableRange=0;
-    if(representableDigits<firstInZeroRange)
-      lastInRepresentableRange=firstInZeroRange-representableDigits;
     double val=0;
-    for(int i=firstInZeroRange-1; i>=lastInRepresentableRange; --i)
-      val =val*(1<<bits)+digit[i];
-    return val*(1<<(bits*lastInRepresentableRange));
+    for (int i=size()-1; i>=0; --i)
+      val = val*18446744073709551616.0 + static_cast<double>(digit[i]);
+    return val;
   }
   // print
   template<int k>
   inline void bigunsignedint<k>::print (std::ostream& s) const
-  {    
-	bool leading=false;
+  {
+    static const char hex[] = "0123456789abcdef";
+    char buffer[digits/4+1];
 
-	// print from left to right
-	for (int i=n-1; i>=0; i--)
-	  for (int d=hexdigits-1; d>=0; d--)
-		{
-		  // extract one hex digit
-		  int current = (digit[i]>>(d*4))&0xF;
-		  if (current!=0)
-			{
-			  //			  s.setf(std::ios::noshowbase);
-			  s << std::hex << current;
-			  leading = false;
-			}
-		  else if (!leading) s << std::hex << current;
-		}
-	if (leading) s << "0";
-	s << std::dec;
+	// print from left to right, including leading zeros
+	for (int d=0; d<digits/4; d++)
+      buffer[digits/4-1-d] = hex[(digit[d/hexdigits]>>(4*(d%hexdigits)))&0xF];
+    buffer[digits/4] = '\0';
+	s << buffer;
   }
 
   template <int k>
@@ -245,14 +339,16 @@ namespace Dune
   inline bigunsignedint<k> bigunsignedint<k>::operator+ (const bigunsignedint<k>& x) const
   {
 	bigunsignedint<k> result;
-	int overflow=0;
+	limb_type overflow=0;
 
 	for (unsigned int i=0; i<n; i++)
 	  {
-		int sum = ((int)digit[i]) + ((int)x.digit[i]) + overflow;
-		result.digit[i] = sum&bitmask;
-		overflow = (sum>>bits)&overflowmask;
+		limb_type sum = digit[i] + overflow;
+		overflow = (sum<overflow);
+		result.digit[i] = sum + x.digit[i];
+		overflow += (result.digit[i]<sum);
 	  }
+	result.truncate();
 	return result;
   }
 
@@ -260,92 +356,178 @@ namespace Dune
   inline bigunsignedint<k> bigunsignedint<k>::operator- (const bigunsignedint<k>& x) const
   {
 	bigunsignedint<k> result;
-	int overflow=0;
+	limb_type overflow=0;
 
 	for (unsigned int i=0; i<n; i++)
 	  {
-		int diff = ((int)digit[i]) - (((int)x.digit[i]) + overflow);
-		if (diff>=0)
-		  result.digit[i] = (unsigned short) diff;
-		else
-		  {
-			result.digit[i] = (unsigned short) (diff+bitmask);
-  			overflow = 1;
-		  }
+		limb_type diff = digit[i] - x.digit[i];
+		limb_type borrow = (digit[i]<x.digit[i]);
+		result.digit[i] = diff - overflow;
+		overflow = borrow + (diff<overflow);
 	  }
+	result.truncate();
 	return result;
   }
 
   template <int k>
   inline bigunsignedint<k> bigunsignedint<k>::operator* (const bigunsignedint<k>& x) const
   {
-	bigunsignedint<2*k> finalproduct(0);
+	bigunsignedint<k> result(0);
 
-	for (unsigned int m=0; m<n; m++) // digit in right factor
+	// only the lower n limbs of the product are needed
+	for (unsigned int m=0; m<n; m++) // limb in right factor
 	  {
-		bigunsignedint<2*k> singleproduct(0);
-		unsigned int overflow(0);
-		for (unsigned int i=0; i<n; i++) 
+		if (x.digit[m]==0) continue;
+		limb_type overflow=0;
+		for (unsigned int i=0; i+m<n; i++)
 		  {
-			unsigned int digitproduct = ((unsigned int)digit[i])*((unsigned int)x.digit[m])+overflow;
-			singleproduct.digit[i+m] = (unsigned short) (digitproduct&bitmask);
-			overflow = (digitproduct>>bits)&bitmask;
+#ifdef __SIZEOF_INT128__
+			unsigned __int128 product = static_cast<unsigned __int128>(digit[i])*x.digit[m]
+			  + result.digit[i+m] + overflow;
+			result.digit[i+m] = static_cast<limb_type>(product);
+			overflow = static_cast<limb_type>(product>>bits);
+#else
+			limb_type high;
+			limb_type low = multiply(digit[i], x.digit[m], high);
+			low += overflow;
+			high += (low<overflow);
+			result.digit[i+m] += low;
+			high += (result.digit[i+m]<low);
+			overflow = high;
+#endif
 		  }
-		finalproduct = finalproduct+singleproduct;
 	  }
-
-	bigunsignedint<k> result;
-	for (unsigned int i=0; i<n; i++) result.digit[i] = finalproduct.digit[i];
+	result.truncate();
 	return result;
   }
 
   template <int k>
   inline  bigunsignedint<k>& bigunsignedint<k>::operator++ ()
   {
-	int overflow=1;
-
 	for (unsigned int i=0; i<n; i++)
-	  {
-		int sum = ((int)digit[i]) + overflow;
-		digit[i] = sum&bitmask;
-		overflow = (sum>>bits)&overflowmask;
-	  }
+	  if (++digit[i]!=0) break;
+	truncate();
 	return *this;
   }
 
   template <int k>
-  inline bigunsignedint<k> bigunsignedint<k>::operator/ (const bigunsignedint<k>& x) const
+  void bigunsignedint<k>::divmod (const bigunsignedint<k>& x, const bigunsignedint<k>& y,
+                                  bigunsignedint<k>& quotient, bigunsignedint<k>& remainder)
   {
-    if(x==0)
+    const int ny = y.size();
+    if (ny==0)
       DUNE_THROW(Dune::MathError, "division by zero!");
 
-	// better slow than nothing
-	bigunsignedint<k> temp(*this);
-	bigunsignedint<k> result(0);
+    const int nx = x.size();
+    if (x<y){
+      remainder = x;
+      quotient = 0;
+      return;
+    }
 
-	while (temp>=x)
-	  {
-		++result;
-		temp = temp-x;
-	  }
+    // Knuth, The Art of Computer Programming, Vol. 2, Algorithm 4.3.1 D.
+    // Normalize such that the highest bit of the divisor is set.
+    const int shift = leadingZeros(y.digit[ny-1]);
+    limb_type u[n+1], v[n];
+    for (int i=ny-1; i>0; i--)
+      v[i] = (y.digit[i]<<shift) | (shift ? y.digit[i-1]>>(bits-shift) : 0);
+    v[0] = y.digit[0]<<shift;
+    u[nx] = shift ? x.digit[nx-1]>>(bits-shift) : 0;
+    for (int i=nx-1; i>0; i--)
+      u[i] = (x.digit[i]<<shift) | (shift ? x.digit[i-1]>>(bits-shift) : 0);
+    u[0] = x.digit[0]<<shift;
+
+    bigunsignedint<k> q(0);
+
+    if (ny==1){
+      // short division
+      limb_type r = u[nx];
+      for (int j=nx-1; j>=0; j--)
+        q.digit[j] = divide(r, u[j], v[0], r);
+      quotient = q;
+      remainder = 0;
+      remainder.digit[0] = r>>shift;
+      return;
+    }
 
-	return result;
+    for (int j=nx-ny; j>=0; j--)
+      {
+        // estimate the quotient limb from the leading limbs
+        limb_type qhat, rhat;
+        bool rhatOverflow = false;
+        if (u[j+ny]>=v[ny-1]){
+          qhat = ~limb_type(0);
+          rhat = u[j+ny-1] + v[ny-1];
+          rhatOverflow = (rhat<v[ny-1]);
+        }
+        else
+          qhat = divide(u[j+ny], u[j+ny-1], v[ny-1], rhat);
+
+        // correct the estimate, at most two steps are necessary
+        while (!rhatOverflow){
+          limb_type high;
+          limb_type low = multiply(qhat, v[ny-2], high);
+          if (high<rhat || (high==rhat && low<=u[j+ny-2]))
+            break;
+          --qhat;
+          rhat += v[ny-1];
+          rhatOverflow = (rhat<v[ny-1]);
+        }
+
+        // multiply and subtract
+        limb_type carry=0, borrow=0;
+        for (int i=0; i<ny; i++){
+          limb_type high;
+          limb_type low = multiply(qhat, v[i], high);
+          low += carry;
+          carry = high + (low<carry);
+          limb_type diff = u[i+j] - low;
+          limb_type b = (u[i+j]<low);
+          u[i+j] = diff - borrow;
+          borrow = b + (diff<borrow);
+        }
+        limb_type diff = u[j+ny] - carry;
+        limb_type b = (u[j+ny]<carry);
+        u[j+ny] = diff - borrow;
+        b += (diff<borrow);
+
+        if (b){
+          // the estimate was one too large, add back
+          --qhat;
+          limb_type overflow=0;
+          for (int i=0; i<ny; i++){
+            limb_type sum = u[i+j] + overflow;
+            overflow = (sum<overflow);
+            u[i+j] = sum + v[i];
+            overflow += (u[i+j]<sum);
+          }
+          u[j+ny] += overflow;
+        }
+        q.digit[j] = qhat;
+      }
+
+    // unnormalize the remainder
+    bigunsignedint<k> r(0);
+    for (int i=0; i<ny; i++)
+      r.digit[i] = (u[i]>>shift) | (shift ? u[i+1]<<(bits-shift) : 0);
+    quotient = q;
+    remainder = r;
   }
 
   template <int k>
-  inline bigunsignedint<k> bigunsignedint<k>::operator% (const bigunsignedint<k>& x) const
+  inline bigunsignedint<k> bigunsignedint<k>::operator/ (const bigunsignedint<k>& x) const
   {
-	// better slow than nothing
-	bigunsignedint<k> temp(*this);
-	bigunsignedint<k> result(0);
-
-	while (temp>=x)
-	  {
-		++result;
-		temp = temp-x;
-	  }
+	bigunsignedint<k> quotient, remainder;
+	divmod(*this, x, quotient, remainder);
+	return quotient;
+  }
 
-	return temp;
+  template <int k>
+  inline bigunsignedint<k> bigunsignedint<k>::operator% (const bigunsignedint<k>& x) const
+  {
+	bigunsignedint<k> quotient, remainder;
+	divmod(*this, x, quotient, remainder);
+	return remainder;
   }
 
 
@@ -382,6 +564,7 @@ namespace Dune
 	bigunsignedint<k> result;
 	for (unsigned int i=0; i<n; i++)
 	  result.digit[i] = ~digit[i];
+	result.truncate();
 	return result;
   }
 
@@ -392,21 +575,12 @@ namespace Dune
 
 	// multiples of bits
 	int j=shift/bits;
-	for (int i=n-1-j; i>=0; i--)
-	  result.digit[i+j] = digit[i];
-
 	// remainder
-	j=shift%bits;
-	for (int i=n-1; i>=0; i--)
-	  {
-		unsigned int temp = result.digit[i];
-		temp = temp<<j;
-		result.digit[i] = (unsigned short) (temp&bitmask);
-		temp = temp>>bits;
-		if (i+1<(int)n)
-		  result.digit[i+1] = result.digit[i+1]|temp;
-	  }	
+	int r=shift%bits;
+	for (int i=n-1-j; i>=0; i--)
+	  result.digit[i+j] = (digit[i]<<r) | ((r && i>0) ? digit[i-1]>>(bits-r) : 0);
 
+	result.truncate();
 	return result;
   }
 
@@ -417,19 +591,10 @@ namespace Dune
 
 	// multiples of bits
 	int j=shift/bits;
-	for (unsigned int i=0; i<n-j; i++)
-	  result.digit[i] = digit[i+j];
-
 	// remainder
-	j=shift%bits;
-	for (unsigned int i=0; i<n; i++)
-	  {
-		unsigned int temp = result.digit[i];
-		temp = temp<<(bits-j);
-		result.digit[i] = (unsigned short) ((temp&compbitmask)>>bits);
-		if (i>0)
-		  result.digit[i-1] = result.digit[i-1] | (temp&bitmask);
-	  }
+	int r=shift%bits;
+	for (int i=0; i+j<static_cast<int>(n); i++)
+	  result.digit[i] = (digit[i+j]>>r) | ((r && i+j+1<static_cast<int>(n)) ? digit[i+j+1]<<(bits-r) : 0);
 
 	return result;
   }
@@ -451,7 +616,7 @@ namespace Dune
   template <int k>
   inline bool bigunsignedint<k>::operator< (const bigunsignedint<k>& x) const
   {
-	for (int i=n-1; i>=0; i--) 
+	for (int i=n-1; i>=0; i--)
 	  if (digit[i]<x.digit[i]) return true;
 	  else if (digit[i]>x.digit[i]) return false;
 	return false;
@@ -460,7 +625,7 @@ namespace Dune
   template <int k>
   inline bool bigunsignedint<k>::operator<= (const bigunsignedint<k>& x) const
   {
-	for (int i=n-1; i>=0; i--) 
+	for (int i=n-1; i>=0; i--)
 	  if (digit[i]<x.digit[i]) return true;
 	  else if (digit[i]>x.digit[i]) return false;
 	return true;
@@ -469,13 +634,13 @@ namespace Dune
   template <int k>
   inline bool bigunsignedint<k>::operator> (const bigunsignedint<k>& x) const
   {
-	return !((*this)<=x);	
+	return !((*this)<=x);
   }
 
   template <int k>
   inline bool bigunsignedint<k>::operator>= (const bigunsignedint<k>& x) const
   {
-	return !((*this)<x);	
+	return !((*this)<x);
   }
 
 
@@ -570,13 +735,13 @@ namespace std
     {
       Dune::bigunsignedint<k> max_;
       for(std::size_t i=0; i < Dune::bigunsignedint<k>::n; ++i)
-        max_.digit[i]=std::numeric_limits<unsigned short>::max();
+        max_.digit[i]=std::numeric_limits<typename Dune::bigunsignedint<k>::limb_type>::max();
+      max_.truncate();
       return max_;
     }
     
     
-    static const int digits = Dune::bigunsignedint<k>::bits *
-    Dune::bigunsignedint<k>::n;
+    static const int digits = Dune::bigunsignedint<k>::digits;
     static const bool is_signed = false;
     static const bool is_integer = true;
     static const bool is_exact = true;
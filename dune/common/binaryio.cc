@@ -0,0 +1,574 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "binaryio.hh"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace Dune {
+
+  namespace {
+
+    // the header at the beginning of a file
+    struct FileHeader
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t byteOrder;
+      uint32_t alignment;
+      uint32_t records;
+      uint64_t indexOffset;
+      uint64_t indexBytes;
+      uint64_t fileBytes;
+      uint32_t indexChecksum;
+      uint32_t reserved[2];
+      uint32_t headerChecksum;    // of the bytes before
+    };
+
+    // an entry of the index, followed by the name padded to 8 bytes
+    struct IndexEntry
+    {
+      uint64_t offset;
+      uint64_t bytes;
+      uint64_t count;
+      uint32_t components;
+      uint32_t checksum;
+      uint16_t kind;
+      uint16_t scalarSize;
+      uint32_t nameLength;
+      uint64_t reserved;
+    };
+
+    dune_static_assert(sizeof(FileHeader) == 64 && sizeof(IndexEntry) == 48,
+                       "The binary file structures must not contain padding");
+
+    const char magic[8] = { 'D', 'U', 'N', 'E', 'B', 'I', 'N', '\0' };
+    const uint32_t byteOrderMark = 0x01020304;
+    const uint32_t swappedByteOrderMark = 0x04030201;
+    const char zeros[4096] = { 0 };
+
+    std::size_t padding(uint64_t offset, std::size_t alignment)
+    {
+      return (alignment - offset % alignment) % alignment;
+    }
+
+#ifndef __SSE4_2__
+    // the tables of the CRC-32C, reading eight bytes per step
+    struct Crc32cTables
+    {
+      uint32_t table[8][256];
+
+      Crc32cTables()
+      {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+          uint32_t crc = i;
+          for (int k = 0; k < 8; ++k)
+            crc = crc & 1 ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+          table[0][i] = crc;
+        }
+        for (int s = 1; s < 8; ++s)
+          for (int i = 0; i < 256; ++i)
+            table[s][i] = (table[s-1][i] >> 8) ^ table[0][table[s-1][i] & 0xFF];
+      }
+    };
+
+    const Crc32cTables& crc32cTables()
+    {
+      static const Crc32cTables tables;
+      return tables;
+    }
+
+    uint32_t littleEndianWord(const unsigned char* p)
+    {
+      return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    }
+#endif
+
+    // writes all bytes, retrying after signals and partial writes
+    void writeAll(int fd, const char* data, std::size_t bytes, const std::string& filename)
+    {
+      while (bytes > 0)
+      {
+        const ssize_t written = ::write(fd, data, bytes);
+        if (written < 0 && errno == EINTR)
+          continue;
+        if (written <= 0)
+          DUNE_THROW(IOError, "Could not write to " << filename << ": " << std::strerror(errno));
+        data += written;
+        bytes -= written;
+      }
+    }
+
+    std::vector<std::string> split(const std::string& s)
+    {
+      std::vector<std::string> lines;
+      std::string::size_type begin = 0;
+      while (begin < s.size())
+      {
+        std::string::size_type end = s.find('\n', begin);
+        if (end == std::string::npos)
+          end = s.size();
+        lines.push_back(s.substr(begin, end-begin));
+        begin = end + 1;
+      }
+      return lines;
+    }
+
+    std::string join(const std::vector<std::string>& lines)
+    {
+      std::string s;
+      for (std::size_t i = 0; i < lines.size(); ++i)
+        s += lines[i] + '\n';
+      return s;
+    }
+
+    std::string text(const BinaryReader& reader, const std::string& name)
+    {
+      BinaryArrayView<unsigned char> a = reader.array<unsigned char>(name);
+      return std::string(a.begin(), a.end());
+    }
+
+  } // end anonymous namespace
+
+  uint32_t crc32c(const void* data, std::size_t len, uint32_t crc)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#ifdef __SSE4_2__
+    uint64_t crc64 = crc;
+    for (; len >= 8; len -= 8, p += 8)
+    {
+      uint64_t word;
+      std::memcpy(&word, p, 8);
+      crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = crc64;
+    for (; len > 0; --len, ++p)
+      crc = _mm_crc32_u8(crc, *p);
+#else
+    const Crc32cTables& t = crc32cTables();
+    for (; len >= 8; len -= 8, p += 8)
+    {
+      const uint32_t low = littleEndianWord(p) ^ crc;
+      const uint32_t high = littleEndianWord(p+4);
+      crc = t.table[7][low & 0xFF] ^ t.table[6][(low >> 8) & 0xFF]
+            ^ t.table[5][(low >> 16) & 0xFF] ^ t.table[4][low >> 24]
+            ^ t.table[3][high & 0xFF] ^ t.table[2][(high >> 8) & 0xFF]
+            ^ t.table[1][(high >> 16) & 0xFF] ^ t.table[0][high >> 24];
+    }
+    for (; len > 0; --len, ++p)
+      crc = t.table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+#endif
+    return ~crc;
+  }
+
+  BinaryWriter::BinaryWriter(const std::string& filename, std::size_t alignment, std::size_t bufferSize)
+    : filename_(filename), alignment_(alignment), buffer_(std::max(bufferSize, std::size_t(4096))),
+      buffered_(0), offset_(0), fd_(-1)
+  {
+    if (alignment < 8 || alignment > 4096 || (alignment & (alignment-1)) != 0)
+      DUNE_THROW(RangeError, "The alignment of a binary file has to be a power of two between 8 and 4096, not "
+                 << alignment);
+    const std::string tmp = filename_ + ".tmp";
+    fd_ = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd_ < 0)
+      DUNE_THROW(IOError, "Could not create " << tmp << ": " << std::strerror(errno));
+    // the header is written by close()
+    append(zeros, sizeof(FileHeader));
+  }
+
+  BinaryWriter::~BinaryWriter()
+  {
+    release();
+  }
+
+  void BinaryWriter::writeRecord(const std::string& name, const void* data, std::size_t count,
+                                 BinaryRecord::Kind kind, std::size_t scalarSize, std::size_t components)
+  {
+    if (fd_ < 0)
+      DUNE_THROW(InvalidStateException, "The binary file " << filename_ << " is closed");
+    if (name.empty() || name.find('\n') != std::string::npos)
+      DUNE_THROW(RangeError, "The name of an array has to be a nonempty line, not '" << name << "'");
+    for (std::size_t i = 0; i < records_.size(); ++i)
+      if (records_[i].name == name)
+        DUNE_THROW(RangeError, "The binary file " << filename_ << " already contains an array " << name);
+
+    pad();
+    BinaryRecord r;
+    r.name = name;
+    r.kind = kind;
+    r.scalarSize = scalarSize;
+    r.components = components;
+    r.count = count;
+    r.offset = offset_;
+    r.bytes = uint64_t(count)*components*scalarSize;
+    r.checksum = crc32c(data, r.bytes);
+    append(data, r.bytes);
+    records_.push_back(r);
+  }
+
+  void BinaryWriter::append(const void* data, std::size_t bytes)
+  {
+    const char* p = static_cast<const char*>(data);
+    if (bytes == 0)
+      return;
+    if (buffered_ + bytes > buffer_.size())
+    {
+      flush();
+      // large arrays go to the file directly
+      if (bytes >= buffer_.size())
+      {
+        writeAll(fd_, p, bytes, filename_);
+        offset_ += bytes;
+        return;
+      }
+    }
+    std::memcpy(&buffer_[buffered_], p, bytes);
+    buffered_ += bytes;
+    offset_ += bytes;
+  }
+
+  void BinaryWriter::pad()
+  {
+    append(zeros, padding(offset_, alignment_));
+  }
+
+  void BinaryWriter::flush()
+  {
+    writeAll(fd_, &buffer_[0], buffered_, filename_);
+    buffered_ = 0;
+  }
+
+  void BinaryWriter::close()
+  {
+    if (fd_ < 0)
+      return;
+    try
+    {
+      append(zeros, padding(offset_, 8));
+      std::vector<char> index;
+      for (std::size_t i = 0; i < records_.size(); ++i)
+      {
+        const BinaryRecord& r = records_[i];
+        IndexEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.offset = r.offset;
+        entry.bytes = r.bytes;
+        entry.count = r.count;
+        entry.components = r.components;
+        entry.checksum = r.checksum;
+        entry.kind = r.kind;
+        entry.scalarSize = r.scalarSize;
+        entry.nameLength = r.name.size();
+        const char* e = reinterpret_cast<const char*>(&entry);
+        index.insert(index.end(), e, e + sizeof(entry));
+        index.insert(index.end(), r.name.begin(), r.name.end());
+        index.resize(index.size() + padding(index.size(), 8), '\0');
+      }
+
+      FileHeader header;
+      std::memset(&header, 0, sizeof(header));
+      std::memcpy(header.magic, magic, sizeof(magic));
+      header.version = version;
+      header.byteOrder = byteOrderMark;
+      header.alignment = alignment_;
+      header.records = records_.size();
+      header.indexOffset = offset_;
+      header.indexBytes = index.size();
+      header.fileBytes = offset_ + index.size();
+      header.indexChecksum = crc32c(index.empty() ? 0 : &index[0], index.size());
+      header.headerChecksum = crc32c(&header, offsetof(FileHeader, headerChecksum));
+
+      if (!index.empty())
+        append(&index[0], index.size());
+      flush();
+      if (::lseek(fd_, 0, SEEK_SET) != 0)
+        DUNE_THROW(IOError, "Could not write to " << filename_ << ": " << std::strerror(errno));
+      writeAll(fd_, reinterpret_cast<const char*>(&header), sizeof(header), filename_);
+      const int fd = fd_;
+      fd_ = -1;
+      if (::close(fd) != 0)
+        DUNE_THROW(IOError, "Could not write to " << filename_ << ": " << std::strerror(errno));
+      if (std::rename((filename_ + ".tmp").c_str(), filename_.c_str()) != 0)
+        DUNE_THROW(IOError, "Could not move " << filename_ << ".tmp to " << filename_ << ": "
+                   << std::strerror(errno));
+    }
+    catch (...)
+    {
+      release();
+      std::remove((filename_ + ".tmp").c_str());
+      throw;
+    }
+  }
+
+  void BinaryWriter::release()
+  {
+    if (fd_ < 0)
+      return;
+    ::close(fd_);
+    fd_ = -1;
+    std::remove((filename_ + ".tmp").c_str());
+  }
+
+  BinaryReader::BinaryReader(const std::string& filename, bool verify)
+    : filename_(filename), verify_(verify), data_(0), size_(0), mapped_(false), version_(0)
+  {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      DUNE_THROW(IOError, "Could not open " << filename << ": " << std::strerror(errno));
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size < off_t(sizeof(FileHeader)))
+    {
+      ::close(fd);
+      DUNE_THROW(IOError, filename << " is not a binary file");
+    }
+    size_ = status.st_size;
+#if HAVE_SYS_MMAN_H
+    void* map = ::mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED)
+    {
+      data_ = static_cast<const char*>(map);
+      mapped_ = true;
+    }
+#endif
+    if (!mapped_)
+    {
+      // without memory maps the file is read into memory
+      char* buffer = static_cast<char*>(std::malloc(size_));
+      std::size_t read = 0;
+      while (buffer && read < size_)
+      {
+        const ssize_t n = ::read(fd, buffer + read, size_ - read);
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n <= 0)
+          break;
+        read += n;
+      }
+      data_ = buffer;
+      if (read < size_)
+      {
+        ::close(fd);
+        std::free(buffer);
+        DUNE_THROW(IOError, "Could not read " << filename);
+      }
+    }
+    ::close(fd);
+
+    try
+    {
+      FileHeader header;
+      std::memcpy(&header, data_, sizeof(header));
+      if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+        DUNE_THROW(IOError, filename << " is not a binary file");
+      if (header.byteOrder == swappedByteOrderMark)
+        DUNE_THROW(IOError, filename << " was written on a machine of the other byte order");
+      if (header.byteOrder != byteOrderMark
+          || header.headerChecksum != crc32c(&header, offsetof(FileHeader, headerChecksum)))
+        DUNE_THROW(IOError, "The header of " << filename << " is corrupted");
+      if (header.version < 1 || header.version > BinaryWriter::version)
+        DUNE_THROW(IOError, filename << " has the format version " << header.version
+                   << ", only versions up to " << BinaryWriter::version << " are supported");
+      version_ = header.version;
+      if (header.fileBytes != size_)
+        DUNE_THROW(IOError, filename << " has " << size_ << " bytes instead of " << header.fileBytes);
+      if (header.indexOffset > size_ || header.indexBytes > size_ - header.indexOffset
+          || header.indexChecksum != crc32c(data_ + header.indexOffset, header.indexBytes))
+        DUNE_THROW(IOError, "The index of " << filename << " is corrupted");
+
+      const char* p = data_ + header.indexOffset;
+      const char* end = p + header.indexBytes;
+      for (uint32_t i = 0; i < header.records; ++i)
+      {
+        IndexEntry entry;
+        if (std::size_t(end - p) < sizeof(entry))
+          DUNE_THROW(IOError, "The index of " << filename << " is corrupted");
+        std::memcpy(&entry, p, sizeof(entry));
+        p += sizeof(entry);
+        if (std::size_t(end - p) < entry.nameLength
+            || entry.offset > header.indexOffset || entry.bytes > header.indexOffset - entry.offset
+            || entry.bytes != entry.count*entry.components*entry.scalarSize)
+          DUNE_THROW(IOError, "The index of " << filename << " is corrupted");
+        BinaryRecord r;
+        r.name.assign(p, entry.nameLength);
+        r.kind = BinaryRecord::Kind(entry.kind);
+        r.scalarSize = entry.scalarSize;
+        r.components = entry.components;
+        r.count = entry.count;
+        r.offset = entry.offset;
+        r.bytes = entry.bytes;
+        r.checksum = entry.checksum;
+        p += entry.nameLength + padding(entry.nameLength, 8);
+        names_[r.name] = records_.size();
+        records_.push_back(r);
+      }
+      verified_.assign(records_.size(), false);
+    }
+    catch (...)
+    {
+      unmap();
+      throw;
+    }
+  }
+
+  BinaryReader::~BinaryReader()
+  {
+    unmap();
+  }
+
+  void BinaryReader::unmap()
+  {
+#if HAVE_SYS_MMAN_H
+    if (mapped_)
+      ::munmap(const_cast<char*>(data_), size_);
+#endif
+    if (!mapped_)
+      std::free(const_cast<char*>(data_));
+    data_ = 0;
+  }
+
+  const BinaryRecord& BinaryReader::record(const std::string& name) const
+  {
+    std::map<std::string,std::size_t>::const_iterator i = names_.find(name);
+    if (i == names_.end())
+      DUNE_THROW(RangeError, filename_ << " contains no array " << name);
+    return records_[i->second];
+  }
+
+  const void* BinaryReader::access(const BinaryRecord& r, BinaryRecord::Kind kind, std::size_t scalarSize,
+                                   std::size_t components) const
+  {
+    if (r.kind != kind || r.scalarSize != scalarSize || r.components != components)
+      DUNE_THROW(RangeError, "The array " << r.name << " in " << filename_ << " consists of "
+                 << r.components << " scalars of kind " << r.kind << " and size " << r.scalarSize
+                 << " per element, not " << components << " of kind " << kind << " and size " << scalarSize);
+    const char* data = data_ + r.offset;
+    const std::size_t i = &r - &records_[0];
+    if (verify_ && !verified_[i])
+    {
+      if (crc32c(data, r.bytes) != r.checksum)
+        DUNE_THROW(IOError, "The array " << r.name << " in " << filename_ << " is corrupted");
+      verified_[i] = true;
+    }
+    return data;
+  }
+
+  std::string binaryRankFile(const std::string& basename, int rank)
+  {
+    std::ostringstream name;
+    name << basename << "." << rank << ".dbin";
+    return name.str();
+  }
+
+  void writeBinaryIndex(const std::string& basename, const std::vector<std::vector<BinaryRecord> >& records)
+  {
+    // the files are named relative to the index, so that the data set can be moved
+    const std::string::size_type slash = basename.rfind('/');
+    const std::string local = slash == std::string::npos ? basename : basename.substr(slash+1);
+    std::vector<std::string> files(records.size());
+    for (std::size_t p = 0; p < records.size(); ++p)
+      files[p] = binaryRankFile(local, p);
+
+    std::vector<std::string> names;
+    std::map<std::string, std::vector<uint64_t> > counts;
+    for (std::size_t p = 0; p < records.size(); ++p)
+      for (std::size_t i = 0; i < records[p].size(); ++i)
+      {
+        const BinaryRecord& r = records[p][i];
+        std::vector<uint64_t>& c = counts[r.name];
+        if (c.empty())
+        {
+          names.push_back(r.name);
+          c.resize(records.size(), 0);
+        }
+        c[p] = r.count;
+      }
+
+    BinaryWriter writer(basename + ".dbin");
+    const std::string fileList = join(files), nameList = join(names);
+    writer.write("files", reinterpret_cast<const unsigned char*>(fileList.data()), fileList.size());
+    writer.write("names", reinterpret_cast<const unsigned char*>(nameList.data()), nameList.size());
+    for (std::size_t i = 0; i < names.size(); ++i)
+      writer.write("counts/" + names[i], counts[names[i]]);
+    writer.close();
+  }
+
+  namespace Detail {
+
+    std::string binaryRecordTable(const std::vector<BinaryRecord>& records)
+    {
+      std::ostringstream table;
+      for (std::size_t i = 0; i < records.size(); ++i)
+        table << records[i].count << ' ' << records[i].name << '\n';
+      return table.str();
+    }
+
+    std::vector<BinaryRecord> binaryRecordTable(const char* table, std::size_t len)
+    {
+      const std::vector<std::string> lines = split(std::string(table, len));
+      std::vector<BinaryRecord> records;
+      for (std::size_t i = 0; i < lines.size(); ++i)
+      {
+        if (lines[i].empty())
+          continue;
+        const std::string::size_type space = lines[i].find(' ');
+        if (space == std::string::npos)
+          DUNE_THROW(IOError, "Invalid table of arrays: " << lines[i]);
+        BinaryRecord r;
+        r.count = std::strtoull(lines[i].c_str(), 0, 10);
+        r.name = lines[i].substr(space+1);
+        records.push_back(r);
+      }
+      return records;
+    }
+
+  } // end namespace Detail
+
+  BinaryIndex::BinaryIndex(const std::string& basename, bool verify)
+    : verify_(verify)
+  {
+    BinaryReader reader(basename + ".dbin", verify);
+    const std::string::size_type slash = basename.rfind('/');
+    const std::string directory = slash == std::string::npos ? "" : basename.substr(0, slash+1);
+    files_ = split(text(reader, "files"));
+    for (std::size_t p = 0; p < files_.size(); ++p)
+      files_[p] = directory + files_[p];
+    names_ = split(text(reader, "names"));
+    for (std::size_t i = 0; i < names_.size(); ++i)
+    {
+      BinaryArrayView<uint64_t> counts = reader.array<uint64_t>("counts/" + names_[i]);
+      if (counts.size() != files_.size())
+        DUNE_THROW(IOError, "The index " << reader.filename() << " is inconsistent");
+      std::vector<std::size_t>& offsets = offsets_[names_[i]];
+      offsets.resize(counts.size()+1, 0);
+      for (std::size_t p = 0; p < counts.size(); ++p)
+        offsets[p+1] = offsets[p] + counts[p];
+    }
+  }
+
+  const std::vector<std::size_t>& BinaryIndex::offsets(const std::string& name) const
+  {
+    std::map<std::string, std::vector<std::size_t> >::const_iterator i = offsets_.find(name);
+    if (i == offsets_.end())
+      DUNE_THROW(RangeError, "The distributed data set contains no array " << name);
+    return i->second;
+  }
+
+} // end namespace Dune
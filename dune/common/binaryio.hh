@@ -0,0 +1,564 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_BINARYIO_HH
+#define DUNE_COMMON_BINARYIO_HH
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/common/denseview.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/collectivecommunication.hh>
+#include <dune/common/static_assert.hh>
+
+/** @file
+    @brief Versioned binary files of named arrays, read through memory maps.
+*/
+
+namespace Dune {
+
+  /** @addtogroup Common
+   @{
+  */
+
+  /**
+   * @brief Computes the CRC-32C (Castagnoli) checksum of len bytes.
+   *
+   * Pass the checksum of the preceding bytes as crc to checksum data
+   * in pieces; crc32c(a+b) == crc32c(b, crc32c(a)).
+   */
+  uint32_t crc32c(const void* data, std::size_t len, uint32_t crc = 0);
+
+  /**
+   * @brief Description of an array stored in a binary file.
+   *
+   * An array consists of count elements, each made of components
+   * scalars of the same kind and size, e.g. a FieldVector<double,3> is
+   * an element of three floating point scalars of eight bytes.
+   */
+  struct BinaryRecord
+  {
+    //! The kinds of scalars
+    enum Kind { signedInteger = 1, unsignedInteger = 2, floatingPoint = 3 };
+
+    std::string name;        //!< The name of the array, unique in its file
+    Kind kind;               //!< The kind of the scalars
+    std::size_t scalarSize;  //!< The size of a scalar in bytes
+    std::size_t components;  //!< The number of scalars per element
+    std::size_t count;       //!< The number of elements
+    uint64_t offset;         //!< The position of the first element in the file
+    uint64_t bytes;          //!< The size of the array in bytes
+    uint32_t checksum;       //!< The CRC-32C of the array
+  };
+
+  /**
+   * @brief Describes how objects of type T are stored in binary files.
+   *
+   * Arithmetic types, std::complex and FieldVector of them are supported.
+   * Specialize this class for other types whose objects consist of
+   * components scalars of type Scalar without padding.
+   */
+  template<class T>
+  struct BinaryTraits
+  {
+    dune_static_assert(std::numeric_limits<T>::is_specialized,
+                       "BinaryTraits is only defined for arithmetic types, std::complex and FieldVector");
+
+    //! The type of the scalars
+    typedef T Scalar;
+
+    //! The number of scalars per object
+    static const std::size_t components = 1;
+  };
+
+  template<class K>
+  struct BinaryTraits<std::complex<K> >
+  {
+    typedef typename BinaryTraits<K>::Scalar Scalar;
+    static const std::size_t components = 2*BinaryTraits<K>::components;
+  };
+
+  template<class K, int n>
+  struct BinaryTraits<FieldVector<K,n> >
+  {
+    typedef typename BinaryTraits<K>::Scalar Scalar;
+    static const std::size_t components = n*BinaryTraits<K>::components;
+  };
+
+  /**
+   * @brief A read-only view of the elements of an array in a binary file.
+   *
+   * The view stays valid as long as the BinaryReader it came from.
+   */
+  template<class T>
+  class BinaryArrayView
+  {
+  public:
+    typedef T value_type;
+    typedef const T* const_iterator;
+    typedef std::size_t size_type;
+
+    //! Constructor making a view of no elements
+    BinaryArrayView() : data_(0), size_(0) {}
+
+    //! Constructor making a view of the elements data[i], i<size
+    BinaryArrayView(const T* data, size_type size) : data_(data), size_(size) {}
+
+    const T& operator[](size_type i) const { return data_[i]; }
+    const T* data() const { return data_; }
+    size_type size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+  private:
+    const T* data_;
+    size_type size_;
+  };
+
+  /**
+   * @brief Writes named arrays to a binary file.
+   *
+   * The file starts with a header holding the format version and the
+   * byte order, followed by the arrays, each at an offset that is a
+   * multiple of the alignment, and an index of the arrays. The header,
+   * the index and every array carry a CRC-32C checksum. Small arrays
+   * are collected in a buffer, large ones are written directly, so the
+   * data goes to the file in large writes.
+   *
+   * \code
+   * Dune::BinaryWriter writer("state.dbin");
+   * writer.write("solution", x);           // a DynamicVector<double>
+   * writer.write("coordinates", points);   // a std::vector<FieldVector<double,3> >
+   * writer.close();
+   * \endcode
+   *
+   * The data is written to filename.tmp, which replaces the file only
+   * when close() succeeds, so neither a crash nor an exception leaves a
+   * truncated file behind the name.
+   */
+  class BinaryWriter
+  {
+  public:
+    //! The version of the file format written
+    static const uint32_t version = 1;
+
+    /**
+     * @brief Creates the file.
+     *
+     * @param filename   The name of the file.
+     * @param alignment  The alignment of the arrays in the file and thus in
+     *                   memory when they are read, a power of two between 8
+     *                   and 4096.
+     * @param bufferSize The size of the write buffer in bytes.
+     */
+    explicit BinaryWriter(const std::string& filename, std::size_t alignment = 64,
+                          std::size_t bufferSize = 1 << 22);
+
+    //! Removes the data written so far unless the file was closed
+    ~BinaryWriter();
+
+    //! Writes the count objects starting at data as an array of the given name
+    template<class T>
+    void write(const std::string& name, const T* data, std::size_t count)
+    {
+      typedef typename BinaryTraits<T>::Scalar Scalar;
+      dune_static_assert(sizeof(T) == BinaryTraits<T>::components*sizeof(Scalar),
+                         "The objects have to consist of their scalars without padding");
+      writeRecord(name, data, count, kind<Scalar>(), sizeof(Scalar), BinaryTraits<T>::components);
+    }
+
+    //! Writes the entries of a std::vector
+    template<class T, class A>
+    void write(const std::string& name, const std::vector<T,A>& v)
+    {
+      write(name, v.empty() ? static_cast<const T*>(0) : &v[0], v.size());
+    }
+
+    //! Writes the entries of a DynamicVector
+    template<class K, class A>
+    void write(const std::string& name, const DynamicVector<K,A>& v)
+    {
+      write(name, v.size() ? &v[0] : static_cast<const K*>(0), v.size());
+    }
+
+    /**
+     * @brief Writes the index and the header and moves the file to its name.
+     *
+     * No arrays can be written afterwards.
+     */
+    void close();
+
+    //! The name of the file
+    const std::string& filename() const
+    {
+      return filename_;
+    }
+
+    //! The arrays written so far
+    const std::vector<BinaryRecord>& records() const
+    {
+      return records_;
+    }
+
+    //! The kind of a scalar type
+    template<class Scalar>
+    static BinaryRecord::Kind kind()
+    {
+      return std::numeric_limits<Scalar>::is_integer
+             ? (std::numeric_limits<Scalar>::is_signed ? BinaryRecord::signedInteger : BinaryRecord::unsignedInteger)
+             : BinaryRecord::floatingPoint;
+    }
+
+  private:
+    // not copyable
+    BinaryWriter(const BinaryWriter&);
+    BinaryWriter& operator=(const BinaryWriter&);
+
+    void writeRecord(const std::string& name, const void* data, std::size_t count,
+                     BinaryRecord::Kind kind, std::size_t scalarSize, std::size_t components);
+    void append(const void* data, std::size_t bytes);
+    void pad();
+    void flush();
+    void release();
+
+    std::string filename_;
+    std::size_t alignment_;
+    std::vector<char> buffer_;
+    std::size_t buffered_;
+    uint64_t offset_;
+    int fd_;
+    std::vector<BinaryRecord> records_;
+  };
+
+  /**
+   * @brief Reads the arrays of a binary file written by BinaryWriter.
+   *
+   * The file is mapped into memory, so the arrays are read without
+   * copying: array() and vector() return views of the mapped file, which
+   * the operating system fills on first access. The views stay valid as
+   * long as the reader.
+   *
+   * \code
+   * Dune::BinaryReader reader("state.dbin");
+   * Dune::DenseVectorView<const double> x = reader.vector<double>("solution");
+   * Dune::BinaryArrayView<Dune::FieldVector<double,3> > points
+   *   = reader.array<Dune::FieldVector<double,3> >("coordinates");
+   * \endcode
+   *
+   * Files of a newer version or of the other byte order are rejected
+   * with an IOError, as are corrupted headers and indices. With verify
+   * set, the checksum of an array is checked when it is first accessed,
+   * which reads it once; this is not thread safe.
+   */
+  class BinaryReader
+  {
+  public:
+    /**
+     * @brief Opens and maps the file.
+     *
+     * @param filename The name of the file.
+     * @param verify   Whether to check the checksums of the arrays.
+     */
+    explicit BinaryReader(const std::string& filename, bool verify = true);
+
+    //! Unmaps the file, the views of it become invalid
+    ~BinaryReader();
+
+    //! The name of the file
+    const std::string& filename() const
+    {
+      return filename_;
+    }
+
+    //! The format version of the file
+    uint32_t version() const
+    {
+      return version_;
+    }
+
+    //! The number of arrays in the file
+    std::size_t size() const
+    {
+      return records_.size();
+    }
+
+    //! The description of the i-th array
+    const BinaryRecord& record(std::size_t i) const
+    {
+      return records_[i];
+    }
+
+    //! Whether the file contains an array of the given name
+    bool contains(const std::string& name) const
+    {
+      return names_.find(name) != names_.end();
+    }
+
+    //! The description of the array of the given name, throws a RangeError if there is none
+    const BinaryRecord& record(const std::string& name) const;
+
+    //! A view of the array of the given name, whose objects have to be of type T
+    template<class T>
+    BinaryArrayView<T> array(const std::string& name) const
+    {
+      typedef typename BinaryTraits<T>::Scalar Scalar;
+      const BinaryRecord& r = record(name);
+      const void* data = access(r, BinaryWriter::kind<Scalar>(), sizeof(Scalar), BinaryTraits<T>::components);
+      return BinaryArrayView<T>(static_cast<const T*>(data), r.count);
+    }
+
+    //! A DenseVector view of the array of the given name, whose objects have to be of type K
+    template<class K>
+    DenseVectorView<const K> vector(const std::string& name) const
+    {
+      BinaryArrayView<K> a = array<K>(name);
+      return DenseVectorView<const K>(a.data(), a.size());
+    }
+
+    //! Copies the array of the given name into a std::vector
+    template<class T, class A>
+    void read(const std::string& name, std::vector<T,A>& v) const
+    {
+      BinaryArrayView<T> a = array<T>(name);
+      v.assign(a.begin(), a.end());
+    }
+
+    //! Copies the array of the given name into a DynamicVector
+    template<class K, class A>
+    void read(const std::string& name, DynamicVector<K,A>& v) const
+    {
+      BinaryArrayView<K> a = array<K>(name);
+      v.resize(a.size());
+      std::copy(a.begin(), a.end(), v.begin());
+    }
+
+  private:
+    // not copyable
+    BinaryReader(const BinaryReader&);
+    BinaryReader& operator=(const BinaryReader&);
+
+    const void* access(const BinaryRecord& r, BinaryRecord::Kind kind, std::size_t scalarSize,
+                       std::size_t components) const;
+    void unmap();
+
+    std::string filename_;
+    bool verify_;
+    const char* data_;
+    std::size_t size_;
+    bool mapped_;
+    uint32_t version_;
+    std::vector<BinaryRecord> records_;
+    std::map<std::string,std::size_t> names_;
+    mutable std::vector<char> verified_;
+  };
+
+  /**
+   * @name Distributed binary files
+   *
+   * A data set distributed over the processes is stored as one file per
+   * process, written by a BinaryWriter for binaryRankFile(basename,rank),
+   * and an index basename.dbin written by writeBinaryIndex(). The index
+   * records the number of elements every process wrote to every array,
+   * so that a restart with a different number of processes can read any
+   * range of the concatenated arrays with BinaryIndex.
+   * @{
+   */
+
+  //! The name of the file of the given rank in the distributed data set basename
+  std::string binaryRankFile(const std::string& basename, int rank);
+
+  /**
+   * @brief Writes the index of a distributed data set.
+   *
+   * records[p] are the arrays written by the process of rank p, the
+   * index goes to basename.dbin.
+   */
+  void writeBinaryIndex(const std::string& basename, const std::vector<std::vector<BinaryRecord> >& records);
+
+#ifndef DOXYGEN
+  namespace Detail {
+
+    //! The names and counts of the arrays, one per line
+    std::string binaryRecordTable(const std::vector<BinaryRecord>& records);
+
+    //! The names and counts of the arrays, parsed from the lines
+    std::vector<BinaryRecord> binaryRecordTable(const char* table, std::size_t len);
+
+  } // end namespace Detail
+#endif // DOXYGEN
+
+  /**
+   * @brief Closes the files of all processes and writes the index of the data set.
+   *
+   * This is a collective operation. The names and sizes of the arrays
+   * are gathered to the process of rank 0, which writes the index.
+   * writer has to write binaryRankFile(basename, comm.rank()).
+   * If a process cannot close its file, it rethrows the exception and
+   * the other processes throw an IOError.
+   */
+  template<class C>
+  void writeBinaryIndex(const std::string& basename, BinaryWriter& writer, const CollectiveCommunication<C>& comm)
+  {
+    // the longest table and whether a process failed; a process that
+    // cannot close its file still takes part in the reduction, so that
+    // the others do not wait for it forever
+    int reduced[2] = { 0, 0 };
+    std::string table;
+    try
+    {
+      writer.close();
+      table = Detail::binaryRecordTable(writer.records());
+      reduced[0] = table.size();
+    }
+    catch (...)
+    {
+      reduced[1] = 1;
+      comm.max(reduced, 2);
+      throw;
+    }
+    comm.max(reduced, 2);
+    if (reduced[1])
+      DUNE_THROW(IOError, "Could not close the file of another process of " << basename);
+    const int length = reduced[0];
+    table.resize(length, '\n');
+    std::vector<char> tables(comm.rank() == 0 ? std::size_t(length)*comm.size() : length);
+    if (length > 0)
+      comm.gather(&table[0], &tables[0], length, 0);
+
+    // the index is written by one process, but everyone has to know whether it failed
+    int failed = 0;
+    std::string message;
+    if (comm.rank() == 0)
+    {
+      try
+      {
+        std::vector<std::vector<BinaryRecord> > records(comm.size());
+        for (int p = 0; p < comm.size() && length > 0; ++p)
+          records[p] = Detail::binaryRecordTable(&tables[0] + std::size_t(length)*p, length);
+        writeBinaryIndex(basename, records);
+      }
+      catch (const Exception& e)
+      {
+        failed = 1;
+        message = e.what();
+      }
+    }
+    comm.broadcast(&failed, 1, 0);
+    if (failed)
+      DUNE_THROW(IOError, "Could not write the index of " << basename
+                 << (message.empty() ? "" : ": ") << message);
+  }
+
+  /**
+   * @brief Reads ranges of the arrays of a distributed data set.
+   *
+   * The elements of an array written by the processes are numbered
+   * consecutively in the order of the ranks. read() copies any range of
+   * them from the files of the processes that wrote them, so a restart
+   * with a different number of processes can take its part, e.g. the
+   * range(), regardless of how the data was distributed before.
+   */
+  class BinaryIndex
+  {
+  public:
+    //! Reads the index basename.dbin
+    explicit BinaryIndex(const std::string& basename, bool verify = true);
+
+    //! The number of processes that wrote the data set
+    int ranks() const
+    {
+      return files_.size();
+    }
+
+    //! The file written by the process of the given rank
+    const std::string& file(int rank) const
+    {
+      return files_[rank];
+    }
+
+    //! The names of the arrays
+    const std::vector<std::string>& names() const
+    {
+      return names_;
+    }
+
+    //! The number of elements of the array written by the process of the given rank
+    std::size_t count(const std::string& name, int rank) const
+    {
+      return offsets(name)[rank+1] - offsets(name)[rank];
+    }
+
+    //! The number of the first element of the array written by the process of the given rank
+    std::size_t offset(const std::string& name, int rank) const
+    {
+      return offsets(name)[rank];
+    }
+
+    //! The number of elements of the array written by all processes
+    std::size_t total(const std::string& name) const
+    {
+      return offsets(name).back();
+    }
+
+    /**
+     * @brief The range of elements of process rank of size processes.
+     *
+     * Splits the elements of the array into size blocks that differ by
+     * at most one element.
+     */
+    std::pair<std::size_t,std::size_t> range(const std::string& name, int rank, int size) const
+    {
+      const std::size_t n = total(name);
+      return std::make_pair(n*rank/size, n*(rank+1)/size);
+    }
+
+    //! Copies the elements [begin,end) of the array of the given name
+    template<class T, class A>
+    void read(const std::string& name, std::size_t begin, std::size_t end, std::vector<T,A>& v) const
+    {
+      const std::vector<std::size_t>& o = offsets(name);
+      if (begin > end || end > o.back())
+        DUNE_THROW(RangeError, "The elements [" << begin << "," << end << ") of " << name
+                   << " are not in [0," << o.back() << ")");
+      v.clear();
+      v.reserve(end-begin);
+      const int first = std::upper_bound(o.begin(), o.end(), begin) - o.begin() - 1;
+      for (int p = first; p < ranks() && o[p] < end; ++p)
+      {
+        if (o[p+1] == o[p])
+          continue;
+        BinaryReader reader(files_[p], verify_);
+        BinaryArrayView<T> a = reader.array<T>(name);
+        if (a.size() != o[p+1] - o[p])
+          DUNE_THROW(IOError, "The file " << files_[p] << " does not match the index");
+        v.insert(v.end(), a.begin() + (std::max(begin, o[p]) - o[p]), a.begin() + (std::min(end, o[p+1]) - o[p]));
+      }
+    }
+
+  private:
+    const std::vector<std::size_t>& offsets(const std::string& name) const;
+
+    bool verify_;
+    std::vector<std::string> files_;
+    std::vector<std::string> names_;
+    std::map<std::string, std::vector<std::size_t> > offsets_;
+  };
+
+  /** @} */
+
+  /** @} */
+
+} // end namespace Dune
+
+#endif // DUNE_COMMON_BINARYIO_HH
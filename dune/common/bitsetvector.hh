@@ -9,6 +9,8 @@
 #include <bitset>
 #include <iostream>
 #include <algorithm>
+#include <limits>
+#include <stdint.h>
 
 #include <dune/common/genericiterator.hh>
 #include <dune/common/exceptions.hh>
@@ -18,6 +20,97 @@ namespace Dune {
     template <int block_size, class Alloc> class BitSetVector;
     template <int block_size, class Alloc> class BitSetVectorReference;
 
+#ifndef DOXYGEN
+    namespace Detail
+    {
+        //! The number of set bits of a word
+        inline int bitSetVectorPopCount(uint64_t word)
+        {
+#ifdef __GNUC__
+            return __builtin_popcountll(word);
+#else
+            word = word - ((word >> 1) & 0x5555555555555555ull);
+            word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+            word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+            return static_cast<int>((word * 0x0101010101010101ull) >> 56);
+#endif
+        }
+
+        //! The number of trailing zero bits of a non-zero word
+        inline int bitSetVectorTrailingZeros(uint64_t word)
+        {
+#ifdef __GNUC__
+            return __builtin_ctzll(word);
+#else
+            int zeros = 0;
+            while (!(word & 1)) {
+                word >>= 1;
+                ++zeros;
+            }
+            return zeros;
+#endif
+        }
+
+        //! A word with the lowest n bits set
+        inline uint64_t bitSetVectorLowBits(std::size_t n)
+        {
+            return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+        }
+    }
+#endif
+
+    /**
+       \brief A proxy class that acts as a mutable reference to a
+       single bit in a BitSetVector.
+     */
+    class BitSetVectorBitReference
+    {
+    public:
+        BitSetVectorBitReference(uint64_t& word, uint64_t mask) :
+            word_(&word),
+            mask_(mask)
+        {}
+
+        //! The value of the bit
+        operator bool() const
+        {
+            return (*word_ & mask_) != 0;
+        }
+
+        //! The negated value of the bit
+        bool operator~() const
+        {
+            return (*word_ & mask_) == 0;
+        }
+
+        //! Assignment from bool
+        BitSetVectorBitReference& operator=(bool b)
+        {
+            if (b)
+                *word_ |= mask_;
+            else
+                *word_ &= ~mask_;
+            return *this;
+        }
+
+        //! Assignment from another bit
+        BitSetVectorBitReference& operator=(const BitSetVectorBitReference& b)
+        {
+            return *this = bool(b);
+        }
+
+        //! Flips the bit
+        BitSetVectorBitReference& flip()
+        {
+            *word_ ^= mask_;
+            return *this;
+        }
+
+    private:
+        uint64_t* word_;
+        uint64_t mask_;
+    };
+
     /**
        \brief A proxy class that acts as a const reference to a single
        bitset in a BitSetVector.
@@ -35,7 +128,7 @@ namespace Dune {
 
         typedef Dune::BitSetVector<block_size, Alloc> BitSetVector;
         friend class Dune::BitSetVector<block_size, Alloc>;
-        
+
         BitSetVectorConstReference(const BitSetVector& blockBitField, int block_number) :
             blockBitField(blockBitField),
             block_number(block_number)
@@ -43,16 +136,16 @@ namespace Dune {
 
         //! hide assignment operator
         BitSetVectorConstReference& operator=(const BitSetVectorConstReference & b);
-        
+
     public:
 
         typedef std::bitset<block_size> bitset;
 
         // bitset interface typedefs
-        typedef typename std::vector<bool, Alloc>::const_reference reference;
-        typedef typename std::vector<bool, Alloc>::const_reference const_reference;
+        typedef bool reference;
+        typedef bool const_reference;
         typedef size_t size_type;
-        
+
         //! Returns a copy of *this shifted left by n bits.
         bitset operator<<(size_type n) const
         {
@@ -87,15 +180,27 @@ namespace Dune {
         size_type count() const
         {
             size_type n = 0;
-            for(size_type i=0; i<block_size; ++i)
-                n += getBit(i);
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                n += Detail::bitSetVectorPopCount(getBits(i));
             return n;
         }
 
         //! Returns true if any bits are set.
         bool any() const
         {
-            return count();
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                if (getBits(i))
+                    return true;
+            return false;
+        }
+
+        //! Returns true if all bits are set.
+        bool all() const
+        {
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                if (getBits(i) != Detail::bitSetVectorLowBits(pieceSize(i)))
+                    return false;
+            return true;
         }
 
         //! Returns true if no bits are set.
@@ -104,17 +209,17 @@ namespace Dune {
             return ! any();
         }
 
-        //! Returns true if bit n is set. 
+        //! Returns true if bit n is set.
         bool test(size_type n) const
         {
             return getBit(n);
         }
-        
+
         const_reference operator[](size_type i) const
         {
             return getBit(i);
         }
-        
+
         //! cast to bitset
         operator bitset() const
         {
@@ -150,7 +255,7 @@ namespace Dune {
 
           - unsigned long to_ulong() const
          */
-        
+
         friend std::ostream& operator<< (std::ostream& s, const BitSetVectorConstReference& v)
         {
             s << "(";
@@ -159,7 +264,7 @@ namespace Dune {
             s << ")";
             return s;
         }
-        
+
     protected:
         const BitSetVector& blockBitField;
         int block_number;
@@ -169,15 +274,45 @@ namespace Dune {
             return blockBitField.getBit(block_number,i);
         }
 
+        //! The number of bits of the word starting at bit i of the block
+        static size_type pieceSize(size_type i)
+        {
+            return std::min(size_type(BitSetVector::wordBits), size_type(block_size)-i);
+        }
+
+        //! The bits i,...,i+pieceSize(i)-1 of the block
+        typename BitSetVector::word_type getBits(size_type i) const
+        {
+            return blockBitField.getBits(block_number*size_type(block_size)+i, pieceSize(i));
+        }
+
+        //! The bits i,...,i+pieceSize(i)-1 of a bitset
+        static typename BitSetVector::word_type getBits(const bitset& bs, size_type i)
+        {
+            if (block_size <= std::numeric_limits<unsigned long>::digits)
+                return bs.to_ulong();
+            typename BitSetVector::word_type bits = 0;
+            for (size_type j=0; j<pieceSize(i); ++j)
+                if (bs.test(i+j))
+                    bits |= typename BitSetVector::word_type(1) << j;
+            return bits;
+        }
+
+        //! The bits i,...,i+pieceSize(i)-1 of another block
+        static typename BitSetVector::word_type getBits(const BitSetVectorConstReference& bs, size_type i)
+        {
+            return bs.getBits(i);
+        }
+
         template<class BS>
         bool equals(const BS & bs) const
         {
-            bool eq = true;
-            for(int i=0; i<block_size; ++i)
-                eq &= (getBit(i) == bs[i]);
-            return eq;
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                if (getBits(i) != getBits(bs, i))
+                    return false;
+            return true;
         }
-        
+
     private:
         /**
            This is only a Proxy class, you can't get the address of the
@@ -209,21 +344,21 @@ namespace Dune {
         friend class Dune::BitSetVector<block_size, Alloc>;
 
         typedef Dune::BitSetVectorConstReference<block_size,Alloc> BitSetVectorConstReference;
-        
+
         BitSetVectorReference(BitSetVector& blockBitField, int block_number) :
             BitSetVectorConstReference(blockBitField, block_number),
             blockBitField(blockBitField)
         {};
-        
+
     public:
         typedef std::bitset<block_size> bitset;
 
         //! bitset interface typedefs
         //! \{
         //! A proxy class that acts as a reference to a single bit.
-        typedef typename std::vector<bool, Alloc>::reference reference;
+        typedef BitSetVectorBitReference reference;
         //! A proxy class that acts as a const reference to a single bit.
-        typedef typename std::vector<bool, Alloc>::const_reference const_reference;
+        typedef bool const_reference;
         //! \}
 
         //! size_type typedef (an unsigned integral type)
@@ -232,118 +367,113 @@ namespace Dune {
         //! Assignment from bool, sets each bit in the bitset to b
         BitSetVectorReference& operator=(bool b)
         {
-            for(int i=0; i<block_size; ++i)
-                getBit(i) = b;
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, b ? ~typename BitSetVector::word_type(0) : 0);
             return (*this);
         }
-        
+
         //! Assignment from bitset
         BitSetVectorReference& operator=(const bitset & b)
         {
-            for(int i=0; i<block_size; ++i)
-                getBit(i) = b.test(i);
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(b, i));
             return (*this);
         }
 
         //! Assignment from BitSetVectorConstReference
         BitSetVectorReference& operator=(const BitSetVectorConstReference & b)
         {
-            for(int i=0; i<block_size; ++i)
-                getBit(i) = b.test(i);
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(b, i));
             return (*this);
         }
 
         //! Assignment from BitSetVectorReference
         BitSetVectorReference& operator=(const BitSetVectorReference & b)
         {
-            for(int i=0; i<block_size; ++i)
-                getBit(i) = b.test(i);
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(b, i));
             return (*this);
         }
 
         //! Bitwise and (for bitset).
         BitSetVectorReference& operator&=(const bitset& x)
         {
-            for (size_type i=0; i<block_size; i++)
-                getBit(i) = (test(i) & x.test(i));
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(i) & getBits(x, i));
             return *this;
         }
 
         //! Bitwise and (for BitSetVectorConstReference and BitSetVectorReference)
         BitSetVectorReference& operator&=(const BitSetVectorConstReference& x)
         {
-            for (size_type i=0; i<block_size; i++)
-                getBit(i) = (test(i) & x.test(i));
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(i) & getBits(x, i));
             return *this;
         }
 
         //! Bitwise inclusive or (for bitset)
         BitSetVectorReference& operator|=(const bitset& x)
         {
-            for (size_type i=0; i<block_size; i++)
-                getBit(i) = (test(i) | x.test(i));
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(i) | getBits(x, i));
             return *this;
         }
 
         //! Bitwise inclusive or (for BitSetVectorConstReference and BitSetVectorReference)
         BitSetVectorReference& operator|=(const BitSetVectorConstReference& x)
         {
-            for (size_type i=0; i<block_size; i++)
-                getBit(i) = (test(i) | x.test(i));
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(i) | getBits(x, i));
             return *this;
         }
 
         //! Bitwise exclusive or (for bitset).
         BitSetVectorReference& operator^=(const bitset& x)
         {
-            for (size_type i=0; i<block_size; i++)
-                getBit(i) = (test(i) ^ x.test(i));
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(i) ^ getBits(x, i));
             return *this;
         }
 
         //! Bitwise exclusive or (for BitSetVectorConstReference and BitSetVectorReference)
         BitSetVectorReference& operator^=(const BitSetVectorConstReference& x)
         {
-            for (size_type i=0; i<block_size; i++)
-                getBit(i) = (test(i) ^ x.test(i));
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, getBits(i) ^ getBits(x, i));
             return *this;
         }
 
         //! Left shift.
         BitSetVectorReference& operator<<=(size_type n)
         {
-            for (size_type i=0; i<block_size-n; i++)
-                getBit(i) = test(i+n);
-            return *this;
+            return *this = (bitset(*this) << n);
         }
 
         //! Right shift.
         BitSetVectorReference& operator>>=(size_type n)
         {
-            for (size_type i=0; i<block_size-n; i++)
-                getBit(i+n) = test(i);
-            return *this;
+            return *this = (bitset(*this) >> n);
         }
 
         // Sets every bit.
         BitSetVectorReference& set()
         {
-            for (size_type i=0; i<block_size; i++)
-                set(i);
-            return *this;
+            return *this = true;
         }
 
         //! Flips the value of every bit.
         BitSetVectorReference& flip()
         {
-            for (size_type i=0; i<block_size; i++)
-                flip(i);
+            for(size_type i=0; i<block_size; i+=BitSetVector::wordBits)
+                setBits(i, ~getBits(i));
             return *this;
         }
 
         //! Clears every bit.
         BitSetVectorReference& reset()
         {
+            return *this = false;
         }
 
         //! Sets bit n if val is nonzero, and clears bit n if val is zero.
@@ -374,16 +504,24 @@ namespace Dune {
         {
             return getBit(i);
         }
-        
+
     protected:
         BitSetVector& blockBitField;
 
         using BitSetVectorConstReference::getBit;
+        using BitSetVectorConstReference::getBits;
+        using BitSetVectorConstReference::pieceSize;
 
         reference getBit(size_type i)
         {
             return blockBitField.getBit(this->block_number,i);
         }
+
+        //! Set the bits i,...,i+pieceSize(i)-1 of the block
+        void setBits(size_type i, typename BitSetVector::word_type bits)
+        {
+            blockBitField.setBits(this->block_number*size_type(block_size)+i, pieceSize(i), bits);
+        }
     };
 
     /**
@@ -394,13 +532,13 @@ namespace Dune {
     {
         typedef BitSetVectorConstReference<block_size,Alloc> type;
     };
-  
+
     template<int block_size, class Alloc>
     struct const_reference< BitSetVectorConstReference<block_size,Alloc> >
     {
         typedef BitSetVectorConstReference<block_size,Alloc> type;
     };
-  
+
     template<int block_size, class Alloc>
     struct mutable_reference< BitSetVectorReference<block_size,Alloc> >
     {
@@ -415,13 +553,19 @@ namespace Dune {
 
     /**
        \brief A dynamic %array of blocks of booleans
+
+       The bits are stored consecutively in 64 bit words, so counting
+       and the logical operations on whole vectors work on a word at a
+       time. Blocks never straddle two words if block_size divides 64
+       or is a multiple of it; for these block sizes all block
+       operations are done with a single shift and mask per word.
     */
     template <int block_size, class Allocator=std::allocator<bool> >
-    class BitSetVector : private std::vector<bool, Allocator>
+    class BitSetVector
     {
-        /** \brief The implementation class: an unblocked bitfield */
+        /** \brief An unblocked bitfield, which can be converted */
         typedef std::vector<bool, Allocator> BlocklessBaseClass;
-        
+
     public:
         //! container interface typedefs
         //! \{
@@ -442,12 +586,22 @@ namespace Dune {
         typedef BitSetVectorConstReference<block_size,Allocator>* const_pointer;
 
         /** \brief size type */
-        typedef typename std::vector<bool, Allocator>::size_type size_type;
+        typedef std::size_t size_type;
 
         /** \brief The type of the allocator */
         typedef Allocator allocator_type;
         //! \}
 
+        /** \brief The type of the words the bits are stored in */
+        typedef uint64_t word_type;
+
+        enum {
+            /** \brief The number of bits per word */
+            wordBits = 64,
+            /** \brief Whether no block straddles two words */
+            aligned = (wordBits % block_size == 0) || (block_size % wordBits == 0)
+        };
+
         //! iterators
         //! \{
         typedef Dune::GenericIterator<BitSetVector<block_size,Allocator>, value_type, reference, std::ptrdiff_t, ForwardIteratorFacade> iterator;
@@ -460,7 +614,7 @@ namespace Dune {
         }
 
         //! Returns a const_iterator pointing to the beginning of the vector.
-        const_iterator begin() const{    
+        const_iterator begin() const{
             return const_iterator(*this, 0);
         }
 
@@ -470,103 +624,207 @@ namespace Dune {
         }
 
         //! Returns a const_iterator pointing to the end of the vector.
-        const_iterator end() const{    
+        const_iterator end() const{
             return const_iterator(*this, size());
         }
-  
+
         //! Default constructor
         BitSetVector() :
-            BlocklessBaseClass()
+            blocks_(0)
         {}
-        
+
         //! Construction from an unblocked bitfield
         BitSetVector(const BlocklessBaseClass& blocklessBitField) :
-            BlocklessBaseClass(blocklessBitField)
+            words_(wordCount(blocklessBitField.size()), 0),
+            blocks_(blocklessBitField.size()/block_size)
         {
             if (blocklessBitField.size()%block_size != 0)
                 DUNE_THROW(RangeError, "Vector size is not a multiple of the block size!");
+            for (size_type i=0; i<blocklessBitField.size(); ++i)
+                if (blocklessBitField[i])
+                    words_[i/wordBits] |= word_type(1) << (i%wordBits);
         }
-        
+
         /** Constructor with a given length
             \param n Number of blocks
         */
         explicit BitSetVector(int n) :
-            BlocklessBaseClass(n*block_size)
+            words_(wordCount(n*size_type(block_size)), 0),
+            blocks_(n)
         {}
-        
+
         //! Constructor which initializes the field with true or false
         BitSetVector(int n, bool v) :
-            BlocklessBaseClass(n*block_size,v)
-        {}
+            words_(wordCount(n*size_type(block_size)), v ? ~word_type(0) : 0),
+            blocks_(n)
+        {
+            clearUnusedBits();
+        }
 
         //! Erases all of the elements.
         void clear()
         {
-            BlocklessBaseClass::clear();
+            words_.clear();
+            blocks_ = 0;
         }
-        
+
         //! Resize field
         void resize(int n, bool v = bool())
         {
-            BlocklessBaseClass::resize(n*block_size, v);
+            size_type oldBits = bits();
+            words_.resize(wordCount(n*size_type(block_size)), v ? ~word_type(0) : 0);
+            // the unused bits of the former last word are zero
+            if (v && oldBits%wordBits != 0 && oldBits/wordBits < words_.size())
+                words_[oldBits/wordBits] |= ~Detail::bitSetVectorLowBits(oldBits%wordBits);
+            blocks_ = n;
+            clearUnusedBits();
         }
-        
+
         /** \brief Return the number of blocks */
         size_type size() const
         {
-            return BlocklessBaseClass::size()/block_size;
+            return blocks_;
         }
-        
+
         //! Sets all entries to <tt> true </tt>
         void setAll() {
-            this->assign(BlocklessBaseClass::size(), true);
+            std::fill(words_.begin(), words_.end(), ~word_type(0));
+            clearUnusedBits();
         }
-        
+
         //! Sets all entries to <tt> false </tt>
         void unsetAll() {
-            this->assign(BlocklessBaseClass::size(), false);
+            std::fill(words_.begin(), words_.end(), word_type(0));
         }
-        
+
         /** \brief Return reference to i-th block */
         reference operator[](int i)
         {
             return reference(*this, i);
         }
-        
+
         /** \brief Return const reference to i-th block */
         const_reference operator[](int i) const
         {
             return const_reference(*this, i);
         }
-        
+
         /** \brief Return reference to last block */
         reference back()
         {
             return reference(*this, size()-1);
         }
-        
+
         /** \brief Return const reference to last block */
         const_reference back() const
         {
             return const_reference(*this, size()-1);
         }
-        
+
         //! Returns the number of bits that are set.
         size_type count() const
         {
-            return std::count(BlocklessBaseClass::begin(), BlocklessBaseClass::end(), true);
+            size_type n = 0;
+            for (size_type w=0; w<words_.size(); ++w)
+                n += Detail::bitSetVectorPopCount(words_[w]);
+            return n;
         }
-        
+
         //! Returns the number of set bits, while each block is masked with 1<<i
         size_type countmasked(int j) const
         {
             size_type n = 0;
+            if (wordBits % block_size == 0) {
+                // bit j of all blocks within a word
+                word_type mask = 0;
+                for (int i=j; i<wordBits; i+=block_size)
+                    mask |= word_type(1) << i;
+                for (size_type w=0; w<words_.size(); ++w)
+                    n += Detail::bitSetVectorPopCount(words_[w] & mask);
+                return n;
+            }
             size_type blocks = size();
             for(size_type i=0; i<blocks; ++i)
                 n += getBit(i,j);
             return n;
         }
-        
+
+        //! Returns true if any bit is set.
+        bool any() const
+        {
+            for (size_type w=0; w<words_.size(); ++w)
+                if (words_[w])
+                    return true;
+            return false;
+        }
+
+        //! Returns true if all bits are set.
+        bool all() const
+        {
+            size_type full = bits()/wordBits;
+            for (size_type w=0; w<full; ++w)
+                if (words_[w] != ~word_type(0))
+                    return false;
+            return bits()%wordBits == 0
+                || words_[full] == Detail::bitSetVectorLowBits(bits()%wordBits);
+        }
+
+        //! Returns true if no bit is set.
+        bool none() const
+        {
+            return ! any();
+        }
+
+        //! Bitwise and with a vector of the same size
+        BitSetVector& operator&=(const BitSetVector& x)
+        {
+            checkSize(x);
+            for (size_type w=0; w<words_.size(); ++w)
+                words_[w] &= x.words_[w];
+            return *this;
+        }
+
+        //! Bitwise inclusive or with a vector of the same size
+        BitSetVector& operator|=(const BitSetVector& x)
+        {
+            checkSize(x);
+            for (size_type w=0; w<words_.size(); ++w)
+                words_[w] |= x.words_[w];
+            return *this;
+        }
+
+        //! Bitwise exclusive or with a vector of the same size
+        BitSetVector& operator^=(const BitSetVector& x)
+        {
+            checkSize(x);
+            for (size_type w=0; w<words_.size(); ++w)
+                words_[w] ^= x.words_[w];
+            return *this;
+        }
+
+        /**
+           \brief Calls a functor for each set bit.
+
+           The bits are visited in ascending order as f(i,j), where i
+           is the number of the block and j the number of the bit in
+           the block. Only the words containing set bits are scanned
+           bit by bit.
+           \return The functor after the last call.
+         */
+        template<class F>
+        F forEachSetBit(F f) const
+        {
+            for (size_type w=0; w<words_.size(); ++w) {
+                word_type word = words_[w];
+                while (word) {
+                    size_type bit = w*wordBits + Detail::bitSetVectorTrailingZeros(word);
+                    f(bit/block_size, bit%block_size);
+                    word &= word-1;
+                }
+            }
+            return f;
+        }
+
         //! Send bitfield to an output stream
         friend std::ostream& operator<< (std::ostream& s, const BitSetVector& v)
         {
@@ -577,25 +835,88 @@ namespace Dune {
 
     private:
 
+        typedef typename Allocator::template rebind<word_type>::other WordAllocator;
+
+        //! The number of words needed for n bits
+        static size_type wordCount(size_type n)
+        {
+            return (n+wordBits-1)/wordBits;
+        }
+
+        //! The total number of bits
+        size_type bits() const
+        {
+            return blocks_*block_size;
+        }
+
+        //! Keep the bits after the last block zero
+        void clearUnusedBits()
+        {
+            if (bits()%wordBits != 0)
+                words_.back() &= Detail::bitSetVectorLowBits(bits()%wordBits);
+        }
+
+        void checkSize(const BitSetVector& x) const
+        {
+            if (x.size() != size())
+                DUNE_THROW(RangeError, "Vector sizes do not match!");
+        }
+
         // get a prepresentation as value_type
         value_type getRepr(int i) const
         {
-            value_type bits;
-            for(int j=0; j<block_size; ++j)
-                bits.set(j, getBit(i,j));
-            return bits;
+            value_type repr;
+            for (size_type j=0; j<block_size; j+=wordBits) {
+                word_type word = getBits(i*size_type(block_size)+j,
+                                         std::min(size_type(wordBits), size_type(block_size)-j));
+                while (word) {
+                    repr.set(j+Detail::bitSetVectorTrailingZeros(word));
+                    word &= word-1;
+                }
+            }
+            return repr;
         }
-        
-        typename std::vector<bool>::reference getBit(size_type i, size_type j) {
-            return BlocklessBaseClass::operator[](i*block_size+j);
+
+        //! The bits pos,...,pos+n-1 with n<=wordBits
+        word_type getBits(size_type pos, size_type n) const
+        {
+            size_type w = pos/wordBits, offset = pos%wordBits;
+            word_type word = words_[w] >> offset;
+            if (!aligned && offset+n > size_type(wordBits))
+                word |= words_[w+1] << (wordBits-offset);
+            return word & Detail::bitSetVectorLowBits(n);
         }
-        
-        typename std::vector<bool>::const_reference getBit(size_type i, size_type j) const {
-            return BlocklessBaseClass::operator[](i*block_size+j);
+
+        //! Set the bits pos,...,pos+n-1 with n<=wordBits
+        void setBits(size_type pos, size_type n, word_type value)
+        {
+            size_type w = pos/wordBits, offset = pos%wordBits;
+            word_type mask = Detail::bitSetVectorLowBits(n);
+            value &= mask;
+            words_[w] = (words_[w] & ~(mask << offset)) | (value << offset);
+            if (!aligned && offset+n > size_type(wordBits)) {
+                size_type shift = wordBits-offset;
+                words_[w+1] = (words_[w+1] & ~(mask >> shift)) | (value >> shift);
+            }
+        }
+
+        BitSetVectorBitReference getBit(size_type i, size_type j) {
+            size_type pos = i*block_size+j;
+            return BitSetVectorBitReference(words_[pos/wordBits], word_type(1) << (pos%wordBits));
         }
-        
+
+        bool getBit(size_type i, size_type j) const {
+            size_type pos = i*block_size+j;
+            return (words_[pos/wordBits] >> (pos%wordBits)) & 1;
+        }
+
         friend class BitSetVectorReference<block_size,Allocator>;
         friend class BitSetVectorConstReference<block_size,Allocator>;
+
+        /** \brief The words holding the bits */
+        std::vector<word_type, WordAllocator> words_;
+        /** \brief The number of blocks */
+        size_type blocks_;
     };
 
 }  // namespace Dune
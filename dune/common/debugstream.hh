@@ -93,6 +93,16 @@ namespace Dune {
 
   Dune::dwarn.attach(mylog);
   \endcode
+
+  Output from several threads, or to slow file systems, can be attached
+  through a DebugSink instead, for example an AsyncDebugSink which
+  writes the lines from a background thread:
+
+  \code
+  Dune::AsyncDebugSink sink(mylog, rank);
+
+  Dune::dinfo.attach(sink);
+  \endcode
   */
   /**
      \addtogroup DebugOut
@@ -144,10 +154,46 @@ namespace Dune {
   //! \brief standard exception for the debugstream
   class DebugStreamError : public IOError {};
 
+  /*! \brief Interface for destinations of DebugStream that are more than a std::ostream
+
+  A sink hands out a stream for the calling thread, so that several
+  threads may write to a DebugStream attached to it at the same time.
+  */
+  class DebugSink {
+  public:
+    virtual ~DebugSink() {};
+
+    //! \brief the stream the calling thread writes to
+    virtual std::ostream& stream() = 0;
+
+    //! \brief the stream the output finally ends up in
+    virtual std::ostream& target() = 0;
+
+    //! \brief wait until everything written so far has reached the target
+    virtual void flush() = 0;
+  };
+
   class StreamWrap {
   public:
-    StreamWrap(std::ostream& _out) : out(_out) { };
+    StreamWrap(std::ostream& _out) : out(_out), sink(0) { };
+    StreamWrap(DebugSink& _sink) : out(_sink.target()), sink(&_sink) { };
+
+    //! \brief the stream to write to from the calling thread
+    std::ostream& stream() {
+      return sink ? sink->stream() : out;
+    };
+
+    //! \brief flush the stream, and wait for the sink to write everything
+    void flush() {
+      if (sink) {
+        sink->stream().flush();
+        sink->flush();
+      } else
+        out.flush();
+    };
+
     std::ostream& out;
+    DebugSink* sink;
     StreamWrap *next;
   };
 
@@ -251,6 +297,8 @@ namespace Dune {
       while (current != 0) {
         StreamWrap *s = current;
         current = current->next;
+        if (s->sink)
+          s->flush();
         delete s;
       };
     };
@@ -262,10 +310,10 @@ namespace Dune {
       if (activator<thislevel, dlevel>::value) {
         if (! _tied) {
           if (_active)
-            current->out << data;
+            current->stream() << data;
         } else {
           if (_active && tiedstate->_active)
-            tiedstate->current->out << data;        
+            tiedstate->current->stream() << data;        
         };
       };      
 
@@ -284,10 +332,10 @@ namespace Dune {
       if (activator<thislevel, dlevel>::value) {
         if (! _tied) {
           if (_active)
-            current->out << data;
+            current->stream() << data;
         } else {
           if (_active && tiedstate->_active)
-            tiedstate->current->out << data;        
+            tiedstate->current->stream() << data;        
         };
       };      
 
@@ -299,10 +347,10 @@ namespace Dune {
       if (activator<thislevel, dlevel>::value) {
         if (! _tied) {
           if (_active)
-            f(current->out);
+            f(current->stream());
         } else {
           if (_active && tiedstate->_active)
-            f(tiedstate->current->out);
+            f(tiedstate->current->stream());
         };
       }
 
@@ -314,10 +362,10 @@ namespace Dune {
       if (activator<thislevel, dlevel>::value) {
         if (! _tied) {
           if (_active)
-            current->out.flush();
+            current->flush();
         } else {
           if (_active && tiedstate->_active)
-            tiedstate->current->out.flush();
+            tiedstate->current->flush();
         };
       }
 
@@ -336,13 +384,20 @@ namespace Dune {
       };
     };
     
-    //! \brief restore previously set activation flag
+    /*! \brief restore previously set activation flag
+
+    If the output goes to a DebugSink, it is flushed.
+    */
     void pop() throw(DebugStreamError) {
       if (_actstack.empty())
         DUNE_THROW(DebugStreamError, "No previous activation setting!");
       
       _active = _actstack.top();
       _actstack.pop();
+
+      StreamWrap* s = _tied ? tiedstate->current : current;
+      if (s->sink)
+        s->flush();
     };
 
     /*! \brief reports if this stream will produce output
@@ -367,6 +422,20 @@ namespace Dune {
       newcurr->next = current;
       current = newcurr;    
     };
+
+    /*! \brief set output to a DebugSink. 
+
+    Old stream data is stored. The sink must outlive this stream or
+    be detach()ed before it is destructed.
+    */
+    void attach(DebugSink& sink) {
+      if (_tied)
+        DUNE_THROW(DebugStreamError, "Cannot attach to a tied stream!");
+
+      StreamWrap* newcurr = new StreamWrap(sink);
+      newcurr->next = current;
+      current = newcurr;    
+    };
     
     //! \brief detach current output stream and restore to previous stream
     void detach() throw(DebugStreamError) {
@@ -377,6 +446,8 @@ namespace Dune {
       
       StreamWrap* old = current;
       current = current->next;
+      if (old->sink)
+        old->flush();
       delete old;
     };
 
@@ -7,6 +7,8 @@
 #include <cmath>
 #include <cstddef>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <vector>
 
 #include <dune/common/misc.hh>
@@ -101,6 +103,87 @@ namespace Dune
   /** @brief Error thrown if operations of a FieldMatrix fail. */
   class FMatrixError : public Exception {};
 
+  /**
+     \brief The type of the copies a DenseMatrix makes of itself, e.g. for the LU decomposition
+
+     The copies are MAT by default. Matrix types which do not own their
+     entries, like DenseMatrixView, have to specialize this with a matrix
+     type that does and that is constructible from MAT.
+  */
+  template<typename MAT>
+  struct DenseMatrixCopy
+  {
+    typedef MAT type;
+  };
+
+  template< class K, class Allocator > class DynamicMatrix;
+
+#ifndef DOXYGEN
+  namespace Detail
+  {
+    /* Adds the products row[j]*x[j], j in [begin,end), to y. The products
+       are summed up in Acc first, as chosen by the AccumulationTraits of
+       the entries K of the row, and the sum is added to y. */
+    template<class Acc, class K>
+    struct DenseRowProduct
+    {
+      template<class Row, class X>
+      static Acc sum (const Row& row, const X& x, std::size_t begin, std::size_t end)
+      {
+        Acc s(0);
+        for (std::size_t j=begin; j<end; ++j)
+          s += Acc(row[j]) * x[j];
+        return s;
+      }
+
+      template<class Row, class X, class T>
+      static void add (const Row& row, const X& x, T& y, std::size_t begin, std::size_t end)
+      {
+        y += sum(row, x, begin, end);
+      }
+
+      template<class Row, class X, class T>
+      static void subtract (const Row& row, const X& x, T& y, std::size_t begin, std::size_t end)
+      {
+        y -= sum(row, x, begin, end);
+      }
+
+      template<class F, class Row, class X, class T>
+      static void add (const F& alpha, const Row& row, const X& x, T& y, std::size_t begin, std::size_t end)
+      {
+        y += alpha * sum(row, x, begin, end);
+      }
+    };
+
+    /* Without a wider accumulator every product is added to y directly,
+       which also works for vectors of another field, e.g. complex ones. */
+    template<class K>
+    struct DenseRowProduct<K,K>
+    {
+      template<class Row, class X, class T>
+      static void add (const Row& row, const X& x, T& y, std::size_t begin, std::size_t end)
+      {
+        for (std::size_t j=begin; j<end; ++j)
+          y += row[j] * x[j];
+      }
+
+      template<class Row, class X, class T>
+      static void subtract (const Row& row, const X& x, T& y, std::size_t begin, std::size_t end)
+      {
+        for (std::size_t j=begin; j<end; ++j)
+          y -= row[j] * x[j];
+      }
+
+      template<class F, class Row, class X, class T>
+      static void add (const F& alpha, const Row& row, const X& x, T& y, std::size_t begin, std::size_t end)
+      {
+        for (std::size_t j=begin; j<end; ++j)
+          y += alpha * row[j] * x[j];
+      }
+    };
+  }
+#endif // DOXYGEN
+
   /** 
       @brief A dense n x m matrix.
 
@@ -174,7 +257,7 @@ namespace Dune
         
     //===== iterator interface to rows of the matrix
     //! Iterator class for sequential access
-    typedef DenseIterator<DenseMatrix,row_type> Iterator;
+    typedef DenseIterator<DenseMatrix,row_type,row_reference> Iterator;
     //! typedef for stl compliant access
     typedef Iterator iterator;
     //! rename the iterators for easier access
@@ -209,7 +292,7 @@ namespace Dune
     }
 
     //! Iterator class for sequential access
-    typedef DenseIterator<const DenseMatrix,const row_type> ConstIterator;
+    typedef DenseIterator<const DenseMatrix,const row_type,const_row_reference> ConstIterator;
     //! typedef for stl compliant access
     typedef ConstIterator const_iterator;
     //! rename the iterators for easier access
@@ -332,8 +415,7 @@ namespace Dune
       for (size_type i=0; i<rows(); ++i)
       {
         y[i] = 0;
-        for (size_type j=0; j<cols(); j++)
-          y[i] += (*this)[i][j] * x[j];
+        RowProduct::add((*this)[i], x, y[i], 0, cols());
       }
     }
 
@@ -352,10 +434,12 @@ namespace Dune
         DUNE_THROW( FMatrixError, "Index out of range." );
 #endif
       for( size_type i = 0; i < cols(); ++i )
-      {
         y[ i ] = 0;
-        for( size_type j = 0; j < rows(); ++j )
-          y[ i ] += (*this)[ j ][ i ] * x[ j ];
+      for( size_type j = 0; j < rows(); ++j )
+      {
+        const_row_reference row = (*this)[ j ];
+        for( size_type i = 0; i < cols(); ++i )
+          y[ i ] += row[ i ] * x[ j ];
       }
     }
 
@@ -370,8 +454,7 @@ namespace Dune
         DUNE_THROW(FMatrixError,"y += A x -- index out of range (sizes: x: " << x.N() << ", y: " << y.N() << ", A: " << this->N() << " x " << this->M() << ")" << std::endl);
 #endif
       for (size_type i=0; i<rows(); i++)
-        for (size_type j=0; j<cols(); j++)
-          y[i] += (*this)[i][j] * x[j];
+        RowProduct::add((*this)[i], x, y[i], 0, cols());
     }
 
     //! y += A^T x
@@ -384,8 +467,11 @@ namespace Dune
 #endif
       
       for (size_type i=0; i<rows(); i++)
+      {
+        const_row_reference row = (*this)[i];
         for (size_type j=0; j<cols(); j++)
-          y[j] += (*this)[i][j]*x[i];
+          y[j] += row[j]*x[i];
+      }
     }
 
     //! y += A^H x
@@ -398,8 +484,11 @@ namespace Dune
 #endif
       
       for (size_type i=0; i<rows(); i++)
+      {
+        const_row_reference row = (*this)[i];
         for (size_type j=0; j<cols(); j++)
-          y[j] += conjugateComplex((*this)[i][j])*x[i];
+          y[j] += conjugateComplex(row[j])*x[i];
+      }
     }
 
     //! y -= A x
@@ -411,8 +500,7 @@ namespace Dune
       if (y.N()!=N()) DUNE_THROW(FMatrixError,"index out of range");
 #endif
       for (size_type i=0; i<rows(); i++)
-        for (size_type j=0; j<cols(); j++)
-          y[i] -= (*this)[i][j] * x[j];
+        RowProduct::subtract((*this)[i], x, y[i], 0, cols());
     }
 
     //! y -= A^T x
@@ -425,8 +513,11 @@ namespace Dune
 #endif
       
       for (size_type i=0; i<rows(); i++)
+      {
+        const_row_reference row = (*this)[i];
         for (size_type j=0; j<cols(); j++)
-          y[j] -= (*this)[i][j]*x[i];
+          y[j] -= row[j]*x[i];
+      }
     }
 
     //! y -= A^H x
@@ -439,8 +530,11 @@ namespace Dune
 #endif
       
       for (size_type i=0; i<rows(); i++)
+      {
+        const_row_reference row = (*this)[i];
         for (size_type j=0; j<cols(); j++)
-          y[j] -= conjugateComplex((*this)[i][j])*x[i];
+          y[j] -= conjugateComplex(row[j])*x[i];
+      }
     }
 
     //! y += alpha A x
@@ -452,8 +546,7 @@ namespace Dune
       if (y.N()!=N()) DUNE_THROW(FMatrixError,"index out of range");
 #endif
       for (size_type i=0; i<rows(); i++)
-        for (size_type j=0; j<cols(); j++)
-          y[i] += alpha * (*this)[i][j] * x[j];
+        RowProduct::add(alpha, (*this)[i], x, y[i], 0, cols());
     }
 
     //! y += alpha A^T x
@@ -466,8 +559,11 @@ namespace Dune
 #endif
       
       for (size_type i=0; i<rows(); i++)
+      {
+        const_row_reference row = (*this)[i];
         for (size_type j=0; j<cols(); j++)
-          y[j] += alpha*(*this)[i][j]*x[i];
+          y[j] += alpha*row[j]*x[i];
+      }
     }
 
     //! y += alpha A^H x
@@ -480,8 +576,11 @@ namespace Dune
 #endif
       
       for (size_type i=0; i<rows(); i++)
+      {
+        const_row_reference row = (*this)[i];
         for (size_type j=0; j<cols(); j++)
-          y[j] += alpha*conjugateComplex((*this)[i][j])*x[i];
+          y[j] += alpha*conjugateComplex(row[j])*x[i];
+      }
     }
 
     //===== norms
@@ -489,17 +588,17 @@ namespace Dune
     //! frobenius norm: sqrt(sum over squared values of entries)
     typename FieldTraits<value_type>::real_type frobenius_norm () const
     {
-      typename FieldTraits<value_type>::real_type sum=(0.0);
+      typename AccumulationTraits<value_type>::real_accumulation_type sum=(0.0);
       for (size_type i=0; i<rows(); ++i) sum += (*this)[i].two_norm2();
-      return fvmeta::sqrt(sum);
+      return typename FieldTraits<value_type>::real_type(fvmeta::sqrt(sum));
     }
 
     //! square of frobenius norm, need for block recursion
     typename FieldTraits<value_type>::real_type frobenius_norm2 () const
     {
-      typename FieldTraits<value_type>::real_type sum=(0.0);
+      typename AccumulationTraits<value_type>::real_accumulation_type sum=(0.0);
       for (size_type i=0; i<rows(); ++i) sum += (*this)[i].two_norm2();
-      return sum;
+      return typename FieldTraits<value_type>::real_type(sum);
     }
 
     //! infinity norm (row sum norm, how to generalize for blocks?)
@@ -539,6 +638,26 @@ namespace Dune
     template <class V>
     void solve (V& x, const V& b) const;
 
+    /** \brief Solve system A x = b by mixed-precision iterative refinement
+     *
+     * Factorizes a copy of the matrix with entries of type Low, e.g. float
+     * for a matrix of doubles, and corrects the solution with residuals
+     * computed with the matrix itself until they are at the rounding level
+     * of its field. The factorization and the substitutions move half the
+     * data of solve(), each residual reads the matrix once. If the copy is
+     * singular or the residual is not small enough after maxIterations
+     * corrections, e.g. because the matrix is too ill-conditioned for Low,
+     * x is computed by solve().
+     *
+     * \tparam Low the field type of the factorization
+     * \return whether the refinement converged
+     *
+     * \exception FMatrixError if the matrix is singular
+     * \note The factorization is a DynamicMatrix, include dynmatrix.hh.
+     */
+    template <class Low, class V>
+    bool refinedSolve (V& x, const V& b, int maxIterations = 30) const;
+
     /** \brief Compute inverse
      *
      * \exception FMatrixError if the matrix is singular
@@ -553,7 +672,7 @@ namespace Dune
     MAT& leftmultiply (const DenseMatrix<M2>& M)
     {
       assert(M.rows() == M.cols() && M.rows() == rows());
-      MAT C(asImp());
+      typename DenseMatrixCopy<MAT>::type C(asImp());
 
       for (size_type i=0; i<rows(); i++)
         for (size_type j=0; j<cols(); j++) {
@@ -570,7 +689,7 @@ namespace Dune
     MAT& rightmultiply (const DenseMatrix<M2>& M)
     {
       assert(M.rows() == M.cols() && M.cols() == cols());
-      MAT C(asImp());
+      typename DenseMatrixCopy<MAT>::type C(asImp());
       
       for (size_type i=0; i<rows(); i++)
         for (size_type j=0; j<cols(); j++) {
@@ -656,6 +775,8 @@ namespace Dune
   private:
 
 #ifndef DOXYGEN
+    typedef Detail::DenseRowProduct<typename AccumulationTraits<value_type>::accumulation_type, value_type> RowProduct;
+
     struct ElimPivot
     {
       ElimPivot(std::vector<size_type> & pivot);
@@ -696,8 +817,8 @@ namespace Dune
     };
 #endif // DOXYGEN
     
-    template<class Func>
-    void luDecomposition(DenseMatrix<MAT>& A, Func func) const;
+    template<class Func, class Copy>
+    void luDecomposition(DenseMatrix<Copy>& A, Func func) const;
   };
 
 #ifndef DOXYGEN
@@ -736,8 +857,8 @@ namespace Dune
     (*rhs_)[k] -= factor*(*rhs_)[i];
   }
   template<typename MAT>
-  template<typename Func>
-  inline void DenseMatrix<MAT>::luDecomposition(DenseMatrix<MAT>& A, Func func) const
+  template<typename Func, typename Copy>
+  inline void DenseMatrix<MAT>::luDecomposition(DenseMatrix<Copy>& A, Func func) const
   {
     typedef typename FieldTraits<value_type>::real_type
       real_type;
@@ -841,19 +962,75 @@ namespace Dune
       V& rhs = x; // use x to store rhs
       rhs = b; // copy data
       Elim<V> elim(rhs);
-      MAT A(asImp());
+      typename DenseMatrixCopy<MAT>::type A(asImp());
       
       luDecomposition(A, elim);
       
       // backsolve
       for(int i=rows()-1; i>=0; i--){
-        for (size_type j=i+1; j<rows(); j++)
-          rhs[i] -= A[i][j]*x[j];
+        RowProduct::subtract(A[i], x, rhs[i], i+1, rows());
         x[i] = rhs[i]/A[i][i];
       }
     }   
   }
 
+  template<typename MAT>
+  template <class Low, class V>
+  inline bool DenseMatrix<MAT>::refinedSolve(V& x, const V& b, int maxIterations) const
+  {
+    if (rows()!=cols())
+      DUNE_THROW(FMatrixError, "Can't solve for a " << rows() << "x" << cols() << " matrix!");
+
+    typedef typename FieldTraits<value_type>::real_type real_type;
+    typedef Detail::DenseRowProduct<typename AccumulationTraits<Low>::accumulation_type, Low> LowRowProduct;
+    const size_type n = rows();
+
+    DynamicMatrix< Low, std::allocator<Low> > A(asImp());
+    std::vector<size_type> pivot(n);
+    try {
+      luDecomposition(A, ElimPivot(pivot));
+    }
+    catch (FMatrixError&) {
+      // singular in the precision of Low only?
+      solve(x, b);
+      return false;
+    }
+
+    // the stopping criterion of LAPACK's dsgesv
+    const real_type tolerance = infinity_norm() * std::numeric_limits<real_type>::epsilon()
+                                * std::sqrt(real_type(n));
+
+    std::vector<Low> d(n);
+    V r(b);
+    x = 0;
+    for (int k=0; k<=maxIterations; ++k)
+    {
+      // correction d = A^{-1} r with the factorization
+      for (size_type i=0; i<n; ++i)
+        d[i] = r[i];
+      for (size_type i=0; i<n; ++i)
+        std::swap(d[i], d[pivot[i]]);
+      for (size_type i=1; i<n; ++i)
+        LowRowProduct::subtract(A[i], d, d[i], 0, i);
+      for (size_type i=n; i-->0; )
+      {
+        LowRowProduct::subtract(A[i], d, d[i], i+1, n);
+        d[i] /= A[i][i];
+      }
+      for (size_type i=0; i<n; ++i)
+        x[i] += d[i];
+
+      // residual r = b - A x with the matrix itself
+      r = b;
+      mmv(x, r);
+      if (r.infinity_norm() <= tolerance * x.infinity_norm())
+        return true;
+    }
+
+    solve(x, b);
+    return false;
+  }
+
   template<typename MAT>
   inline void DenseMatrix<MAT>::invert()
   {
@@ -888,11 +1065,12 @@ namespace Dune
     }
     else {
       
-      MAT A(asImp());
+      typedef typename DenseMatrixCopy<MAT>::type Copy;
+      Copy A(asImp());
       std::vector<size_type> pivot(rows());
       luDecomposition(A, ElimPivot(pivot));
-      DenseMatrix<MAT>& L=A;
-      DenseMatrix<MAT>& U=A;
+      const Copy& L=A;
+      const Copy& U=A;
           
       // initialize inverse
       *this=field_type();
@@ -954,7 +1132,7 @@ namespace Dune
 
     }
 
-    MAT A(asImp());
+    typename DenseMatrixCopy<MAT>::type A(asImp());
     field_type det;
     try
     {
@@ -10,6 +10,7 @@
 #include "matvectraits.hh"
 #include "promotiontraits.hh"
 #include "dotproduct.hh"
+#include "hash.hh"
 
 namespace Dune {
 
@@ -112,16 +113,63 @@ namespace Dune {
 
   }
 
+#ifndef DOXYGEN
+  namespace Detail
+  {
+    // operator-> of iterators returning proxy objects, which have to
+    // outlive the member access
+    template<class T, class R>
+    struct DenseIteratorArrow
+    {
+      class Pointer
+      {
+      public:
+        explicit Pointer (const R& r) : r_(r) {}
+
+        R* operator-> () const
+        {
+          return &r_;
+        }
+
+      private:
+        mutable typename remove_const<R>::type r_;
+      };
+
+      static Pointer get (const R& r)
+      {
+        return Pointer(r);
+      }
+    };
+
+    // operator-> of iterators returning their entries by reference
+    template<class T>
+    struct DenseIteratorArrow<T, T&>
+    {
+      typedef T* Pointer;
+
+      static Pointer get (T& t)
+      {
+        return &t;
+      }
+    };
+  }
+#endif // DOXYGEN
+
   /*! \brief Generic iterator class for dense vector and matrix implementations
 
     provides sequential access to DenseVector, FieldVector and FieldMatrix
+
+    \tparam C the container
+    \tparam T the type of the entries
+    \tparam R the type returned on dereferencing, T& or a proxy object
+               like the row views of DynamicMatrix
    */
-  template<class C, class T>
+  template<class C, class T, class R = T&>
   class DenseIterator : 
-    public Dune::RandomAccessIteratorFacade<DenseIterator<C,T>,T, T&, std::ptrdiff_t>
+    public Dune::RandomAccessIteratorFacade<DenseIterator<C,T,R>,T, R, std::ptrdiff_t>
   {
-    friend class DenseIterator<typename remove_const<C>::type, typename remove_const<T>::type >;
-    friend class DenseIterator<const typename remove_const<C>::type, const typename remove_const<T>::type >;
+    template<class C2, class T2, class R2>
+    friend class DenseIterator;
     
   public:
     
@@ -144,24 +192,28 @@ namespace Dune {
       : container_(&cont), position_(pos)
     {}
     
-    DenseIterator(const DenseIterator<typename remove_const<C>::type, typename remove_const<T>::type >& other)
+    //! conversion from the mutable to the const iterator
+    template<class C2, class T2, class R2>
+    DenseIterator(const DenseIterator<C2,T2,R2>& other,
+                  typename enable_if<Conversion<C2*,C*>::exists>::type* = 0)
       : container_(other.container_), position_(other.position_)
     {}
     
     // Methods needed by the forward iterator
-    bool equals(const DenseIterator<typename remove_const<C>::type,typename remove_const<T>::type>& other) const
+    template<class C2, class T2, class R2>
+    bool equals(const DenseIterator<C2,T2,R2>& other) const
     {
       return position_ == other.position_ && container_ == other.container_;
     }
     
-    
-    bool equals(const DenseIterator<const typename remove_const<C>::type,const typename remove_const<T>::type>& other) const
-    {
-      return position_ == other.position_ && container_ == other.container_;
+    R dereference() const{
+      return container_->operator[](position_);
     }
     
-    T& dereference() const{
-      return container_->operator[](position_);
+    //! member access, also for proxy objects
+    typename Detail::DenseIteratorArrow<T,R>::Pointer operator->() const
+    {
+      return Detail::DenseIteratorArrow<T,R>::get(dereference());
     }
     
     void increment(){
@@ -174,7 +226,7 @@ namespace Dune {
     }
     
     // Additional function needed by RandomAccessIterator
-    T& elementAt(DifferenceType i)const{
+    R elementAt(DifferenceType i)const{
       return container_->operator[](position_+i);
     }
     
@@ -182,13 +234,8 @@ namespace Dune {
       position_=position_+n;
     }
     
-    DifferenceType distanceTo(DenseIterator<const typename remove_const<C>::type,const typename remove_const<T>::type> other)const
-    {
-      assert(other.container_==container_);
-      return other.position_ - position_;
-    }
-    
-    DifferenceType distanceTo(DenseIterator<typename remove_const<C>::type, typename remove_const<T>::type> other)const
+    template<class C2, class T2, class R2>
+    DifferenceType distanceTo(const DenseIterator<C2,T2,R2>& other)const
     {
       assert(other.container_==container_);
       return other.position_ - position_;
@@ -464,12 +511,13 @@ namespace Dune {
     template<class Other>
     typename PromotionTraits<field_type,typename DenseVector<Other>::field_type>::PromotedType operator* (const DenseVector<Other>& y) const {
       typedef typename PromotionTraits<field_type, typename DenseVector<Other>::field_type>::PromotedType PromotedType;
-      PromotedType result(0);
+      typedef typename AccumulationTraits<PromotedType>::accumulation_type Accumulation;
+      Accumulation result(0);
       assert(y.size() == size());
       for (size_type i=0; i<size(); i++) {
-        result += PromotedType((*this)[i]*y[i]);
+        result += Accumulation((*this)[i])*Accumulation(y[i]);
       }
-      return result;
+      return PromotedType(result);
     }
 
     /**
@@ -482,50 +530,53 @@ namespace Dune {
     template<class Other>
     typename PromotionTraits<field_type,typename DenseVector<Other>::field_type>::PromotedType dot(const DenseVector<Other>& y) const {
       typedef typename PromotionTraits<field_type, typename DenseVector<Other>::field_type>::PromotedType PromotedType;
-      PromotedType result(0);
+      typedef typename AccumulationTraits<PromotedType>::accumulation_type Accumulation;
+      Accumulation result(0);
       assert(y.size() == size());
       for (size_type i=0; i<size(); i++) {
-        result += Dune::dot((*this)[i],y[i]);
+        result += Dune::dot(Accumulation((*this)[i]),Accumulation(y[i]));
       }
-      return result;
+      return PromotedType(result);
      }
 
     //===== norms
 
     //! one norm (sum over absolute values of entries)
     typename FieldTraits<value_type>::real_type one_norm() const {
-      typename FieldTraits<value_type>::real_type result( 0 );
+      typename AccumulationTraits<value_type>::real_accumulation_type result( 0 );
       for (size_type i=0; i<size(); i++)
         result += std::abs((*this)[i]);
-      return result;
+      return typename FieldTraits<value_type>::real_type(result);
     }
 
 
     //! simplified one norm (uses Manhattan norm for complex values)
     typename FieldTraits<value_type>::real_type one_norm_real () const
     {
-      typename FieldTraits<value_type>::real_type result( 0 );
+      typename AccumulationTraits<value_type>::real_accumulation_type result( 0 );
       for (size_type i=0; i<size(); i++)
         result += fvmeta::absreal((*this)[i]);
-      return result;
+      return typename FieldTraits<value_type>::real_type(result);
     }
 
     //! two norm sqrt(sum over squared values of entries)
     typename FieldTraits<value_type>::real_type two_norm () const
     {
-      typename FieldTraits<value_type>::real_type result( 0 );
+      typedef typename AccumulationTraits<value_type>::accumulation_type Accumulation;
+      typename AccumulationTraits<value_type>::real_accumulation_type result( 0 );
       for (size_type i=0; i<size(); i++)
-        result += fvmeta::abs2((*this)[i]);
-      return fvmeta::sqrt(result);
+        result += fvmeta::abs2(Accumulation((*this)[i]));
+      return typename FieldTraits<value_type>::real_type(fvmeta::sqrt(result));
     }
 
     //! square of two norm (sum over squared values of entries), need for block recursion
     typename FieldTraits<value_type>::real_type two_norm2 () const
     {
-      typename FieldTraits<value_type>::real_type result( 0 );
+      typedef typename AccumulationTraits<value_type>::accumulation_type Accumulation;
+      typename AccumulationTraits<value_type>::real_accumulation_type result( 0 );
       for (size_type i=0; i<size(); i++)
-        result += fvmeta::abs2((*this)[i]);
-      return result;
+        result += fvmeta::abs2(Accumulation((*this)[i]));
+      return typename FieldTraits<value_type>::real_type(result);
     }
 
     //! infinity norm (maximum of absolute values of entries)
@@ -588,6 +639,20 @@ namespace Dune {
     return s;
   }
 
+#if HAVE_DUNE_HASH || defined(DOXYGEN)
+  /** \brief Hash the entries of a DenseVector
+   *  \relates DenseVector
+   *
+   *  Vectors with equal entries have equal hash values, independent of
+   *  the implementation of the DenseVector interface.
+   */
+  template<typename V>
+  inline std::size_t hash_value (const DenseVector<V>& v)
+  {
+    return hash_sequence(v.begin(), v.end());
+  }
+#endif // HAVE_DUNE_HASH || defined(DOXYGEN)
+
   /** @} end documentation */
 
 } // end namespace
@@ -0,0 +1,542 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_DENSEVIEW_HH
+#define DUNE_DENSEVIEW_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+#include <dune/common/densematrix.hh>
+#include <dune/common/densevector.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/ftraits.hh>
+#include <dune/common/iteratorfacades.hh>
+#include <dune/common/static_assert.hh>
+#include <dune/common/typetraits.hh>
+
+namespace Dune
+{
+
+/**
+    @addtogroup DenseMatVec
+    @{
+*/
+
+/*! \file
+ *  \brief Dense vectors and matrices referring to entries stored elsewhere.
+ */
+
+  /** \brief Marks a size which is only known at run time */
+  enum { dynamicExtent = -1 };
+
+  /** \brief Marks a stride which is only known at run time */
+  enum { dynamicStride = 0 };
+
+  template< class K, int SIZE = dynamicExtent, int STRIDE = 1 > class DenseVectorView;
+  template< class K, int ROWS = dynamicExtent, int COLS = dynamicExtent > class DenseMatrixView;
+  template< class K, class Allocator > class DynamicMatrix;
+
+  /** \brief Random access iterator over the entries of a DenseVectorView
+   *
+   *  In contrast to DenseIterator it refers to the entries and not to
+   *  the view, so it stays valid when a temporary view, e.g. a row of a
+   *  DynamicMatrix, is destroyed.
+   */
+  template< class T, int STRIDE >
+  class DenseViewIterator
+    : public RandomAccessIteratorFacade< DenseViewIterator<T,STRIDE>, T, T&, std::ptrdiff_t >
+  {
+    template< class T2, int STRIDE2 >
+    friend class DenseViewIterator;
+
+  public:
+    /** \brief The type of the difference between two positions. */
+    typedef std::ptrdiff_t DifferenceType;
+
+    /** \brief The type of the indices of the entries. */
+    typedef std::size_t SizeType;
+
+    DenseViewIterator ()
+      : data_(0), stride_(STRIDE), position_(0)
+    {}
+
+    DenseViewIterator (T *data, DifferenceType stride, DifferenceType position)
+      : data_(data), stride_(stride), position_(position)
+    {}
+
+    //! conversion from the mutable to the const iterator
+    template< class T2 >
+    DenseViewIterator (const DenseViewIterator<T2,STRIDE> &other,
+                       typename enable_if< Conversion<T2*,T*>::exists >::type* = 0)
+      : data_(other.data_), stride_(other.stride_), position_(other.position_)
+    {}
+
+    template< class T2 >
+    bool equals (const DenseViewIterator<T2,STRIDE> &other) const
+    {
+      return position_ == other.position_ && data_ == other.data_;
+    }
+
+    T &dereference () const
+    {
+      return data_[position_*stride()];
+    }
+
+    void increment ()
+    {
+      ++position_;
+    }
+
+    void decrement ()
+    {
+      --position_;
+    }
+
+    T &elementAt (DifferenceType i) const
+    {
+      return data_[(position_+i)*stride()];
+    }
+
+    void advance (DifferenceType n)
+    {
+      position_ += n;
+    }
+
+    template< class T2 >
+    DifferenceType distanceTo (const DenseViewIterator<T2,STRIDE> &other) const
+    {
+      assert(other.data_ == data_);
+      return other.position_ - position_;
+    }
+
+    //! return index
+    SizeType index () const
+    {
+      return position_;
+    }
+
+  private:
+    DifferenceType stride () const
+    {
+      return (STRIDE == dynamicStride ? stride_ : DifferenceType(STRIDE));
+    }
+
+    T *data_;
+    DifferenceType stride_;
+    DifferenceType position_;
+  };
+
+
+
+  template< class K, int SIZE, int STRIDE >
+  struct DenseMatVecTraits< DenseVectorView<K,SIZE,STRIDE> >
+  {
+    typedef DenseVectorView<K,SIZE,STRIDE> derived_type;
+    typedef typename remove_const<K>::type value_type;
+    typedef std::size_t size_type;
+  };
+
+  template< class K, int SIZE, int STRIDE >
+  struct FieldTraits< DenseVectorView<K,SIZE,STRIDE> >
+  {
+    typedef typename FieldTraits<K>::field_type field_type;
+    typedef typename FieldTraits<K>::real_type real_type;
+  };
+
+  /** \brief A dense vector referring to entries stored elsewhere
+   *
+   *  The view gives the DenseVector interface to entries which are not
+   *  owned by a DUNE vector, e.g. the rows of a DynamicMatrix, an MPI
+   *  buffer or an array of another library, without copying them. The
+   *  i-th entry is data[i*stride].
+   *
+   *  Copies of a view refer to the same entries, while assignments copy
+   *  the entries, like the assignments to the rows of a FieldMatrix do.
+   *  Binary operators return DynamicVectors. A view of const K gives
+   *  read-only access, e.g. to a received buffer:
+   *  \code
+   *  void residual (const double* buffer, std::size_t n)
+   *  {
+   *    DenseVectorView<const double> x(buffer, n);
+   *    double norm = x.two_norm();
+   *    ...
+   *  }
+   *  \endcode
+   *
+   *  \tparam K      is the field type (use float, double, complex, etc),
+   *                 const qualified for read-only views
+   *  \tparam SIZE   is the number of entries, dynamicExtent if it is
+   *                 given at run time
+   *  \tparam STRIDE is the distance of consecutive entries, dynamicStride
+   *                 if it is given at run time
+   */
+  template< class K, int SIZE, int STRIDE >
+  class DenseVectorView : public DenseVector< DenseVectorView<K,SIZE,STRIDE> >
+  {
+    dune_static_assert(SIZE >= 0 || SIZE == int(dynamicExtent),
+                       "The size of a DenseVectorView has to be non-negative or dynamicExtent");
+    dune_static_assert(STRIDE > 0 || STRIDE == int(dynamicStride),
+                       "The stride of a DenseVectorView has to be positive or dynamicStride");
+
+    typedef DenseVector< DenseVectorView<K,SIZE,STRIDE> > Base;
+
+  public:
+    typedef typename Base::size_type size_type;
+    typedef typename Base::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+
+    //! Constructor making a view of no entries
+    DenseVectorView () :
+      data_(0), size_(SIZE == dynamicExtent ? 0 : SIZE),
+      stride_(STRIDE == dynamicStride ? 1 : STRIDE)
+    {}
+
+    //! Constructor making a view of the entries data[i*stride], i<SIZE
+    explicit DenseVectorView (K *data) :
+      data_(data), size_(SIZE), stride_(STRIDE == dynamicStride ? 1 : STRIDE)
+    {
+      dune_static_assert(SIZE != dynamicExtent, "The size of the view is missing");
+    }
+
+    //! Constructor making a view of the entries data[i*stride], i<size
+    DenseVectorView (K *data, size_type size,
+                     difference_type stride = (STRIDE == dynamicStride ? 1 : STRIDE)) :
+      data_(data), size_(size), stride_(stride)
+    {
+      assert(SIZE == dynamicExtent || size == size_type(SIZE));
+      assert(STRIDE == dynamicStride || stride == STRIDE);
+    }
+
+    //! Copy constructor, the copy refers to the same entries
+    DenseVectorView (const DenseVectorView &other) :
+      data_(other.data_), size_(other.size_), stride_(other.stride_)
+    {}
+
+    //! Conversion of a view to a read-only view
+    template< class K2 >
+    DenseVectorView (const DenseVectorView<K2,SIZE,STRIDE> &other,
+                     typename enable_if< Conversion<K2*,K*>::exists >::type* = 0) :
+      data_(other.data()), size_(other.size()), stride_(other.stride())
+    {}
+
+    //! Assign the entries of other
+    DenseVectorView &operator= (const DenseVectorView &other)
+    {
+      return assign(other);
+    }
+
+    //! Assign the entries of x
+    template< class V >
+    DenseVectorView &operator= (const DenseVector<V> &x)
+    {
+      return assign(x);
+    }
+
+    using Base::operator=;
+
+    //===== access to the entries, also for views of const K
+    K &operator[] (size_type i) { return vec_access(i); }
+    const K &operator[] (size_type i) const { return vec_access(i); }
+
+    //! Binary vector addition
+    template< class V >
+    DynamicVector<value_type> operator+ (const DenseVector<V> &b) const
+    {
+      DynamicVector<value_type> z(*this);
+      return (z+=b);
+    }
+
+    //! Binary vector subtraction
+    template< class V >
+    DynamicVector<value_type> operator- (const DenseVector<V> &b) const
+    {
+      DynamicVector<value_type> z(*this);
+      return (z-=b);
+    }
+
+    //! pointer to the first entry
+    K *data () { return data_; }
+    //! pointer to the first entry
+    const K *data () const { return data_; }
+
+    //! distance of consecutive entries
+    difference_type stride () const
+    {
+      return (STRIDE == dynamicStride ? stride_ : difference_type(STRIDE));
+    }
+
+    //===== iterators over the entries, which do not refer to the view
+    typedef DenseViewIterator<K,STRIDE> Iterator;
+    typedef Iterator iterator;
+    typedef DenseViewIterator<const K,STRIDE> ConstIterator;
+    typedef ConstIterator const_iterator;
+
+    Iterator begin () { return Iterator(data_, stride(), 0); }
+    Iterator end () { return Iterator(data_, stride(), vec_size()); }
+    Iterator beforeEnd () { return Iterator(data_, stride(), difference_type(vec_size())-1); }
+    Iterator beforeBegin () { return Iterator(data_, stride(), -1); }
+    Iterator find (size_type i) { return Iterator(data_, stride(), std::min(i, vec_size())); }
+
+    ConstIterator begin () const { return ConstIterator(data_, stride(), 0); }
+    ConstIterator end () const { return ConstIterator(data_, stride(), vec_size()); }
+    ConstIterator beforeEnd () const { return ConstIterator(data_, stride(), difference_type(vec_size())-1); }
+    ConstIterator beforeBegin () const { return ConstIterator(data_, stride(), -1); }
+    ConstIterator find (size_type i) const { return ConstIterator(data_, stride(), std::min(i, vec_size())); }
+
+    //==== make this thing a vector
+    size_type vec_size () const
+    {
+      return (SIZE == dynamicExtent ? size_ : size_type(SIZE));
+    }
+    K &vec_access (size_type i)
+    {
+      assert(i < vec_size());
+      return data_[i*stride()];
+    }
+    const K &vec_access (size_type i) const
+    {
+      assert(i < vec_size());
+      return data_[i*stride()];
+    }
+
+  private:
+    template< class V >
+    DenseVectorView &assign (const DenseVector<V> &x)
+    {
+      assert(x.size() == vec_size());
+      for (size_type i=0; i<vec_size(); ++i)
+        data_[i*stride()] = x[i];
+      return *this;
+    }
+
+    K *data_;
+    size_type size_;
+    difference_type stride_;
+  };
+
+
+
+  template< class K, int ROWS, int COLS >
+  struct DenseMatVecTraits< DenseMatrixView<K,ROWS,COLS> >
+  {
+    typedef DenseMatrixView<K,ROWS,COLS> derived_type;
+
+    typedef DenseVectorView<K,COLS> row_type;
+
+    typedef row_type row_reference;
+    typedef DenseVectorView<const K,COLS> const_row_reference;
+
+    typedef typename remove_const<K>::type value_type;
+    typedef std::size_t size_type;
+  };
+
+  template< class K, int ROWS, int COLS >
+  struct FieldTraits< DenseMatrixView<K,ROWS,COLS> >
+  {
+    typedef typename FieldTraits<K>::field_type field_type;
+    typedef typename FieldTraits<K>::real_type real_type;
+  };
+
+  /** \brief solve() and invert() work on a DynamicMatrix copy, include dynmatrix.hh for them */
+  template< class K, int ROWS, int COLS >
+  struct DenseMatrixCopy< DenseMatrixView<K,ROWS,COLS> >
+  {
+    typedef typename remove_const<K>::type value_type;
+    typedef DynamicMatrix< value_type, std::allocator<value_type> > type;
+  };
+
+  /** \brief A dense matrix referring to entries stored elsewhere
+   *
+   *  The view gives the DenseMatrix interface to entries which are not
+   *  owned by a DUNE matrix, e.g. a sub-matrix of a DynamicMatrix or an
+   *  array of another library, without copying them. The entries are
+   *  stored row by row, the entry (i,j) is data[i*leadingDimension+j], as
+   *  in the row-major BLAS and LAPACK interfaces. The rows are
+   *  DenseVectorViews.
+   *
+   *  Copies of a view refer to the same entries, while assignments copy
+   *  the entries. The matrix-vector products work on the entries in place,
+   *  solve(), invert() and determinant() factorize a DynamicMatrix copy.
+   *
+   *  \tparam K    is the field type (use float, double, complex, etc),
+   *               const qualified for read-only views
+   *  \tparam ROWS is the number of rows, dynamicExtent if it is given at
+   *               run time
+   *  \tparam COLS is the number of columns, dynamicExtent if it is given at
+   *               run time
+   */
+  template< class K, int ROWS, int COLS >
+  class DenseMatrixView : public DenseMatrix< DenseMatrixView<K,ROWS,COLS> >
+  {
+    dune_static_assert((ROWS >= 0 || ROWS == int(dynamicExtent))
+                       && (COLS >= 0 || COLS == int(dynamicExtent)),
+                       "The sizes of a DenseMatrixView have to be non-negative or dynamicExtent");
+
+    typedef DenseMatrix< DenseMatrixView<K,ROWS,COLS> > Base;
+
+  public:
+    typedef typename Base::size_type size_type;
+    typedef typename Base::value_type value_type;
+    typedef typename Base::row_type row_type;
+    //! The type of the read-only views of a row
+    typedef DenseVectorView<const K,COLS> const_row_type;
+    //! The type of the views of a column
+    typedef DenseVectorView<K,ROWS,dynamicStride> column_type;
+    //! The type of the read-only views of a column
+    typedef DenseVectorView<const K,ROWS,dynamicStride> const_column_type;
+    //! The type of the views of a sub-matrix
+    typedef DenseMatrixView<K> view_type;
+    //! The type of the read-only views of a sub-matrix
+    typedef DenseMatrixView<const K> const_view_type;
+
+    //! Constructor making a view of no entries
+    DenseMatrixView () :
+      data_(0), rows_(ROWS == dynamicExtent ? 0 : ROWS),
+      cols_(COLS == dynamicExtent ? 0 : COLS), leadingDimension_(cols_)
+    {}
+
+    //! Constructor making a view of ROWS x COLS entries, stored row by row with the given leading dimension
+    explicit DenseMatrixView (K *data, size_type leadingDimension = (COLS == dynamicExtent ? 0 : COLS)) :
+      data_(data), rows_(ROWS), cols_(COLS), leadingDimension_(leadingDimension)
+    {
+      dune_static_assert(ROWS != dynamicExtent && COLS != dynamicExtent,
+                         "The sizes of the view are missing");
+      assert(leadingDimension >= cols_);
+    }
+
+    //! Constructor making a view of r x c entries, stored row by row with the given leading dimension
+    DenseMatrixView (K *data, size_type r, size_type c, size_type leadingDimension) :
+      data_(data), rows_(r), cols_(c), leadingDimension_(leadingDimension)
+    {
+      assert(ROWS == dynamicExtent || r == size_type(ROWS));
+      assert(COLS == dynamicExtent || c == size_type(COLS));
+      assert(leadingDimension >= c);
+    }
+
+    //! Constructor making a view of r x c contiguous entries
+    DenseMatrixView (K *data, size_type r, size_type c) :
+      data_(data), rows_(r), cols_(c), leadingDimension_(c)
+    {
+      assert(ROWS == dynamicExtent || r == size_type(ROWS));
+      assert(COLS == dynamicExtent || c == size_type(COLS));
+    }
+
+    //! Copy constructor, the copy refers to the same entries
+    DenseMatrixView (const DenseMatrixView &other) :
+      data_(other.data_), rows_(other.rows_), cols_(other.cols_),
+      leadingDimension_(other.leadingDimension_)
+    {}
+
+    //! Conversion of a view to a read-only view
+    template< class K2 >
+    DenseMatrixView (const DenseMatrixView<K2,ROWS,COLS> &other,
+                     typename enable_if< Conversion<K2*,K*>::exists >::type* = 0) :
+      data_(other.data()), rows_(other.rows()), cols_(other.cols()),
+      leadingDimension_(other.leadingDimension())
+    {}
+
+    //! Assign the entries of other
+    DenseMatrixView &operator= (const DenseMatrixView &other)
+    {
+      return assign(other);
+    }
+
+    //! Assign the entries of m
+    template< class M >
+    DenseMatrixView &operator= (const DenseMatrix<M> &m)
+    {
+      return assign(m);
+    }
+
+    //! Assign the scalar k to all entries
+    DenseMatrixView &operator= (const value_type &k)
+    {
+      Base::operator=(k);
+      return *this;
+    }
+
+    //! pointer to the entry (0,0)
+    K *data () { return data_; }
+    //! pointer to the entry (0,0)
+    const K *data () const { return data_; }
+
+    //! distance of the first entries of consecutive rows
+    size_type leadingDimension () const { return leadingDimension_; }
+
+    //! view of the row i
+    row_type row (size_type i) { return mat_access(i); }
+    //! view of the row i
+    const_row_type row (size_type i) const { return mat_access(i); }
+
+    //! view of the column j
+    column_type column (size_type j)
+    {
+      assert(j < mat_cols());
+      return column_type(data_+j, mat_rows(), leadingDimension_);
+    }
+
+    //! view of the column j
+    const_column_type column (size_type j) const
+    {
+      assert(j < mat_cols());
+      return const_column_type(data_+j, mat_rows(), leadingDimension_);
+    }
+
+    //! view of the r x c entries starting at (i,j)
+    view_type subMatrix (size_type i, size_type j, size_type r, size_type c)
+    {
+      assert(i+r <= mat_rows() && j+c <= mat_cols());
+      return view_type(data_+i*leadingDimension_+j, r, c, leadingDimension_);
+    }
+
+    //! view of the r x c entries starting at (i,j)
+    const_view_type subMatrix (size_type i, size_type j, size_type r, size_type c) const
+    {
+      assert(i+r <= mat_rows() && j+c <= mat_cols());
+      return const_view_type(data_+i*leadingDimension_+j, r, c, leadingDimension_);
+    }
+
+    // make this thing a matrix
+    size_type mat_rows () const
+    {
+      return (ROWS == dynamicExtent ? rows_ : size_type(ROWS));
+    }
+    size_type mat_cols () const
+    {
+      return (COLS == dynamicExtent ? cols_ : size_type(COLS));
+    }
+    row_type mat_access (size_type i)
+    {
+      assert(i < mat_rows());
+      return row_type(data_+i*leadingDimension_, mat_cols());
+    }
+    const_row_type mat_access (size_type i) const
+    {
+      assert(i < mat_rows());
+      return const_row_type(data_+i*leadingDimension_, mat_cols());
+    }
+
+  private:
+    template< class M >
+    DenseMatrixView &assign (const DenseMatrix<M> &m)
+    {
+      assert(m.rows() == mat_rows() && m.cols() == mat_cols());
+      for (size_type i=0; i<mat_rows(); ++i)
+        for (size_type j=0; j<mat_cols(); ++j)
+          data_[i*leadingDimension_+j] = m[i][j];
+      return *this;
+    }
+
+    K *data_;
+    size_type rows_;
+    size_type cols_;
+    size_type leadingDimension_;
+  };
+
+/** @} end documentation */
+
+} // end namespace
+
+#endif
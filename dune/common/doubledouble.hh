@@ -0,0 +1,482 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_DOUBLEDOUBLE_HH
+#define DUNE_COMMON_DOUBLEDOUBLE_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/promotiontraits.hh>
+
+/** @file
+    @brief A field type of about 32 significant decimal digits stored as the unevaluated sum of two doubles.
+
+    Like gmpfield.hh, include this header before the dense vector and
+    matrix headers, so that their std::sqrt and std::abs calls see the
+    overloads for DoubleDouble.
+*/
+
+namespace Dune {
+
+#ifndef DOXYGEN
+  namespace Detail {
+    namespace DoubleDoubleArithmetic {
+
+      // s+e = a+b exactly
+      inline void twoSum(double a, double b, double& s, double& e)
+      {
+        s = a+b;
+        const double bb = s-a;
+        e = (a-(s-bb)) + (b-bb);
+      }
+
+      // s+e = a+b exactly if |a| >= |b|
+      inline void quickTwoSum(double a, double b, double& s, double& e)
+      {
+        s = a+b;
+        e = b-(s-a);
+      }
+
+      // hi+lo = a with 26 bit halves
+      inline void split(double a, double& hi, double& lo)
+      {
+        const double t = 134217729.0*a;  // 2^27+1
+        hi = t-(t-a);
+        lo = a-hi;
+      }
+
+      // p+e = a*b exactly (Dekker), without relying on a fused multiply-add
+      inline void twoProd(double a, double b, double& p, double& e)
+      {
+        double ah, al, bh, bl;
+        p = a*b;
+        split(a, ah, al);
+        split(b, bh, bl);
+        e = ((ah*bh-p) + ah*bl + al*bh) + al*bl;
+      }
+
+    }
+  }
+#endif // DOXYGEN
+
+  /** @addtogroup DenseMatVec
+   *
+   * @{
+   */
+
+  /**
+   * @brief A floating point number of twice the precision of double, stored as the sum of two doubles.
+   *
+   * The value is hi()+lo() with |lo()| at most half an ulp of hi(), which
+   * gives 106 bits of significand with the exponent range of double. The
+   * arithmetic uses the error-free transformations of Dekker and Knuth, as
+   * in the QD library: every operation is a short fixed sequence of double
+   * operations without branches or allocation, so it costs about 10 to 20
+   * times a double operation. The relative error of +, -, * and / is a
+   * small multiple of numeric_limits<DoubleDouble>::epsilon() = 2^-104.
+   *
+   * DoubleDouble can be used as the field of FieldVector, FieldMatrix and
+   * DynamicMatrix, with FloatCmp, FMatrixHelp::eigenValues and MPI. It
+   * converts implicitly from double, but only explicitly to double via
+   * toDouble(), so that no computation drops to double precision by
+   * accident. For FloatCmp::round and trunc, convert to double first.
+   * Like for GMPField, std::sqrt, std::abs and std::floor are overloaded.
+   */
+  class DoubleDouble
+  {
+  public:
+    //! Constructs zero
+    DoubleDouble() : hi_(0), lo_(0) {}
+
+    //! Constructs the value x
+    DoubleDouble(double x) : hi_(x), lo_(0) {}
+
+    //! Constructs the value hi+lo, which must not overlap, i.e. hi == hi+lo in double
+    DoubleDouble(double hi, double lo) : hi_(hi), lo_(lo) {}
+
+    /**
+     * @brief Constructs the value of a decimal number like "1.25e-3"
+     *
+     * @throw RangeError if s is not a number
+     */
+    explicit DoubleDouble(const std::string& s) : hi_(0), lo_(0)
+    {
+      if (!parse(s.c_str(), *this))
+        DUNE_THROW(RangeError, "\"" << s << "\" is not a number");
+    }
+
+    //! The leading double
+    double hi() const { return hi_; }
+
+    //! The trailing double
+    double lo() const { return lo_; }
+
+    //! The value rounded to double
+    double toDouble() const { return hi_+lo_; }
+
+    DoubleDouble& operator+=(const DoubleDouble& b)
+    {
+      using namespace Detail::DoubleDoubleArithmetic;
+      double s, e, t, f;
+      twoSum(hi_, b.hi_, s, e);
+      twoSum(lo_, b.lo_, t, f);
+      e += t;
+      quickTwoSum(s, e, s, e);
+      e += f;
+      quickTwoSum(s, e, hi_, lo_);
+      return *this;
+    }
+
+    DoubleDouble& operator-=(const DoubleDouble& b)
+    {
+      return *this += -b;
+    }
+
+    DoubleDouble& operator*=(const DoubleDouble& b)
+    {
+      using namespace Detail::DoubleDoubleArithmetic;
+      double p, e;
+      twoProd(hi_, b.hi_, p, e);
+      e += hi_*b.lo_ + lo_*b.hi_;
+      quickTwoSum(p, e, hi_, lo_);
+      return *this;
+    }
+
+    DoubleDouble& operator/=(const DoubleDouble& b)
+    {
+      using namespace Detail::DoubleDoubleArithmetic;
+      // long division with three quotient digits
+      const double q1 = hi_/b.hi_;
+      // infinite and nan operands or quotients as in double, the
+      // correction would make them nan
+      const double infinity = std::numeric_limits<double>::infinity();
+      if (!(std::abs(q1) < infinity) || !(std::abs(b.hi_) < infinity))
+        return *this = DoubleDouble(q1);
+      DoubleDouble r = *this - q1*b;
+      const double q2 = r.hi_/b.hi_;
+      r -= q2*b;
+      const double q3 = r.hi_/b.hi_;
+      double s, e;
+      quickTwoSum(q1, q2, s, e);
+      *this = DoubleDouble(s, e) + DoubleDouble(q3);
+      return *this;
+    }
+
+    DoubleDouble operator-() const
+    {
+      return DoubleDouble(-hi_, -lo_);
+    }
+
+    DoubleDouble operator+() const
+    {
+      return *this;
+    }
+
+    friend DoubleDouble operator+(DoubleDouble a, const DoubleDouble& b) { return a += b; }
+    friend DoubleDouble operator+(DoubleDouble a, double b) { return a += b; }
+    friend DoubleDouble operator+(double a, const DoubleDouble& b) { return DoubleDouble(a) += b; }
+    friend DoubleDouble operator-(DoubleDouble a, const DoubleDouble& b) { return a -= b; }
+    friend DoubleDouble operator-(DoubleDouble a, double b) { return a -= b; }
+    friend DoubleDouble operator-(double a, const DoubleDouble& b) { return DoubleDouble(a) -= b; }
+    friend DoubleDouble operator*(DoubleDouble a, const DoubleDouble& b) { return a *= b; }
+    friend DoubleDouble operator*(DoubleDouble a, double b) { return a *= b; }
+    friend DoubleDouble operator*(double a, const DoubleDouble& b) { return DoubleDouble(a) *= b; }
+    friend DoubleDouble operator/(DoubleDouble a, const DoubleDouble& b) { return a /= b; }
+    friend DoubleDouble operator/(DoubleDouble a, double b) { return a /= b; }
+    friend DoubleDouble operator/(double a, const DoubleDouble& b) { return DoubleDouble(a) /= b; }
+
+    friend bool operator==(const DoubleDouble& a, const DoubleDouble& b) { return a.hi_ == b.hi_ && a.lo_ == b.lo_; }
+    friend bool operator!=(const DoubleDouble& a, const DoubleDouble& b) { return !(a == b); }
+    friend bool operator<(const DoubleDouble& a, const DoubleDouble& b) { return a.hi_ < b.hi_ || (a.hi_ == b.hi_ && a.lo_ < b.lo_); }
+    friend bool operator>(const DoubleDouble& a, const DoubleDouble& b) { return b < a; }
+    friend bool operator<=(const DoubleDouble& a, const DoubleDouble& b) { return !(b < a); }
+    friend bool operator>=(const DoubleDouble& a, const DoubleDouble& b) { return !(a < b); }
+    friend bool operator==(const DoubleDouble& a, double b) { return a == DoubleDouble(b); }
+    friend bool operator!=(const DoubleDouble& a, double b) { return a != DoubleDouble(b); }
+    friend bool operator<(const DoubleDouble& a, double b) { return a < DoubleDouble(b); }
+    friend bool operator>(const DoubleDouble& a, double b) { return a > DoubleDouble(b); }
+    friend bool operator<=(const DoubleDouble& a, double b) { return a <= DoubleDouble(b); }
+    friend bool operator>=(const DoubleDouble& a, double b) { return a >= DoubleDouble(b); }
+    friend bool operator==(double a, const DoubleDouble& b) { return DoubleDouble(a) == b; }
+    friend bool operator!=(double a, const DoubleDouble& b) { return DoubleDouble(a) != b; }
+    friend bool operator<(double a, const DoubleDouble& b) { return DoubleDouble(a) < b; }
+    friend bool operator>(double a, const DoubleDouble& b) { return DoubleDouble(a) > b; }
+    friend bool operator<=(double a, const DoubleDouble& b) { return DoubleDouble(a) <= b; }
+    friend bool operator>=(double a, const DoubleDouble& b) { return DoubleDouble(a) >= b; }
+
+    /**
+     * @brief Writes the decimal representation with the precision of the stream, at most 32 digits.
+     *
+     * As for double, the number is written with precision significant
+     * digits without trailing zeros, in scientific notation if the exponent
+     * is out of [-5,precision). If the scientific flag of the stream is set,
+     * it is written in scientific notation with precision digits after the
+     * point.
+     */
+    friend std::ostream& operator<<(std::ostream& out, const DoubleDouble& a)
+    {
+      const bool scientific = (out.flags() & std::ios::scientific) != 0;
+      return out << a.toString(scientific ? out.precision()+1 : out.precision(), scientific);
+    }
+
+    /**
+     * @brief Reads a decimal number, see DoubleDouble(const std::string&)
+     *
+     * If the next word is not a number, the failbit of the stream is
+     * set and a is not changed.
+     */
+    friend std::istream& operator>>(std::istream& in, DoubleDouble& a)
+    {
+      std::string s;
+      DoubleDouble value;
+      if (in >> s)
+      {
+        if (parse(s.c_str(), value))
+          a = value;
+        else
+          in.setstate(std::ios::failbit);
+      }
+      return in;
+    }
+
+  private:
+    static DoubleDouble power10(int n)
+    {
+      DoubleDouble result(1), base(10);
+      const bool negative = n < 0;
+      for (unsigned int m = negative ? -n : n; m; m >>= 1, base *= base)
+        if (m & 1)
+          result *= base;
+      return negative ? 1/result : result;
+    }
+
+    // parses the whole string s, returns false if it is not a number
+    static bool parse(const char* s, DoubleDouble& value)
+    {
+      const char* const begin = s;
+      DoubleDouble result;
+      bool negative = false;
+      if (*s == '-' || *s == '+')
+        negative = *s++ == '-';
+      long exponent = 0;
+      bool point = false, digits = false;
+      for (; (*s >= '0' && *s <= '9') || (*s == '.' && !point); ++s)
+        if (*s == '.')
+          point = true;
+        else
+          {
+            result = 10*result + double(*s-'0');
+            exponent -= point;
+            digits = true;
+          }
+      if (digits && (*s == 'e' || *s == 'E'))
+      {
+        char* end;
+        exponent += std::strtol(s+1, &end, 10);
+        s = end == s+1 ? s : end;
+      }
+      if (!digits || *s)
+      {
+        // inf and nan, as written by operator<<
+        char* end;
+        const double x = std::strtod(begin, &end);
+        if (end == begin || *end || std::abs(x) < std::numeric_limits<double>::infinity())
+          return false;
+        value = x;
+        return true;
+      }
+      result *= power10(int(std::max(-100000L, std::min(exponent, 100000L))));
+      value = negative ? -result : result;
+      return true;
+    }
+
+    std::string toString(std::streamsize precision, bool scientific) const
+    {
+      if (hi_ != hi_)
+        return "nan";
+      if (hi_ == std::numeric_limits<double>::infinity())
+        return "inf";
+      if (hi_ == -std::numeric_limits<double>::infinity())
+        return "-inf";
+      const int digits = int(std::max<std::streamsize>(1, std::min<std::streamsize>(precision, 32)));
+      std::string result = hi_ < 0 ? "-" : "";
+      DoubleDouble r = hi_ < 0 ? -*this : *this;
+      if (r.hi_ == 0)
+        return result + "0";
+
+      // the digits of r/10^exponent in [1,10), one more for the rounding
+      int exponent = int(std::floor(std::log10(r.hi_)));
+      r /= power10(exponent);
+      if (r.hi_ >= 10)
+        {
+          r /= 10;
+          ++exponent;
+        }
+      else if (r.hi_ < 1)
+        {
+          r *= 10;
+          --exponent;
+        }
+      std::string d(digits+1, '0');
+      for (int i = 0; i <= digits; ++i)
+        {
+          int digit = int(std::floor(r.hi_));
+          if (digit < 0) digit = 0;
+          if (digit > 9) digit = 9;
+          d[i] = char('0'+digit);
+          r = 10*(r - double(digit));
+          if (r.hi_ < 0 && i < digits)
+            {
+              // the truncation went one too far
+              int j = i;
+              while (d[j] == '0')
+                d[j--] = '9';
+              --d[j];
+              r += 10;
+            }
+        }
+      // round to nearest
+      if (d[digits] >= '5')
+        {
+          int j = digits-1;
+          while (j >= 0 && d[j] == '9')
+            d[j--] = '0';
+          if (j >= 0)
+            ++d[j];
+          else
+            {
+              d.insert(d.begin(), '1');
+              ++exponent;
+            }
+        }
+      d.resize(digits);
+      if (!scientific)
+        d.erase(std::max<std::size_t>(1, d.find_last_not_of('0')+1));
+
+      if (scientific || exponent < -5 || exponent >= digits)
+        {
+          result += d[0];
+          if (d.size() > 1)
+            result += "." + d.substr(1);
+          const int e = exponent < 0 ? -exponent : exponent;
+          result += exponent < 0 ? "e-" : "e+";
+          if (e < 10)
+            result += '0';
+          return result + toDecimal(e);
+        }
+      if (exponent < 0)
+        return result + "0." + std::string(-exponent-1, '0') + d;
+      if (exponent+1 < int(d.size()))
+        return result + d.substr(0, exponent+1) + "." + d.substr(exponent+1);
+      return result + d + std::string(exponent+1-d.size(), '0');
+    }
+
+    static std::string toDecimal(int n)
+    {
+      std::string s;
+      do
+        s.insert(s.begin(), char('0'+n%10));
+      while (n /= 10);
+      return s;
+    }
+
+    double hi_;
+    double lo_;
+  };
+
+#ifndef DOXYGEN
+  template<> struct PromotionTraits<DoubleDouble,double> { typedef DoubleDouble PromotedType; };
+  template<> struct PromotionTraits<double,DoubleDouble> { typedef DoubleDouble PromotedType; };
+  template<> struct PromotionTraits<DoubleDouble,float> { typedef DoubleDouble PromotedType; };
+  template<> struct PromotionTraits<float,DoubleDouble> { typedef DoubleDouble PromotedType; };
+  template<> struct PromotionTraits<DoubleDouble,int> { typedef DoubleDouble PromotedType; };
+  template<> struct PromotionTraits<int,DoubleDouble> { typedef DoubleDouble PromotedType; };
+#endif // DOXYGEN
+
+  /** @} */
+
+} // end namespace Dune
+
+namespace std
+{
+
+  //! The square root, with Karp's trick of one Newton step from the double root
+  inline Dune::DoubleDouble sqrt(const Dune::DoubleDouble& a)
+  {
+    using namespace Dune::Detail::DoubleDoubleArithmetic;
+    if (a.hi() <= 0)
+      return Dune::DoubleDouble(std::sqrt(a.hi()));
+    const double x = 1/std::sqrt(a.hi());
+    const double ax = a.hi()*x;
+    double s, e;
+    twoProd(ax, ax, s, e);
+    const double correction = (a - Dune::DoubleDouble(s, e)).hi()*(x*0.5);
+    twoSum(ax, correction, s, e);
+    return Dune::DoubleDouble(s, e);
+  }
+
+  //! The absolute value
+  inline Dune::DoubleDouble abs(const Dune::DoubleDouble& a)
+  {
+    return a.hi() < 0 ? -a : a;
+  }
+
+  //! The largest integer not greater than a
+  inline Dune::DoubleDouble floor(const Dune::DoubleDouble& a)
+  {
+    using namespace Dune::Detail::DoubleDoubleArithmetic;
+    const double hi = std::floor(a.hi());
+    if (hi != a.hi())
+      return Dune::DoubleDouble(hi);
+    double s, e;
+    quickTwoSum(hi, std::floor(a.lo()), s, e);
+    return Dune::DoubleDouble(s, e);
+  }
+
+  template<>
+  class numeric_limits<Dune::DoubleDouble>
+  {
+    typedef Dune::DoubleDouble T;
+  public:
+    static const bool is_specialized = true;
+    static T min() throw() { return T(2.0041683600089728e-292); }  // 2^-969
+    static T max() throw() { return T(1.79769313486231570815e+308, 9.97920154767359795037e+291); }
+    static T lowest() throw() { return -max(); }
+    static const int digits = 106;
+    static const int digits10 = 31;
+    static const int max_digits10 = 33;
+    static const bool is_signed = true;
+    static const bool is_integer = false;
+    static const bool is_exact = false;
+    static const int radix = 2;
+    static T epsilon() throw() { return T(4.93038065763132e-32); }  // 2^-104
+    static T round_error() throw() { return T(0.5); }
+    static const int min_exponent = -968;
+    static const int min_exponent10 = -291;
+    static const int max_exponent = numeric_limits<double>::max_exponent;
+    static const int max_exponent10 = numeric_limits<double>::max_exponent10;
+    static const bool has_infinity = true;
+    static const bool has_quiet_NaN = true;
+    static const bool has_signaling_NaN = true;
+    static const float_denorm_style has_denorm = denorm_absent;
+    static const bool has_denorm_loss = false;
+    static T infinity() throw() { return T(numeric_limits<double>::infinity()); }
+    static T quiet_NaN() throw() { return T(numeric_limits<double>::quiet_NaN()); }
+    static T signaling_NaN() throw() { return T(numeric_limits<double>::signaling_NaN()); }
+    static T denorm_min() throw() { return min(); }
+    static const bool is_iec559 = false;
+    static const bool is_bounded = true;
+    static const bool is_modulo = false;
+    static const bool traps = false;
+    static const bool tinyness_before = false;
+    static const float_round_style round_style = round_to_nearest;
+  };
+
+} // end namespace std
+
+#endif // DUNE_COMMON_DOUBLEDOUBLE_HH
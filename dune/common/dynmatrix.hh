@@ -7,11 +7,13 @@
 #include <cmath>
 #include <cstddef>
 #include <iostream>
+#include <vector>
 
 #include <dune/common/misc.hh>
 #include <dune/common/exceptions.hh>
 #include <dune/common/dynvector.hh>
 #include <dune/common/densematrix.hh>
+#include <dune/common/denseview.hh>
 #include <dune/common/static_assert.hh>
 
 namespace Dune
@@ -26,71 +28,157 @@ namespace Dune
  *  \brief This file implements a dense matrix with dynamic numbers of rows and columns.
  */
 
-  template< class K > class DynamicMatrix;
+  template< class K, class Allocator = std::allocator<K> > class DynamicMatrix;
 
-  template< class K >
-  struct DenseMatVecTraits< DynamicMatrix<K> >
+  template< class K, class Allocator >
+  struct DenseMatVecTraits< DynamicMatrix<K,Allocator> >
   {
-    typedef DynamicMatrix<K> derived_type;
+    typedef DynamicMatrix<K,Allocator> derived_type;
 
-    typedef DynamicVector<K> row_type;
+    typedef DenseVectorView<K> row_type;
 
-    typedef row_type &row_reference;
-    typedef const row_type &const_row_reference;
+    typedef row_type row_reference;
+    typedef DenseVectorView<const K> const_row_reference;
 
-    typedef std::vector<K> container_type;
+    typedef std::vector<K,Allocator> container_type;
     typedef K value_type;
     typedef typename container_type::size_type size_type;
   };
   
-  template< class K >
-  struct FieldTraits< DynamicMatrix<K> >
+  template< class K, class Allocator >
+  struct FieldTraits< DynamicMatrix<K,Allocator> >
   {
     typedef typename FieldTraits<K>::field_type field_type;
     typedef typename FieldTraits<K>::real_type real_type;
   };
 
   /** \brief Construct a matrix with a dynamic size.
+   *
+   * The entries are stored row by row in a single contiguous block,
+   * the entry (i,j) is data()[i*leadingDimension()+j]. The block can be
+   * handed to row-major BLAS and LAPACK routines or to MPI. The rows,
+   * columns and sub-matrices are views of the block, see DenseVectorView
+   * and DenseMatrixView. Constructing and resizing allocate once.
    *
    * \tparam K is the field type (use float, double, complex, etc)
+   * \tparam Allocator the allocator of the entries, e.g. an ArenaAllocator
+   *         for temporaries
    */
-  template<class K>
-  class DynamicMatrix : public DenseMatrix< DynamicMatrix<K> >
+  template<class K, class Allocator>
+  class DynamicMatrix : public DenseMatrix< DynamicMatrix<K,Allocator> >
   {
-    std::vector< DynamicVector<K> > _data;
-    typedef DenseMatrix< DynamicMatrix<K> > Base;
+    typedef DenseMatrix< DynamicMatrix<K,Allocator> > Base;
   public:
     typedef typename Base::size_type size_type;
     typedef typename Base::value_type value_type;
     typedef typename Base::row_type row_type;
-    
+    //! The type of the read-only views of a row
+    typedef DenseVectorView<const K> const_row_type;
+    //! The type of the views of a column
+    typedef DenseVectorView<K,dynamicExtent,dynamicStride> column_type;
+    //! The type of the read-only views of a column
+    typedef DenseVectorView<const K,dynamicExtent,dynamicStride> const_column_type;
+    //! The type of the views of a sub-matrix
+    typedef DenseMatrixView<K> view_type;
+    //! The type of the read-only views of a sub-matrix
+    typedef DenseMatrixView<const K> const_view_type;
+    typedef Allocator allocator_type;
+
+  private:
+    std::vector<K,Allocator> _data;
+    size_type _rows;
+    size_type _cols;
+
+  public:
     //===== constructors
     //! \brief Default constructor
-    DynamicMatrix () {}
+    explicit DynamicMatrix (const allocator_type &a = allocator_type() ) :
+      _data(a), _rows(0), _cols(0)
+    {}
 
     //! \brief Constructor initializing the whole matrix with a scalar
-    DynamicMatrix (size_type r, size_type c, value_type v = value_type() ) :
-      _data(r, row_type(c, v) )
+    DynamicMatrix (size_type r, size_type c, value_type v = value_type(),
+                   const allocator_type &a = allocator_type() ) :
+      _data(r*c, v, a), _rows(r), _cols(c)
     {}
 
+    //! \brief Copy constructor from another dense matrix, e.g. a DenseMatrixView
+    template<class M>
+    DynamicMatrix (const DenseMatrix<M> &m, const allocator_type &a = allocator_type() ) :
+      _data(a), _rows(m.rows()), _cols(m.cols())
+    {
+      _data.reserve(_rows*_cols);
+      for (size_type i=0; i<_rows; ++i)
+        for (size_type j=0; j<_cols; ++j)
+          _data.push_back(m[i][j]);
+    }
+
     //==== resize related methods
     void resize (size_type r, size_type c, value_type v = value_type() )
     {
-      _data.resize(0);
-      _data.resize(r, row_type(c, v) );
+      _data.assign(r*c, v);
+      _rows = r;
+      _cols = c;
     }
     
     //===== assignment
     using Base::operator=;
-    
+
+    //===== access to the storage
+    //! pointer to the entry (0,0)
+    K *data () { return _data.empty() ? 0 : &_data[0]; }
+    //! pointer to the entry (0,0)
+    const K *data () const { return _data.empty() ? 0 : &_data[0]; }
+
+    //! distance of the first entries of consecutive rows
+    size_type leadingDimension () const { return _cols; }
+
+    //! view of the row i
+    row_type row (size_type i) { return mat_access(i); }
+    //! view of the row i
+    const_row_type row (size_type i) const { return mat_access(i); }
+
+    //! view of the column j
+    column_type column (size_type j)
+    {
+      assert(j < _cols);
+      return column_type(data()+j, _rows, _cols);
+    }
+
+    //! view of the column j
+    const_column_type column (size_type j) const
+    {
+      assert(j < _cols);
+      return const_column_type(data()+j, _rows, _cols);
+    }
+
+    //! view of the r x c entries starting at (i,j)
+    view_type subMatrix (size_type i, size_type j, size_type r, size_type c)
+    {
+      assert(i+r <= _rows && j+c <= _cols);
+      return view_type(data()+i*_cols+j, r, c, _cols);
+    }
+
+    //! view of the r x c entries starting at (i,j)
+    const_view_type subMatrix (size_type i, size_type j, size_type r, size_type c) const
+    {
+      assert(i+r <= _rows && j+c <= _cols);
+      return const_view_type(data()+i*_cols+j, r, c, _cols);
+    }
+
     // make this thing a matrix
-    size_type mat_rows() const { return _data.size(); }
-    size_type mat_cols() const {
-      assert(this->rows());
-      return _data.front().size();
+    size_type mat_rows() const { return _rows; }
+    size_type mat_cols() const { return _cols; }
+    row_type mat_access(size_type i)
+    {
+      assert(i < _rows);
+      return row_type(data()+i*_cols, _cols);
+    }
+    const_row_type mat_access(size_type i) const
+    {
+      assert(i < _rows);
+      return const_row_type(data()+i*_cols, _cols);
     }
-    row_type & mat_access(size_type i) { return _data[i]; }
-    const row_type & mat_access(size_type i) const { return _data[i]; }
   };
 
 /** @} end documentation */
@@ -25,18 +25,18 @@ namespace Dune {
  * \brief This file implements a dense vector with a dynamic size.
 */
   
-  template< class K > class DynamicVector;
-  template< class K >
-  struct DenseMatVecTraits< DynamicVector<K> >
+  template< class K, class Allocator = std::allocator<K> > class DynamicVector;
+  template< class K, class Allocator >
+  struct DenseMatVecTraits< DynamicVector<K,Allocator> >
   {
-    typedef DynamicVector<K> derived_type;
-    typedef std::vector<K> container_type;
+    typedef DynamicVector<K,Allocator> derived_type;
+    typedef std::vector<K,Allocator> container_type;
     typedef K value_type;
     typedef typename container_type::size_type size_type;
   };
   
-  template< class K >
-  struct FieldTraits< DynamicVector<K> >
+  template< class K, class Allocator >
+  struct FieldTraits< DynamicVector<K,Allocator> >
   {
     typedef typename FieldTraits<K>::field_type field_type;
     typedef typename FieldTraits<K>::real_type real_type;
@@ -45,23 +45,29 @@ namespace Dune {
   /** \brief Construct a vector with a dynamic size.
    *
    * \tparam K is the field type (use float, double, complex, etc)
+   * \tparam Allocator the allocator of the storage, e.g. a
+   *         SizeClassAllocator to take small vectors from pooled memory
    */
-  template< class K >
-  class DynamicVector : public DenseVector< DynamicVector<K> >
+  template< class K, class Allocator >
+  class DynamicVector : public DenseVector< DynamicVector<K,Allocator> >
   {
-    std::vector<K> _data;
+    std::vector<K,Allocator> _data;
 
-    typedef DenseVector< DynamicVector<K> > Base;
+    typedef DenseVector< DynamicVector<K,Allocator> > Base;
   public:
     typedef typename Base::size_type size_type;
     typedef typename Base::value_type value_type;
+    typedef Allocator allocator_type;
     
 	//! Constructor making uninitialized vector
-	DynamicVector() {}
+	explicit DynamicVector(const allocator_type &a = allocator_type() ) :
+      _data(a)
+    {}
 
 	//! Constructor making vector with identical coordinates
-	explicit DynamicVector (size_type n, value_type c = value_type() ) :
-      _data(n,c)
+	explicit DynamicVector (size_type n, value_type c = value_type(),
+                            const allocator_type &a = allocator_type() ) :
+      _data(n,c,a)
     {}
 
 	//! Constructor making vector with identical coordinates
@@ -69,6 +75,12 @@ namespace Dune {
       _data(x._data)
 	{}
 
+    //! Copy constructor from another dense vector, e.g. a DenseVectorView
+    template<class X>
+    DynamicVector (const DenseVector<X> & x, const allocator_type &a = allocator_type() ) :
+      _data(x.begin(), x.end(), a)
+    {}
+
     using Base::operator=;
     
     //==== forward some methods of std::vector
@@ -106,12 +118,12 @@ namespace Dune {
    *
    *  \returns the input stream (in)
    */
-  template<class K>
+  template<class K, class Allocator>
   inline std::istream &operator>> ( std::istream &in,
-    DynamicVector<K> &v )
+    DynamicVector<K,Allocator> &v )
   {
-    DynamicVector<K> w(v);
-    for( typename DynamicVector<K>::size_type i = 0; i < w.size(); ++i )
+    DynamicVector<K,Allocator> w(v);
+    for( typename DynamicVector<K,Allocator>::size_type i = 0; i < w.size(); ++i )
       in >> w[ i ];
     if(in)
       v = w;
@@ -122,4 +134,6 @@ namespace Dune {
 
 } // end namespace
 
+DUNE_DEFINE_HASH(DUNE_HASH_TEMPLATE_ARGS(class K, class Allocator),DUNE_HASH_TYPE(Dune::DynamicVector<K,Allocator>))
+
 #endif
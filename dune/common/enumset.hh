@@ -2,6 +2,8 @@
 #define DUNE_ENUMSET_HH
 
 #include<iostream>
+#include<stdint.h>
+#include<dune/common/typetraits.hh>
 
 namespace Dune
 {
@@ -106,9 +108,161 @@ namespace Dune
   class Combine 
   {
   public:
+    /**
+     * @brief The type the set holds.
+     */
+    typedef TA Type;
+
     static bool contains(const TA& item);
   };
   
+  /**
+   * @brief A set of enumeration values represented by a bit mask.
+   *
+   * Item i is contained in the set if bit i of the mask is set.
+   * Therefore only items in the range [0,64) can be represented.
+   * Testing membership needs only a shift and a bitwise and.
+   *
+   * @tparam TA The type the set holds.
+   * @tparam mask The bit mask of the items in the set.
+   */
+  template<typename TA, uint64_t mask>
+  class BitmaskAttributeSet
+  {
+  public:
+    /**
+     * @brief The type the set holds.
+     */
+    typedef TA Type;
+
+    enum{
+      /** @brief The maximum number of items that can be represented. */
+      maxItems = 64
+    };
+
+    /**
+     * @brief Tests whether an item is in the set.
+     * @return True if bit item of the mask is set.
+     */
+    static bool contains(const Type& item);
+  };
+
+  /**
+   * @brief Compile time bit mask of a set of enumeration values.
+   *
+   * For sets that can be represented by a BitmaskAttributeSet,
+   * i.e. all items lie in [0,64), isBitmask is true and value
+   * is the corresponding mask. This is the case for EmptySet,
+   * EnumItem, EnumRange, Combine and BitmaskAttributeSet if the
+   * items are in range.
+   *
+   * @tparam S The type of the set.
+   */
+  template<class S>
+  struct AttributeSetBitmask
+  {
+    enum{
+      /** @brief True if the set can be represented as a bit mask. */
+      isBitmask=false
+    };
+    /** @brief The bit mask of the set. */
+    static const uint64_t value=0;
+  };
+
+  template<typename TA>
+  struct AttributeSetBitmask<EmptySet<TA> >
+  {
+    enum{ isBitmask=true };
+    static const uint64_t value=0;
+  };
+
+  template<typename TA, int item>
+  struct AttributeSetBitmask<EnumItem<TA,item> >
+  {
+    enum{ isBitmask= (item>=0 && item<64) };
+    static const uint64_t value= isBitmask ? uint64_t(1)<<(item&63) : 0;
+  };
+
+  template<typename TA, int from, int to>
+  struct AttributeSetBitmask<EnumRange<TA,from,to> >
+  {
+    enum{ isBitmask= (from>=0 && to<64) };
+    static const uint64_t value= !isBitmask || from>to ? 0 :
+      (to==63 ? ~uint64_t(0) : (uint64_t(1)<<((to+1)&63))-1)
+      & ~((uint64_t(1)<<(from&63))-1);
+  };
+
+  template<class TI1, class TI2, typename TA>
+  struct AttributeSetBitmask<Combine<TI1,TI2,TA> >
+  {
+    enum{ isBitmask= AttributeSetBitmask<TI1>::isBitmask &&
+          AttributeSetBitmask<TI2>::isBitmask };
+    static const uint64_t value= AttributeSetBitmask<TI1>::value |
+      AttributeSetBitmask<TI2>::value;
+  };
+
+  template<typename TA, uint64_t mask>
+  struct AttributeSetBitmask<BitmaskAttributeSet<TA,mask> >
+  {
+    enum{ isBitmask=true };
+    static const uint64_t value=mask;
+  };
+
+  /**
+   * @brief Get the fastest representation of a set of enumeration values.
+   *
+   * If the set can be represented by a bit mask (see AttributeSetBitmask)
+   * Type is the corresponding BitmaskAttributeSet, otherwise it is the
+   * set itself. Both contain exactly the same items.
+   *
+   * @tparam S The type of the set.
+   * @tparam TA The type the set holds.
+   */
+  template<class S, typename TA=typename S::Type>
+  struct BitmaskAttributeSetOf
+  {
+    /** @brief The type of the set to use for membership tests. */
+    typedef typename SelectType<AttributeSetBitmask<S>::isBitmask,
+                                BitmaskAttributeSet<TA,AttributeSetBitmask<S>::value>,
+                                S>::Type Type;
+  };
+
+#ifndef DOXYGEN
+  template<class S, typename TA, bool isBitmask=AttributeSetBitmask<S>::isBitmask>
+  struct BitmaskContains
+  {
+    static bool contains(const S& set, const TA& item)
+    {
+      return set.contains(item);
+    }
+  };
+
+  template<class S, typename TA>
+  struct BitmaskContains<S,TA,true>
+  {
+    static bool contains(const S&, const TA& item)
+    {
+      return BitmaskAttributeSet<TA,AttributeSetBitmask<S>::value>::contains(item);
+    }
+  };
+#endif
+
+  /**
+   * @brief Tests whether an item is contained in a set.
+   *
+   * If the set can be represented by a bit mask (see AttributeSetBitmask)
+   * the test is done using the bit mask, otherwise the contains method
+   * of the set is called.
+   * @param set The set to test.
+   * @param item The item to look for.
+   * @return True if the item is in the set.
+   */
+  template<class S, typename TA>
+  inline bool bitmaskContains(const S& set, const TA& item)
+  {
+    return BitmaskContains<S,TA>::contains(set, item);
+  }
+
   template<typename TA>
   inline bool EmptySet<TA>::contains(const Type& attribute)
   {
@@ -133,6 +287,23 @@ namespace Dune
     return os<<i;
   }
 
+  template<typename TA, uint64_t mask>
+  inline bool BitmaskAttributeSet<TA,mask>::contains(const Type& item)
+  {
+    return static_cast<uint64_t>(item)<maxItems &&
+      ((mask>>static_cast<uint64_t>(item)) & 1);
+  }
+
+  template<typename TA, uint64_t mask>
+  inline std::ostream& operator<<(std::ostream& os, const BitmaskAttributeSet<TA,mask>&)
+  {
+    os<<"{";
+    for(int i=0; i<64; ++i)
+      if((mask>>i) & 1)
+        os<<" "<<i;
+    return os<<" }";
+  }
+
   template<typename TA, int from, int to>
   inline bool EnumRange<TA,from,to>::contains(const Type& item)
   {
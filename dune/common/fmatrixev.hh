@@ -5,10 +5,14 @@
  * \brief Eigenvalue computations for the FieldMatrix class
  */
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <cassert>
+#include <limits>
 
+// for the Jacobi method of eigenValues() on DoubleDouble matrices
+#include <dune/common/doubledouble.hh>
 #include <dune/common/exceptions.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
@@ -125,6 +129,79 @@ static void eigenValues(const FieldMatrix<K, dim, dim>& matrix,
     }
   }
 }
+
+/** \brief calculates the eigenvalues of a symmetric field matrix in double-double precision
+    \param[in]  matrix matrix eigenvalues are calculated for
+    \param[out] eigenvalues FieldVector that contains eigenvalues in
+                ascending order
+
+    \note LAPACK cannot compute in DoubleDouble, so the cyclic Jacobi method
+    is used. It computes even eigenvalues that are tiny compared to the
+    norm of the matrix with a small relative error.
+*/
+template <int dim>
+static void eigenValues(const FieldMatrix<DoubleDouble, dim, dim>& matrix,
+                        FieldVector<DoubleDouble, dim>& eigenvalues)
+{
+  FieldMatrix<DoubleDouble, dim, dim> a(matrix);
+  const DoubleDouble eps = std::numeric_limits<DoubleDouble>::epsilon();
+  const DoubleDouble tolerance = eps * eps * a.frobenius_norm2();
+
+  for (int sweep = 0; sweep < 50; ++sweep)
+  {
+    DoubleDouble off = 0;
+    for (int p = 0; p < dim; ++p)
+      for (int q = p+1; q < dim; ++q)
+        off += a[p][q] * a[p][q];
+    if (off <= tolerance)
+      break;
+
+    for (int p = 0; p < dim; ++p)
+      for (int q = p+1; q < dim; ++q)
+      {
+        if (a[p][q] == 0)
+          continue;
+        // rotation annihilating a[p][q], with the smaller angle
+        const DoubleDouble theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+        DoubleDouble t = 1 / (std::abs(theta) + std::sqrt(theta * theta + 1));
+        if (theta < 0)
+          t = -t;
+        const DoubleDouble c = 1 / std::sqrt(t * t + 1);
+        const DoubleDouble s = t * c;
+        for (int k = 0; k < dim; ++k)
+        {
+          const DoubleDouble akp = a[k][p], akq = a[k][q];
+          a[k][p] = c * akp - s * akq;
+          a[k][q] = s * akp + c * akq;
+        }
+        for (int k = 0; k < dim; ++k)
+        {
+          const DoubleDouble apk = a[p][k], aqk = a[q][k];
+          a[p][k] = c * apk - s * aqk;
+          a[q][k] = s * apk + c * aqk;
+        }
+      }
+  }
+
+  for (int i = 0; i < dim; ++i)
+    eigenvalues[i] = a[i][i];
+  std::sort(eigenvalues.begin(), eigenvalues.end());
+}
+
+#ifndef DOXYGEN
+// resolve the ambiguity between the double-double and the 1x1 and 2x2 overloads
+inline void eigenValues(const FieldMatrix<DoubleDouble, 1, 1>& matrix,
+                        FieldVector<DoubleDouble, 1>& eigenvalues)
+{
+  eigenValues<DoubleDouble>(matrix, eigenvalues);
+}
+
+inline void eigenValues(const FieldMatrix<DoubleDouble, 2, 2>& matrix,
+                        FieldVector<DoubleDouble, 2>& eigenvalues)
+{
+  eigenValues<DoubleDouble>(matrix, eigenvalues);
+}
+#endif // DOXYGEN
 /** \brief calculates the eigenvalues of a symmetric field matrix 
     \param[in]  matrix matrix eigenvalues are calculated for 
     \param[out] eigenValues FieldVector that contains eigenvalues in 
@@ -40,6 +40,45 @@ struct FieldTraits< std::complex<T> >
     typedef T real_type;
 };
 
+/**
+   @addtogroup DenseMatVec
+   \brief Type traits to choose the type in which sums of a field are accumulated
+
+   The dot products and norms of DenseVector and the products and
+   substitutions of DenseMatrix add up their terms in these types. By
+   default the terms are added in the field itself. Specialize the traits
+   to store entries in a narrow type and accumulate in a wider one, e.g.
+
+   \code
+   namespace Dune {
+     template<>
+     struct AccumulationTraits<float>
+     {
+       typedef double accumulation_type;
+       typedef double real_accumulation_type;
+     };
+   }
+   \endcode
+
+   The specialization has to be visible wherever the kernels are used with
+   the field, so put it into a header included by all translation units.
+*/
+template<class T>
+struct AccumulationTraits
+{
+    //! export the type in which sums of the field are accumulated
+    typedef T accumulation_type;
+    //! export the type in which sums of the real type of the field are accumulated, e.g. for norms
+    typedef typename FieldTraits<T>::real_type real_accumulation_type;
+};
+
+template<class T>
+struct AccumulationTraits<const T>
+{
+    typedef typename AccumulationTraits<T>::accumulation_type accumulation_type;
+    typedef typename AccumulationTraits<T>::real_accumulation_type real_accumulation_type;
+};
+
 } // end namespace Dune
 
 #endif // DUNE_FTRAITS_HH
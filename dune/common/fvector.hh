@@ -399,4 +399,6 @@ representing a field and a compile-time given size.
 
 } // end namespace
 
+DUNE_DEFINE_HASH(DUNE_HASH_TEMPLATE_ARGS(class K, int SIZE),DUNE_HASH_TYPE(Dune::FieldVector<K,SIZE>))
+
 #endif
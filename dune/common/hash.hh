@@ -3,6 +3,11 @@
 #ifndef DUNE_COMMON_HASH_HH
 #define DUNE_COMMON_HASH_HH
 
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
 #if HAVE_STD_HASH
 #include <functional>
 #endif
@@ -34,7 +39,9 @@
  *
  * This file provides the functor Dune::hash to calculate hash values and
  * some infrastructure to simplify extending Dune::hash for user-defined types,
- * independent of the actual underlying implementation.
+ * independent of the actual underlying implementation. HashState and
+ * hash_sequence() provide a fast, well-distributed way to hash sequences of
+ * values, which the hashable vector types of dune-common use.
  *
  */
 
@@ -392,6 +399,176 @@ namespace Dune {
       }
   }
 
+#ifndef DOXYGEN
+  namespace Detail {
+
+    //! Multiplies a and b to 128 bits and folds the product to 64 bits.
+    inline uint64_t hashMultiplyFold(uint64_t a, uint64_t b)
+    {
+#ifdef __SIZEOF_INT128__
+      unsigned __int128 product = static_cast<unsigned __int128>(a)*b;
+      return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product>>64);
+#else
+      const uint64_t mask = 0xFFFFFFFFu;
+      uint64_t a0 = a&mask, a1 = a>>32, b0 = b&mask, b1 = b>>32;
+      uint64_t p00 = a0*b0, p01 = a0*b1, p10 = a1*b0, p11 = a1*b1;
+      uint64_t middle = (p00>>32) + (p01&mask) + (p10&mask);
+      uint64_t high = p11 + (p01>>32) + (p10>>32) + (middle>>32);
+      return ((middle<<32) | (p00&mask)) ^ high;
+#endif
+    }
+
+    // the constants of wyhash
+    const uint64_t hashSecret0 = 0xa0761d6478bd642full;
+    const uint64_t hashSecret1 = 0xe7037ed1a0b428dbull;
+    const uint64_t hashSecret2 = 0x8ebc6af09c88c6e3ull;
+
+    //! The bits of a floating point number, with all zeros mapped to the same word.
+    inline uint64_t floatingPointWord(double x)
+    {
+      if (x == 0)
+        return 0;
+      uint64_t word;
+      std::memcpy(&word, &x, sizeof(word));
+      return word;
+    }
+
+  } // end namespace Detail
+#endif // DOXYGEN
+
+  //! Incrementally hashes a sequence of values.
+  /**
+   * HashState is a fast, high-quality alternative to hash_combine(). Every
+   * value is turned into a 64 bit word and two words at a time are mixed into
+   * the state by a folded 128 bit multiplication, as in wyhash. Arithmetic
+   * values are used directly, floating point zeros of both signs yield the
+   * same hash, and all other types are hashed with Dune::hash first.
+   *
+   * The result does not depend on the platform except for the width of
+   * std::size_t.
+   *
+   * \note This class is only available if the macro `HAVE_DUNE_HASH` is defined.
+   */
+  class HashState
+  {
+  public:
+    //! Starts a new hash computation.
+    explicit HashState(uint64_t seed = 0)
+      : state_(seed ^ Detail::hashSecret0), pending_(0), count_(0)
+    {}
+
+    //! Adds a 64 bit word.
+    void addWord(uint64_t word)
+    {
+      if (count_ & 1)
+        state_ = Detail::hashMultiplyFold(pending_ ^ Detail::hashSecret1, word ^ state_);
+      else
+        pending_ = word;
+      ++count_;
+    }
+
+    //! Adds an object of a type hashable by Dune::hash.
+    template<typename T>
+    void add(const T& arg)
+    {
+      Dune::hash<T> hasher;
+      addWord(hasher(arg));
+    }
+
+    void add(bool arg) { addWord(arg); }
+    void add(char arg) { addWord(static_cast<uint64_t>(arg)); }
+    void add(signed char arg) { addWord(static_cast<uint64_t>(arg)); }
+    void add(unsigned char arg) { addWord(arg); }
+    void add(short arg) { addWord(static_cast<uint64_t>(arg)); }
+    void add(unsigned short arg) { addWord(arg); }
+    void add(int arg) { addWord(static_cast<uint64_t>(arg)); }
+    void add(unsigned int arg) { addWord(arg); }
+    void add(long arg) { addWord(static_cast<uint64_t>(arg)); }
+    void add(unsigned long arg) { addWord(arg); }
+    void add(long long arg) { addWord(static_cast<uint64_t>(arg)); }
+    void add(unsigned long long arg) { addWord(arg); }
+    void add(float arg) { addWord(Detail::floatingPointWord(arg)); }
+    void add(double arg) { addWord(Detail::floatingPointWord(arg)); }
+    //! long double is hashed with double precision, equal values still give equal hashes.
+    void add(long double arg) { addWord(Detail::floatingPointWord(static_cast<double>(arg))); }
+
+    //! Adds the real and the imaginary part.
+    template<typename K>
+    void add(const std::complex<K>& arg)
+    {
+      add(arg.real());
+      add(arg.imag());
+    }
+
+    //! Adds all objects in the range [first,last).
+    template<typename It>
+    void add(It first, It last)
+    {
+      for (; first != last; ++first)
+        add(*first);
+    }
+
+    //! Adds len bytes starting at data.
+    void addBytes(const void* data, std::size_t len)
+    {
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      for (; len >= 8; len -= 8, bytes += 8)
+        {
+          uint64_t word;
+          std::memcpy(&word, bytes, 8);
+          addWord(word);
+        }
+      if (len > 0)
+        {
+          // the tail is padded with zeros and tagged with its length
+          uint64_t word = 0;
+          std::memcpy(&word, bytes, len);
+          addWord(word ^ (uint64_t(len) << 56));
+        }
+    }
+
+    //! Returns the hash value of all objects added so far.
+    std::size_t value() const
+    {
+      uint64_t last = (count_ & 1) ? pending_ : 0;
+      uint64_t h = Detail::hashMultiplyFold(last ^ Detail::hashSecret1, state_ ^ count_);
+      return static_cast<std::size_t>(Detail::hashMultiplyFold(h ^ Detail::hashSecret0,
+                                                               count_ ^ Detail::hashSecret2));
+    }
+
+  private:
+    uint64_t state_;
+    uint64_t pending_;
+    uint64_t count_;
+  };
+
+  //! Hashes all elements in the range [first,last) with HashState.
+  /**
+   * Unlike hash_range(), this mixes the elements with a full-avalanche
+   * function and hashes arithmetic elements without calling Dune::hash.
+   * Use it for vectors of coordinates or indices.
+   *
+   * \note This function is only available if the macro `HAVE_DUNE_HASH` is defined.
+   */
+  template<typename It>
+  inline std::size_t hash_sequence(It first, It last)
+  {
+    HashState state;
+    state.add(first,last);
+    return state.value();
+  }
+
+  //! Hashes len bytes starting at data with HashState.
+  /**
+   * \note This function is only available if the macro `HAVE_DUNE_HASH` is defined.
+   */
+  inline std::size_t hash_bytes(const void* data, std::size_t len, uint64_t seed = 0)
+  {
+    HashState state(seed);
+    state.addBytes(data,len);
+    return state.value();
+  }
+
 } // end namespace Dune
 
 #endif // HAVE_DUNE_HASH || defined(DOXYGEN)
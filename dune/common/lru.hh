@@ -23,7 +23,8 @@ struct _lru_default_traits
 {
     typedef _Key key_type;
     typedef _Alloc allocator;
-    typedef std::list< std::pair<_Key, _Tp> > list_type;
+    typedef std::list< std::pair<_Key, _Tp>,
+                       typename allocator::template rebind<std::pair<_Key, _Tp> >::other > list_type;
     typedef typename list_type::iterator iterator;
     typedef typename std::less<key_type> cmp;
     typedef std::map< key_type, iterator, cmp, 
@@ -38,6 +39,8 @@ struct _lru_default_traits
     Implementatation of an LRU (least recently used) cache
     container. This implementation follows the approach presented in
     http://aim.adc.rmit.edu.au/phd/sgreuter/papers/graphite2003.pdf
+
+    For a hashed cache with a fixed capacity see LRUCache in lrucache.hh.
  */
 template <typename _Key, typename _Tp,
           typename _Traits = _lru_default_traits<_Key, _Tp> >
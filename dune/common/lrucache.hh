@@ -0,0 +1,595 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_LRUCACHE_HH
+#define DUNE_COMMON_LRUCACHE_HH
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/hash.hh>
+
+#if HAVE_STD_THREAD
+#include <mutex>
+#endif
+
+/** @file
+    @brief Bounded hash indexed LRU caches for memoisation.
+*/
+
+namespace Dune {
+
+  /**
+   * @brief Usage counters of an LRUCache.
+   */
+  struct LRUCacheStatistics
+  {
+    LRUCacheStatistics()
+      : hits(0), misses(0), evictions(0)
+    {}
+
+    /** @brief The number of lookups that found their key. */
+    std::size_t hits;
+    /** @brief The number of lookups that did not find their key. */
+    std::size_t misses;
+    /** @brief The number of entries dropped to make room for new ones. */
+    std::size_t evictions;
+
+    LRUCacheStatistics& operator+=(const LRUCacheStatistics& other)
+    {
+      hits += other.hits;
+      misses += other.misses;
+      evictions += other.evictions;
+      return *this;
+    }
+  };
+
+  inline std::ostream& operator<<(std::ostream& os, const LRUCacheStatistics& stats)
+  {
+    os<<"hits="<<stats.hits<<" misses="<<stats.misses<<" evictions="<<stats.evictions;
+    return os;
+  }
+
+#if HAVE_DUNE_HASH || defined(DOXYGEN)
+
+#ifndef DOXYGEN
+  namespace Detail
+  {
+    /** @brief Spread the bits of a hash value by Fibonacci hashing. */
+    inline uint64_t lruCacheMix(std::size_t h, uint64_t factor)
+    {
+      return static_cast<uint64_t>(h) * factor;
+    }
+  }
+#endif
+
+  /**
+   * @brief A bounded least recently used cache.
+   *
+   * In contrast to lru, the entries are located by hashing and the
+   * number of entries is bounded. Inserting into a full cache evicts
+   * the least recently used entry. All nodes are allocated when the
+   * cache is constructed; the recency list and the hash chains link
+   * them by index, so neither lookups nor insertions allocate memory.
+   *
+   * The cache counts hits, misses and evictions, see statistics().
+   * It is not thread-safe, see ShardedLRUCache for concurrent use.
+   *
+   * \code
+   * LRUCache<int, LocalBasis> cache(64);
+   * const LocalBasis& basis = cache.findOrInsert(type, makeLocalBasis);
+   * \endcode
+   *
+   * @tparam Key The type of the keys, has to be equality comparable.
+   * @tparam T The type of the cached values, has to be copyable.
+   * @tparam Hash The hash functor for the keys.
+   * @tparam Alloc The allocator for the entries.
+   */
+  template<class Key, class T, class Hash = hash<Key>,
+           class Alloc = std::allocator<std::pair<const Key,T> > >
+  class LRUCache
+  {
+  public:
+    /** @brief The type of the keys. */
+    typedef Key key_type;
+    /** @brief The type of the cached values. */
+    typedef T mapped_type;
+    /** @brief The type of the entries. */
+    typedef std::pair<const Key,T> value_type;
+    /** @brief The size type. */
+    typedef std::size_t size_type;
+    /** @brief The hash functor. */
+    typedef Hash hasher;
+    /** @brief The allocator type. */
+    typedef Alloc allocator_type;
+
+    /**
+     * @brief Create an empty cache.
+     * @param capacity The maximum number of entries, at least one.
+     * @param hash The hash functor.
+     * @param allocator The allocator for the entries.
+     */
+    explicit LRUCache(size_type capacity, const Hash& hash = Hash(),
+                      const Alloc& allocator = Alloc())
+      : hash_(hash), allocator_(allocator), links_(capacity),
+        head_(npos), tail_(npos), free_(0), size_(0)
+    {
+      if(capacity==0)
+        DUNE_THROW(RangeError, "The capacity of an LRUCache has to be positive!");
+      // at most half of the buckets are used
+      bucketBits_ = 1;
+      while((size_type(1)<<bucketBits_) < 2*capacity)
+        ++bucketBits_;
+      buckets_.assign(size_type(1)<<bucketBits_, npos);
+      for(size_type i=0; i<capacity; ++i)
+        links_[i].next = i+1<capacity ? i+1 : npos;
+      entries_ = allocator_.allocate(capacity);
+    }
+
+    ~LRUCache()
+    {
+      clear();
+      allocator_.deallocate(entries_, capacity());
+    }
+
+    /**
+     * @brief Look up the value of a key.
+     *
+     * Counts a hit or a miss. A found entry becomes the most recently used.
+     * @return A pointer to the value or null if the key is not cached.
+     */
+    T* find(const Key& key)
+    {
+      std::size_t h = hash_(key);
+      size_type i = locate(key, h);
+      if(i==npos){
+        ++statistics_.misses;
+        return 0;
+      }
+      ++statistics_.hits;
+      moveToFront(i);
+      return &entries_[i].second;
+    }
+
+    /**
+     * @brief Look up the value of a key, computing it on a miss.
+     *
+     * Counts a hit or a miss. On a miss the value is computed by
+     * f(key) and inserted. Either way the entry becomes the most
+     * recently used.
+     * @return The cached value, valid until the entry is evicted.
+     */
+    template<class F>
+    T& findOrInsert(const Key& key, F f)
+    {
+      std::size_t h = hash_(key);
+      size_type i = locate(key, h);
+      if(i!=npos){
+        ++statistics_.hits;
+        moveToFront(i);
+        return entries_[i].second;
+      }
+      ++statistics_.misses;
+      return entries_[insertNew(key, f(key), h)].second;
+    }
+
+    /**
+     * @brief Store a value, replacing the one cached for the key.
+     *
+     * The entry becomes the most recently used. If the cache is full
+     * the least recently used entry is evicted. Neither a hit nor a
+     * miss is counted.
+     * @return The cached value, valid until the entry is evicted.
+     */
+    T& insert(const Key& key, const T& value)
+    {
+      std::size_t h = hash_(key);
+      size_type i = locate(key, h);
+      if(i!=npos){
+        entries_[i].second = value;
+        moveToFront(i);
+        return entries_[i].second;
+      }
+      return entries_[insertNew(key, value, h)].second;
+    }
+
+    /**
+     * @brief Remove the entry of a key.
+     * @return Whether the key was cached.
+     */
+    bool erase(const Key& key)
+    {
+      size_type i = locate(key, hash_(key));
+      if(i==npos)
+        return false;
+      release(i);
+      return true;
+    }
+
+    /** @brief Remove all entries. The statistics are kept. */
+    void clear()
+    {
+      while(tail_!=npos)
+        release(tail_);
+    }
+
+    /** @brief The most recently used entry. The cache must not be empty. */
+    value_type& front()
+    {
+      return entries_[head_];
+    }
+
+    /** @brief The least recently used entry. The cache must not be empty. */
+    value_type& back()
+    {
+      return entries_[tail_];
+    }
+
+    /** @brief The number of entries. */
+    size_type size() const
+    {
+      return size_;
+    }
+
+    /** @brief The maximum number of entries. */
+    size_type capacity() const
+    {
+      return links_.size();
+    }
+
+    /** @brief The usage counters. */
+    const LRUCacheStatistics& statistics() const
+    {
+      return statistics_;
+    }
+
+    /** @brief Set the usage counters to zero. */
+    void resetStatistics()
+    {
+      statistics_ = LRUCacheStatistics();
+    }
+
+  private:
+    // Prevent copying
+    LRUCache(const LRUCache&);
+    LRUCache& operator=(const LRUCache&);
+
+    static const size_type npos = size_type(-1);
+
+    /** @brief The links of an entry. */
+    struct Link
+    {
+      /** @brief The more recently used entry, or the next free one. */
+      size_type prev;
+      /** @brief The less recently used entry, or the next free one. */
+      size_type next;
+      /** @brief The next entry in the same bucket. */
+      size_type chain;
+      /** @brief The hash value of the key. */
+      std::size_t hash;
+    };
+
+    typedef typename Alloc::template rebind<Link>::other LinkAllocator;
+    typedef typename Alloc::template rebind<size_type>::other BucketAllocator;
+
+    size_type bucket(std::size_t h) const
+    {
+      return static_cast<size_type>(Detail::lruCacheMix(h, 0x9E3779B97F4A7C15ull) >> (64-bucketBits_));
+    }
+
+    size_type locate(const Key& key, std::size_t h) const
+    {
+      for(size_type i=buckets_[bucket(h)]; i!=npos; i=links_[i].chain)
+        if(links_[i].hash==h && entries_[i].first==key)
+          return i;
+      return npos;
+    }
+
+    void unlink(size_type i)
+    {
+      Link& link = links_[i];
+      if(link.prev!=npos)
+        links_[link.prev].next = link.next;
+      else
+        head_ = link.next;
+      if(link.next!=npos)
+        links_[link.next].prev = link.prev;
+      else
+        tail_ = link.prev;
+    }
+
+    void pushFront(size_type i)
+    {
+      links_[i].prev = npos;
+      links_[i].next = head_;
+      if(head_!=npos)
+        links_[head_].prev = i;
+      else
+        tail_ = i;
+      head_ = i;
+    }
+
+    void moveToFront(size_type i)
+    {
+      if(i!=head_){
+        unlink(i);
+        pushFront(i);
+      }
+    }
+
+    /** @brief Destroy an entry and put its node on the free list. */
+    void release(size_type i)
+    {
+      size_type* chain = &buckets_[bucket(links_[i].hash)];
+      while(*chain!=i)
+        chain = &links_[*chain].chain;
+      *chain = links_[i].chain;
+      unlink(i);
+      allocator_.destroy(entries_+i);
+      links_[i].next = free_;
+      free_ = i;
+      --size_;
+    }
+
+    /** @brief Insert a key that is not cached yet. */
+    size_type insertNew(const Key& key, const T& value, std::size_t h)
+    {
+      if(free_==npos){
+        release(tail_);
+        ++statistics_.evictions;
+      }
+      size_type i = free_;
+      allocator_.construct(entries_+i, value_type(key, value));
+      free_ = links_[i].next;
+      size_type& first = buckets_[bucket(h)];
+      links_[i].chain = first;
+      links_[i].hash = h;
+      first = i;
+      pushFront(i);
+      ++size_;
+      return i;
+    }
+
+    Hash hash_;
+    Alloc allocator_;
+    /** @brief The storage of the entries. */
+    value_type* entries_;
+    /** @brief The links of the entries, parallel to entries_. */
+    std::vector<Link, LinkAllocator> links_;
+    /** @brief The first entry of each hash chain. */
+    std::vector<size_type, BucketAllocator> buckets_;
+    /** @brief The base two logarithm of the number of buckets. */
+    int bucketBits_;
+    /** @brief The most recently used entry. */
+    size_type head_;
+    /** @brief The least recently used entry. */
+    size_type tail_;
+    /** @brief The first unused node. */
+    size_type free_;
+    size_type size_;
+    LRUCacheStatistics statistics_;
+  };
+
+  template<class Key, class T, class Hash, class Alloc>
+  const typename LRUCache<Key,T,Hash,Alloc>::size_type LRUCache<Key,T,Hash,Alloc>::npos;
+
+#if HAVE_STD_THREAD || defined(DOXYGEN)
+  /**
+   * @brief A thread-safe LRU cache made of independently locked shards.
+   *
+   * Each key belongs to one of several LRUCache shards, chosen by its
+   * hash value. Every shard has its own mutex, so threads only contend
+   * if they access the same shard at the same time. Each shard evicts
+   * on its own, hence the least recently used entry of the whole cache
+   * is not necessarily the one evicted.
+   *
+   * As entries might be evicted by other threads at any time, values
+   * are returned by copy.
+   *
+   * \note Only available if the compiler supports std::thread (HAVE_STD_THREAD).
+   *
+   * @tparam Key The type of the keys, has to be equality comparable.
+   * @tparam T The type of the cached values, has to be copyable.
+   * @tparam Hash The hash functor for the keys.
+   * @tparam Alloc The allocator for the entries.
+   */
+  template<class Key, class T, class Hash = hash<Key>,
+           class Alloc = std::allocator<std::pair<const Key,T> > >
+  class ShardedLRUCache
+  {
+  public:
+    /** @brief The type of a shard. */
+    typedef LRUCache<Key,T,Hash,Alloc> Shard;
+    /** @brief The type of the keys. */
+    typedef Key key_type;
+    /** @brief The type of the cached values. */
+    typedef T mapped_type;
+    /** @brief The size type. */
+    typedef std::size_t size_type;
+
+    /**
+     * @brief Create an empty cache.
+     * @param capacity The maximum number of entries. It is divided
+     * evenly among the shards, rounding up.
+     * @param shards The number of shards.
+     * @param hash The hash functor.
+     * @param allocator The allocator for the entries.
+     */
+    explicit ShardedLRUCache(size_type capacity, size_type shards = 16,
+                             const Hash& hash = Hash(), const Alloc& allocator = Alloc())
+      : hash_(hash), shards_(shards)
+    {
+      if(shards==0)
+        DUNE_THROW(RangeError, "A ShardedLRUCache needs at least one shard!");
+      size_type shardCapacity = (capacity+shards-1)/shards;
+      try{
+        for(size_type i=0; i<shards; ++i)
+          shards_[i].cache = new Shard(shardCapacity, hash, allocator);
+      }catch(...){
+        // the destructor does not run, the shards not created yet are 0
+        for(size_type i=0; i<shards; ++i)
+          delete shards_[i].cache;
+        throw;
+      }
+    }
+
+    ~ShardedLRUCache()
+    {
+      for(size_type i=0; i<shards_.size(); ++i)
+        delete shards_[i].cache;
+    }
+
+    /**
+     * @brief Look up the value of a key.
+     * @param key The key.
+     * @param value Set to the cached value if the key is found.
+     * @return Whether the key was found.
+     */
+    bool find(const Key& key, T& value)
+    {
+      Locked shard = lock(key);
+      T* cached = shard.cache.find(key);
+      if(cached)
+        value = *cached;
+      return cached!=0;
+    }
+
+    /**
+     * @brief Look up the value of a key, computing it on a miss.
+     *
+     * The value is computed by f(key) without holding the lock, so
+     * concurrent misses for the same key might compute it more than
+     * once. Each lookup counts as one hit or miss.
+     * @return A copy of the cached value.
+     */
+    template<class F>
+    T findOrInsert(const Key& key, F f)
+    {
+      {
+        Locked shard = lock(key);
+        T* cached = shard.cache.find(key);
+        if(cached)
+          return *cached;
+      }
+      T value = f(key);
+      Locked shard = lock(key);
+      shard.cache.insert(key, value);
+      return value;
+    }
+
+    /** @brief Store a value, replacing the one cached for the key. */
+    void insert(const Key& key, const T& value)
+    {
+      Locked shard = lock(key);
+      shard.cache.insert(key, value);
+    }
+
+    /**
+     * @brief Remove the entry of a key.
+     * @return Whether the key was cached.
+     */
+    bool erase(const Key& key)
+    {
+      Locked shard = lock(key);
+      return shard.cache.erase(key);
+    }
+
+    /** @brief Remove all entries. The statistics are kept. */
+    void clear()
+    {
+      for(size_type i=0; i<shards_.size(); ++i){
+        std::lock_guard<std::mutex> guard(shards_[i].mutex);
+        shards_[i].cache->clear();
+      }
+    }
+
+    /** @brief The number of entries. */
+    size_type size() const
+    {
+      size_type n=0;
+      for(size_type i=0; i<shards_.size(); ++i){
+        std::lock_guard<std::mutex> guard(shards_[i].mutex);
+        n += shards_[i].cache->size();
+      }
+      return n;
+    }
+
+    /** @brief The maximum number of entries. */
+    size_type capacity() const
+    {
+      return shards_.size()*shards_[0].cache->capacity();
+    }
+
+    /** @brief The number of shards. */
+    size_type shards() const
+    {
+      return shards_.size();
+    }
+
+    /** @brief The usage counters summed over all shards. */
+    LRUCacheStatistics statistics() const
+    {
+      LRUCacheStatistics stats;
+      for(size_type i=0; i<shards_.size(); ++i){
+        std::lock_guard<std::mutex> guard(shards_[i].mutex);
+        stats += shards_[i].cache->statistics();
+      }
+      return stats;
+    }
+
+    /** @brief Set the usage counters to zero. */
+    void resetStatistics()
+    {
+      for(size_type i=0; i<shards_.size(); ++i){
+        std::lock_guard<std::mutex> guard(shards_[i].mutex);
+        shards_[i].cache->resetStatistics();
+      }
+    }
+
+  private:
+    // Prevent copying
+    ShardedLRUCache(const ShardedLRUCache&);
+    ShardedLRUCache& operator=(const ShardedLRUCache&);
+
+    /** @brief A shard with its mutex. */
+    struct Entry
+    {
+      Entry() : cache(0)
+      {}
+
+      mutable std::mutex mutex;
+      Shard* cache;
+    };
+
+    /** @brief A locked shard. */
+    struct Locked
+    {
+      explicit Locked(Entry& entry)
+        : guard(entry.mutex), cache(*entry.cache)
+      {}
+
+      std::unique_lock<std::mutex> guard;
+      Shard& cache;
+    };
+
+    Locked lock(const Key& key)
+    {
+      // Use other bits than the buckets of the shard.
+      uint64_t h = Detail::lruCacheMix(hash_(key), 0xC2B2AE3D27D4EB4Full);
+      return Locked(shards_[static_cast<size_type>((h>>32) % shards_.size())]);
+    }
+
+    Hash hash_;
+    std::vector<Entry> shards_;
+  };
+#endif // HAVE_STD_THREAD
+
+#endif // HAVE_DUNE_HASH
+
+} // namespace Dune
+
+#endif // DUNE_COMMON_LRUCACHE_HH
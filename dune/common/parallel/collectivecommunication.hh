@@ -88,6 +88,10 @@ namespace Dune
 
 	/** @brief  Compute the sum of the argument over all processes and 
 		return the result in every process. Assumes that T has an operator+
+
+		The order of the additions depends on the number of processes, so
+		floating point sums may differ in the last bits. Sum ReproducibleSum
+		accumulators for results that do not.
 	*/
 	template<typename T>
 	T sum (T& in) const // MPI does not know about const :-(
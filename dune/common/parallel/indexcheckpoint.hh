@@ -0,0 +1,418 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_INDEXCHECKPOINT_HH
+#define DUNE_INDEXCHECKPOINT_HH
+
+#if HAVE_MPI
+
+#include <cstddef>
+#include <string>
+#include <time.h>
+#include <vector>
+
+#include <mpi.h>
+
+#include <dune/common/binaryio.hh>
+#include <dune/common/exceptions.hh>
+
+#include "indexset.hh"
+#include "indexsetio.hh"
+#include "interface.hh"
+#include "remoteindices.hh"
+
+namespace Dune
+{
+  /** @addtogroup Common_Parallel
+   *
+   * @{
+   */
+  /**
+   * @file
+   * @brief Checkpoints of index sets, remote indices and interfaces.
+   *
+   * Setting up the parallel index information, i.e. filling the
+   * ParallelIndexSet, RemoteIndices::rebuild() and Interface::build(),
+   * communicates with all processes and is expensive at scale. A
+   * checkpoint stores the result in one binary file per process, from
+   * which a restarted run with the same number of processes
+   * reconstructs the objects without communication:
+   *
+   * \code
+   * // after the set up
+   * writeIndexCheckpoint("indices", remoteIndices, interface);
+   * ...
+   * // on restart, instead of the set up
+   * ParallelIndexSet<int,ParallelLocalIndex<Flags> > indexSet;
+   * RemoteIndices<ParallelIndexSet<int,ParallelLocalIndex<Flags> > > remoteIndices;
+   * Interface interface;
+   * readIndexCheckpoint("indices", indexSet, remoteIndices, interface, MPI_COMM_WORLD);
+   * \endcode
+   */
+
+#ifndef DOXYGEN
+  namespace Detail {
+
+    // appends the positions of the local index pairs in indexSet and the
+    // remote attributes of the remote indices in list
+    template<class I, class L>
+    void remoteIndexPositions(const I& indexSet, const L& list, std::vector<uint64_t>& positions,
+                              std::vector<signed char>& attributes)
+    {
+      typename I::const_iterator pair = indexSet.begin();
+      const typename I::const_iterator end = indexSet.end();
+      uint64_t position = 0;
+      // both are sorted by the global index
+      for (typename L::const_iterator remote = list.begin(); remote != list.end(); ++remote)
+      {
+        while (pair != end && &*pair != &remote->localIndexPair())
+        {
+          ++pair;
+          ++position;
+        }
+        if (pair == end)
+          DUNE_THROW(InvalidStateException, "The remote indices do not refer to their index set in order");
+        positions.push_back(position);
+        attributes.push_back(remote->attribute());
+      }
+    }
+
+    template<class I, class L>
+    void writeRemoteIndexLists(BinaryWriter& writer, const std::string& name, const I& indexSet,
+                               const std::vector<const L*>& lists)
+    {
+      std::vector<uint64_t> offsets(1, 0), positions;
+      std::vector<signed char> attributes;
+      for (std::size_t i = 0; i < lists.size(); ++i)
+      {
+        if (lists[i])
+          remoteIndexPositions(indexSet, *lists[i], positions, attributes);
+        offsets.push_back(positions.size());
+      }
+      writer.write(name + "/offsets", offsets);
+      writer.write(name + "/positions", positions);
+      writer.write(name + "/attributes", attributes);
+    }
+
+    // fills list with the i-th list written by writeRemoteIndexLists
+    template<class I, class L>
+    void readRemoteIndexList(const BinaryReader& reader, const std::string& name, const I& indexSet,
+                             std::size_t i, L& list)
+    {
+      typedef typename L::MemberType RemoteIndex;
+      typedef typename RemoteIndex::Attribute Attribute;
+      const BinaryArrayView<uint64_t> offsets = reader.array<uint64_t>(name + "/offsets");
+      const BinaryArrayView<uint64_t> positions = reader.array<uint64_t>(name + "/positions");
+      const BinaryArrayView<signed char> attributes = reader.array<signed char>(name + "/attributes");
+      if (i+1 >= offsets.size() || offsets[i] > offsets[i+1] || offsets[i+1] > positions.size()
+          || attributes.size() != positions.size())
+        DUNE_THROW(IOError, "The remote indices " << name << " in " << reader.filename() << " are inconsistent");
+      const typename I::const_iterator begin = indexSet.begin();
+      for (uint64_t k = offsets[i]; k < offsets[i+1]; ++k)
+      {
+        if (positions[k] >= indexSet.size())
+          DUNE_THROW(IOError, "The remote indices " << name << " in " << reader.filename()
+                     << " do not match the index set");
+        list.push_back(RemoteIndex(Attribute(attributes[k]), &*(begin + positions[k])));
+      }
+    }
+
+  } // end namespace Detail
+#endif // DOXYGEN
+
+  /**
+   * @brief Writes remote indices to a binary file.
+   *
+   * The remote index lists are stored as the positions of their local
+   * index pairs in the index sets, so they can only be read together
+   * with the index sets they refer to, see writeIndexSet().
+   */
+  template<class T, class A>
+  void writeRemoteIndices(BinaryWriter& writer, const std::string& name, const RemoteIndices<T,A>& remoteIndices)
+  {
+    typedef typename RemoteIndices<T,A>::RemoteIndexList RemoteIndexList;
+    typedef typename RemoteIndices<T,A>::const_iterator Iterator;
+    if (!remoteIndices.isSynced())
+      DUNE_THROW(InvalidStateException, "The remote indices are not in sync with the index sets");
+
+    std::vector<int> processes, neighbours(remoteIndices.getNeighbours().begin(), remoteIndices.getNeighbours().end());
+    std::vector<unsigned char> shared;
+    std::vector<const RemoteIndexList*> send, receive;
+    for (Iterator process = remoteIndices.begin(); process != remoteIndices.end(); ++process)
+    {
+      processes.push_back(process->first);
+      shared.push_back(process->second.first == process->second.second);
+      send.push_back(process->second.first);
+      // shared lists are written once
+      receive.push_back(shared.back() ? 0 : process->second.second);
+    }
+    std::vector<int> settings(2);
+    settings[0] = remoteIndices.publicIgnored;
+    settings[1] = remoteIndices.includeSelf;
+    writer.write(name + "/settings", settings);
+    writer.write(name + "/neighbours", neighbours);
+    writer.write(name + "/processes", processes);
+    writer.write(name + "/shared", shared);
+    Detail::writeRemoteIndexLists(writer, name + "/send", remoteIndices.sourceIndexSet(), send);
+    Detail::writeRemoteIndexLists(writer, name + "/receive", remoteIndices.destinationIndexSet(), receive);
+  }
+
+  /**
+   * @brief Reads remote indices written by writeRemoteIndices().
+   *
+   * The index sets of remoteIndices have to be set, see
+   * RemoteIndices::setIndexSets(), to the index sets read from the
+   * same file. The remote indices are replaced and in sync with the
+   * index sets afterwards, without any communication.
+   */
+  template<class T, class A>
+  void readRemoteIndices(const BinaryReader& reader, const std::string& name, RemoteIndices<T,A>& remoteIndices)
+  {
+    typedef typename RemoteIndices<T,A>::RemoteIndexList RemoteIndexList;
+    const BinaryArrayView<int> settings = reader.array<int>(name + "/settings");
+    const BinaryArrayView<int> neighbours = reader.array<int>(name + "/neighbours");
+    const BinaryArrayView<int> processes = reader.array<int>(name + "/processes");
+    const BinaryArrayView<unsigned char> shared = reader.array<unsigned char>(name + "/shared");
+    if (settings.size() != 2 || shared.size() != processes.size())
+      DUNE_THROW(IOError, "The remote indices " << name << " in " << reader.filename() << " are inconsistent");
+
+    remoteIndices.free();
+    remoteIndices.setNeighbours(neighbours);
+    for (std::size_t i = 0; i < processes.size(); ++i)
+    {
+      RemoteIndexList* send = new RemoteIndexList();
+      RemoteIndexList* receive = send;
+      remoteIndices.remoteIndices_.insert(std::make_pair(processes[i], std::make_pair(send, receive)));
+      if (!shared[i])
+      {
+        receive = new RemoteIndexList();
+        remoteIndices.remoteIndices_[processes[i]].second = receive;
+      }
+      Detail::readRemoteIndexList(reader, name + "/send", remoteIndices.sourceIndexSet(), i, *send);
+      if (!shared[i])
+        Detail::readRemoteIndexList(reader, name + "/receive", remoteIndices.destinationIndexSet(), i, *receive);
+    }
+    remoteIndices.publicIgnored = settings[0];
+    remoteIndices.includeSelf = settings[1];
+    remoteIndices.sourceSeqNo_ = remoteIndices.source_->seqNo();
+    remoteIndices.destSeqNo_ = remoteIndices.target_->seqNo();
+    remoteIndices.firstBuild = false;
+  }
+
+  /**
+   * @brief Writes a communication interface to a binary file.
+   */
+  inline void writeInterface(BinaryWriter& writer, const std::string& name, const Interface& interface)
+  {
+    typedef Interface::InformationMap::const_iterator Iterator;
+    std::vector<int> processes;
+    std::vector<uint64_t> sendOffsets(1, 0), receiveOffsets(1, 0), send, receive;
+    for (Iterator process = interface.interfaces().begin(); process != interface.interfaces().end(); ++process)
+    {
+      processes.push_back(process->first);
+      for (std::size_t i = 0; i < process->second.first.size(); ++i)
+        send.push_back(process->second.first[i]);
+      for (std::size_t i = 0; i < process->second.second.size(); ++i)
+        receive.push_back(process->second.second[i]);
+      sendOffsets.push_back(send.size());
+      receiveOffsets.push_back(receive.size());
+    }
+    writer.write(name + "/processes", processes);
+    writer.write(name + "/send/offsets", sendOffsets);
+    writer.write(name + "/send/indices", send);
+    writer.write(name + "/receive/offsets", receiveOffsets);
+    writer.write(name + "/receive/indices", receive);
+  }
+
+  /**
+   * @brief Reads a communication interface written by writeInterface().
+   *
+   * The interface is replaced and uses the communicator comm.
+   */
+  inline void readInterface(const BinaryReader& reader, const std::string& name, Interface& interface, MPI_Comm comm)
+  {
+    const BinaryArrayView<int> processes = reader.array<int>(name + "/processes");
+    const BinaryArrayView<uint64_t> sendOffsets = reader.array<uint64_t>(name + "/send/offsets");
+    const BinaryArrayView<uint64_t> send = reader.array<uint64_t>(name + "/send/indices");
+    const BinaryArrayView<uint64_t> receiveOffsets = reader.array<uint64_t>(name + "/receive/offsets");
+    const BinaryArrayView<uint64_t> receive = reader.array<uint64_t>(name + "/receive/indices");
+    if (sendOffsets.size() != processes.size()+1 || receiveOffsets.size() != processes.size()+1
+        || sendOffsets[processes.size()] != send.size() || receiveOffsets[processes.size()] != receive.size())
+      DUNE_THROW(IOError, "The interface " << name << " in " << reader.filename() << " is inconsistent");
+
+    interface.free();
+    interface.communicator_ = comm;
+    for (std::size_t i = 0; i < processes.size(); ++i)
+    {
+      if (sendOffsets[i] > sendOffsets[i+1] || receiveOffsets[i] > receiveOffsets[i+1])
+        DUNE_THROW(IOError, "The interface " << name << " in " << reader.filename() << " is inconsistent");
+      std::pair<InterfaceInformation,InterfaceInformation>& information = interface.interfaces()[processes[i]];
+      information.first.reserve(sendOffsets[i+1] - sendOffsets[i]);
+      for (uint64_t k = sendOffsets[i]; k < sendOffsets[i+1]; ++k)
+        information.first.add(send[k]);
+      information.second.reserve(receiveOffsets[i+1] - receiveOffsets[i]);
+      for (uint64_t k = receiveOffsets[i]; k < receiveOffsets[i+1]; ++k)
+        information.second.add(receive[k]);
+    }
+  }
+
+  /**
+   * @brief Writes a checkpoint of the index sets, the remote indices and an interface.
+   *
+   * This is a collective operation of the processes of the communicator
+   * of remoteIndices. Every process writes binaryRankFile(basename, rank),
+   * marked with an identifier common to all processes of this checkpoint.
+   * If a process fails, it rethrows its exception and the other
+   * processes throw an IOError.
+   */
+  template<class T, class A>
+  void writeIndexCheckpoint(const std::string& basename, const RemoteIndices<T,A>& remoteIndices,
+                            const Interface& interface)
+  {
+    MPI_Comm comm = remoteIndices.communicator();
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    long long identity[3] = { 0, rank, size };
+    if (rank == 0)
+    {
+      timespec now;
+      clock_gettime(CLOCK_REALTIME, &now);
+      identity[0] = now.tv_sec*1000000000LL + now.tv_nsec;
+    }
+    MPI_Bcast(identity, 1, MPI_LONG_LONG, 0, comm);
+
+    // a process that fails still takes part in the reduction, so that
+    // the others do not wait for it forever
+    const bool twoSets = &remoteIndices.sourceIndexSet() != &remoteIndices.destinationIndexSet();
+    int failed = 0, anyFailed;
+    try
+    {
+      BinaryWriter writer(binaryRankFile(basename, rank));
+      writer.write("checkpoint", identity, 3);
+      writeIndexSet(writer, "source", remoteIndices.sourceIndexSet());
+      if (twoSets)
+        writeIndexSet(writer, "destination", remoteIndices.destinationIndexSet());
+      writeRemoteIndices(writer, "remote", remoteIndices);
+      writeInterface(writer, "interface", interface);
+      writer.close();
+    }
+    catch (...)
+    {
+      failed = 1;
+      MPI_Allreduce(&failed, &anyFailed, 1, MPI_INT, MPI_MAX, comm);
+      throw;
+    }
+    MPI_Allreduce(&failed, &anyFailed, 1, MPI_INT, MPI_MAX, comm);
+    if (anyFailed)
+      DUNE_THROW(IOError, "The checkpoint " << basename << " could not be written by all processes");
+  }
+
+#ifndef DOXYGEN
+  namespace Detail {
+
+    // checks that all processes of comm read the files of one checkpoint
+    // written by the same number of processes
+    inline void checkIndexCheckpoint(const BinaryReader* reader, std::string error, MPI_Comm comm)
+    {
+      int rank, size;
+      MPI_Comm_rank(comm, &rank);
+      MPI_Comm_size(comm, &size);
+      long long check[3] = { 1, 0, 0 };
+      if (reader)
+      {
+        try
+        {
+          const BinaryArrayView<long long> identity = reader->array<long long>("checkpoint");
+          if (identity.size() == 3 && identity[1] == rank && identity[2] == size)
+          {
+            check[0] = 0;
+            check[1] = identity[0];
+            check[2] = -identity[0];
+          }
+          else
+            error = reader->filename() + " was not written by this process";
+        }
+        catch (const Exception& e)
+        {
+          error = e.what();
+        }
+      }
+      long long global[3];
+      MPI_Allreduce(check, global, 3, MPI_LONG_LONG, MPI_MAX, comm);
+      if (check[0])
+        DUNE_THROW(IOError, error);
+      if (global[0])
+        DUNE_THROW(IOError, "The checkpoint could not be read by all processes");
+      if (global[1] != -global[2])
+        DUNE_THROW(IOError, "The files " << reader->filename() << " and of other processes belong to different checkpoints");
+    }
+
+  } // end namespace Detail
+#endif // DOXYGEN
+
+  /**
+   * @brief Reads a checkpoint written by writeIndexCheckpoint() with one index set.
+   *
+   * This is a collective operation of the processes of comm, whose number
+   * has to be the one of the processes that wrote the checkpoint. Besides
+   * a consistency check of the files of all processes, it does not
+   * communicate. indexSet has to be empty, remoteIndices and interface
+   * are replaced.
+   */
+  template<class T, class A>
+  void readIndexCheckpoint(const std::string& basename, T& indexSet, RemoteIndices<T,A>& remoteIndices,
+                           Interface& interface, MPI_Comm comm)
+  {
+    readIndexCheckpoint(basename, indexSet, indexSet, remoteIndices, interface, comm);
+  }
+
+  /**
+   * @brief Reads a checkpoint written by writeIndexCheckpoint() with two index sets.
+   *
+   * If the checkpoint was written with one index set, destination is
+   * not touched and source is used on both sides.
+   */
+  template<class T, class A>
+  void readIndexCheckpoint(const std::string& basename, T& source, T& destination,
+                           RemoteIndices<T,A>& remoteIndices, Interface& interface, MPI_Comm comm)
+  {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    // the other processes must not wait for a process that failed to open its file
+    BinaryReader* reader = 0;
+    std::string error;
+    try
+    {
+      reader = new BinaryReader(binaryRankFile(basename, rank));
+    }
+    catch (const Exception& e)
+    {
+      error = e.what();
+    }
+    try
+    {
+      Detail::checkIndexCheckpoint(reader, error, comm);
+      readIndexSet(*reader, "source", source);
+      const bool twoSets = reader->contains("destination/global");
+      if (twoSets && &source == &destination)
+        DUNE_THROW(IOError, reader->filename() << " holds two index sets, but only one was given");
+      if (twoSets)
+        readIndexSet(*reader, "destination", destination);
+      remoteIndices.setIndexSets(source, twoSets ? destination : source, comm);
+      readRemoteIndices(*reader, "remote", remoteIndices);
+      readInterface(*reader, "interface", interface, comm);
+    }
+    catch (...)
+    {
+      delete reader;
+      throw;
+    }
+    delete reader;
+  }
+
+  /** @} */
+} // end namespace Dune
+
+#endif // HAVE_MPI
+
+#endif // DUNE_INDEXCHECKPOINT_HH
@@ -5,6 +5,7 @@
 #include<algorithm>
 #include<dune/common/arraylist.hh>
 #include<dune/common/exceptions.hh>
+#include<dune/common/hash.hh>
 #include<iostream>
 
 #include"localindex.hh"
@@ -163,6 +164,23 @@ namespace Dune
      * @param index The index to set it to.
      */
     inline void setLocal(int index);
+
+#if HAVE_DUNE_HASH
+
+    /**
+     * @brief Hash the global index.
+     *
+     * Like the comparison operators this ignores the local index.
+     */
+    inline friend std::size_t hash_value(const IndexPair& pair)
+    {
+      HashState state;
+      state.add(pair.global_);
+      return state.value();
+    }
+
+#endif // HAVE_DUNE_HASH
+
   private:
     /** @brief The global index. */
     GlobalIndex global_;
@@ -311,7 +329,7 @@ namespace Dune
      * @brief Get the state the index set is in.
      * @return The state of the index set.
      */
-    inline const ParallelIndexSetState& state()
+    inline const ParallelIndexSetState& state() const
       {
           return state_;
       }
@@ -442,6 +460,19 @@ namespace Dune
      */
     inline const_iterator end() const;
 
+    /**
+     * @brief Call a functor for each contiguous part of the index pairs.
+     *
+     * The parts are handed out in the order of the iterators as
+     * f(first, n), where first is a constant pointer to the first
+     * index pair of the part and n the number of pairs in it.
+     * @param f The functor.
+     * @return The functor after the last call.
+     * @see ArrayList::for_each_span
+     */
+    template<class F>
+    inline F for_each_span(F f) const;
+
     /**
      * @brief Renumbers the local index numbers.
      *
@@ -468,6 +499,21 @@ namespace Dune
     inline size_t size() const;
 
   private:
+    /** @brief Functor numbering the local indices consecutively. */
+    struct RenumberLocal
+    {
+      RenumberLocal() : index_(0)
+      {}
+
+      void operator()(IndexPair* pairs, std::size_t n)
+      {
+        for(std::size_t i=0; i<n; ++i, ++index_)
+          pairs[i].local()=index_;
+      }
+
+      uint32_t index_;
+    };
+
     /** @brief The index pairs. */
     ArrayList<IndexPair,N> localIndices_;
     /** @brief The new indices for the RESIZE state. */
@@ -835,7 +881,7 @@ namespace Dune
   inline void ParallelIndexSet<TG,TL,N>::merge(){
     if(localIndices_.size()==0)
       {
-	localIndices_=newIndices_;
+	localIndices_.swap(newIndices_);
 	newIndices_.clear();
       }
     else if(newIndices_.size()>0 || deletedEntries_)
@@ -884,7 +930,7 @@ namespace Dune
 	    tempPairs.push_back(*added);
 	    added.eraseToHere();
 	  }
-	localIndices_ = tempPairs;
+	localIndices_.swap(tempPairs);
       }
   }
 
@@ -1011,12 +1057,14 @@ namespace Dune
 		 <<"GROUND state for renumberLocal()");
 #endif
 
-    typedef typename ArrayList<IndexPair,N>::iterator iterator;
-    const const_iterator end_ = end();
-    uint32_t index=0;
+    localIndices_.for_each_span(RenumberLocal());
+  }
 
-    for(iterator pair=begin(); pair!=end_; index++, ++pair)
-      pair->local()=index;
+  template<class TG, class TL, int N>
+  template<class F>
+  inline F ParallelIndexSet<TG,TL,N>::for_each_span(F f) const
+  {
+    return localIndices_.for_each_span(f);
   }
 
   template<class TG, class TL, int N>
@@ -1133,4 +1181,7 @@ namespace Dune
 #endif // DOXYGEN
 
 }
+
+DUNE_DEFINE_HASH(DUNE_HASH_TEMPLATE_ARGS(class TG, class TL),DUNE_HASH_TYPE(Dune::IndexPair<TG,TL>))
+
 #endif 
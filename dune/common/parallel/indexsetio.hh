@@ -0,0 +1,93 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_INDEXSETIO_HH
+#define DUNE_INDEXSETIO_HH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <dune/common/binaryio.hh>
+#include <dune/common/exceptions.hh>
+
+#include "indexset.hh"
+#include "plocalindex.hh"
+
+namespace Dune
+{
+  /** @addtogroup Common_Parallel
+   *
+   * @{
+   */
+  /**
+   * @file
+   * @brief Writing and reading ParallelIndexSets to and from binary files.
+   */
+
+  /**
+   * @brief Writes an index set to a binary file.
+   *
+   * The index pairs are stored as the arrays name/global, name/local,
+   * name/attribute and name/public, sorted by the global index. The
+   * index set has to be in the ground state and the global indices of an
+   * arithmetic type, see BinaryTraits.
+   */
+  template<class TG, class TA, int N>
+  void writeIndexSet(BinaryWriter& writer, const std::string& name,
+                     const ParallelIndexSet<TG,ParallelLocalIndex<TA>,N>& indexSet)
+  {
+    typedef typename ParallelIndexSet<TG,ParallelLocalIndex<TA>,N>::const_iterator Iterator;
+    if (indexSet.state() != GROUND)
+      DUNE_THROW(InvalidIndexSetState, "The index set has to be in the ground state to be written");
+
+    const std::size_t n = indexSet.size();
+    std::vector<TG> global;
+    std::vector<uint64_t> local;
+    std::vector<signed char> attribute;
+    std::vector<unsigned char> isPublic;
+    global.reserve(n);
+    local.reserve(n);
+    attribute.reserve(n);
+    isPublic.reserve(n);
+    for (Iterator pair = indexSet.begin(); pair != indexSet.end(); ++pair)
+    {
+      global.push_back(pair->global());
+      local.push_back(pair->local().local());
+      attribute.push_back(pair->local().attribute());
+      isPublic.push_back(pair->local().isPublic());
+    }
+    writer.write(name + "/global", global);
+    writer.write(name + "/local", local);
+    writer.write(name + "/attribute", attribute);
+    writer.write(name + "/public", isPublic);
+  }
+
+  /**
+   * @brief Reads an index set written by writeIndexSet().
+   *
+   * The index pairs are added to indexSet, which is usually empty.
+   */
+  template<class TG, class TA, int N>
+  void readIndexSet(const BinaryReader& reader, const std::string& name,
+                    ParallelIndexSet<TG,ParallelLocalIndex<TA>,N>& indexSet)
+  {
+    typedef ParallelLocalIndex<TA> LocalIndex;
+    const BinaryArrayView<TG> global = reader.array<TG>(name + "/global");
+    const BinaryArrayView<uint64_t> local = reader.array<uint64_t>(name + "/local");
+    const BinaryArrayView<signed char> attribute = reader.array<signed char>(name + "/attribute");
+    const BinaryArrayView<unsigned char> isPublic = reader.array<unsigned char>(name + "/public");
+    const std::size_t n = global.size();
+    if (local.size() != n || attribute.size() != n || isPublic.size() != n)
+      DUNE_THROW(IOError, "The arrays of the index set " << name << " in " << reader.filename()
+                 << " differ in size");
+
+    indexSet.beginResize();
+    for (std::size_t i = 0; i < n; ++i)
+      indexSet.add(global[i], LocalIndex(local[i], TA(attribute[i]), isPublic[i] != 0));
+    indexSet.endResize();
+  }
+
+  /** @} */
+} // end namespace Dune
+
+#endif // DUNE_INDEXSETIO_HH
@@ -0,0 +1,630 @@
+// $Id$
+#ifndef DUNE_INDICESMIGRATOR_HH
+#define DUNE_INDICESMIGRATOR_HH
+
+#include"indexset.hh"
+#include"remoteindices.hh"
+#include"communicator.hh"
+#include<dune/common/stdstreams.hh>
+#include<algorithm>
+#include<cassert>
+#include<set>
+#include<vector>
+
+#if HAVE_MPI
+#include"mpitraits.hh"
+#include<mpi.h>
+
+namespace Dune
+{
+  /** @addtogroup Common_Parallel
+   *
+   * @{
+   */
+  /**
+   * @file
+   * @brief Class for moving indices and the data attached to them
+   * between processes.
+   */
+
+  /**
+   * @brief Moves indices of a distributed index set and the data
+   * attached to them to other processes.
+   *
+   * For each local index the user provides the rank of the process
+   * the index should live on after the migration. All indices whose
+   * target is another process are removed from the local index set
+   * and added to the index set of the target process, together with
+   * their attribute, their public flag and (optionally) the data stored
+   * for them in an indexed container.
+   *
+   * If an index arrives at a process that already knows it, the
+   * received entry replaces the local one. If the same index arrives
+   * from several processes the entry of the process with the lowest
+   * rank is used.
+   *
+   * The index set is renumbered afterwards, i.e. the local
+   * indices are consecutive and ordered like the global indices
+   * (see ParallelIndexSet::renumberLocal()), and the data container
+   * is reordered accordingly. Finally the remote indices are rebuilt,
+   * ignoring the public flags if they were built that way before.
+   *
+   * If all processes only send indices to processes they already share
+   * indices with according to the remote indices, which is a symmetric
+   * relation, the message sizes are only exchanged between neighbours.
+   * Otherwise a global all-to-all communication takes place. The
+   * neighbour hint is not used for this, as a process it names need
+   * not name the process in turn.
+   *
+   * @tparam T The type of the parallel index set. Its local index has
+   * to be a ParallelLocalIndex.
+   */
+  template<typename T>
+  class IndicesMigrator
+  {
+  public:
+
+    /** @brief The type of the index set. */
+    typedef T ParallelIndexSet;
+
+    /** @brief The type of the index pair */
+    typedef typename ParallelIndexSet::IndexPair IndexPair;
+
+    /** @brief Type of the global index used in the index set. */
+    typedef typename ParallelIndexSet::GlobalIndex GlobalIndex;
+
+    /** @brief Type of the attribute used in the index set. */
+    typedef typename ParallelIndexSet::LocalIndex::Attribute Attribute;
+
+    /**
+     * @brief Type of the remote indices.
+     */
+    typedef Dune::RemoteIndices<ParallelIndexSet> RemoteIndices;
+
+    /**
+     * @brief Constructor.
+     *
+     * The source as well as the target index set of the remote
+     * indices have to be the same as the provided index set.
+     * @param indexSet The index set with the information
+     * of the locally present indices.
+     * @param remoteIndices The remote indices.
+     */
+    IndicesMigrator(ParallelIndexSet& indexSet,
+                    RemoteIndices& remoteIndices);
+
+    /**
+     * @brief Migrate the indices and the data attached to them.
+     *
+     * The template parameter GatherScatter (e.g. CopyGatherScatter)
+     * has to provide the static methods
+     * \code
+     * static const typename CommPolicy<Data>::IndexedType& gather(const Data& data, std::size_t index);
+     * static void scatter(Data& data, const typename CommPolicy<Data>::IndexedType& value,
+     *                     std::size_t index);
+     * \endcode
+     * as used by BufferedCommunicator. Only data with
+     * CommPolicy<Data>::IndexedTypeFlag SizeOne is supported and the
+     * IndexedType is sent as plain bytes.
+     * Additionally Data has to provide a method resize(std::size_t).
+     *
+     * This is a collective operation.
+     *
+     * @param targets The rank of the target process for each local
+     * index, i.e. targets[i] is the target of the index with local index i.
+     * @param data The data attached to the indices, indexed by the
+     * local index. After the call it is indexed by the new local indices.
+     * @param neighbours Optional: The neighbours the process will share indices
+     * with after the migration. If omitted the remote indices will be rebuilt
+     * using a ring communication with all processes.
+     */
+    template<class GatherScatter, class Data>
+    void migrate(const std::vector<int>& targets, Data& data,
+                 const std::vector<int>& neighbours=std::vector<int>());
+
+    /**
+     * @brief Migrate the indices without any data attached to them.
+     *
+     * This is a collective operation.
+     *
+     * @param targets The rank of the target process for each local
+     * index, i.e. targets[i] is the target of the index with local index i.
+     * @param neighbours Optional: The neighbours the process will share indices
+     * with after the migration. If omitted the remote indices will be rebuilt
+     * using a ring communication with all processes.
+     */
+    void migrate(const std::vector<int>& targets,
+                 const std::vector<int>& neighbours=std::vector<int>());
+
+    /**
+     * @brief Whether the last migration only communicated with neighbours.
+     * @return False if a global all-to-all communication was needed.
+     */
+    bool neighbourExchange() const;
+
+  private:
+    /** @brief The set of locally present indices.*/
+    ParallelIndexSet& indexSet_;
+
+    /** @brief The remote indices. */
+    RemoteIndices& remoteIndices_;
+
+    /** @brief Our rank. */
+    int rank_;
+
+    /** @brief The number of processes. */
+    int procs_;
+
+    /** @brief Whether the last migration used the neighbour exchange. */
+    bool neighbourExchange_;
+
+    /** @brief The communicator tag to use. */
+    enum{ commTag_=335 };
+
+    /**
+     * @brief Information about a received index.
+     */
+    struct ReceivedIndex
+    {
+      /** @brief The global index. */
+      GlobalIndex global;
+      /** @brief The attribute on the sending process. */
+      char attribute;
+      /** @brief The public flag on the sending process. */
+      char isPublic;
+      /** @brief The position of the data in the receive order. */
+      std::size_t position;
+    };
+
+    /**
+     * @brief Compares received indices by their global index.
+     */
+    struct ReceivedIndexLess
+    {
+      bool operator()(const ReceivedIndex& r1, const ReceivedIndex& r2) const
+      {
+        return r1.global<r2.global;
+      }
+    };
+
+    /**
+     * @brief Data mover used if no data is attached to the indices.
+     */
+    struct NoDataMover
+    {
+      int packSize(int, MPI_Comm) const
+      {
+        return 0;
+      }
+      void pack(std::size_t, char*, int, int*, MPI_Comm)
+      {}
+      void unpack(char*, int, int*, MPI_Comm)
+      {}
+      void keep(std::size_t)
+      {}
+      void resize(std::size_t)
+      {}
+      void scatterKept(std::size_t, std::size_t)
+      {}
+      void scatterReceived(std::size_t, std::size_t)
+      {}
+    };
+
+    /**
+     * @brief Data mover that gathers and scatters the data via
+     * GatherScatter and sends it as bytes.
+     */
+    template<class GatherScatter, class Data>
+    struct DataMover
+    {
+      typedef typename CommPolicy<Data>::IndexedType IndexedType;
+
+      dune_static_assert((is_same<SizeOne,typename CommPolicy<Data>::IndexedTypeFlag>::value),
+                         "IndicesMigrator only supports data with one value per index");
+
+      DataMover(Data& data)
+        : data_(data)
+      {}
+
+      int packSize(int n, MPI_Comm comm) const
+      {
+        int size;
+        MPI_Pack_size(n*sizeof(IndexedType), MPI_BYTE, comm, &size);
+        return size;
+      }
+
+      void pack(std::size_t local, char* buffer, int bufferSize, int* position,
+                MPI_Comm comm)
+      {
+        IndexedType value = GatherScatter::gather(data_, local);
+        MPI_Pack(&value, sizeof(IndexedType), MPI_BYTE, buffer, bufferSize,
+                 position, comm);
+      }
+
+      void unpack(char* buffer, int bufferSize, int* position, MPI_Comm comm)
+      {
+        received_.push_back(IndexedType());
+        MPI_Unpack(buffer, bufferSize, position, &received_.back(),
+                   sizeof(IndexedType), MPI_BYTE, comm);
+      }
+
+      void keep(std::size_t local)
+      {
+        kept_.push_back(GatherScatter::gather(data_, local));
+      }
+
+      void resize(std::size_t size)
+      {
+        data_.resize(size);
+      }
+
+      void scatterKept(std::size_t kept, std::size_t local)
+      {
+        GatherScatter::scatter(data_, kept_[kept], local);
+      }
+
+      void scatterReceived(std::size_t received, std::size_t local)
+      {
+        GatherScatter::scatter(data_, received_[received], local);
+      }
+
+    private:
+      /** @brief The data we migrate. */
+      Data& data_;
+      /** @brief The values of the indices we keep. */
+      std::vector<IndexedType> kept_;
+      /** @brief The values received in the order of arrival. */
+      std::vector<IndexedType> received_;
+    };
+
+    /**
+     * @brief Migrate the indices and move the data with the mover.
+     */
+    template<class Mover>
+    void migrateIndices(const std::vector<int>& targets, Mover& mover,
+                        const std::vector<int>& neighbours);
+
+    /**
+     * @brief Decide collectively whether only neighbours are targets.
+     * @param targets The targets of the local indices.
+     * @param partners Filled with the neighbouring ranks.
+     */
+    bool onlyNeighbours(const std::vector<int>& targets,
+                        std::vector<int>& partners);
+
+    /**
+     * @brief Exchange the message sizes.
+     * @param sendSizes The size of the message to each process.
+     * @param receiveSizes The size of the message from each process.
+     * @param partners The ranks of the neighbours if only neighbours
+     * are involved.
+     */
+    void exchangeSizes(std::vector<int>& sendSizes, std::vector<int>& receiveSizes,
+                       const std::vector<int>& partners);
+
+    /**
+     * @brief Exchange the packed messages.
+     */
+    void exchangeMessages(char* sendBuffer, std::vector<int>& sendSizes,
+                          std::vector<int>& sendOffsets, char* receiveBuffer,
+                          std::vector<int>& receiveSizes,
+                          std::vector<int>& receiveOffsets,
+                          const std::vector<int>& partners);
+  };
+
+  /** @} */
+
+  template<typename T>
+  IndicesMigrator<T>::IndicesMigrator(ParallelIndexSet& indexSet,
+                                      RemoteIndices& remoteIndices)
+    : indexSet_(indexSet), remoteIndices_(remoteIndices),
+      neighbourExchange_(false)
+  {
+    // index sets must match.
+    assert(&remoteIndices.sourceIndexSet() == &remoteIndices.destinationIndexSet());
+    assert(&remoteIndices.sourceIndexSet() == &indexSet);
+    MPI_Comm_rank(remoteIndices_.communicator(), &rank_);
+    MPI_Comm_size(remoteIndices_.communicator(), &procs_);
+  }
+
+  template<typename T>
+  inline bool IndicesMigrator<T>::neighbourExchange() const
+  {
+    return neighbourExchange_;
+  }
+
+  template<typename T>
+  template<class GatherScatter, class Data>
+  void IndicesMigrator<T>::migrate(const std::vector<int>& targets, Data& data,
+                                   const std::vector<int>& neighbours)
+  {
+    DataMover<GatherScatter,Data> mover(data);
+    migrateIndices(targets, mover, neighbours);
+  }
+
+  template<typename T>
+  void IndicesMigrator<T>::migrate(const std::vector<int>& targets,
+                                   const std::vector<int>& neighbours)
+  {
+    NoDataMover mover;
+    migrateIndices(targets, mover, neighbours);
+  }
+
+  template<typename T>
+  bool IndicesMigrator<T>::onlyNeighbours(const std::vector<int>& targets,
+                                          std::vector<int>& partners)
+  {
+    // Only the processes we share remote indices with, as they know us
+    // as well and thus post the matching receives.
+    std::set<int> known;
+    typedef typename RemoteIndices::const_iterator RemoteIterator;
+    for(RemoteIterator remote=remoteIndices_.begin(); remote != remoteIndices_.end();
+        ++remote)
+      known.insert(remote->first);
+    known.erase(rank_);
+
+    int local=1, global;
+    typedef typename ParallelIndexSet::const_iterator Iterator;
+    const Iterator end=indexSet_.end();
+    for(Iterator pair=indexSet_.begin(); pair!=end; ++pair){
+      int target=targets[pair->local()];
+      if(target!=rank_ && known.find(target)==known.end()){
+        local=0;
+        break;
+      }
+    }
+
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MIN, remoteIndices_.communicator());
+    partners.assign(known.begin(), known.end());
+    return global==1;
+  }
+
+  template<typename T>
+  void IndicesMigrator<T>::exchangeSizes(std::vector<int>& sendSizes,
+                                         std::vector<int>& receiveSizes,
+                                         const std::vector<int>& partners)
+  {
+    MPI_Comm comm=remoteIndices_.communicator();
+
+    if(!neighbourExchange_){
+      MPI_Alltoall(&(sendSizes[0]), 1, MPI_INT, &(receiveSizes[0]), 1, MPI_INT,
+                   comm);
+      return;
+    }
+
+    std::vector<MPI_Request> requests(2*partners.size());
+    std::vector<MPI_Status> statuses(2*partners.size());
+    typedef std::vector<int>::const_iterator Iterator;
+    MPI_Request* req = requests.size()>0 ? &(requests[0]) : 0;
+
+    for(Iterator partner=partners.begin(); partner != partners.end(); ++partner)
+      MPI_Irecv(&(receiveSizes[*partner]), 1, MPI_INT, *partner, commTag_, comm,
+                req++);
+    for(Iterator partner=partners.begin(); partner != partners.end(); ++partner)
+      MPI_Isend(&(sendSizes[*partner]), 1, MPI_INT, *partner, commTag_, comm,
+                req++);
+
+    if(requests.size()>0)
+      MPI_Waitall(requests.size(), &(requests[0]), &(statuses[0]));
+  }
+
+  template<typename T>
+  void IndicesMigrator<T>::exchangeMessages(char* sendBuffer, std::vector<int>& sendSizes,
+                                            std::vector<int>& sendOffsets,
+                                            char* receiveBuffer,
+                                            std::vector<int>& receiveSizes,
+                                            std::vector<int>& receiveOffsets,
+                                            const std::vector<int>& partners)
+  {
+    MPI_Comm comm=remoteIndices_.communicator();
+
+    if(!neighbourExchange_){
+      MPI_Alltoallv(sendBuffer, &(sendSizes[0]), &(sendOffsets[0]), MPI_PACKED,
+                    receiveBuffer, &(receiveSizes[0]), &(receiveOffsets[0]),
+                    MPI_PACKED, comm);
+      return;
+    }
+
+    std::vector<MPI_Request> requests;
+    typedef std::vector<int>::const_iterator Iterator;
+
+    for(Iterator partner=partners.begin(); partner != partners.end(); ++partner)
+      if(receiveSizes[*partner]>0){
+        requests.push_back(MPI_Request());
+        MPI_Irecv(receiveBuffer+receiveOffsets[*partner], receiveSizes[*partner],
+                  MPI_PACKED, *partner, commTag_, comm, &(requests.back()));
+      }
+    for(Iterator partner=partners.begin(); partner != partners.end(); ++partner)
+      if(sendSizes[*partner]>0){
+        requests.push_back(MPI_Request());
+        MPI_Isend(sendBuffer+sendOffsets[*partner], sendSizes[*partner],
+                  MPI_PACKED, *partner, commTag_, comm, &(requests.back()));
+      }
+
+    if(requests.size()>0){
+      std::vector<MPI_Status> statuses(requests.size());
+      MPI_Waitall(requests.size(), &(requests[0]), &(statuses[0]));
+    }
+  }
+
+  template<typename T>
+  template<class Mover>
+  void IndicesMigrator<T>::migrateIndices(const std::vector<int>& targets,
+                                          Mover& mover,
+                                          const std::vector<int>& neighbours)
+  {
+    typedef typename ParallelIndexSet::iterator Iterator;
+    typedef typename ParallelIndexSet::const_iterator ConstIterator;
+
+    MPI_Comm comm=remoteIndices_.communicator();
+    MPI_Datatype type=MPITraits<GlobalIndex>::getType();
+
+    assert(targets.size()>=indexSet_.size());
+
+    std::vector<int> partners;
+    neighbourExchange_ = onlyNeighbours(targets, partners);
+
+    // Count the indices we send to each process
+    std::vector<int> sendCounts(procs_, 0);
+    const ConstIterator end=static_cast<const ParallelIndexSet&>(indexSet_).end();
+
+    for(ConstIterator pair=static_cast<const ParallelIndexSet&>(indexSet_).begin();
+        pair!=end; ++pair){
+      int target=targets[pair->local()];
+      assert(target>=0 && target<procs_);
+      if(target!=rank_)
+        ++sendCounts[target];
+    }
+
+    // Calculate the sizes of the messages. Each message contains
+    // the number of indices followed by global index, attribute,
+    // public flag and the data for each index.
+    int intSize, globalSize, charSize;
+    MPI_Pack_size(1, MPI_INT, comm, &intSize);
+    MPI_Pack_size(1, type, comm, &globalSize);
+    MPI_Pack_size(2, MPI_CHAR, comm, &charSize);
+    int itemSize=globalSize+charSize+mover.packSize(1, comm);
+
+    std::vector<int> sendSizes(procs_, 0), sendOffsets(procs_, 0);
+    int bufferSize=0;
+    for(int proc=0; proc < procs_; ++proc)
+      if(sendCounts[proc]>0){
+        sendOffsets[proc]=bufferSize;
+        bufferSize+=intSize+sendCounts[proc]*itemSize;
+      }
+
+    std::vector<char> sendBuffer(bufferSize>0 ? bufferSize : 1);
+
+    // Pack the messages
+    std::vector<int> positions(sendOffsets);
+    for(int proc=0; proc < procs_; ++proc)
+      if(sendCounts[proc]>0)
+        MPI_Pack(&(sendCounts[proc]), 1, MPI_INT, &(sendBuffer[0]), bufferSize,
+                 &(positions[proc]), comm);
+
+    for(ConstIterator pair=static_cast<const ParallelIndexSet&>(indexSet_).begin();
+        pair!=end; ++pair){
+      int target=targets[pair->local()];
+      if(target==rank_)
+        continue;
+      char attribute=static_cast<char>(pair->local().attribute());
+      char isPublic=static_cast<char>(pair->local().isPublic());
+      MPI_Pack(const_cast<GlobalIndex*>(&(pair->global())), 1, type,
+               &(sendBuffer[0]), bufferSize, &(positions[target]), comm);
+      MPI_Pack(&attribute, 1, MPI_CHAR, &(sendBuffer[0]), bufferSize,
+               &(positions[target]), comm);
+      MPI_Pack(&isPublic, 1, MPI_CHAR, &(sendBuffer[0]), bufferSize,
+               &(positions[target]), comm);
+      mover.pack(pair->local(), &(sendBuffer[0]), bufferSize,
+                 &(positions[target]), comm);
+    }
+
+    for(int proc=0; proc < procs_; ++proc)
+      if(sendCounts[proc]>0)
+        sendSizes[proc]=positions[proc]-sendOffsets[proc];
+
+    // Exchange the messages
+    std::vector<int> receiveSizes(procs_, 0), receiveOffsets(procs_, 0);
+    exchangeSizes(sendSizes, receiveSizes, partners);
+
+    int receiveBufferSize=0;
+    for(int proc=0; proc < procs_; ++proc){
+      receiveOffsets[proc]=receiveBufferSize;
+      receiveBufferSize+=receiveSizes[proc];
+    }
+
+    std::vector<char> receiveBuffer(receiveBufferSize>0 ? receiveBufferSize : 1);
+    exchangeMessages(&(sendBuffer[0]), sendSizes, sendOffsets, &(receiveBuffer[0]),
+                     receiveSizes, receiveOffsets, partners);
+
+    // Unpack the received indices in ascending order of the source rank
+    std::vector<ReceivedIndex> received;
+    for(int proc=0; proc < procs_; ++proc){
+      if(receiveSizes[proc]==0)
+        continue;
+      int position=receiveOffsets[proc];
+      int count;
+      MPI_Unpack(&(receiveBuffer[0]), receiveBufferSize, &position, &count, 1,
+                 MPI_INT, comm);
+      for(int i=0; i < count; ++i){
+        ReceivedIndex index;
+        MPI_Unpack(&(receiveBuffer[0]), receiveBufferSize, &position,
+                   &(index.global), 1, type, comm);
+        MPI_Unpack(&(receiveBuffer[0]), receiveBufferSize, &position,
+                   &(index.attribute), 1, MPI_CHAR, comm);
+        MPI_Unpack(&(receiveBuffer[0]), receiveBufferSize, &position,
+                   &(index.isPublic), 1, MPI_CHAR, comm);
+        index.position=received.size();
+        mover.unpack(&(receiveBuffer[0]), receiveBufferSize, &position, comm);
+        received.push_back(index);
+      }
+    }
+
+    // Sort by global index. Of several entries for the same global
+    // index the one from the lowest rank wins.
+    std::stable_sort(received.begin(), received.end(), ReceivedIndexLess());
+    typedef typename std::vector<ReceivedIndex>::iterator ReceivedIterator;
+    ReceivedIterator unique=received.begin();
+    for(ReceivedIterator index=received.begin(); index != received.end(); ++index)
+      if(unique==received.begin() || (unique-1)->global != index->global)
+        *(unique++)=*index;
+    received.erase(unique, received.end());
+
+    // Remove the indices that left us or that are replaced by received ones
+    // and remember the ones we keep.
+    std::vector<GlobalIndex> kept;
+    indexSet_.beginResize();
+
+    ReceivedIterator index=received.begin();
+    const Iterator iend=indexSet_.end();
+    for(Iterator pair=indexSet_.begin(); pair!=iend; ++pair){
+      while(index != received.end() && index->global < pair->global())
+        ++index;
+      if(targets[pair->local()]!=rank_ ||
+         (index != received.end() && index->global == pair->global())){
+        indexSet_.markAsDeleted(pair);
+      }else{
+        kept.push_back(pair->global());
+        mover.keep(pair->local());
+      }
+    }
+
+    typedef typename ParallelIndexSet::LocalIndex LocalIndex;
+    for(index=received.begin(); index != received.end(); ++index)
+      indexSet_.add(index->global,
+                    LocalIndex(Attribute(index->attribute),
+                               static_cast<bool>(index->isPublic)));
+
+    indexSet_.endResize();
+    indexSet_.renumberLocal();
+
+    // Reorder the data according to the new local indices.
+    mover.resize(indexSet_.size());
+    typedef typename std::vector<GlobalIndex>::const_iterator KeptIterator;
+    KeptIterator keptIndex=kept.begin();
+    index=received.begin();
+    const ConstIterator newEnd=static_cast<const ParallelIndexSet&>(indexSet_).end();
+    for(ConstIterator pair=static_cast<const ParallelIndexSet&>(indexSet_).begin();
+        pair!=newEnd; ++pair){
+      if(keptIndex != kept.end() && *keptIndex == pair->global()){
+        mover.scatterKept(keptIndex-kept.begin(), pair->local());
+        ++keptIndex;
+      }else{
+        assert(index != received.end() && index->global == pair->global());
+        mover.scatterReceived(index->position, pair->local());
+        ++index;
+      }
+    }
+
+    // Rebuild the remote indices the way they were built before.
+    remoteIndices_.setNeighbours(neighbours);
+    if(remoteIndices_.publicIgnored)
+      remoteIndices_.template rebuild<true>();
+    else
+      remoteIndices_.template rebuild<false>();
+  }
+
+} // namespace Dune
+
+#endif // HAVE_MPI
+#endif
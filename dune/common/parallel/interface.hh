@@ -205,6 +205,7 @@ namespace Dune
    */
   class Interface : public InterfaceBuilder
   {
+    friend void readInterface(const BinaryReader&, const std::string&, Interface&, MPI_Comm);
     
   public:
     typedef InterfaceInformation Information;
@@ -376,12 +377,12 @@ namespace Dune
       RemoteIterator remote = send ? process->second.first->begin() : process->second.second->begin();
 	
       while(remote!=remoteEnd){
-	  if( send ?  destFlags.contains(remote->attribute()) :
-	      sourceFlags.contains(remote->attribute())){
+	  if( send ?  bitmaskContains(destFlags, remote->attribute()) :
+	      bitmaskContains(sourceFlags, remote->attribute())){
 
               // do we send the index?
-            if( send ? sourceFlags.contains(remote->localIndexPair().local().attribute()) :
-                destFlags.contains(remote->localIndexPair().local().attribute()))
+            if( send ? bitmaskContains(sourceFlags, remote->localIndexPair().local().attribute()) :
+                bitmaskContains(destFlags, remote->localIndexPair().local().attribute()))
                 ++size;
           }
           ++remote;
@@ -398,11 +399,11 @@ namespace Dune
       RemoteIterator remote = send ? process->second.first->begin() : process->second.second->begin();
 	
       while(remote!=remoteEnd){
-	  if( send ?  destFlags.contains(remote->attribute()) :
-	      sourceFlags.contains(remote->attribute())){
+	  if( send ?  bitmaskContains(destFlags, remote->attribute()) :
+	      bitmaskContains(sourceFlags, remote->attribute())){
               // do we send the index?
-            if( send ? sourceFlags.contains(remote->localIndexPair().local().attribute()) :
-                destFlags.contains(remote->localIndexPair().local().attribute()))
+            if( send ? bitmaskContains(sourceFlags, remote->localIndexPair().local().attribute()) :
+                bitmaskContains(destFlags, remote->localIndexPair().local().attribute()))
               interfaceInformation.add(process->first,remote->localIndexPair().local().local());
           }
           ++remote;
@@ -72,6 +72,8 @@ namespace Dune
   ComposeMPITraits(unsigned int,MPI_UNSIGNED);
   ComposeMPITraits(long,MPI_LONG);
   ComposeMPITraits(unsigned long,MPI_UNSIGNED_LONG);
+  ComposeMPITraits(long long,MPI_LONG_LONG);
+  ComposeMPITraits(unsigned long long,MPI_UNSIGNED_LONG_LONG);
   ComposeMPITraits(float,MPI_FLOAT);
   ComposeMPITraits(double,MPI_DOUBLE);
   ComposeMPITraits(long double,MPI_LONG_DOUBLE);
@@ -114,6 +116,22 @@ namespace Dune
   MPI_Datatype MPITraits<FieldVector<K,n> >::vectortype = {MPI_DATATYPE_NULL};
 
 
+  class DoubleDouble;
+
+  template<>
+  struct MPITraits<DoubleDouble>
+  {
+    static inline MPI_Datatype getType()
+    {
+      static MPI_Datatype datatype = MPI_DATATYPE_NULL;
+      if(datatype==MPI_DATATYPE_NULL){
+        MPI_Type_contiguous(2, MPI_DOUBLE, &datatype);
+        MPI_Type_commit(&datatype);
+      }
+      return datatype;
+    }
+  };
+
   template<int k>
   class bigunsignedint;
   
@@ -126,7 +144,7 @@ namespace Dune
     static inline MPI_Datatype getType()
     {
       if(datatype==MPI_DATATYPE_NULL){
-	MPI_Type_contiguous(bigunsignedint<k>::n, MPITraits<unsigned short>::getType(),
+	MPI_Type_contiguous(bigunsignedint<k>::n, MPITraits<typename bigunsignedint<k>::limb_type>::getType(),
 			    &vectortype);
 	//MPI_Type_commit(&vectortype);
 	bigunsignedint<k> data;
@@ -11,6 +11,7 @@
 #include <dune/common/stdstreams.hh>
 #include <map>
 #include <set>
+#include <string>
 #include <utility>
 #include <iostream>
 #include <algorithm>
@@ -46,6 +47,9 @@ namespace Dune{
   
   template<typename T1, typename T2>
   class RemoteIndex;
+
+  class BinaryReader;
+  class BinaryWriter;
   
   template<typename T>
   class IndicesSyncer;
@@ -153,6 +157,9 @@ namespace Dune{
 
   template<class T>
     class IndicesSyncer;
+
+  template<typename T>
+  class IndicesMigrator;
   
   // forward declaration needed for friend declaration.
   template<typename T1, typename T2>
@@ -181,6 +188,7 @@ namespace Dune{
   {
     friend class InterfaceBuilder;
     friend class IndicesSyncer<T>;
+    friend class IndicesMigrator<T>;
     template<typename T1, typename A2, typename A1>
     friend void repairLocalIndexPointers(std::map<int,SLList<std::pair<typename T1::GlobalIndex, typename T1::LocalIndex::Attribute>,A2> >&, 
                                          RemoteIndices<T1,A1>&,
@@ -189,6 +197,10 @@ namespace Dune{
     template<class G, class T1, class T2>
     friend void fillIndexSetHoles(const G& graph, Dune::OwnerOverlapCopyCommunication<T1,T2>& oocomm);
     friend std::ostream& operator<<<>(std::ostream&, const RemoteIndices<T>&);
+    template<class T1, class A1>
+    friend void writeRemoteIndices(BinaryWriter&, const std::string&, const RemoteIndices<T1,A1>&);
+    template<class T1, class A1>
+    friend void readRemoteIndices(const BinaryReader&, const std::string&, RemoteIndices<T1,A1>&);
     
   public:
    
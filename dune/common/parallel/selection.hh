@@ -3,6 +3,7 @@
 #define DUNE_SELECTION_HH
 
 #include"indexset.hh"
+#include<dune/common/enumset.hh>
 #include<dune/common/iteratorfacades.hh>
 
 namespace Dune
@@ -52,7 +53,7 @@ namespace Dune
       : iter_(iter), end_(end)
     {
       // Step to the first valid entry
-      while(iter_!=end_ && !AttributeSet::contains(iter_->local().attribute()))
+      while(iter_!=end_ && !FastAttributeSet::contains(iter_->local().attribute()))
 	++iter_;
     }
     
@@ -60,7 +61,7 @@ namespace Dune
     {
       assert(iter_!=end_);
       for(++iter_;iter_!=end_; ++iter_)
-	if(AttributeSet::contains(iter_->local().attribute()))
+	if(FastAttributeSet::contains(iter_->local().attribute()))
 	  break;
     }
     
@@ -81,6 +82,10 @@ namespace Dune
     }
       
   private:
+    /** @brief The set used for the membership tests (a bit mask if possible). */
+    typedef typename BitmaskAttributeSetOf<TS,typename TL::Attribute>::Type
+    FastAttributeSet;
+
     ParallelIndexSetIterator iter_;
     const ParallelIndexSetIterator end_;
   };
@@ -254,6 +259,10 @@ namespace Dune
     
 	
   private:
+    /** @brief The set used for the membership tests (a bit mask if possible). */
+    typedef typename BitmaskAttributeSetOf<TS,typename TL::Attribute>::Type
+    FastAttributeSet;
+
     uint32_t* selected_;
     size_t size_;
     bool built_;
@@ -271,17 +280,20 @@ namespace Dune
     const const_iterator end = indexset.end();
     int entries = 0;
     
+    // The loops are branch free: The membership test is added
+    // to the counter instead of being tested.
     for(const_iterator index = indexset.begin(); index != end; ++index)
-      if(AttributeSet::contains(index->local().attribute()))
-	 ++entries;
+      entries += FastAttributeSet::contains(index->local().attribute());
 
-    selected_ = new uint32_t[entries];
+    // One additional entry for the unconditional store below.
+    selected_ = new uint32_t[entries+1];
     built_ = true;
     
     entries = 0;
-    for(const_iterator index = indexset.begin(); index != end; ++index)
-      if(AttributeSet::contains(index->local().attribute()))
-	selected_[entries++]= index->local().local();
+    for(const_iterator index = indexset.begin(); index != end; ++index){
+      selected_[entries]= index->local().local();
+      entries += FastAttributeSet::contains(index->local().attribute());
+    }
     
     size_=entries;
     built_=true;
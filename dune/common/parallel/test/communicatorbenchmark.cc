@@ -0,0 +1,127 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <dune/common/benchmark.hh>
+#include <dune/common/enumset.hh>
+#include <dune/common/parallel/communicator.hh>
+#include <dune/common/parallel/indexset.hh>
+#include <dune/common/parallel/interface.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/parallel/plocalindex.hh>
+#include <dune/common/parallel/remoteindices.hh>
+
+/**
+ * @file
+ * @brief Benchmark building the remote indices and exchanging overlap data.
+ *
+ * The indices are partitioned into contiguous blocks, one per process,
+ * that overlap with the blocks of the neighbouring processes. Run with
+ * several processes, e.g. mpirun -np 4 communicatorbenchmark.
+ *
+ * Usage: communicatorbenchmark [--repetitions N] [--warmup N] [--min-time S]
+ *                              [--filter TEXT] [--json FILE]
+ */
+
+#if HAVE_MPI
+
+enum Flags { owner, overlap };
+
+typedef Dune::ParallelLocalIndex<Flags> LocalIndex;
+typedef Dune::ParallelIndexSet<int,LocalIndex,512> IndexSet;
+typedef Dune::RemoteIndices<IndexSet> RemoteIndices;
+
+struct VectorGatherScatter
+{
+  static double gather(const std::vector<double>& v, int i)
+  {
+    return v[i];
+  }
+
+  static void scatter(std::vector<double>& v, double value, int i)
+  {
+    v[i]=value;
+  }
+};
+
+/** @brief Build the remote indices from scratch. */
+struct Rebuild
+{
+  const IndexSet& indexSet;
+  const std::vector<int>& neighbours;
+  Rebuild(const IndexSet& s, const std::vector<int>& n) : indexSet(s), neighbours(n) {}
+  void operator() () const
+  {
+    RemoteIndices remote(indexSet, indexSet, MPI_COMM_WORLD, neighbours);
+    remote.rebuild<false>();
+  }
+};
+
+/** @brief Send the owner values to the overlap of the neighbours. */
+struct Forward
+{
+  Dune::BufferedCommunicator& communicator;
+  std::vector<double>& values;
+  Forward(Dune::BufferedCommunicator& c, std::vector<double>& v) : communicator(c), values(v) {}
+  void operator() () const
+  {
+    communicator.forward<VectorGatherScatter>(values, values);
+  }
+};
+
+int main(int argc, char** argv)
+{
+  Dune::MPIHelper& helper=Dune::MPIHelper::instance(argc, argv);
+  const int rank=helper.rank(), size=helper.size();
+  Dune::Benchmark suite("communicator", argc, argv, helper.getCollectiveCommunication());
+
+  const int owned=100000;
+  const int widths[] = {1, 1000};
+  for(std::size_t w=0; w<sizeof(widths)/sizeof(widths[0]); ++w){
+    const int width=widths[w];
+    const int begin=std::max(0, rank*owned-width), end=std::min(size*owned, (rank+1)*owned+width);
+    IndexSet indexSet;
+    indexSet.beginResize();
+    for(int g=begin; g<end; ++g)
+      indexSet.add(g, LocalIndex(g-begin, g>=rank*owned && g<(rank+1)*owned ? owner : overlap, true));
+    indexSet.endResize();
+    std::vector<int> neighbours;
+    if(rank>0)
+      neighbours.push_back(rank-1);
+    if(rank<size-1)
+      neighbours.push_back(rank+1);
+
+    RemoteIndices remote(indexSet, indexSet, MPI_COMM_WORLD, neighbours);
+    remote.rebuild<false>();
+    Dune::Interface interface;
+    interface.build(remote, Dune::EnumItem<Flags,owner>(), Dune::EnumItem<Flags,overlap>());
+    Dune::BufferedCommunicator communicator;
+    std::vector<double> values(end-begin, rank);
+    communicator.build<std::vector<double> >(interface);
+
+    std::ostringstream name;
+    name<<" overlap="<<width<<" processes="<<size;
+    suite.run("rebuild remote indices"+name.str(), Rebuild(indexSet, neighbours), end-begin);
+    suite.run("forward"+name.str(), Forward(communicator, values), end-begin-owned);
+    communicator.free();
+  }
+  return suite.finish();
+}
+
+#else
+
+int main()
+{
+  std::cout<<"communicatorbenchmark needs MPI"<<std::endl;
+  return 77;
+}
+
+#endif // HAVE_MPI
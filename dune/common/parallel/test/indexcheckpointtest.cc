@@ -0,0 +1,172 @@
+#include"config.h"
+
+#if HAVE_MPI
+
+#include<dune/common/enumset.hh>
+#include<dune/common/parallel/communicator.hh>
+#include<dune/common/parallel/indexcheckpoint.hh>
+#include<cstdio>
+#include<iostream>
+#include<vector>
+#include<sys/stat.h>
+#include<unistd.h>
+
+enum GridFlags{
+  owner, overlap, border
+};
+
+typedef Dune::ParallelLocalIndex<GridFlags> LocalIndex;
+typedef Dune::ParallelIndexSet<int,LocalIndex,45> IndexSet;
+typedef Dune::RemoteIndices<IndexSet> RemoteIndices;
+
+const int N=100;
+
+struct VectorGatherScatter
+{
+  static double gather(const std::vector<double>& v, int i)
+  {
+    return v[i];
+  }
+
+  static void scatter(std::vector<double>& v, double value, int i)
+  {
+    v[i]=value;
+  }
+};
+
+/**
+ * @brief Setup a one dimensional decomposition where each process
+ * owns N indices and has an overlap of two indices with its neighbours.
+ */
+void setupIndexSet(IndexSet& indexSet, int rank, int size)
+{
+  const int begin=std::max(0, rank*N-2), end=std::min(size*N, (rank+1)*N+2);
+  indexSet.beginResize();
+  for(int g=begin; g<end; ++g)
+    indexSet.add(g, LocalIndex(g-begin, g>=rank*N && g<(rank+1)*N ? owner : overlap, true));
+  indexSet.endResize();
+}
+
+/** @brief Whether the lists of remote indices agree in the global indices and attributes. */
+bool sameRemoteIndices(const RemoteIndices& r1, const RemoteIndices& r2)
+{
+  if(r1.neighbours()!=r2.neighbours())
+    return false;
+  for(RemoteIndices::const_iterator p1=r1.begin(), p2=r2.begin(); p1!=r1.end(); ++p1, ++p2){
+    if(p1->first!=p2->first || (p1->second.first==p1->second.second)!=(p2->second.first==p2->second.second))
+      return false;
+    RemoteIndices::RemoteIndexList::const_iterator i1=p1->second.first->begin(), i2=p2->second.first->begin();
+    for(; i1!=p1->second.first->end() && i2!=p2->second.first->end(); ++i1, ++i2)
+      if(i1->localIndexPair().global()!=i2->localIndexPair().global() || i1->attribute()!=i2->attribute())
+        return false;
+    if(i1!=p1->second.first->end() || i2!=p2->second.first->end())
+      return false;
+  }
+  return true;
+}
+
+int testCheckpoint()
+{
+  int rank, size, ret=0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  IndexSet indexSet;
+  setupIndexSet(indexSet, rank, size);
+  RemoteIndices remoteIndices(indexSet, indexSet, MPI_COMM_WORLD);
+  remoteIndices.rebuild<false>();
+  Dune::Interface interface;
+  interface.build(remoteIndices, Dune::EnumItem<GridFlags,owner>(), Dune::EnumItem<GridFlags,overlap>());
+  Dune::writeIndexCheckpoint("indexcheckpointtest", remoteIndices, interface);
+
+  IndexSet restoredSet;
+  RemoteIndices restoredRemote;
+  Dune::Interface restoredInterface;
+  Dune::readIndexCheckpoint("indexcheckpointtest", restoredSet, restoredRemote, restoredInterface, MPI_COMM_WORLD);
+
+  if(restoredSet.size()!=indexSet.size() || !restoredRemote.isSynced()
+     || !sameRemoteIndices(remoteIndices, restoredRemote) || restoredInterface!=interface){
+    std::cerr<<rank<<": restored state differs from the original"<<std::endl;
+    ++ret;
+  }
+
+  // the restored interface communicates like the original
+  std::vector<double> values(restoredSet.size(), -1);
+  for(IndexSet::const_iterator pair=restoredSet.begin(); pair!=restoredSet.end(); ++pair)
+    if(pair->local().attribute()==owner)
+      values[pair->local().local()]=pair->global();
+  Dune::BufferedCommunicator communicator;
+  communicator.build<std::vector<double> >(restoredInterface);
+  communicator.forward<VectorGatherScatter>(values, values);
+  communicator.free();
+  for(IndexSet::const_iterator pair=restoredSet.begin(); pair!=restoredSet.end(); ++pair)
+    if(values[pair->local().local()]!=pair->global()){
+      std::cerr<<rank<<": global index "<<pair->global()<<" received "<<values[pair->local().local()]<<std::endl;
+      ++ret;
+    }
+
+  // files of different checkpoints are detected on all processes
+  Dune::writeIndexCheckpoint("indexcheckpointtest2", remoteIndices, interface);
+  if(rank==0)
+    std::rename(Dune::binaryRankFile("indexcheckpointtest2", 0).c_str(),
+                Dune::binaryRankFile("indexcheckpointtest", 0).c_str());
+  MPI_Barrier(MPI_COMM_WORLD);
+  if(size>1){
+    try{
+      IndexSet mixedSet;
+      RemoteIndices mixedRemote;
+      Dune::Interface mixedInterface;
+      Dune::readIndexCheckpoint("indexcheckpointtest", mixedSet, mixedRemote, mixedInterface, MPI_COMM_WORLD);
+      std::cerr<<rank<<": mixed checkpoint read"<<std::endl;
+      ++ret;
+    }
+    catch(Dune::IOError&){}
+  }
+
+  // a process that cannot write its file does not leave the others waiting
+  if(size>1){
+    const std::string blocked=Dune::binaryRankFile("indexcheckpointtest3", size-1)+".tmp";
+    if(rank==size-1)
+      mkdir(blocked.c_str(), 0700);
+    bool thrown=false;
+    try{
+      Dune::writeIndexCheckpoint("indexcheckpointtest3", remoteIndices, interface);
+    }
+    catch(Dune::IOError&){
+      thrown=true;
+    }
+    if(!thrown){
+      std::cerr<<rank<<": failure of another process not detected"<<std::endl;
+      ++ret;
+    }
+    if(rank==size-1)
+      rmdir(blocked.c_str());
+    else
+      std::remove(Dune::binaryRankFile("indexcheckpointtest3", rank).c_str());
+  }
+
+  std::remove(Dune::binaryRankFile("indexcheckpointtest", rank).c_str());
+  if(rank!=0)
+    std::remove(Dune::binaryRankFile("indexcheckpointtest2", rank).c_str());
+  return ret;
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+#if HAVE_MPI
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  int ret=testCheckpoint();
+  int globalRet;
+  MPI_Allreduce(&ret, &globalRet, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  if(rank==0)
+    std::cout<<"Checkpoint test "<<(globalRet==0 ? "passed" : "failed")<<std::endl;
+  MPI_Finalize();
+  return globalRet>0 ? 1 : 0;
+#else
+  return 77;
+#endif
+}
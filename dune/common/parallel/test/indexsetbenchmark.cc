@@ -0,0 +1,87 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+#include <dune/common/benchmark.hh>
+#include <dune/common/parallel/indexset.hh>
+#include <dune/common/parallel/plocalindex.hh>
+
+/**
+ * @file
+ * @brief Benchmark building a ParallelIndexSet and looking up global indices.
+ *
+ * Usage: indexsetbenchmark [--repetitions N] [--warmup N] [--min-time S]
+ *                          [--filter TEXT] [--json FILE]
+ */
+
+enum Flags { owner, overlap };
+
+typedef Dune::ParallelLocalIndex<Flags> LocalIndex;
+typedef Dune::ParallelIndexSet<int,LocalIndex,512> IndexSet;
+
+/** @brief Build an index set from the global indices in the given order. */
+struct Build
+{
+  const std::vector<int>& globals;
+  Build(const std::vector<int>& g) : globals(g) {}
+  void operator() () const
+  {
+    IndexSet indexSet;
+    indexSet.beginResize();
+    for(std::size_t i=0; i<globals.size(); ++i)
+      indexSet.add(globals[i], LocalIndex(i, i%8 ? owner : overlap, true));
+    indexSet.endResize();
+    Dune::Benchmark::doNotOptimize(indexSet.size());
+  }
+};
+
+/** @brief Look up the local indices of global indices. */
+struct Lookup
+{
+  const IndexSet& indexSet;
+  const std::vector<int>& globals;
+  Lookup(const IndexSet& s, const std::vector<int>& g) : indexSet(s), globals(g) {}
+  void operator() () const
+  {
+    std::size_t sum=0;
+    for(std::size_t i=0; i<globals.size(); ++i)
+      sum+=indexSet[globals[i]].local().local();
+    Dune::Benchmark::doNotOptimize(sum);
+  }
+};
+
+int main(int argc, char** argv)
+{
+  Dune::Benchmark suite("indexset", argc, argv);
+
+  const int sizes[] = {1000, 100000};
+  for(std::size_t s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s){
+    const int n=sizes[s];
+    // every third global index, sorted and permuted
+    std::vector<int> sorted(n), scattered(n);
+    for(int i=0; i<n; ++i){
+      sorted[i]=3*i;
+      scattered[i]=3*int((7919L*i)%n);
+    }
+    IndexSet indexSet;
+    indexSet.beginResize();
+    for(int i=0; i<n; ++i)
+      indexSet.add(sorted[i], LocalIndex(i, owner, true));
+    indexSet.endResize();
+
+    std::ostringstream name;
+    name<<" n="<<n;
+    suite.run("build sorted"+name.str(), Build(sorted), n);
+    suite.run("build scattered"+name.str(), Build(scattered), n);
+    suite.run("lookup sorted"+name.str(), Lookup(indexSet, sorted), n);
+    suite.run("lookup scattered"+name.str(), Lookup(indexSet, scattered), n);
+  }
+  return suite.finish();
+}
@@ -0,0 +1,60 @@
+// $Id$
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/binaryio.hh>
+#include <dune/common/parallel/indexset.hh>
+#include <dune/common/parallel/indexsetio.hh>
+#include <dune/common/parallel/plocalindex.hh>
+
+#include <cstdio>
+#include <iostream>
+
+enum Flags { owner, overlap, border };
+
+int main()
+{
+  typedef Dune::ParallelLocalIndex<Flags> LocalIndex;
+  typedef Dune::ParallelIndexSet<long,LocalIndex,45> IndexSet;
+
+  IndexSet indexSet;
+  indexSet.beginResize();
+  for (int i = 0; i < 100; ++i)
+    indexSet.add(1000-7*i, LocalIndex(i, Flags(i%3), i%2 == 0));
+  indexSet.endResize();
+
+  const std::string filename = "indexsetiotest.dbin";
+  {
+    Dune::BinaryWriter writer(filename);
+    writeIndexSet(writer, "indices", indexSet);
+    writer.close();
+  }
+
+  int ret = 0;
+  IndexSet restored;
+  {
+    Dune::BinaryReader reader(filename);
+    readIndexSet(reader, "indices", restored);
+  }
+  std::remove(filename.c_str());
+
+  if (restored.size() != indexSet.size()) {
+    std::cerr << "restored " << restored.size() << " instead of " << indexSet.size() << " indices" << std::endl;
+    return 1;
+  }
+  for (IndexSet::const_iterator pair = indexSet.begin(), other = restored.begin();
+       pair != indexSet.end(); ++pair, ++other)
+    if (pair->global() != other->global() || pair->local().local() != other->local().local()
+        || pair->local().attribute() != other->local().attribute()
+        || pair->local().isPublic() != other->local().isPublic()) {
+      std::cerr << "index pair " << *pair << " restored as " << *other << std::endl;
+      ++ret;
+    }
+  if (restored[1000-7*5].local().local() != 5) {
+    std::cerr << "global index not found in the restored index set" << std::endl;
+    ++ret;
+  }
+  return ret;
+}
@@ -0,0 +1,212 @@
+#include"config.h"
+
+#if HAVE_MPI
+
+#include<dune/common/parallel/indicesmigrator.hh>
+#include<iostream>
+#include<vector>
+
+enum GridFlags{
+  owner, overlap, border
+};
+
+typedef Dune::ParallelLocalIndex<GridFlags> LocalIndex;
+typedef Dune::ParallelIndexSet<int,LocalIndex,45> IndexSet;
+typedef Dune::RemoteIndices<IndexSet> RemoteIndices;
+
+const int N=10;
+
+/**
+ * @brief Setup a one dimensional decomposition where each process
+ * owns N indices and has an overlap copy of the first index of
+ * the next process.
+ */
+void setupIndexSet(IndexSet& indexSet, std::vector<double>& data, int rank,
+                   int procs)
+{
+  indexSet.beginResize();
+  int local=0;
+  for(int i=0; i<N; ++i, ++local)
+    indexSet.add(rank*N+i, LocalIndex(local, owner, true));
+  if(rank+1<procs)
+    indexSet.add((rank+1)*N, LocalIndex(local++, overlap, true));
+  indexSet.endResize();
+
+  data.resize(indexSet.size());
+  typedef IndexSet::const_iterator Iterator;
+  for(Iterator pair=indexSet.begin(); pair!=indexSet.end(); ++pair)
+    data[pair->local()]=pair->global();
+}
+
+/**
+ * @brief Check that the data matches the global indices.
+ */
+int checkData(const IndexSet& indexSet, const std::vector<double>& data,
+              int rank)
+{
+  int ret=0;
+
+  if(data.size()!=indexSet.size()){
+    std::cerr<<rank<<": data size "<<data.size()<<" does not match index set size "
+             <<indexSet.size()<<std::endl;
+    return 1;
+  }
+
+  std::size_t local=0;
+  typedef IndexSet::const_iterator Iterator;
+  for(Iterator pair=indexSet.begin(); pair!=indexSet.end(); ++pair, ++local){
+    if(pair->local()!=local){
+      std::cerr<<rank<<": local index of "<<*pair<<" should be "<<local<<std::endl;
+      ++ret;
+    }
+    if(data[pair->local()]!=pair->global()){
+      std::cerr<<rank<<": wrong data "<<data[pair->local()]<<" for "<<*pair<<std::endl;
+      ++ret;
+    }
+  }
+  return ret;
+}
+
+int testMigration()
+{
+  int rank, procs;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &procs);
+
+  IndexSet indexSet;
+  std::vector<double> data;
+  setupIndexSet(indexSet, data, rank, procs);
+
+  RemoteIndices remoteIndices(indexSet, indexSet, MPI_COMM_WORLD);
+  remoteIndices.rebuild<false>();
+
+  Dune::IndicesMigrator<IndexSet> migrator(indexSet, remoteIndices);
+
+  // Move the upper half of the owned indices to the next process,
+  // which is a neighbour.
+  std::vector<int> targets(indexSet.size(), rank);
+  typedef IndexSet::const_iterator Iterator;
+  for(Iterator pair=indexSet.begin(); pair!=indexSet.end(); ++pair)
+    if(rank+1<procs && pair->local().attribute()==owner &&
+       pair->global()>=rank*N+N/2)
+      targets[pair->local()]=rank+1;
+
+  migrator.migrate<Dune::CopyGatherScatter<std::vector<double> > >(targets, data);
+
+  int ret=checkData(indexSet, data, rank);
+
+  if(procs>1 && !migrator.neighbourExchange()){
+    std::cerr<<rank<<": neighbour exchange expected"<<std::endl;
+    ++ret;
+  }
+
+  std::size_t expected=N;
+  if(rank+1<procs)
+    // upper half is gone, but the overlap copy is still there
+    expected=N-N/2+1;
+  if(rank>0)
+    expected+=N/2;
+
+  if(indexSet.size()!=expected){
+    std::cerr<<rank<<": expected "<<expected<<" indices, got "<<indexSet.size()<<std::endl;
+    ++ret;
+  }
+
+  for(Iterator pair=indexSet.begin(); pair!=indexSet.end(); ++pair)
+    if(pair->global()<rank*N && pair->local().attribute()!=owner){
+      std::cerr<<rank<<": received index "<<*pair<<" should be owner"<<std::endl;
+      ++ret;
+    }
+
+  // Now gather everything on process 0.
+  targets.assign(indexSet.size(), 0);
+  migrator.migrate<Dune::CopyGatherScatter<std::vector<double> > >(targets, data);
+
+  ret+=checkData(indexSet, data, rank);
+
+  if(procs>2 && migrator.neighbourExchange()){
+    std::cerr<<rank<<": all-to-all exchange expected"<<std::endl;
+    ++ret;
+  }
+
+  expected = rank==0 ? procs*N : 0;
+  if(indexSet.size()!=expected){
+    std::cerr<<rank<<": expected "<<expected<<" indices, got "<<indexSet.size()<<std::endl;
+    ++ret;
+  }
+
+  if(remoteIndices.neighbours()!=0){
+    std::cerr<<rank<<": no remote indices expected"<<std::endl;
+    ++ret;
+  }
+
+  // Migrate the indices only and distribute them round robin.
+  targets.resize(indexSet.size());
+  for(Iterator pair=indexSet.begin(); pair!=indexSet.end(); ++pair)
+    targets[pair->local()]=pair->global()%procs;
+  migrator.migrate(targets);
+
+  for(Iterator pair=indexSet.begin(); pair!=indexSet.end(); ++pair)
+    if(pair->global()%procs!=rank){
+      std::cerr<<rank<<": index "<<*pair<<" on wrong process"<<std::endl;
+      ++ret;
+    }
+
+  return ret;
+}
+
+/**
+ * @brief Check that the remote indices are rebuilt ignoring the public
+ * flags if they were built that way.
+ */
+int testPublicIgnored()
+{
+  int rank, procs;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &procs);
+
+  // the indices of the previous setup, but none of them public
+  IndexSet indexSet;
+  indexSet.beginResize();
+  for(int i=0; i<N; ++i)
+    indexSet.add(rank*N+i, LocalIndex(i, owner, false));
+  if(rank+1<procs)
+    indexSet.add((rank+1)*N, LocalIndex(N, overlap, false));
+  indexSet.endResize();
+
+  RemoteIndices remoteIndices(indexSet, indexSet, MPI_COMM_WORLD);
+  remoteIndices.rebuild<true>();
+  const int neighbours=remoteIndices.neighbours();
+
+  Dune::IndicesMigrator<IndexSet> migrator(indexSet, remoteIndices);
+  std::vector<int> targets(indexSet.size(), rank);
+  migrator.migrate(targets);
+
+  if(remoteIndices.neighbours()!=neighbours || (procs>1 && neighbours==0)){
+    std::cerr<<rank<<": "<<remoteIndices.neighbours()<<" neighbours after the migration instead of "
+             <<neighbours<<std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+#if HAVE_MPI
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  int ret=testMigration();
+  ret+=testPublicIgnored();
+  int globalRet;
+  MPI_Allreduce(&ret, &globalRet, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  if(rank==0)
+    std::cout<<"Migration test "<<(globalRet==0 ? "passed" : "failed")<<std::endl;
+  MPI_Finalize();
+  return globalRet>0 ? 1 : 0;
+#else
+  return 77;
+#endif
+}
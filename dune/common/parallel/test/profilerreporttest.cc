@@ -0,0 +1,121 @@
+#include"config.h"
+
+#if HAVE_MPI
+
+#include<dune/common/profiler.hh>
+#include<dune/common/parallel/mpicollectivecommunication.hh>
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<vector>
+
+/** @brief A row of the report: the indented name and the numbers. */
+struct Row
+{
+  std::string label;
+  double calls, wallMin, wallAvg, wallMax;
+  int ranks;
+};
+
+/**
+ * @brief Enter regions depending on the rank.
+ *
+ * All processes enter "common" twice, the odd ones enter "odd" in it
+ * each time and the even ones enter "even" three times.
+ */
+void enterRegions(int rank)
+{
+  for(int i=0; i<2; ++i){
+    Dune::ScopedRegion region("common");
+    if(rank%2==1){
+      Dune::ScopedRegion region("odd");
+    }
+  }
+  if(rank%2==0)
+    for(int i=0; i<3; ++i){
+      Dune::ScopedRegion region("even");
+    }
+}
+
+int testReport(int root)
+{
+  Dune::CollectiveCommunication<MPI_Comm> comm(MPI_COMM_WORLD);
+  const int rank=comm.rank(), size=comm.size();
+  std::ostringstream out;
+  Dune::Profiler::report(out, comm, root);
+  if(rank!=root){
+    if(!out.str().empty()){
+      std::cerr<<rank<<": report written on a process other than the root"<<std::endl;
+      return 1;
+    }
+    return 0;
+  }
+  std::cout<<out.str();
+
+  std::istringstream in(out.str());
+  std::string header;
+  std::getline(in, header);
+  const bool ranksColumn=header.find("ranks")!=std::string::npos;
+  std::vector<Row> rows;
+  std::string line;
+  while(std::getline(in, line)){
+    Row row;
+    const std::string::size_type space=line.find(' ', line.find_first_not_of(' '));
+    row.label=line.substr(0, space);
+    std::istringstream numbers(line.substr(space));
+    numbers>>row.calls>>row.wallMin>>row.wallAvg>>row.wallMax;
+    row.ranks=1;
+    if(ranksColumn)
+      numbers>>row.ranks;
+    rows.push_back(row);
+  }
+
+  int ret=0;
+  if(ranksColumn!=(size>1)){
+    std::cerr<<"ranks column "<<(ranksColumn ? "shown" : "missing")<<" on "<<size<<" processes"<<std::endl;
+    ++ret;
+  }
+  // the union of the regions of all processes, nested depth first
+  std::vector<Row> expected;
+  const Row common={"common", 2, 0, 0, 0, size};
+  const Row odd={"  odd", 2, 0, 0, 0, size/2};
+  const Row even={"even", 3, 0, 0, 0, (size+1)/2};
+  expected.push_back(common);
+  if(size>1)
+    expected.push_back(odd);
+  expected.push_back(even);
+  bool wrong=rows.size()!=expected.size();
+  for(std::size_t i=0; i<rows.size() && !wrong; ++i)
+    wrong=rows[i].label!=expected[i].label || rows[i].calls!=expected[i].calls
+      || rows[i].ranks!=expected[i].ranks || rows[i].wallMin>rows[i].wallAvg
+      || rows[i].wallAvg>rows[i].wallMax;
+  if(wrong){
+    std::cerr<<"wrong report on "<<size<<" processes with root "<<root<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+#if HAVE_MPI
+  MPI_Init(&argc, &argv);
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  Dune::Profiler::enable();
+  enterRegions(rank);
+  int ret=testReport(0);
+  ret+=testReport(size-1);
+  int globalRet;
+  MPI_Allreduce(&ret, &globalRet, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  if(rank==0)
+    std::cout<<"Profiler report test "<<(globalRet==0 ? "passed" : "failed")<<std::endl;
+  MPI_Finalize();
+  return globalRet>0 ? 1 : 0;
+#else
+  return 77;
+#endif
+}
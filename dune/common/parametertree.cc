@@ -14,15 +14,82 @@
 #include <set>
 #include <algorithm>
 
+#if HAVE_STD_THREAD
+#include <atomic>
+#endif
+
 #include <dune/common/exceptions.hh>
 #include <dune/common/parametertree.hh>
 
 using namespace Dune;
 
+namespace {
+
+    // a generation no tree had before, so that a tree constructed where
+    // another one was destroyed does not accept the paths taken from it
+    std::size_t nextGeneration()
+    {
+#if HAVE_STD_THREAD
+        static std::atomic<std::size_t> generation(0);
+#else
+        static std::size_t generation = 0;
+#endif
+        return ++generation;
+    }
+
+}
+
 ParameterTree::ParameterTree()
+    : generation_(nextGeneration())
 {
 }
 
+ParameterTree::ParameterTree(const ParameterTree& other)
+    : valueKeys(other.valueKeys), subKeys(other.subKeys),
+      values(other.values), subs(other.subs), generation_(nextGeneration())
+{
+}
+
+ParameterTree& ParameterTree::operator= (const ParameterTree& other)
+{
+    valueKeys = other.valueKeys;
+    subKeys = other.subKeys;
+    values = other.values;
+    subs = other.subs;
+    index_.clear();
+    generation_ = nextGeneration();
+    return *this;
+}
+
+ParameterTree::IndexEntry* ParameterTree::entry(const std::string& key) const
+{
+    IndexEntry* e = index_.find(key);
+    if (e)
+    {
+        if (unchanged(e->path))
+            return e;
+        // a subtree was assigned to, other entries may refer to its values
+        index_.clear();
+    }
+
+    Detail::ParameterTreePath path(1, std::make_pair(this, generation_));
+    const ParameterTree* tree = this;
+    std::string::size_type begin = 0, dot;
+    while ((dot = key.find('.', begin)) != std::string::npos)
+    {
+        std::map<std::string, ParameterTree>::const_iterator s = tree->subs.find(key.substr(begin, dot-begin));
+        if (s == tree->subs.end())
+            return 0;
+        tree = &s->second;
+        path.push_back(std::make_pair(tree, tree->generation_));
+        begin = dot+1;
+    }
+    std::map<std::string, std::string>::const_iterator v = tree->values.find(key.substr(begin));
+    if (v == tree->values.end())
+        return 0;
+    return &index_.insert(key, &v->second, path);
+}
+
 void ParameterTree::report(std::ostream& stream, const std::string& prefix) const
 {
 	typedef std::map<std::string, std::string>::const_iterator ValueIt;
@@ -228,3 +295,63 @@ const ParameterTree::KeyVector& ParameterTree::getSubKeys() const
 {
 	return subKeys;
 }
+
+Detail::ParameterTreeIndex::Entry* Detail::ParameterTreeIndex::find(const std::string& key)
+{
+    if (heads_.empty())
+        return 0;
+    const std::size_t h = hashKey(key);
+    for (std::size_t i = heads_[h % heads_.size()]; i != std::size_t(-1); i = entries_[i].next)
+        if (entries_[i].hash == h && entries_[i].key == key)
+            return &entries_[i];
+    return 0;
+}
+
+Detail::ParameterTreeIndex::Entry& Detail::ParameterTreeIndex::insert(const std::string& key, const std::string* value,
+                                                                     const ParameterTreePath& path)
+{
+    // keep at most one entry per bucket on average
+    if (entries_.size() >= heads_.size())
+    {
+        heads_.assign(std::max<std::size_t>(16, 2*heads_.size()), std::size_t(-1));
+        for (std::size_t i = 0; i < entries_.size(); ++i)
+        {
+            std::size_t& head = heads_[entries_[i].hash % heads_.size()];
+            entries_[i].next = head;
+            head = i;
+        }
+    }
+    Entry e;
+    e.hash = hashKey(key);
+    e.key = key;
+    e.value = value;
+    e.path = path;
+    e.parsed = 0;
+    std::size_t& head = heads_[e.hash % heads_.size()];
+    e.next = head;
+    head = entries_.size();
+    entries_.push_back(e);
+    return entries_.back();
+}
+
+void Detail::ParameterTreeIndex::clear()
+{
+    for (std::size_t i = 0; i < entries_.size(); ++i)
+        while (entries_[i].parsed)
+        {
+            ParsedParameterBase* next = entries_[i].parsed->next;
+            delete entries_[i].parsed;
+            entries_[i].parsed = next;
+        }
+    entries_.clear();
+    heads_.clear();
+}
+
+std::size_t Detail::ParameterTreeIndex::hashKey(const std::string& key)
+{
+    // FNV-1a
+    std::size_t h = 2166136261u;
+    for (std::size_t i = 0; i < key.size(); ++i)
+        h = (h ^ (unsigned char)key[i]) * 16777619u;
+    return h;
+}
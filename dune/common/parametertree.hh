@@ -16,8 +16,12 @@
 #include <sstream>
 #include <string>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 #include <algorithm>
+#if HAVE_STD_THREAD
+#include <mutex>
+#endif
 
 #include <dune/common/array.hh>
 #include <dune/common/exceptions.hh>
@@ -26,8 +30,90 @@
 
 namespace Dune {
 
+  class ParameterTree;
+
+#ifndef DOXYGEN
+  namespace Detail {
+
+    // the trees on the way from a ParameterTree to one of its values, with
+    // their generations when the way was taken
+    typedef std::vector<std::pair<const ParameterTree*, std::size_t> > ParameterTreePath;
+
+    // a value parsed by ParameterTree::get<T>(), together with the string
+    // it was parsed from
+    struct ParsedParameterBase
+    {
+      ParsedParameterBase(const std::type_info& t, const std::string& s)
+        : type(&t), source(s), next(0)
+      {}
+      virtual ~ParsedParameterBase() {}
+
+      const std::type_info* type;
+      std::string source;
+      ParsedParameterBase* next;
+    };
+
+    template<class T>
+    struct ParsedParameter : public ParsedParameterBase
+    {
+      ParsedParameter(const std::string& s, const T& v)
+        : ParsedParameterBase(typeid(T), s), value(v)
+      {}
+
+      T value;
+    };
+
+    // Hash index of the values of a ParameterTree by their full dotted
+    // key, with the values parsed for each type. Copies are empty, as the
+    // index points into the maps of the tree it belongs to.
+    class ParameterTreeIndex
+    {
+    public:
+      struct Entry
+      {
+        std::size_t hash;
+        std::string key;
+        const std::string* value;
+        ParameterTreePath path;
+        ParsedParameterBase* parsed;
+        std::size_t next;
+      };
+
+      ParameterTreeIndex() {}
+      ParameterTreeIndex(const ParameterTreeIndex&) {}
+      ParameterTreeIndex& operator=(const ParameterTreeIndex&) { clear(); return *this; }
+      ~ParameterTreeIndex() { clear(); }
+
+      Entry* find(const std::string& key);
+      Entry& insert(const std::string& key, const std::string* value, const ParameterTreePath& path);
+      void clear();
+
+    private:
+      static std::size_t hashKey(const std::string& key);
+
+      std::vector<Entry> entries_;
+      std::vector<std::size_t> heads_;
+    };
+
+  } // end namespace Detail
+#endif // DOXYGEN
+
   /** \brief Hierarchical structure of string parameters
    * \ingroup Common
+   *
+   * get<T>() parses the string of a key only once per type and keeps the
+   * result until the string changes, and it finds keys through a hash
+   * index of the full dotted keys instead of walking the subtrees. Keys
+   * read in inner loops can be resolved once with a Handle:
+   *
+   * \code
+   * ParameterTree::Handle<double> dt = tree.handle<double>("time.step");
+   * for (...)
+   *   t += dt.get();
+   * \endcode
+   *
+   * The caches are updated under a lock of the tree, so several threads
+   * may read a ParameterTree at once, as long as none modifies it.
    */
   class ParameterTree
   {
@@ -36,8 +122,91 @@ namespace Dune {
     template<typename T>
     struct Parser;
 
+    typedef Detail::ParameterTreeIndex::Entry IndexEntry;
+
   public:
 
+    /** \brief A key resolved once, for reading its value repeatedly
+     *
+     * get() checks whether the string of the key still equals the one it
+     * parsed and only parses again if not, so it takes constant time and
+     * does not allocate memory as long as the value does not change.
+     * A Handle refers to the tree it was created from and must not
+     * outlive it; assignments to the tree or its subtrees are detected
+     * and make get() resolve the key again. As a Handle caches the parsed
+     * value itself, each thread has to use its own Handle.
+     *
+     * \tparam T type of the value
+     */
+    template<class T>
+    class Handle
+    {
+    public:
+      //! Creates a handle that refers to no key
+      Handle() : tree_(0), value_(0) {}
+
+      /** \brief Resolves the key in the given tree
+       *
+       * \throws RangeError if the key does not exist or cannot be parsed as T
+       */
+      Handle(const ParameterTree& tree, const std::string& key)
+        : tree_(&tree), key_(key), value_(0)
+      {
+        resolve();
+        source_ = *value_;
+        parsed_ = tree_->parse<T>(source_, key_);
+      }
+
+      /** \brief The value of the key, parsed as T
+       *
+       * \throws RangeError if the key was removed or the value changed and
+       * cannot be parsed as T
+       */
+      const T& get() const
+      {
+        if (!ParameterTree::unchanged(path_))
+          resolve();
+        if (*value_ != source_)
+        {
+          parsed_ = tree_->parse<T>(*value_, key_);
+          source_ = *value_;
+        }
+        return parsed_;
+      }
+
+      //! The key this handle refers to
+      const std::string& key() const
+      {
+        return key_;
+      }
+
+    private:
+      void resolve() const
+      {
+        {
+#if HAVE_STD_THREAD
+          std::lock_guard<std::mutex> guard(tree_->mutex_);
+#endif
+          const IndexEntry* entry = tree_->entry(key_);
+          if (entry)
+          {
+            value_ = entry->value;
+            path_ = entry->path;
+            return;
+          }
+        }
+        DUNE_THROW(RangeError, "Key '" << key_ << "' not found in parameter "
+                   "file!");
+      }
+
+      const ParameterTree* tree_;
+      std::string key_;
+      mutable const std::string* value_;
+      mutable Detail::ParameterTreePath path_;
+      mutable std::string source_;
+      mutable T parsed_;
+    };
+
     /** \brief storage for key lists
      */
     typedef std::vector<std::string> KeyVector;
@@ -46,6 +215,16 @@ namespace Dune {
      */
     ParameterTree();
 
+    /** \brief Copy all keys and substructures of another ParameterTree
+     */
+    ParameterTree(const ParameterTree& other);
+
+    /** \brief Copy all keys and substructures of another ParameterTree
+     *
+     * The handles of this tree resolve their keys again on their next use.
+     */
+    ParameterTree& operator= (const ParameterTree& other);
+
 
     /** \brief test for key
      *
@@ -173,8 +352,12 @@ namespace Dune {
      */
     template<typename T>
     T get(const std::string& key, const T& defaultValue) const {
-      if(hasKey(key))
-        return get<T>(key);
+#if HAVE_STD_THREAD
+      std::lock_guard<std::mutex> guard(mutex_);
+#endif
+      IndexEntry* e = entry(key);
+      if(e)
+        return parseCached<T>(*e);
       else
         return defaultValue;
     }
@@ -189,17 +372,25 @@ namespace Dune {
      */
     template <class T>
     T get(const std::string& key) const {
-      if(not hasKey(key))
+#if HAVE_STD_THREAD
+      std::lock_guard<std::mutex> guard(mutex_);
+#endif
+      IndexEntry* e = entry(key);
+      if(!e)
         DUNE_THROW(RangeError, "Key '" << key << "' not found in parameter "
                    "file!");
-      try {
-        return Parser<T>::parse((*this)[key]);
-      }
-      catch(const RangeError&) {
-        DUNE_THROW(RangeError, "Cannot parse value \"" <<
-                   (*this)[key] << "\" for key \"" << key << "\" as a " <<
-                   className<T>());
-      }
+      return parseCached<T>(*e);
+    }
+
+    /** \brief Resolve a key for reading its value repeatedly
+     *
+     * \tparam T Type of the value
+     * \param key Key name
+     * \throws RangeError if key does not exist or cannot be parsed as T
+     */
+    template <class T>
+    Handle<T> handle(const std::string& key) const {
+      return Handle<T>(*this, key);
     }
 
     /** \brief get value keys
@@ -227,6 +418,63 @@ namespace Dune {
 
     std::map<std::string, std::string> values;
     std::map<std::string, ParameterTree> subs;
+
+    // Renewed by every assignment to this tree, which may destroy values
+    // that indices and handles point to. Generations are unique over all
+    // trees, so a tree constructed in the storage of a destroyed one does
+    // not match its old paths.
+    std::size_t generation_;
+    mutable Detail::ParameterTreeIndex index_;
+#if HAVE_STD_THREAD
+    // guards index_
+    mutable std::mutex mutex_;
+#endif
+
+    // the index entry of key, or 0 if the key does not exist; the caller
+    // holds the lock of the tree
+    IndexEntry* entry(const std::string& key) const;
+
+    // whether no tree on the path was assigned to since it was taken
+    static bool unchanged(const Detail::ParameterTreePath& path)
+    {
+      for (std::size_t i = 0; i < path.size(); ++i)
+        if (path[i].first->generation_ != path[i].second)
+          return false;
+      return !path.empty();
+    }
+
+    template<class T>
+    static T parse(const std::string& str, const std::string& key)
+    {
+      try {
+        return Parser<T>::parse(str);
+      }
+      catch(const RangeError&) {
+        DUNE_THROW(RangeError, "Cannot parse value \"" <<
+                   str << "\" for key \"" << key << "\" as a " <<
+                   className<T>());
+      }
+    }
+
+    // the value of the entry parsed as T, from the cache if it is up to date
+    template<class T>
+    static const T& parseCached(IndexEntry& e)
+    {
+      Detail::ParsedParameterBase* p = e.parsed;
+      while(p && *p->type != typeid(T))
+        p = p->next;
+      if(!p) {
+        p = new Detail::ParsedParameter<T>(*e.value, parse<T>(*e.value, e.key));
+        p->next = e.parsed;
+        e.parsed = p;
+      }
+      else if(p->source != *e.value) {
+        static_cast<Detail::ParsedParameter<T>*>(p)->value = parse<T>(*e.value, e.key);
+        p->source = *e.value;
+      }
+      return static_cast<Detail::ParsedParameter<T>*>(p)->value;
+    }
+
     static std::string ltrim(const std::string& s);
     static std::string rtrim(const std::string& s);
     static std::vector<std::string> split(const std::string & s);
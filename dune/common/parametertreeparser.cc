@@ -159,3 +159,91 @@ void Dune::ParameterTreeParser::readOptions(int argc, char* argv [],
 
 }
 
+namespace {
+
+    void writeSize(std::size_t n, std::vector<char>& blob)
+    {
+        for (; n >= 0x80; n >>= 7)
+            blob.push_back(char(0x80 | (n & 0x7f)));
+        blob.push_back(char(n));
+    }
+
+    void writeString(const std::string& s, std::vector<char>& blob)
+    {
+        writeSize(s.size(), blob);
+        blob.insert(blob.end(), s.begin(), s.end());
+    }
+
+    std::size_t readSize(const std::vector<char>& blob, std::size_t& pos)
+    {
+        std::size_t n = 0;
+        for (int shift = 0; ; shift += 7)
+        {
+            if (pos >= blob.size() || shift >= int(8*sizeof(std::size_t)))
+                DUNE_THROW(Dune::IOError, "Truncated or corrupt binary ParameterTree");
+            const unsigned char byte = blob[pos++];
+            n |= std::size_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return n;
+        }
+    }
+
+    std::string readString(const std::vector<char>& blob, std::size_t& pos)
+    {
+        const std::size_t n = readSize(blob, pos);
+        if (n > blob.size() - pos)
+            DUNE_THROW(Dune::IOError, "Truncated or corrupt binary ParameterTree");
+        pos += n;
+        return std::string(blob.begin() + (pos-n), blob.begin() + pos);
+    }
+
+    void writeTree(const Dune::ParameterTree& pt, std::vector<char>& blob)
+    {
+        const Dune::ParameterTree::KeyVector& valueKeys = pt.getValueKeys();
+        const Dune::ParameterTree::KeyVector& subKeys = pt.getSubKeys();
+        writeSize(valueKeys.size(), blob);
+        for (std::size_t i = 0; i < valueKeys.size(); ++i)
+        {
+            writeString(valueKeys[i], blob);
+            writeString(pt[valueKeys[i]], blob);
+        }
+        writeSize(subKeys.size(), blob);
+        for (std::size_t i = 0; i < subKeys.size(); ++i)
+        {
+            writeString(subKeys[i], blob);
+            writeTree(pt.sub(subKeys[i]), blob);
+        }
+    }
+
+    void readTree(const std::vector<char>& blob, std::size_t& pos,
+                  Dune::ParameterTree& pt, bool overwrite)
+    {
+        for (std::size_t n = readSize(blob, pos); n > 0; --n)
+        {
+            const std::string key = readString(blob, pos);
+            const std::string value = readString(blob, pos);
+            if (overwrite || ! pt.hasKey(key))
+                pt[key] = value;
+        }
+        for (std::size_t n = readSize(blob, pos); n > 0; --n)
+        {
+            const std::string key = readString(blob, pos);
+            readTree(blob, pos, pt.sub(key), overwrite);
+        }
+    }
+
+} // end anonymous namespace
+
+void Dune::ParameterTreeParser::writeBinaryTree(const ParameterTree& pt,
+                                                std::vector<char>& blob)
+{
+    writeTree(pt, blob);
+}
+
+void Dune::ParameterTreeParser::readBinaryTree(const std::vector<char>& blob,
+                                               ParameterTree& pt,
+                                               bool overwrite)
+{
+    std::size_t pos = 0;
+    readTree(blob, pos, pt, overwrite);
+}
@@ -7,10 +7,14 @@
  * \brief Various parser methods to get data into a ParameterTree object
  */
 
+#include <exception>
 #include <istream>
 #include <string>
+#include <vector>
 
+#include <dune/common/exceptions.hh>
 #include <dune/common/parametertree.hh>
+#include <dune/common/parallel/collectivecommunication.hh>
 
 namespace Dune {
 
@@ -117,6 +121,55 @@ namespace Dune {
      */
     static void readINITree(std::string file, ParameterTree& pt, bool overwrite = true);
 
+    /** \brief parse file on one process and broadcast it to all others
+     *
+     * The process root parses the file and broadcasts the resulting tree
+     * in the format of writeBinaryTree(), so that the file system is not
+     * accessed by every process. This is a collective operation; if
+     * reading fails, all processes throw. The root rethrows its exception,
+     * the others throw an IOError if it was one and a Dune::Exception
+     * with its message otherwise.
+     * Command line options read by readOptions() afterwards override
+     * the values of the file as usual.
+     *
+     * \param comm The processes that read the file
+     * \param file filename
+     * \param pt   The parameter tree to store the config structure.
+     * \param overwrite Whether to overwrite already existing values.
+     *                  If false, values in the stream will be ignored
+     *                  if the key is already present.
+     * \param root The rank of the process that reads the file
+     */
+    template<class C>
+    static void readINITree(const CollectiveCommunication<C>& comm, const std::string& file,
+                            ParameterTree& pt, bool overwrite = true, int root = 0);
+
+    //@}
+
+    /** @name Binary format for transferring trees between processes
+     *
+     *  The keys and values are stored with their lengths as variable
+     *  length integers, in the order of appearance in the tree.
+     */
+    //@{
+
+    /** \brief append a compact binary representation of a tree to blob
+     *
+     * \param pt   The parameter tree to write
+     * \param blob The buffer to append to
+     */
+    static void writeBinaryTree(const ParameterTree& pt, std::vector<char>& blob);
+
+    /** \brief read a tree written by writeBinaryTree()
+     *
+     * \param blob The buffer to read
+     * \param pt   The parameter tree to store the config structure.
+     * \param overwrite Whether to overwrite already existing values.
+     * \throw Dune::IOError if the blob is truncated
+     */
+    static void readBinaryTree(const std::vector<char>& blob, ParameterTree& pt,
+                               bool overwrite = true);
+
     //@}
 
     /** \brief parse command line options and build hierarchical ParameterTree structure
@@ -132,8 +185,82 @@ namespace Dune {
      */
     static void readOptions(int argc, char* argv [], ParameterTree& pt);
 
+
+  private:
+    // sends the message of an exception thrown on root, or receives it and
+    // throws it as an IOError (code 1) or Exception (code 2)
+    template<class C>
+    static void broadcastError(const CollectiveCommunication<C>& comm, int root,
+                               int code, std::string message);
   };
 
+  template<class C>
+  void ParameterTreeParser::readINITree(const CollectiveCommunication<C>& comm,
+                                        const std::string& file, ParameterTree& pt,
+                                        bool overwrite, int root)
+  {
+    std::vector<char> blob;
+    if (comm.rank() == root)
+    {
+      try {
+        ParameterTree filePt;
+        readINITree(file, filePt);
+        writeBinaryTree(filePt, blob);
+      }
+      catch (IOError& e) {
+        broadcastError(comm, root, 1, e.what());
+        throw;
+      }
+      catch (Exception& e) {
+        broadcastError(comm, root, 2, e.what());
+        throw;
+      }
+      // the other processes must not wait for the tree forever
+      catch (std::exception& e) {
+        broadcastError(comm, root, 2, e.what());
+        throw;
+      }
+      catch (...) {
+        broadcastError(comm, root, 2, "Unknown exception while reading " + file);
+        throw;
+      }
+    }
+    // the size of the blob, or the negative error code
+    int size = blob.size();
+    comm.broadcast(&size, 1, root);
+    if (size < 0)
+      broadcastError(comm, root, -size, std::string());
+    blob.resize(size);
+    if (size > 0)
+      comm.broadcast(&blob[0], size, root);
+    readBinaryTree(blob, pt, overwrite);
+  }
+
+  template<class C>
+  void ParameterTreeParser::broadcastError(const CollectiveCommunication<C>& comm, int root,
+                                           int code, std::string message)
+  {
+    int header[2] = { -code, int(message.size()) };
+    // the other processes receive the code as the size of the blob
+    if (comm.rank() == root)
+      comm.broadcast(header, 1, root);
+    comm.broadcast(header+1, 1, root);
+    message.resize(header[1]);
+    if (header[1] > 0)
+      comm.broadcast(&message[0], header[1], root);
+    if (comm.rank() == root)
+      return;
+    if (code == 1)
+    {
+      IOError e;
+      e.message(message);
+      throw e;
+    }
+    Exception e;
+    e.message(message);
+    throw e;
+  }
+
 } // end namespace Dune
 
 #endif // DUNE_PARAMETER_PARSER_HH
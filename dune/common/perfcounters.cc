@@ -0,0 +1,103 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "perfcounters.hh"
+
+#if HAVE_PERF_EVENT
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Dune {
+
+#if HAVE_PERF_EVENT
+  namespace {
+
+    const unsigned long long configs[PerfCounters::events] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    int open(unsigned long long config, int group)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = config;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                         | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+    }
+
+  } // end anonymous namespace
+#endif // HAVE_PERF_EVENT
+
+  PerfCounters::PerfCounters()
+    : leader_(-1)
+  {
+    int count = 0;
+    for (int e = 0; e < events; ++e)
+    {
+      fds_[e] = -1;
+      position_[e] = -1;
+#if HAVE_PERF_EVENT
+      fds_[e] = open(configs[e], leader_);
+      if (fds_[e] < 0)
+        continue;
+      if (leader_ < 0)
+        leader_ = fds_[e];
+      position_[e] = count++;
+#endif
+    }
+    (void)count;
+  }
+
+  PerfCounters::~PerfCounters()
+  {
+#if HAVE_PERF_EVENT
+    // the members first, then the leader
+    for (int e = events-1; e >= 0; --e)
+      if (fds_[e] >= 0)
+        close(fds_[e]);
+#endif
+  }
+
+  void PerfCounters::read(Counts& counts) const
+  {
+    for (int e = 0; e < events; ++e)
+      counts[e] = 0;
+#if HAVE_PERF_EVENT
+    if (leader_ < 0)
+      return;
+    // number of counters, time enabled, time running, the counts
+    unsigned long long values[3+events];
+    if (::read(leader_, values, sizeof(values)) < ssize_t(3*sizeof(values[0])))
+      return;
+    // the group was not counting all the time, as other groups used the
+    // hardware counters: extrapolate
+    const double scale = (values[2] > 0 && values[2] < values[1]) ? double(values[1]) / values[2] : 1.0;
+    for (int e = 0; e < events; ++e)
+      if (position_[e] >= 0 && position_[e] < int(values[0]))
+        counts[e] = scale == 1.0 ? values[3+position_[e]]
+                    : static_cast<unsigned long long>(scale * values[3+position_[e]]);
+#endif
+  }
+
+  const char* PerfCounters::name(Event event)
+  {
+    static const char* names[events] = { "cycles", "instructions", "cache misses", "branch misses" };
+    return names[event];
+  }
+
+} // end namespace Dune
@@ -0,0 +1,99 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_PERFCOUNTERS_HH
+#define DUNE_COMMON_PERFCOUNTERS_HH
+
+/** @file
+    @brief Hardware performance counters of the calling thread.
+*/
+
+namespace Dune {
+
+  /** @addtogroup Common
+   @{
+  */
+
+  /**
+   * @brief Counts hardware events of the calling thread with the Linux perf_event_open system call.
+   *
+   * The counters are opened by the constructor as one group, so they are
+   * scheduled together, and count the events of the constructing thread
+   * in user space only, which unprivileged processes may do unless
+   * /proc/sys/kernel/perf_event_paranoid is above 2. Where a counter
+   * cannot be opened, because the system call is missing or forbidden as
+   * in many containers, or the processor does not support the event,
+   * available() is false for it and it stays zero. Counters that the
+   * kernel multiplexes with others are extrapolated to the whole time.
+   *
+   * \code
+   * Dune::PerfCounters counters;
+   * Dune::PerfCounters::Counts before, after;
+   * counters.read(before);
+   * kernel();
+   * counters.read(after);
+   * if (counters.available(Dune::PerfCounters::instructions))
+   *   std::cout << after[Dune::PerfCounters::instructions] - before[Dune::PerfCounters::instructions];
+   * \endcode
+   *
+   * The Profiler uses these counters for its regions if enabled with them.
+   */
+  class PerfCounters
+  {
+  public:
+    //! The counted events
+    enum Event {
+      cycles,       //!< CPU cycles
+      instructions, //!< instructions retired
+      cacheMisses,  //!< last level cache misses
+      branchMisses, //!< mispredicted branches
+      events        //!< the number of events
+    };
+
+    //! The counts of all events
+    typedef unsigned long long Counts[events];
+
+    //! Opens the counters for the calling thread
+    PerfCounters();
+
+    //! Closes the counters
+    ~PerfCounters();
+
+    //! Whether the event is counted
+    bool available(Event event) const
+    {
+      return fds_[event] >= 0;
+    }
+
+    //! Whether any event is counted
+    bool available() const
+    {
+      return fds_[0] >= 0 || fds_[1] >= 0 || fds_[2] >= 0 || fds_[3] >= 0;
+    }
+
+    /**
+     * @brief Stores the current counts of all events.
+     *
+     * Only the constructing thread may read the counters.
+     */
+    void read(Counts& counts) const;
+
+    //! A short name of the event
+    static const char* name(Event event);
+
+  private:
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+
+    // the file descriptors of the counters, -1 if not available; the
+    // first available one leads the group
+    int fds_[events];
+    int leader_;
+    // the position of the counters in the values read from the group
+    int position_[events];
+  };
+
+  /** @} end documentation */
+
+} // end namespace Dune
+
+#endif // DUNE_COMMON_PERFCOUNTERS_HH
@@ -0,0 +1,349 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "profiler.hh"
+
+#include <cstring>
+#include <map>
+#include <unistd.h>
+
+#if HAVE_STD_THREAD
+#include <mutex>
+#endif
+
+namespace Dune {
+
+  Profiler::Flag Profiler::enabled_(false);
+  Profiler::Flag Profiler::cpuTime_(false);
+  Profiler::Flag Profiler::counters_(false);
+
+  namespace {
+
+    const char separator = '\x1f';
+
+    // the trees of all threads, which are kept after the threads ended
+    struct Trees
+    {
+#if HAVE_STD_THREAD
+      std::mutex mutex;
+#endif
+      std::vector<Profiler::Node*> roots;
+      // whether the counters of all threads count the events
+      int available[PerfCounters::events];
+
+      Trees()
+      {
+        for (int e = 0; e < PerfCounters::events; ++e)
+          available[e] = 1;
+      }
+    };
+
+    Trees& trees()
+    {
+      // never destructed, threads may still leave regions at exit
+      static Trees* t = new Trees;
+      return *t;
+    }
+
+    // the innermost region the calling thread is in
+#if HAVE_STD_THREAD
+    thread_local Profiler::Node* current = 0;
+#else
+    Profiler::Node* current = 0;
+#endif
+
+    // the hardware counters of a thread, opened when first read
+    struct ThreadCounters
+    {
+      ThreadCounters() : counters(0) {}
+      ~ThreadCounters() { delete counters; }
+      PerfCounters* counters;
+    };
+#if HAVE_STD_THREAD
+    thread_local ThreadCounters threadCounters;
+#else
+    ThreadCounters threadCounters;
+#endif
+
+    void collect(const Profiler::Node* node, const std::string& path,
+                 std::map<std::string, std::size_t>& index, std::vector<Profiler::Node>& regions)
+    {
+      for (std::size_t i = 0; i < node->children.size(); ++i)
+      {
+        const Profiler::Node* child = node->children[i];
+        const std::string childPath = path.empty() ? child->name : path + separator + child->name;
+        std::map<std::string, std::size_t>::iterator it = index.find(childPath);
+        if (it == index.end())
+        {
+          it = index.insert(std::make_pair(childPath, regions.size())).first;
+          regions.push_back(Profiler::Node("", 0));
+          regions.back().name = childPath;
+        }
+        Profiler::Node& region = regions[it->second];
+        region.calls += child->calls;
+        region.wall = std::max(region.wall, child->wall);
+        region.cpu += child->cpu;
+        region.flops += child->flops;
+        for (int e = 0; e < PerfCounters::events; ++e)
+          region.counts[e] += child->counts[e];
+        collect(child, childPath, index, regions);
+      }
+    }
+
+    // writes num/den, n/a if the counts are not available
+    void writeRatio(std::ostream& out, double num, double den, bool available)
+    {
+      if (available && den > 0)
+        out << std::setw(12) << num / den;
+      else
+        out << std::setw(12) << "n/a";
+    }
+
+  } // end anonymous namespace
+
+  Profiler::Node::~Node()
+  {
+    for (std::size_t i = 0; i < children.size(); ++i)
+      delete children[i];
+  }
+
+  Profiler::Node* Profiler::enter(const char* name)
+  {
+    if (!current)
+    {
+      current = new Node("", 0);
+      Trees& t = trees();
+#if HAVE_STD_THREAD
+      std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+      t.roots.push_back(current);
+    }
+
+    // names are usually literals, so compare the pointers first
+    std::vector<Node*>& children = current->children;
+    Node* node = 0;
+    for (std::size_t i = 0; i < children.size() && !node; ++i)
+      if (children[i]->key == name)
+        node = children[i];
+    for (std::size_t i = 0; i < children.size() && !node; ++i)
+      if (std::strcmp(children[i]->key, name) == 0)
+        node = children[i];
+    if (!node)
+    {
+      node = new Node(name, current);
+      children.push_back(node);
+    }
+    current = node;
+    return node;
+  }
+
+  void Profiler::leave(Node* node, double wall, double cpu, const PerfCounters::Counts* counts)
+  {
+    ++node->calls;
+    node->wall += wall;
+    node->cpu += cpu;
+    if (counts)
+    {
+      PerfCounters::Counts end;
+      readCounters(end);
+      // extrapolated counts of multiplexed counters may decrease
+      for (int e = 0; e < PerfCounters::events; ++e)
+        if (end[e] > (*counts)[e])
+          node->counts[e] += end[e] - (*counts)[e];
+    }
+    current = node->parent;
+  }
+
+  void Profiler::readCounters(PerfCounters::Counts& counts)
+  {
+    if (!threadCounters.counters)
+    {
+      threadCounters.counters = new PerfCounters;
+      Trees& t = trees();
+#if HAVE_STD_THREAD
+      std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+      for (int e = 0; e < PerfCounters::events; ++e)
+        if (!threadCounters.counters->available(PerfCounters::Event(e)))
+          t.available[e] = 0;
+    }
+    threadCounters.counters->read(counts);
+  }
+
+  void Profiler::availableCounters(int* available)
+  {
+    Trees& t = trees();
+#if HAVE_STD_THREAD
+    std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+    for (int e = 0; e < PerfCounters::events; ++e)
+      available[e] = t.available[e];
+  }
+
+  void Profiler::reset()
+  {
+    Trees& t = trees();
+#if HAVE_STD_THREAD
+    std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+    for (std::size_t i = 0; i < t.roots.size(); ++i)
+    {
+      Node* root = t.roots[i];
+      for (std::size_t j = 0; j < root->children.size(); ++j)
+        delete root->children[j];
+      root->children.clear();
+    }
+  }
+
+  std::vector<Profiler::Region> Profiler::regions()
+  {
+    // the regions merged over the threads, with their paths as names
+    std::map<std::string, std::size_t> index;
+    std::vector<Node> merged;
+    {
+      Trees& t = trees();
+#if HAVE_STD_THREAD
+      std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+      for (std::size_t i = 0; i < t.roots.size(); ++i)
+        collect(t.roots[i], "", index, merged);
+    }
+
+    std::vector<Region> result(merged.size());
+    for (std::size_t i = 0; i < merged.size(); ++i)
+    {
+      result[i].path = merged[i].name;
+      result[i].calls = merged[i].calls;
+      result[i].wall = merged[i].wall;
+      result[i].cpu = merged[i].cpu;
+      result[i].flops = merged[i].flops;
+      for (int e = 0; e < PerfCounters::events; ++e)
+        result[i].counts[e] = merged[i].counts[e];
+    }
+    return result;
+  }
+
+  std::vector<std::string> Profiler::split(const std::string& s)
+  {
+    std::vector<std::string> paths;
+    std::string::size_type begin = 0;
+    while (begin < s.size())
+    {
+      std::string::size_type end = s.find('\n', begin);
+      if (end == std::string::npos)
+        end = s.size();
+      paths.push_back(s.substr(begin, end-begin));
+      begin = end+1;
+    }
+    return paths;
+  }
+
+  std::string Profiler::join(const std::vector<std::string>& paths)
+  {
+    std::string s;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+      if (i > 0)
+        s += '\n';
+      s += paths[i];
+    }
+    return s;
+  }
+
+  void Profiler::sortDepthFirst(std::vector<std::string>& paths)
+  {
+    // the children of each region in the order of their first appearance
+    std::map<std::string, std::vector<std::string> > children;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+      const std::string::size_type last = paths[i].rfind(separator);
+      children[last == std::string::npos ? std::string() : paths[i].substr(0, last)].push_back(paths[i]);
+    }
+
+    std::vector<std::string> sorted;
+    std::vector<std::string> stack(1);
+    while (!stack.empty())
+    {
+      const std::string path = stack.back();
+      stack.pop_back();
+      if (!path.empty())
+        sorted.push_back(path);
+      std::map<std::string, std::vector<std::string> >::iterator it = children.find(path);
+      if (it != children.end())
+      {
+        stack.insert(stack.end(), it->second.rbegin(), it->second.rend());
+        children.erase(it);
+      }
+    }
+    paths.swap(sorted);
+  }
+
+  void Profiler::write(std::ostream& out, const std::vector<std::string>& paths,
+                       const std::vector<double>& values, const int* available, int size)
+  {
+    std::vector<std::string> labels(paths.size());
+    std::size_t width = 6;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+      const std::string::size_type last = paths[i].rfind(separator);
+      const std::size_t depth = std::count(paths[i].begin(), paths[i].end(), separator);
+      labels[i] = std::string(2*depth, ' ')
+                  + (last == std::string::npos ? paths[i] : paths[i].substr(last+1));
+      width = std::max(width, labels[i].size());
+    }
+
+    std::ostringstream s;
+    s << std::left << std::setw(width) << "region" << std::right
+      << std::setw(12) << "calls" << std::setw(12) << "wall min" << std::setw(12) << "wall avg"
+      << std::setw(12) << "wall max";
+    if (get(cpuTime_))
+      s << std::setw(12) << "cpu avg";
+    if (get(counters_))
+      s << std::setw(12) << "IPC" << std::setw(12) << "miss/kinst" << std::setw(12) << "MB moved"
+        << std::setw(12) << "B/flop";
+    if (size > 1)
+      s << std::setw(8) << "ranks";
+    s << '\n';
+
+    long line = 64;
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+    if (sysconf(_SC_LEVEL1_DCACHE_LINESIZE) > 0)
+      line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+#endif
+    const int m = 7 + PerfCounters::events;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+      const double* v = &values[m*i];
+      const double flops = v[6];
+      const double* counts = v+7;
+      s.setf(std::ios_base::fmtflags(0), std::ios_base::floatfield);
+      s << std::left << std::setw(width) << labels[i] << std::right << std::setw(12) << v[1];
+      s.setf(std::ios_base::fixed, std::ios_base::floatfield);
+      s << std::setw(12) << v[2] << std::setw(12) << v[3] << std::setw(12) << v[4];
+      if (get(cpuTime_))
+        s << std::setw(12) << v[5];
+      if (get(counters_))
+      {
+        const double bytes = counts[PerfCounters::cacheMisses] * line;
+        const bool misses = available[PerfCounters::cacheMisses];
+        s << std::setprecision(2);
+        writeRatio(s, counts[PerfCounters::instructions], counts[PerfCounters::cycles],
+                   available[PerfCounters::instructions] && available[PerfCounters::cycles]);
+        writeRatio(s, 1000 * counts[PerfCounters::cacheMisses], counts[PerfCounters::instructions],
+                   misses && available[PerfCounters::instructions]);
+        writeRatio(s, bytes, 1e6, misses);
+        writeRatio(s, bytes, flops, misses);
+        s << std::setprecision(6);
+      }
+      if (size > 1)
+        s << std::setw(8) << int(v[0]);
+      s << '\n';
+    }
+    out << s.str() << std::flush;
+  }
+
+} // end namespace Dune
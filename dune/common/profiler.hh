@@ -0,0 +1,375 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_PROFILER_HH
+#define DUNE_COMMON_PROFILER_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <time.h>
+#include <vector>
+
+#if HAVE_STD_THREAD
+#include <atomic>
+#endif
+
+#include <dune/common/parallel/collectivecommunication.hh>
+#include <dune/common/perfcounters.hh>
+
+/** @file
+    @brief Hierarchical wall clock profiling of named program regions.
+*/
+
+namespace Dune {
+
+  /** @addtogroup Common
+   @{
+  */
+
+  /**
+   * @brief Collects the wall clock and optionally CPU times of nested program regions.
+   *
+   * Regions are marked by ScopedRegion objects, which add the time
+   * between their construction and destruction to the region of their
+   * name within the enclosing region of the same thread:
+   *
+   * \code
+   * Dune::Profiler::enable();
+   * {
+   *   Dune::ScopedRegion region("assemble");
+   *   ...
+   *   {
+   *     Dune::ScopedRegion region("quadrature");
+   *     ...
+   *   }
+   * }
+   * Dune::Profiler::report(std::cout, mpihelper.getCollectiveCommunication());
+   * \endcode
+   *
+   * Unlike Timer, the wall clock is the monotonic clock of the system
+   * and the CPU time is that of the calling thread, so both are right
+   * with threads. Every thread records its own tree of regions without
+   * locking. A process reports, for each region, the calls and CPU
+   * time summed over its threads and the wall time of the thread that
+   * spent the longest time in it, and report() shows the minimum,
+   * average and maximum of these over the processes.
+   *
+   * With hardware counters enabled, report() also shows the
+   * instructions per cycle, the last level cache misses per 1000
+   * instructions and, with the line size, the bytes moved from memory.
+   * For regions that state their floating point operations with
+   * ScopedRegion::addFlops() it shows the bytes moved per operation,
+   * which tells bandwidth bound from compute bound kernels. Where the
+   * counters are not available, see PerfCounters, these columns show
+   * n/a.
+   *
+   * While the profiler is disabled, which is the default, a ScopedRegion
+   * only tests a flag.
+   */
+  class Profiler
+  {
+  public:
+    /**
+     * @brief Starts recording the regions entered from now on.
+     *
+     * @param cpuTime  Whether to measure the CPU time of the threads as
+     *                 well, which costs a system call per region.
+     * @param counters Whether to read the hardware counters of the
+     *                 threads as well, which costs two system calls per
+     *                 region.
+     */
+    static void enable(bool cpuTime = false, bool counters = false)
+    {
+      set(cpuTime_, cpuTime);
+      set(counters_, counters);
+      set(enabled_, true);
+    }
+
+    //! Stops recording, regions entered before are still finished
+    static void disable()
+    {
+      set(enabled_, false);
+    }
+
+    //! Whether regions are recorded
+    static bool enabled()
+    {
+      return get(enabled_);
+    }
+
+    /**
+     * @brief Forgets the times recorded so far.
+     *
+     * No thread may be inside a region.
+     */
+    static void reset();
+
+    /**
+     * @brief Writes the times of all regions, aggregated over the processes of comm.
+     *
+     * This is a collective operation; the report is written by the
+     * process root only. Regions entered only by some processes are
+     * reported with the number of these processes. No thread may be
+     * inside a region.
+     */
+    template<class C>
+    static void report(std::ostream& out, const CollectiveCommunication<C>& comm, int root = 0);
+
+    //! Writes the times of all regions of this process
+    static void report(std::ostream& out)
+    {
+      report(out, CollectiveCommunication<No_Comm>());
+    }
+
+    //! The monotonic wall clock time in seconds
+    static double wallTime()
+    {
+      timespec t;
+      clock_gettime(CLOCK_MONOTONIC, &t);
+      return t.tv_sec + 1e-9*t.tv_nsec;
+    }
+
+    //! The CPU time of the calling thread in seconds
+    static double cpuTime()
+    {
+      timespec t;
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+      return t.tv_sec + 1e-9*t.tv_nsec;
+    }
+
+#ifndef DOXYGEN
+    // a region in the tree of a thread
+    struct Node
+    {
+      Node(const char* n, Node* p) : key(n), name(n), parent(p), calls(0), wall(0), cpu(0), flops(0)
+      {
+        for (int e = 0; e < PerfCounters::events; ++e)
+          counts[e] = 0;
+      }
+      ~Node();
+
+      const char* key;
+      std::string name;
+      Node* parent;
+      std::vector<Node*> children;
+      std::size_t calls;
+      double wall;
+      double cpu;
+      unsigned long long counts[PerfCounters::events];
+      double flops;
+    };
+
+    // the region of the given name in the current region of the calling thread
+    static Node* enter(const char* name);
+
+    // counts is null or the counters at the start of the region
+    static void leave(Node* node, double wall, double cpu, const PerfCounters::Counts* counts);
+
+    // the hardware counters of the calling thread
+    static void readCounters(PerfCounters::Counts& counts);
+
+    // the switches are read by every region of every thread, which only
+    // needs to see a change eventually, hence the relaxed order
+#if HAVE_STD_THREAD
+    typedef std::atomic<bool> Flag;
+
+    static bool get(const Flag& flag)
+    {
+      return flag.load(std::memory_order_relaxed);
+    }
+
+    static void set(Flag& flag, bool value)
+    {
+      flag.store(value, std::memory_order_relaxed);
+    }
+#else
+    typedef bool Flag;
+
+    static bool get(Flag flag)
+    {
+      return flag;
+    }
+
+    static void set(Flag& flag, bool value)
+    {
+      flag = value;
+    }
+#endif
+
+    static Flag enabled_;
+    static Flag cpuTime_;
+    static Flag counters_;
+#endif // DOXYGEN
+
+  private:
+    // a region of this process, its path consists of the names from the top
+    // level region on separated by '\x1f'
+    struct Region
+    {
+      std::string path;
+      std::size_t calls;
+      double wall;
+      double cpu;
+      unsigned long long counts[PerfCounters::events];
+      double flops;
+    };
+    static std::vector<Region> regions();
+
+    // whether the processes count the events in all threads
+    static void availableCounters(int* available);
+
+    static std::vector<std::string> split(const std::string& s);
+    static std::string join(const std::vector<std::string>& paths);
+    static void sortDepthFirst(std::vector<std::string>& paths);
+    static void write(std::ostream& out, const std::vector<std::string>& paths,
+                      const std::vector<double>& values, const int* available, int size);
+  };
+
+  /**
+   * @brief Marks a region of the program from its construction to its destruction.
+   *
+   * The name must stay valid until Profiler::reset() or the end of
+   * the program, as it identifies the region; string literals are best.
+   */
+  class ScopedRegion
+  {
+  public:
+    //! Enters the region of the given name if the Profiler is enabled
+    explicit ScopedRegion(const char* name)
+      : node_(0)
+    {
+      if (Profiler::get(Profiler::enabled_))
+      {
+        node_ = Profiler::enter(name);
+        counted_ = Profiler::get(Profiler::counters_);
+        if (counted_)
+          Profiler::readCounters(counts_);
+        timed_ = Profiler::get(Profiler::cpuTime_);
+        cpu_ = timed_ ? Profiler::cpuTime() : 0;
+        wall_ = Profiler::wallTime();
+      }
+    }
+
+    //! Leaves the region
+    ~ScopedRegion()
+    {
+      if (node_)
+        Profiler::leave(node_, Profiler::wallTime() - wall_,
+                        timed_ ? Profiler::cpuTime() - cpu_ : 0,
+                        counted_ ? &counts_ : 0);
+    }
+
+    //! Adds floating point operations done in the region, for the bytes per operation
+    void addFlops(double flops)
+    {
+      if (node_)
+        node_->flops += flops;
+    }
+
+  private:
+    ScopedRegion(const ScopedRegion&);
+    ScopedRegion& operator=(const ScopedRegion&);
+
+    Profiler::Node* node_;
+    double wall_;
+    double cpu_;
+    bool timed_;
+    bool counted_;
+    PerfCounters::Counts counts_;
+  };
+
+  template<class C>
+  void Profiler::report(std::ostream& out, const CollectiveCommunication<C>& comm, int root)
+  {
+    const std::vector<Region> local = regions();
+    std::vector<std::string> localPaths(local.size());
+    for (std::size_t i = 0; i < local.size(); ++i)
+      localPaths[i] = local[i].path;
+
+    // agree on the union of the regions: the process with the lowest
+    // rank that knows regions not in the list yet sends them
+    std::vector<std::string> paths;
+    for (int sender = root; ; )
+    {
+      std::string missing;
+      if (comm.rank() == sender)
+      {
+        std::vector<std::string> add;
+        for (std::size_t i = 0; i < localPaths.size(); ++i)
+          if (std::find(paths.begin(), paths.end(), localPaths[i]) == paths.end())
+            add.push_back(localPaths[i]);
+        missing = join(add);
+      }
+      int length = missing.size();
+      comm.broadcast(&length, 1, sender);
+      missing.resize(length);
+      if (length > 0)
+        comm.broadcast(&missing[0], length, sender);
+      const std::vector<std::string> add = split(missing);
+      paths.insert(paths.end(), add.begin(), add.end());
+
+      bool complete = true;
+      for (std::size_t i = 0; i < localPaths.size() && complete; ++i)
+        complete = std::find(paths.begin(), paths.end(), localPaths[i]) != paths.end();
+      int next = complete ? comm.size() : comm.rank();
+      next = comm.min(next);
+      if (next == comm.size())
+        break;
+      sender = next;
+    }
+    sortDepthFirst(paths);
+
+    // per region: processes, calls, wall time, CPU time, counts and
+    // operations summed, wall time minimum and maximum
+    const std::size_t n = paths.size();
+    const int m = 5 + PerfCounters::events;
+    std::vector<double> sums(m*n+1, 0.0), minima(n+1, std::numeric_limits<double>::max()),
+      maxima(n+1, -std::numeric_limits<double>::max());
+    for (std::size_t i = 0; i < local.size(); ++i)
+    {
+      const std::size_t j = std::find(paths.begin(), paths.end(), local[i].path) - paths.begin();
+      sums[m*j] = 1;
+      sums[m*j+1] = local[i].calls;
+      sums[m*j+2] = local[i].wall;
+      sums[m*j+3] = local[i].cpu;
+      sums[m*j+4] = local[i].flops;
+      for (int e = 0; e < PerfCounters::events; ++e)
+        sums[m*j+5+e] = local[i].counts[e];
+      minima[j] = maxima[j] = local[i].wall;
+    }
+    comm.sum(&sums[0], sums.size());
+    comm.min(&minima[0], minima.size());
+    comm.max(&maxima[0], maxima.size());
+    int available[PerfCounters::events];
+    availableCounters(available);
+    comm.min(available, PerfCounters::events);
+
+    if (comm.rank() != root)
+      return;
+    // per region: processes, calls, wall time minimum, average and
+    // maximum, then the averages of CPU time, operations and counts
+    std::vector<double> values((m+2)*n);
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      double* v = &values[(m+2)*j];
+      const double* s = &sums[m*j];
+      v[0] = s[0];
+      v[1] = s[1] / s[0];
+      v[2] = minima[j];
+      v[3] = s[2] / s[0];
+      v[4] = maxima[j];
+      for (int k = 3; k < m; ++k)
+        v[k+2] = s[k] / s[0];
+    }
+    write(out, paths, values, available, comm.size());
+  }
+
+  /** @} end documentation */
+
+} // end namespace Dune
+
+#endif // DUNE_COMMON_PROFILER_HH
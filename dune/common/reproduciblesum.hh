@@ -0,0 +1,244 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_REPRODUCIBLESUM_HH
+#define DUNE_COMMON_REPRODUCIBLESUM_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+#include <dune/common/densevector.hh>
+
+/** @file
+    @brief An exact accumulator for sums of doubles that do not depend on the order of the terms.
+*/
+
+namespace Dune {
+
+  /** @addtogroup Common
+   *
+   * @{
+   */
+
+  /**
+   * @brief Accumulates doubles exactly, so that the sum does not depend on their order.
+   *
+   * Every term is split into 32 bit pieces at fixed binary exponents and
+   * the pieces are added to 64 bit integer bins, one per 32 exponents of
+   * the range of double. Integer additions are associative, so the bins,
+   * and the value() rounded from them, are the same for any order and any
+   * partitioning of the terms. In particular a parallel sum
+   *
+   * \code
+   * Dune::ReproducibleSum local = Dune::reproducibleDot(x, y);
+   * double global = comm.sum(local).value();
+   * \endcode
+   *
+   * gives the same bits for any number of processes: the custom MPI_Op
+   * that CollectiveCommunication creates from operator+ merges the bins
+   * exactly, whatever the reduction tree.
+   *
+   * value() is the exact sum correctly rounded to the nearest double,
+   * except for results in the subnormal range, which may be rounded twice.
+   * Infinite and NaN terms are added up separately and dominate the result.
+   *
+   * An addition costs a few integer operations instead of one floating
+   * point one and the accumulator occupies about half a kilobyte, so use
+   * it where reproducibility is required, not as the default.
+   */
+  class ReproducibleSum
+  {
+  public:
+    //! Constructs a zero sum
+    ReproducibleSum()
+    {
+      clear();
+    }
+
+    //! Constructs the sum of the single term x
+    explicit ReproducibleSum(double x)
+    {
+      clear();
+      *this += x;
+    }
+
+    //! Resets the sum to zero
+    void clear()
+    {
+      std::fill(bins_, bins_+bins, int64_t(0));
+      special_ = 0;
+      pending_ = 0;
+    }
+
+    //! Adds the term x
+    ReproducibleSum& operator+=(double x)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, &x, sizeof(bits));
+      const int biasedExponent = int((bits>>52) & 0x7ff);
+      uint64_t mantissa = bits & ((uint64_t(1)<<52)-1);
+      if (biasedExponent == 0x7ff)
+        {
+          special_ += x;
+          return *this;
+        }
+      // x = +-mantissa*2^(position-1074)
+      int position = 0;
+      if (biasedExponent != 0)
+        {
+          mantissa |= uint64_t(1)<<52;
+          position = biasedExponent-1;
+        }
+      const int bin = position>>5, shift = position&31;
+      const uint64_t low = (mantissa<<shift) & 0xffffffffu;
+      const uint64_t rest = mantissa>>(32-shift);
+      if (bits>>63)
+        {
+          bins_[bin] -= int64_t(low);
+          bins_[bin+1] -= int64_t(rest & 0xffffffffu);
+          bins_[bin+2] -= int64_t(rest>>32);
+        }
+      else
+        {
+          bins_[bin] += int64_t(low);
+          bins_[bin+1] += int64_t(rest & 0xffffffffu);
+          bins_[bin+2] += int64_t(rest>>32);
+        }
+      if (++pending_ >= maxPending)
+        normalize();
+      return *this;
+    }
+
+    //! Adds all terms of another sum
+    ReproducibleSum& operator+=(const ReproducibleSum& other)
+    {
+      for (int i = 0; i < bins; ++i)
+        bins_[i] += other.bins_[i];
+      special_ += other.special_;
+      pending_ += other.pending_+1;
+      if (pending_ >= maxPending)
+        normalize();
+      return *this;
+    }
+
+    //! Adds the terms of the range [first,last)
+    template<class InputIterator>
+    void add(InputIterator first, InputIterator last)
+    {
+      for (; first != last; ++first)
+        *this += double(*first);
+    }
+
+    //! Returns the sum rounded to the nearest double
+    double value() const
+    {
+      if (special_ != 0)
+        return special_;
+
+      ReproducibleSum s(*this);
+      s.normalize();
+      const bool negative = s.bins_[bins-1] < 0;
+      if (negative)
+        {
+          for (int i = 0; i < bins; ++i)
+            s.bins_[i] = -s.bins_[i];
+          s.normalize();
+        }
+      int top = bins-1;
+      while (top >= 0 && s.bins_[top] == 0)
+        --top;
+      if (top < 0)
+        return 0.0;
+      if (top == bins-1)
+        return negative ? -HUGE_VAL : HUGE_VAL;
+
+      // the leading 64 bits, the bits below decide the rounding only
+      const uint64_t b0 = uint64_t(s.bins_[top]);
+      const uint64_t b1 = top >= 1 ? uint64_t(s.bins_[top-1]) : 0;
+      const uint64_t b2 = top >= 2 ? uint64_t(s.bins_[top-2]) : 0;
+      bool sticky = false;
+      for (int i = 0; i < top-2; ++i)
+        sticky = sticky || s.bins_[i] != 0;
+      uint64_t significand = (b0<<32) | b1;
+      int zeros = 0;
+      while (!(significand>>63))
+        {
+          significand <<= 1;
+          ++zeros;
+        }
+      significand |= b2>>(32-zeros);
+      sticky = sticky || (b2 & ((uint64_t(1)<<(32-zeros))-1)) != 0;
+
+      // round to nearest, ties to even
+      uint64_t mantissa = significand>>11;
+      const uint64_t remainder = significand & 0x7ff;
+      if (remainder > 0x400 || (remainder == 0x400 && (sticky || (mantissa & 1))))
+        ++mantissa;
+      const double magnitude = std::ldexp(double(mantissa), 32*(top-1)-1074-zeros+11);
+      return negative ? -magnitude : magnitude;
+    }
+
+    //! Returns the sum of the terms of a and b
+    friend ReproducibleSum operator+(const ReproducibleSum& a, const ReproducibleSum& b)
+    {
+      ReproducibleSum s(a);
+      s += b;
+      return s;
+    }
+
+  private:
+    /* 2098 bits of finite doubles in bins of 32 bits, and one bin for the
+       carries of sums beyond the range of double */
+    enum { bins = 67 };
+    /* The bins hold at most 2^32 after a normalization and grow by less
+       than 2^32 per term, so they cannot overflow before maxPending terms. */
+    enum { maxPending = 1<<29 };
+
+    /* Moves the carries up, leaving all bins but the top one in [0,2^32). */
+    void normalize()
+    {
+      for (int i = 0; i < bins-1; ++i)
+        {
+          const int64_t carry = bins_[i] >= 0 ? bins_[i]>>32 : -((-(bins_[i]+1))>>32)-1;
+          bins_[i] -= carry*(int64_t(1)<<32);
+          bins_[i+1] += carry;
+        }
+      pending_ = 0;
+    }
+
+    int64_t bins_[bins];
+    double special_;
+    int64_t pending_;
+  };
+
+  /**
+   * @brief The dot product \f$x^T y\f$ of real vectors with the products summed up by a ReproducibleSum.
+   *
+   * The products are formed in double in blocks, which the compiler can
+   * vectorize, and added to the accumulator afterwards.
+   */
+  template<class V1, class V2>
+  ReproducibleSum reproducibleDot(const DenseVector<V1>& x, const DenseVector<V2>& y)
+  {
+    assert(x.size() == y.size());
+    const std::size_t blockSize = 256;
+    double products[blockSize];
+    ReproducibleSum sum;
+    for (std::size_t begin = 0; begin < x.size(); begin += blockSize)
+      {
+        const std::size_t n = std::min<std::size_t>(blockSize, x.size()-begin);
+        for (std::size_t i = 0; i < n; ++i)
+          products[i] = double(x[begin+i])*double(y[begin+i]);
+        sum.add(products, products+n);
+      }
+    return sum;
+  }
+
+  /** @} */
+
+} // end namespace Dune
+
+#endif // DUNE_COMMON_REPRODUCIBLESUM_HH
@@ -5,8 +5,10 @@
  * \brief An stl-compliant random-access container which stores everything on the stack
 */
 
+#include <algorithm>
 #include <iostream>
 #include <dune/common/genericiterator.hh>
+#include <dune/common/hash.hh>
 
 #ifdef CHECK_RESERVEDVECTOR
 #define CHECKSIZE(X) assert(X)
@@ -191,6 +193,27 @@ namespace Dune
             return s;
         }
 
+        //! Compare the elements of two vectors
+        friend bool operator== (const ReservedVector& a, const ReservedVector& b)
+        {
+            return a.sz == b.sz && std::equal(a.data, a.data+a.sz, b.data);
+        }
+
+        //! Compare the elements of two vectors
+        friend bool operator!= (const ReservedVector& a, const ReservedVector& b)
+        {
+            return !(a == b);
+        }
+
+#if HAVE_DUNE_HASH
+
+        inline friend std::size_t hash_value(const ReservedVector& v)
+        {
+            return hash_sequence(v.data, v.data+v.sz);
+        }
+
+#endif // HAVE_DUNE_HASH
+
     private:
         T data[n];
         size_type sz;
@@ -198,6 +221,8 @@ namespace Dune
     
 }
 
+DUNE_DEFINE_HASH(DUNE_HASH_TEMPLATE_ARGS(class T, int n),DUNE_HASH_TYPE(Dune::ReservedVector<T,n>))
+
 #undef CHECKSIZE
 
 #endif // RESERVEDVECTOR_HH
@@ -0,0 +1,295 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+// $Id$
+#ifndef DUNE_COMMON_SIZECLASSALLOCATOR_HH
+#define DUNE_COMMON_SIZECLASSALLOCATOR_HH
+
+/** \file
+ * \brief An stl-compliant allocator serving arrays from pools of size classes.
+ */
+
+#include"poolallocator.hh"
+#include"mallocallocator.hh"
+#include<new>
+
+namespace Dune
+{
+  /**
+   * @addtogroup Allocators
+   *
+   * @{
+   */
+
+#ifndef DOXYGEN
+  namespace Detail
+  {
+    /** @brief Storage for n objects of type T. Never constructed. */
+    template<class T, std::size_t n>
+    struct SizeClassBlock
+    {
+      T data_[n];
+    };
+
+    /**
+     * @brief The number of size classes such that the biggest class
+     * still fits into m bytes.
+     */
+    template<std::size_t bytes, std::size_t m, bool fits=(bytes<=m)>
+    struct SizeClassCount
+    {
+      enum { value = 1 + SizeClassCount<2*bytes,m>::value };
+    };
+
+    template<std::size_t bytes, std::size_t m>
+    struct SizeClassCount<bytes,m,false>
+    {
+      enum { value = 0 };
+    };
+
+    /**
+     * @brief The pools of the size classes c,...,classes-1.
+     *
+     * Size class c holds blocks of 2^c objects.
+     */
+    template<class T, std::size_t s, std::size_t c, std::size_t classes>
+    struct SizeClassPools
+    {
+      typedef Pool<SizeClassBlock<T,(std::size_t(1)<<c)>, s> PoolType;
+      typedef SizeClassPools<T,s,c+1,classes> Next;
+
+      static PoolType& pool()
+      {
+        // function local to be usable during static initialization.
+        static PoolType pool_;
+        return pool_;
+      }
+
+      static void* allocate(std::size_t sizeClass)
+      {
+        if(sizeClass==c)
+          return pool().allocate();
+        return Next::allocate(sizeClass);
+      }
+
+      static void free(void* p, std::size_t sizeClass)
+      {
+        if(sizeClass==c)
+          pool().free(p);
+        else
+          Next::free(p, sizeClass);
+      }
+    };
+
+    template<class T, std::size_t s, std::size_t classes>
+    struct SizeClassPools<T,s,classes,classes>
+    {
+      static void* allocate(std::size_t)
+      {
+        assert(false);
+        return 0;
+      }
+
+      static void free(void*, std::size_t)
+      {
+        assert(false);
+      }
+    };
+  }
+#endif
+
+  /**
+   * @brief An allocator serving arrays of objects from pools.
+   *
+   * In contrast to PoolAllocator arbitrary numbers of objects can
+   * be allocated. Hence it can be used in standard containers like
+   * std::vector (see also DynamicVector).
+   *
+   * A request for n objects is rounded up to the next power of two,
+   * the size class. For each size class there is a Pool serving
+   * blocks of that number of objects. Requests that do not fit into
+   * the biggest size class, i.e. need more than m bytes, are sent
+   * to MallocAllocator.
+   *
+   * The pools are shared by all allocators with the same template
+   * parameters. Like PoolAllocator this allocator is not thread-safe.
+   *
+   * \tparam T The type that will be allocated.
+   * \tparam m The maximum number of bytes of a request served from
+   * the pools.
+   * \tparam s The size of a memory chunk of the pools in bytes.
+   */
+  template<class T, std::size_t m=1024, std::size_t s=8192>
+  class SizeClassAllocator
+  {
+  public:
+    /** @brief Type of the values we construct and allocate. */
+    typedef T value_type;
+
+    /** @brief The pointer type. */
+    typedef T* pointer;
+
+    /** @brief The constant pointer type. */
+    typedef const T* const_pointer;
+
+    /** @brief The reference type. */
+    typedef T& reference;
+
+    /** @brief The constant reference type. */
+    typedef const T& const_reference;
+
+    /** @brief The size type. */
+    typedef std::size_t size_type;
+
+    /** @brief The difference_type. */
+    typedef std::ptrdiff_t difference_type;
+
+    enum
+    {
+      /**
+       * @brief The number of size classes.
+       *
+       * Size class c serves requests of up to 2^c objects.
+       */
+      classes = Detail::SizeClassCount<sizeof(T),m>::value,
+
+      /** @brief The maximum number of objects served from the pools. */
+      maxPooled = classes>0 ? (1<<(classes-1)) : 0
+    };
+
+    /** @brief Constructor. */
+    inline SizeClassAllocator()
+    {}
+
+    /** @brief Copy Constructor. */
+    template<typename U>
+    inline SizeClassAllocator(const SizeClassAllocator<U,m,s>&)
+    {}
+
+    /**
+     * @brief Get the size class of a request.
+     * @param n The number of objects requested.
+     * @return The size class or classes if the request
+     * is not served from the pools.
+     */
+    static size_type sizeClass(size_type n)
+    {
+      if(n>static_cast<size_type>(maxPooled))
+        return classes;
+      size_type c=0;
+      while((size_type(1)<<c)<n)
+        ++c;
+      return c;
+    }
+
+    /**
+     * @brief Allocates objects.
+     * @param n The number of objects to allocate.
+     * @param hint Ignored hint.
+     * @return A pointer tp the allocated elements.
+     */
+    inline pointer allocate(size_type n, const void* hint=0)
+    {
+      size_type c = sizeClass(n);
+      if(c<static_cast<size_type>(classes))
+        return static_cast<pointer>(Pools::allocate(c));
+      return MallocAllocator<T>().allocate(n, hint);
+    }
+
+    /**
+     * @brief Free objects.
+     *
+     * Does not call the destructor!
+     * @param p Pointer to the first object.
+     * @param n The number of objects to free. Has to be the number
+     * used for the allocation.
+     */
+    inline void deallocate(pointer p, size_type n)
+    {
+      size_type c = sizeClass(n);
+      if(c<static_cast<size_type>(classes))
+        Pools::free(p, c);
+      else
+        MallocAllocator<T>().deallocate(p, n);
+    }
+
+    /**
+     * @brief Construct an object.
+     * @param p Pointer to the object.
+     * @param value The value to initialize it to.
+     */
+    inline void construct(pointer p, const_reference value)
+    {
+      ::new (static_cast<void*>(p)) T(value);
+    }
+
+#if HAVE_VARIADIC_TEMPLATES || DOXYGEN
+    //! construct an object of type T from variadic parameters
+    //! \note works only with newer C++ compilers
+    template<typename... _Args>
+    void construct(pointer p, _Args&&... __args)
+    {
+      ::new((void *)p) T(std::forward<_Args>(__args)...);
+    }
+#endif
+
+    /**
+     * @brief Destroy an object without freeing memory.
+     * @param p Pointer to the object.
+     */
+    inline void destroy(pointer p)
+    {
+      p->~T();
+    }
+
+    /** @brief Convert a reference to a pointer. */
+    inline pointer  address(reference x) const { return &x; }
+
+    /** @brief Convert a reference to a pointer. */
+    inline const_pointer address(const_reference x) const { return &x; }
+
+    /** @brief The maximum number of objects that can be allocated. */
+    inline size_type max_size() const throw()
+    {
+      return MallocAllocator<T>().max_size();
+    }
+
+    /**
+     * @brief Rebind the allocator to another type.
+     */
+    template<class U>
+    struct rebind
+    {
+      typedef SizeClassAllocator<U,m,s> other;
+    };
+
+  private:
+    typedef Detail::SizeClassPools<T,s,0,classes> Pools;
+  };
+
+  template<typename T1, typename T2, std::size_t m, std::size_t s>
+  bool operator==(const SizeClassAllocator<T1,m,s>&, const SizeClassAllocator<T2,m,s>&)
+  {
+    return false;
+  }
+
+  template<typename T1, typename T2, std::size_t m, std::size_t s>
+  bool operator!=(const SizeClassAllocator<T1,m,s>&, const SizeClassAllocator<T2,m,s>&)
+  {
+    return true;
+  }
+
+  template<typename T, std::size_t m, std::size_t s>
+  bool operator==(const SizeClassAllocator<T,m,s>&, const SizeClassAllocator<T,m,s>&)
+  {
+    return true;
+  }
+
+  template<typename T, std::size_t m, std::size_t s>
+  bool operator!=(const SizeClassAllocator<T,m,s>&, const SizeClassAllocator<T,m,s>&)
+  {
+    return false;
+  }
+
+  /** @} */
+}
+#endif
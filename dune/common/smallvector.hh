@@ -0,0 +1,479 @@
+#ifndef DUNE_COMMON_SMALLVECTOR_HH
+#define DUNE_COMMON_SMALLVECTOR_HH
+
+/** \file
+ * \brief An stl-compliant random-access container which stores small sizes on the stack
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include <dune/common/alignment.hh>
+#include <dune/common/hash.hh>
+#include <dune/common/static_assert.hh>
+
+namespace Dune
+{
+    /**
+       \brief A vector which stores up to n elements without allocating.
+
+       SmallVector has the interface of ReservedVector, but it is not
+       limited to n elements. The first n elements are stored inline,
+       i.e. on the stack if the SmallVector is. When the vector grows
+       beyond n, all elements are moved to memory obtained from the
+       allocator and the capacity grows geometrically like the one of
+       std::vector.
+
+       The elements are stored contiguously, hence the iterators are
+       plain pointers. In contrast to ReservedVector only the elements
+       within size() are constructed.
+
+       Size it for the typical case, e.g. the number of neighbours
+       of most elements, and the rare big cases still work.
+
+       \tparam T The data type SmallVector stores.
+       \tparam n The number of objects stored inline.
+       \tparam A The allocator used beyond n objects.
+     */
+    template<class T, int n, class A = std::allocator<T> >
+    class SmallVector
+    {
+        dune_static_assert(n > 0, "SmallVector needs an inline capacity");
+
+    public:
+
+        /** @{ Typedefs */
+
+        //! The type of object, T, stored in the vector.
+        typedef T value_type;
+        //! Pointer to T.
+        typedef T* pointer;
+        //! Const pointer to T.
+        typedef const T* const_pointer;
+        //! Reference to T
+        typedef T& reference;
+        //! Const reference to T
+        typedef const T& const_reference;
+        //! An unsigned integral type.
+        typedef std::size_t size_type;
+        //! A signed integral type.
+        typedef std::ptrdiff_t difference_type;
+        //! Iterator used to iterate through a vector.
+        typedef T* iterator;
+        //! Const iterator used to iterate through a vector.
+        typedef const T* const_iterator;
+        //! The type of the allocator.
+        typedef A allocator_type;
+
+        /** @} */
+
+        /** @{ Constructors */
+
+        //! Constructor
+        SmallVector(const A& allocator = A())
+            : data_(inlineData()), sz_(0), capacity_(n), allocator_(allocator)
+        {}
+
+        //! Constructor with s copies of value
+        explicit SmallVector(size_type s, const T& value = T(), const A& allocator = A())
+            : data_(inlineData()), sz_(0), capacity_(n), allocator_(allocator)
+        {
+            try {
+                resize(s, value);
+            }
+            catch (...) {
+                deallocate();
+                throw;
+            }
+        }
+
+        //! Copy constructor
+        SmallVector(const SmallVector& other)
+            : data_(inlineData()), sz_(0), capacity_(n), allocator_(other.allocator_)
+        {
+            reserve(other.sz_);
+            try {
+                std::uninitialized_copy(other.begin(), other.end(), data_);
+            }
+            catch (...) {
+                // the destructor does not run for a throwing constructor
+                deallocate();
+                throw;
+            }
+            sz_ = other.sz_;
+        }
+
+#if HAVE_RVALUE_REFERENCES || DOXYGEN
+        //! Move constructor, steals the memory of a vector beyond n elements
+        SmallVector(SmallVector&& other)
+            : data_(inlineData()), sz_(0), capacity_(n), allocator_(other.allocator_)
+        {
+            moveFrom(other);
+        }
+#endif
+
+        //! Destructor
+        ~SmallVector()
+        {
+            clear();
+            deallocate();
+        }
+
+        //! Assignment operator
+        SmallVector& operator=(const SmallVector& other)
+        {
+            if (this != &other) {
+                clear();
+                reserve(other.sz_);
+                std::uninitialized_copy(other.begin(), other.end(), data_);
+                sz_ = other.sz_;
+            }
+            return *this;
+        }
+
+#if HAVE_RVALUE_REFERENCES || DOXYGEN
+        //! Move assignment operator
+        SmallVector& operator=(SmallVector&& other)
+        {
+            if (this != &other) {
+                clear();
+                deallocate();
+                moveFrom(other);
+            }
+            return *this;
+        }
+#endif
+
+        /** @} */
+
+        /** @{ Data access operations */
+
+        //! Erases all elements. The capacity is kept.
+        void clear()
+        {
+            destroy(data_, data_+sz_);
+            sz_ = 0;
+        }
+
+        //! Specifies a new size for the vector, new elements are copies of value.
+        void resize(size_type s, const T& value = T())
+        {
+            if (s < sz_)
+                destroy(data_+s, data_+sz_);
+            else {
+                reserve(s);
+                std::uninitialized_fill(data_+sz_, data_+s, value);
+            }
+            sz_ = s;
+        }
+
+        //! Makes sure that s elements fit without reallocation.
+        void reserve(size_type s)
+        {
+            if (s > capacity_)
+                reallocate(std::max(s, 2*capacity_));
+        }
+
+        //! Appends an element to the end of a vector, amortized O(1) time.
+        void push_back(const T& t)
+        {
+            if (sz_ == capacity_) {
+                // t might be an element of this vector
+                T copy(t);
+                reallocate(2*capacity_);
+                allocator_.construct(data_+sz_, copy);
+            }
+            else
+                allocator_.construct(data_+sz_, t);
+            ++sz_;
+        }
+
+#if HAVE_VARIADIC_TEMPLATES || DOXYGEN
+        //! Constructs an element at the end of a vector, amortized O(1) time.
+        template<typename... Args>
+        void emplace_back(Args&&... args)
+        {
+            if (sz_ == capacity_) {
+                // args might refer to elements of this vector
+                T t(std::forward<Args>(args)...);
+                reallocate(2*capacity_);
+                ::new (static_cast<void*>(data_+sz_)) T(std::move(t));
+            }
+            else
+                ::new (static_cast<void*>(data_+sz_)) T(std::forward<Args>(args)...);
+            ++sz_;
+        }
+#endif
+
+        //! Erases the last element of the vector, O(1) time.
+        void pop_back()
+        {
+            if (! empty()) {
+                --sz_;
+                allocator_.destroy(data_+sz_);
+            }
+        }
+
+        //! Exchanges the contents with another vector.
+        void swap(SmallVector& other)
+        {
+#if HAVE_RVALUE_REFERENCES
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+#else
+            SmallVector tmp(other);
+            other = *this;
+            *this = tmp;
+#endif
+        }
+
+        //! Returns a iterator pointing to the beginning of the vector.
+        iterator begin(){
+            return data_;
+        }
+
+        //! Returns a const_iterator pointing to the beginning of the vector.
+        const_iterator begin() const{
+            return data_;
+        }
+
+        //! Returns an iterator pointing to the end of the vector.
+        iterator end(){
+            return data_+sz_;
+        }
+
+        //! Returns a const_iterator pointing to the end of the vector.
+        const_iterator end() const{
+            return data_+sz_;
+        }
+
+        //! Returns reference to the i'th element.
+        reference operator[] (size_type i)
+        {
+            assert(i < sz_);
+            return data_[i];
+        }
+
+        //! Returns a const reference to the i'th element.
+        const_reference operator[] (size_type i) const
+        {
+            assert(i < sz_);
+            return data_[i];
+        }
+
+        //! Returns reference to first element of vector.
+        reference front()
+        {
+            assert(sz_ > 0);
+            return data_[0];
+        }
+
+        //! Returns const reference to first element of vector.
+        const_reference front() const
+        {
+            assert(sz_ > 0);
+            return data_[0];
+        }
+
+        //! Returns reference to last element of vector.
+        reference back()
+        {
+            assert(sz_ > 0);
+            return data_[sz_-1];
+        }
+
+        //! Returns const reference to last element of vector.
+        const_reference back() const
+        {
+            assert(sz_ > 0);
+            return data_[sz_-1];
+        }
+
+        //! Returns a pointer to the first element.
+        pointer data()
+        {
+            return data_;
+        }
+
+        //! Returns a const pointer to the first element.
+        const_pointer data() const
+        {
+            return data_;
+        }
+
+        /** @} */
+
+        /** @{ Informative Methods */
+
+        //! Returns number of elements in the vector.
+        size_type size () const
+        {
+            return sz_;
+        }
+
+        //! Returns true if vector has no elements.
+        bool empty() const
+        {
+            return sz_==0;
+        }
+
+        //! Returns current capacity (allocated memory) of the vector.
+        size_type capacity() const
+        {
+            return capacity_;
+        }
+
+        //! Returns the maximum length of the vector.
+        size_type max_size() const
+        {
+            return allocator_.max_size();
+        }
+
+        //! Returns the number of elements stored inline.
+        static size_type inlineCapacity()
+        {
+            return n;
+        }
+
+        //! Returns true if the elements are stored inline.
+        bool isInline() const
+        {
+            return data_ == inlineData();
+        }
+
+        /** @} */
+
+        //! Send SmallVector to an output stream
+        friend std::ostream& operator<< (std::ostream& s, const SmallVector& v)
+        {
+            for (size_t i=0; i<v.size(); i++)
+                s << v[i] << "  ";
+            return s;
+        }
+
+#if HAVE_DUNE_HASH
+
+        inline friend std::size_t hash_value(const SmallVector& v)
+        {
+            return hash_sequence(v.begin(), v.end());
+        }
+
+#endif // HAVE_DUNE_HASH
+
+    private:
+
+        /** \brief Inline storage for n objects, aligned for all fundamental types */
+        union Storage
+        {
+            char bytes[n*sizeof(T)];
+            long double longDouble;
+            long long longLong;
+            void* pointer;
+        };
+
+        dune_static_assert(int(AlignmentOf<T>::value) <= int(AlignmentOf<Storage>::value),
+                           "SmallVector does not support over-aligned types");
+
+        T* inlineData()
+        {
+            return reinterpret_cast<T*>(storage_.bytes);
+        }
+
+        const T* inlineData() const
+        {
+            return reinterpret_cast<const T*>(storage_.bytes);
+        }
+
+        void destroy(T* first, T* last)
+        {
+            for (; first != last; ++first)
+                allocator_.destroy(first);
+        }
+
+        //! Free the memory if the elements are not inline.
+        void deallocate()
+        {
+            if (!isInline())
+                allocator_.deallocate(data_, capacity_);
+            data_ = inlineData();
+            capacity_ = n;
+        }
+
+        //! Move the elements to new memory for c elements.
+        void reallocate(size_type c)
+        {
+            T* newData = allocator_.allocate(c);
+            size_type i = 0;
+            try {
+                for (; i < sz_; ++i)
+#if HAVE_RVALUE_REFERENCES
+                    ::new (static_cast<void*>(newData+i)) T(std::move(data_[i]));
+#else
+                    ::new (static_cast<void*>(newData+i)) T(data_[i]);
+#endif
+            }
+            catch (...) {
+                for (size_type j = 0; j < i; ++j)
+                    allocator_.destroy(newData+j);
+                allocator_.deallocate(newData, c);
+                throw;
+            }
+            destroy(data_, data_+sz_);
+            if (!isInline())
+                allocator_.deallocate(data_, capacity_);
+            data_ = newData;
+            capacity_ = c;
+        }
+
+#if HAVE_RVALUE_REFERENCES
+        //! Take the elements of other, which is left empty. This vector has to be empty and inline.
+        void moveFrom(SmallVector& other)
+        {
+            if (other.isInline()) {
+                for (size_type i = 0; i < other.sz_; ++i)
+                    ::new (static_cast<void*>(data_+i)) T(std::move(other.data_[i]));
+                sz_ = other.sz_;
+                other.clear();
+            }
+            else {
+                data_ = other.data_;
+                sz_ = other.sz_;
+                capacity_ = other.capacity_;
+                other.data_ = other.inlineData();
+                other.sz_ = 0;
+                other.capacity_ = n;
+            }
+        }
+#endif
+
+        T* data_;
+        size_type sz_;
+        size_type capacity_;
+        A allocator_;
+        Storage storage_;
+    };
+
+    //! Compare the elements of two vectors
+    template<class T, int n, class A>
+    bool operator==(const SmallVector<T,n,A>& a, const SmallVector<T,n,A>& b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    //! Compare the elements of two vectors
+    template<class T, int n, class A>
+    bool operator!=(const SmallVector<T,n,A>& a, const SmallVector<T,n,A>& b)
+    {
+        return !(a == b);
+    }
+
+}
+
+DUNE_DEFINE_HASH(DUNE_HASH_TEMPLATE_ARGS(class T, int n, class A),DUNE_HASH_TYPE(Dune::SmallVector<T,n,A>))
+
+#endif // DUNE_COMMON_SMALLVECTOR_HH
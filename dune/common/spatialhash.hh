@@ -0,0 +1,365 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_COMMON_SPATIALHASH_HH
+#define DUNE_COMMON_SPATIALHASH_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/float_cmp.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/hash.hh>
+
+#if HAVE_STD_THREAD
+#include <thread>
+#endif
+
+/** @file
+    @brief A hash container merging coordinates that compare equal with FloatCmp.
+*/
+
+namespace Dune {
+
+#if HAVE_DUNE_HASH || defined(DOXYGEN)
+
+  /**
+   * @brief A set of points which identifies points equal up to a tolerance.
+   *
+   * Two points are equal if all their components are equal according to
+   * FloatCmp::eq with the compare style and epsilon of the container.
+   * Inserting a point equal to a stored one yields the index of the stored
+   * point, so the container assigns the same index to coincident points,
+   * e.g. when merging the vertices of imported meshes or matching interfaces.
+   *
+   * The points are bucketed by the cells of a uniform grid of the given
+   * cell size. A lookup visits all cells that contain points within the
+   * tolerance, so it takes O(1) expected time as long as the cell size is
+   * at least the tolerance and small enough to separate most points. For
+   * the relative compare styles the tolerance grows with the magnitude of
+   * the coordinates, choose the cell size for the largest ones.
+   *
+   * Equality with a tolerance is not transitive. If several stored points
+   * are equal to a new one, the one inserted first is used.
+   *
+   * @tparam K     The field type of the coordinates.
+   * @tparam dim   The dimension of the coordinates.
+   * @tparam style The FloatCmp compare style.
+   *
+   * @note Only available if Dune::hash is (HAVE_DUNE_HASH).
+   */
+  template<class K, int dim, FloatCmp::CmpStyle style = FloatCmp::defaultCmpStyle>
+  class SpatialHash
+  {
+  public:
+    /** @brief The type of the points. */
+    typedef FieldVector<K,dim> Coordinate;
+    /** @brief The type of the epsilon of the comparisons. */
+    typedef typename FloatCmp::EpsilonType<K>::Type EpsilonType;
+    /** @brief The type of the indices of the points. */
+    typedef std::size_t Index;
+    /** @brief The type of sizes. */
+    typedef std::size_t size_type;
+
+    /** @brief The index denoting no point. */
+    static const Index npos = Index(-1);
+
+    /**
+     * @brief Constructs an empty container.
+     * @param cellSize The size of the cells of the bucketing grid.
+     * @param epsilon The epsilon of the comparisons.
+     */
+    explicit SpatialHash(K cellSize,
+                         EpsilonType epsilon = FloatCmp::DefaultEpsilon<K,style>::value())
+      : cellSize_(cellSize), epsilon_(epsilon), heads_(16, npos)
+    {
+      if (!(cellSize > 0))
+        DUNE_THROW(RangeError, "The cell size of a SpatialHash has to be positive");
+    }
+
+    /**
+     * @brief Inserts a point unless an equal one is stored.
+     * @return The index of the stored point equal to x and whether x was inserted.
+     */
+    std::pair<Index,bool> insert(const Coordinate& x)
+    {
+      Index found = find(x);
+      if (found != npos)
+        return std::make_pair(found, false);
+      return std::make_pair(append(x), true);
+    }
+
+    /**
+     * @brief Inserts the points of a range.
+     *
+     * Writes the index of the stored point equal to each point to indices.
+     */
+    template<class InputIterator, class OutputIterator>
+    OutputIterator insert(InputIterator first, InputIterator last, OutputIterator indices)
+    {
+      for (; first != last; ++first, ++indices)
+        *indices = insert(*first).first;
+      return indices;
+    }
+
+#if HAVE_STD_THREAD || defined(DOXYGEN)
+    /**
+     * @brief Inserts many points with several threads.
+     *
+     * Every thread first merges a contiguous part of the points into a
+     * private SpatialHash, then the points found by the threads are
+     * inserted in order and finally the indices are translated. If the
+     * clusters of equal points are well separated compared with the
+     * tolerance, the result equals the one of the sequential insert.
+     *
+     * @param points The points to insert.
+     * @param indices Resized and set to the index of the stored point equal to each point.
+     * @param threads The number of threads to use.
+     *
+     * @note Only available if the compiler supports std::thread (HAVE_STD_THREAD).
+     */
+    void parallelInsert(const std::vector<Coordinate>& points, std::vector<Index>& indices,
+                        unsigned int threads = std::thread::hardware_concurrency())
+    {
+      threads = std::max(1u, std::min<unsigned int>(threads, points.size()/1024+1));
+      indices.resize(points.size());
+      std::vector<SpatialHash> parts(threads, SpatialHash(cellSize_, epsilon_));
+      std::vector<std::size_t> begin(threads+1);
+      for (unsigned int t = 0; t <= threads; ++t)
+        begin[t] = points.size()*t/threads;
+
+      std::vector<std::thread> workers;
+      for (unsigned int t = 1; t < threads; ++t)
+        workers.push_back(std::thread(&SpatialHash::insertPart, &parts[t], &points,
+                                      begin[t], begin[t+1], &indices));
+      parts[0].insertPart(&points, begin[0], begin[1], &indices);
+      for (std::size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+
+      // merge the points found by the threads, in order
+      std::vector<std::vector<Index> > global(threads);
+      for (unsigned int t = 0; t < threads; ++t)
+        insert(parts[t].points_.begin(), parts[t].points_.end(), std::back_inserter(global[t]));
+
+      workers.clear();
+      for (unsigned int t = 1; t < threads; ++t)
+        workers.push_back(std::thread(&SpatialHash::translate, &global[t],
+                                      begin[t], begin[t+1], &indices));
+      translate(&global[0], begin[0], begin[1], &indices);
+      for (std::size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+    }
+#endif // HAVE_STD_THREAD || defined(DOXYGEN)
+
+    /**
+     * @brief Finds a stored point equal to x.
+     * @return The index of the first stored point equal to x or npos.
+     */
+    Index find(const Coordinate& x) const
+    {
+      CellIndex low, high;
+      double cells = 1;
+      for (int i = 0; i < dim; ++i)
+        {
+          K tolerance = toleranceOf(x[i]);
+          low[i] = cellOf(x[i]-tolerance);
+          high[i] = cellOf(x[i]+tolerance);
+          cells *= double(high[i]-low[i]+1);
+        }
+
+      Index found = npos;
+      if (cells > double(points_.size()))
+        {
+          // fewer points than cells to visit, compare with all points
+          for (Index j = 0; j < points_.size() && found == npos; ++j)
+            if (equal(x, points_[j]))
+              found = j;
+          return found;
+        }
+
+      // visit all cells of the box [low,high]
+      CellIndex cell = low;
+      while (true)
+        {
+          std::size_t h = hashOf(cell);
+          for (Index j = heads_[h & (heads_.size()-1)]; j != npos; j = next_[j])
+            if (j < found && cellHashes_[j] == h && equal(x, points_[j]))
+              found = j;
+          int i = 0;
+          while (i < dim && cell[i] == high[i])
+            {
+              cell[i] = low[i];
+              ++i;
+            }
+          if (i == dim)
+            break;
+          ++cell[i];
+        }
+      return found;
+    }
+
+    /** @brief Returns the point with index i. */
+    const Coordinate& operator[](Index i) const
+    {
+      return points_[i];
+    }
+
+    /** @brief Returns all points in the order of their indices. */
+    const std::vector<Coordinate>& points() const
+    {
+      return points_;
+    }
+
+    /** @brief Returns the number of points. */
+    size_type size() const
+    {
+      return points_.size();
+    }
+
+    /** @brief Returns true if there are no points. */
+    bool empty() const
+    {
+      return points_.empty();
+    }
+
+    /** @brief Removes all points. */
+    void clear()
+    {
+      points_.clear();
+      cellHashes_.clear();
+      next_.clear();
+      std::fill(heads_.begin(), heads_.end(), npos);
+    }
+
+    /** @brief Prepares the container for n points. */
+    void reserve(size_type n)
+    {
+      points_.reserve(n);
+      cellHashes_.reserve(n);
+      next_.reserve(n);
+      if (n > heads_.size())
+        rehash(n);
+    }
+
+    /** @brief Returns the size of the cells. */
+    K cellSize() const
+    {
+      return cellSize_;
+    }
+
+    /** @brief Returns the epsilon of the comparisons. */
+    EpsilonType epsilon() const
+    {
+      return epsilon_;
+    }
+
+  private:
+    typedef FieldVector<long long, dim> CellIndex;
+
+    /** @brief The largest difference of a component equal to a component x. */
+    K toleranceOf(K x) const
+    {
+      K tolerance;
+      switch (style)
+        {
+        case FloatCmp::absolute :
+          tolerance = epsilon_;
+          break;
+        case FloatCmp::relativeStrong :
+          tolerance = epsilon_*std::abs(x);
+          break;
+        default :
+          // |x-y| <= epsilon*max(|x|,|y|) implies |x-y| <= epsilon*|x|/(1-epsilon)
+          tolerance = epsilon_*std::abs(x)/(1-std::min<K>(epsilon_, 0.5));
+        }
+      // leave room for the rounding of the bounds
+      return tolerance*(1+K(1)/64);
+    }
+
+    long long cellOf(K x) const
+    {
+      const double limit = 4e18;
+      double c = std::floor(double(x/cellSize_));
+      return static_cast<long long>(std::max(-limit, std::min(limit, c)));
+    }
+
+    std::size_t hashOf(const CellIndex& cell) const
+    {
+      return hash_sequence(cell.begin(), cell.end());
+    }
+
+    bool equal(const Coordinate& a, const Coordinate& b) const
+    {
+      for (int i = 0; i < dim; ++i)
+        if (!FloatCmp::eq<K,style>(a[i], b[i], epsilon_))
+          return false;
+      return true;
+    }
+
+    Index append(const Coordinate& x)
+    {
+      if (points_.size() >= heads_.size())
+        rehash(2*heads_.size());
+      CellIndex cell;
+      for (int i = 0; i < dim; ++i)
+        cell[i] = cellOf(x[i]);
+      Index j = points_.size();
+      std::size_t h = hashOf(cell);
+      points_.push_back(x);
+      cellHashes_.push_back(h);
+      Index& head = heads_[h & (heads_.size()-1)];
+      next_.push_back(head);
+      head = j;
+      return j;
+    }
+
+    /** @brief Use at least n buckets. */
+    void rehash(size_type n)
+    {
+      size_type buckets = heads_.size();
+      while (buckets < n)
+        buckets *= 2;
+      heads_.assign(buckets, npos);
+      for (Index j = 0; j < points_.size(); ++j)
+        {
+          Index& head = heads_[cellHashes_[j] & (buckets-1)];
+          next_[j] = head;
+          head = j;
+        }
+    }
+
+#if HAVE_STD_THREAD
+    void insertPart(const std::vector<Coordinate>* points, std::size_t begin, std::size_t end,
+                    std::vector<Index>* indices)
+    {
+      insert(points->begin()+begin, points->begin()+end, indices->begin()+begin);
+    }
+
+    static void translate(const std::vector<Index>* global, std::size_t begin, std::size_t end,
+                          std::vector<Index>* indices)
+    {
+      for (std::size_t i = begin; i < end; ++i)
+        (*indices)[i] = (*global)[(*indices)[i]];
+    }
+#endif // HAVE_STD_THREAD
+
+    K cellSize_;
+    EpsilonType epsilon_;
+    std::vector<Coordinate> points_;
+    std::vector<std::size_t> cellHashes_;
+    std::vector<Index> next_;
+    std::vector<Index> heads_;
+  };
+
+  template<class K, int dim, FloatCmp::CmpStyle style>
+  const typename SpatialHash<K,dim,style>::Index SpatialHash<K,dim,style>::npos;
+
+#endif // HAVE_DUNE_HASH || defined(DOXYGEN)
+
+} // end namespace Dune
+
+#endif // DUNE_COMMON_SPATIALHASH_HH
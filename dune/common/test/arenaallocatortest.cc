@@ -0,0 +1,183 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/arenaallocator.hh>
+#include <dune/common/arraylist.hh>
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/lru.hh>
+#include <dune/common/sllist.hh>
+
+#include <iostream>
+#include <vector>
+
+#if HAVE_STD_THREAD
+#include <thread>
+#endif
+
+using namespace Dune;
+
+/** @brief The allocation has to be aligned and inside the arena. */
+template<class T>
+int checkAlignment(T* p)
+{
+  if(reinterpret_cast<std::size_t>(p) % AlignmentOf<T>::value != 0){
+    std::cerr<<"misaligned allocation "<<p<<std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int testArena()
+{
+  int ret=0;
+  Arena arena(128);
+
+  // different types and alignments.
+  char* c = ArenaAllocator<char>(arena).allocate(3);
+  double* d = ArenaAllocator<double>(arena).allocate(5);
+  FieldMatrix<double,3,3>* m = ArenaAllocator<FieldMatrix<double,3,3> >(arena).allocate(2);
+  ret += checkAlignment(c) + checkAlignment(d) + checkAlignment(m);
+  if(reinterpret_cast<char*>(d)<c+3 || reinterpret_cast<char*>(m)<reinterpret_cast<char*>(d+5)){
+    std::cerr<<"allocations overlap"<<std::endl;
+    ++ret;
+  }
+
+  // rewinding releases the memory but keeps the blocks.
+  std::size_t capacity = arena.capacity();
+  for(int round=0; round<10; ++round){
+    ArenaScope scope(arena);
+    std::vector<double, ArenaAllocator<double> > v;
+    for(int i=0; i<1000; ++i)
+      v.push_back(i);
+    for(int i=0; i<1000; ++i)
+      if(v[i]!=i){
+        std::cerr<<"wrong value in vector"<<std::endl;
+        ++ret;
+        break;
+      }
+    if(round==0)
+      capacity = arena.capacity();
+  }
+  if(arena.capacity()!=capacity){
+    std::cerr<<"arena grew from "<<capacity<<" to "<<arena.capacity()
+             <<" bytes although it was rewound"<<std::endl;
+    ++ret;
+  }
+
+  // the memory of the scope is reused afterwards.
+  double* d2 = ArenaAllocator<double>(arena).allocate(1);
+  if(reinterpret_cast<char*>(d2)!=reinterpret_cast<char*>(m+2)){
+    std::cerr<<"memory was not released by the scope"<<std::endl;
+    ++ret;
+  }
+
+  // freeing the most recent allocation reclaims it.
+  ArenaAllocator<double> allocator(arena);
+  double* p = allocator.allocate(10);
+  allocator.deallocate(p, 10);
+  if(allocator.allocate(1)!=p){
+    std::cerr<<"most recent allocation was not reclaimed"<<std::endl;
+    ++ret;
+  }
+
+  arena.reset();
+  return ret;
+}
+
+int testContainers()
+{
+  int ret=0;
+  Arena arena;
+  ArenaScope scope(arena);
+
+  if(&Arena::current()!=&arena){
+    std::cerr<<"scope did not activate the arena"<<std::endl;
+    ++ret;
+  }
+
+  {
+    // nested scopes fall back to the enclosing arena.
+    ArenaScope inner;
+    if(&inner.arena()!=&arena){
+      std::cerr<<"nested scope uses wrong arena"<<std::endl;
+      ++ret;
+    }
+
+    SLList<int, ArenaAllocator<int> > list;
+    for(int i=0; i<100; ++i)
+      list.push_back(i);
+    int i=0;
+    typedef SLList<int, ArenaAllocator<int> >::iterator Iterator;
+    for(Iterator it=list.begin(); it!=list.end(); ++it, ++i)
+      if(*it!=i){
+        std::cerr<<"wrong value in SLList"<<std::endl;
+        ++ret;
+      }
+
+    ArrayList<double, 10, ArenaAllocator<double> > array;
+    for(int i=0; i<95; ++i)
+      array.push_back(i);
+    for(int i=0; i<95; ++i)
+      if(array[i]!=i){
+        std::cerr<<"wrong value in ArrayList"<<std::endl;
+        ++ret;
+      }
+
+    typedef _lru_default_traits<int, double, ArenaAllocator<double> > Traits;
+    lru<int, double, Traits> cache;
+    cache.insert(10, 1.0);
+    cache.insert(11, 2.0);
+    cache.touch(10);
+    if(cache.front()!=1.0 || cache.back()!=2.0){
+      std::cerr<<"wrong order in lru"<<std::endl;
+      ++ret;
+    }
+
+    DynamicVector<double, ArenaAllocator<double> > v(5, 1.0), w(5, 2.0);
+    v += w;
+    DynamicMatrix<double, ArenaAllocator<double> > A(5, 5, 1.0);
+    A.resize(3, 5, 2.0);
+    DynamicVector<double, ArenaAllocator<double> > x(3, 0.0);
+    A.mv(v, x);
+    for(int i=0; i<3; ++i)
+      if(x[i]!=30.0){
+        std::cerr<<"wrong result "<<x[i]<<" of matrix vector product"<<std::endl;
+        ++ret;
+      }
+  }
+
+  if(&Arena::current()!=&arena){
+    std::cerr<<"scope did not restore the arena"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+#if HAVE_STD_THREAD
+int testThreadArenas()
+{
+  Arena arena;
+  ArenaScope scope(arena);
+  Arena* other = 0;
+  std::thread t([&other](){ other = &Arena::current(); });
+  t.join();
+  if(other==&arena){
+    std::cerr<<"threads share an arena"<<std::endl;
+    return 1;
+  }
+  return 0;
+}
+#endif
+
+int main()
+{
+  int ret = testArena();
+  ret += testContainers();
+#if HAVE_STD_THREAD
+  ret += testThreadArenas();
+#endif
+  return ret;
+}
@@ -104,6 +104,93 @@ int testIteratorRemove(){
     }
     return 0;
 }
+/**
+ * @brief Records the spans handed out by ArrayList::for_each_span.
+ */
+struct SpanChecker{
+    SpanChecker(): next(0), spans(0), errors(0){}
+
+    void operator()(const double* values, std::size_t n){
+	++spans;
+	for(std::size_t i=0; i<n; ++i, ++next)
+	    if(values[i]!=next)
+		++errors;
+    }
+
+    double next;
+    int spans;
+    int errors;
+};
+
+/**
+ * @brief Increments all entries of a span.
+ */
+struct Increment{
+    void operator()(double* values, std::size_t n){
+	for(std::size_t i=0; i<n; ++i)
+	    ++values[i];
+    }
+};
+
+int testSpans(){
+    using namespace Dune;
+    ArrayList<double,10> alist;
+    initConsecutive(alist);
+
+    // the first entries are erased, the spans start within a chunk.
+    ArrayList<double,10>::iterator iter=alist.begin()+4;
+    iter.eraseToHere();
+    alist.for_each_span(Increment());
+    const ArrayList<double,10>& clist=alist;
+    SpanChecker checker;
+    checker.next=6;
+    checker=clist.for_each_span(checker);
+    if(checker.errors || checker.next!=101 || checker.spans!=10){
+	std::cerr<<"for_each_span handed out wrong spans! "<<__FILE__<<":"<<__LINE__<<std::endl;
+	return 1;
+    }
+
+    // erased chunks are reused.
+    iter=alist.begin()+50;
+    iter.eraseToHere();
+    alist.purge();
+    for(int i=101; i<200; ++i)
+	alist.push_back(i);
+    checker=SpanChecker();
+    checker.next=57;
+    checker=clist.for_each_span(checker);
+    if(checker.errors || checker.next!=200){
+	std::cerr<<"wrong entries after purge! "<<__FILE__<<":"<<__LINE__<<std::endl;
+	return 1;
+    }
+    return 0;
+}
+
+int testCopy(){
+    using namespace Dune;
+    ArrayList<double,10> alist;
+    initConsecutive(alist);
+    ArrayList<double,10>::iterator iter=alist.begin()+14;
+    iter.eraseToHere();
+
+    ArrayList<double,10> copy(alist), assigned;
+    assigned=alist;
+    alist[0]=-1;
+    if(copy.size()!=85 || copy[0]!=15 || assigned.size()!=85 || assigned[0]!=15){
+	std::cerr<<"copies share their entries! "<<__FILE__<<":"<<__LINE__<<std::endl;
+	return 1;
+    }
+
+    ArrayList<double,10> other;
+    other.push_back(3);
+    other.swap(copy);
+    if(other.size()!=85 || other[84]!=99 || copy.size()!=1 || copy[0]!=3){
+	std::cerr<<"swapping failed! "<<__FILE__<<":"<<__LINE__<<std::endl;
+	return 1;
+    }
+    return 0;
+}
+
 int testRandomAccess(){
     using namespace Dune;
     ArrayList<double,10> alist;
@@ -198,6 +285,16 @@ int main(){
 	ret++;
 	cerr<< "Erasing failed!"<<endl;
     }
+
+    if(0!=testSpans()){
+	ret++;
+	cerr<< "Spans failed!"<<endl;
+    }
+
+    if(0!=testCopy()){
+	ret++;
+	cerr<< "Copying failed!"<<endl;
+    }
     return ret;
 
 }
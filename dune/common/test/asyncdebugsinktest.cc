@@ -0,0 +1,135 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/asyncdebugsink.hh>
+#include <dune/common/debugstream.hh>
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HAVE_STD_THREAD
+#include <thread>
+
+typedef Dune::DebugStream<2, 2> Stream;
+
+const int lines = 2000;
+
+void work(Stream* out, int thread)
+{
+  for (int i = 0; i < lines; ++i)
+    *out << "thread " << thread << " line " << i << std::endl;
+}
+
+int testThreads()
+{
+  int ret = 0;
+  const int threads = 4;
+  std::ostringstream log;
+  {
+    // a small buffer, so that the threads have to wait for the writer
+    Dune::AsyncDebugSink sink(log, 7, 1024);
+    Stream out;
+    out.attach(sink);
+    out.push(true);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+      workers.push_back(std::thread(work, &out, t));
+    for (int t = 0; t < threads; ++t)
+      workers[t].join();
+    out << "a line longer than the buffer " << std::string(2000, 'x') << std::endl;
+    out << "an incomplete line";
+    out.pop();
+    if (log.str().find("incomplete") != std::string::npos) {
+      std::cerr << "incomplete line written before the destruction of the sink" << std::endl;
+      ++ret;
+    }
+    out.detach();
+  }
+
+  // every line is complete, stamped and in order per thread
+  std::istringstream in(log.str());
+  std::string line;
+  std::vector<int> next(threads, 0);
+  int other = 0;
+  while (std::getline(in, line)) {
+    double time;
+    int rank, t, i;
+    unsigned int number;
+    if (std::sscanf(line.c_str(), "[%lf r%d t%u] thread %d line %d", &time, &rank, &number, &t, &i) == 5
+        && rank == 7 && t >= 0 && t < threads && i == next[t])
+      ++next[t];
+    else if (line.find("] a line longer") != std::string::npos || line.find("] an incomplete line") != std::string::npos)
+      ++other;
+    else {
+      std::cerr << "unexpected line '" << line.substr(0, 80) << "'" << std::endl;
+      ++ret;
+      break;
+    }
+  }
+  for (int t = 0; t < threads; ++t)
+    if (next[t] != lines) {
+      std::cerr << "found " << next[t] << " lines of thread " << t << std::endl;
+      ++ret;
+    }
+  if (other != 2) {
+    std::cerr << "missing long or incomplete line" << std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+void writeLine(Dune::AsyncDebugSink* sink)
+{
+  sink->stream() << "a line of another thread\n";
+}
+
+int testFlush()
+{
+  int ret = 0;
+  std::ostringstream log;
+  Dune::AsyncDebugSink sink(log);
+  // a line ended without std::endl, which does not flush the thread's stream
+  std::thread writer(writeLine, &sink);
+  writer.join();
+  sink.flush();
+  if (log.str().find("] a line of another thread\n") == std::string::npos) {
+    std::cerr << "complete line of another thread not written by flush()" << std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testLevels()
+{
+  int ret = 0;
+  std::ostringstream log;
+  Dune::AsyncDebugSink sink(log);
+  // below the level needed for output at compile time
+  Dune::DebugStream<1, 2> quiet;
+  quiet.attach(sink);
+  quiet << "never written" << std::endl;
+  quiet.flush();
+  quiet.detach();
+  if (!log.str().empty()) {
+    std::cerr << "inactive stream wrote to the sink" << std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+#endif // HAVE_STD_THREAD
+
+int main()
+{
+  int ret = 0;
+#if HAVE_STD_THREAD
+  ret += testThreads();
+  ret += testFlush();
+  ret += testLevels();
+#endif
+  return ret;
+}
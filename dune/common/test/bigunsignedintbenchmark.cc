@@ -0,0 +1,163 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/benchmark.hh>
+#include <dune/common/bigunsignedint.hh>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Measure the throughput of the bigunsignedint arithmetic.
+ *
+ * Usage: bigunsignedintbenchmark [--repetitions N] [--warmup N] [--min-time S]
+ *                                [--filter TEXT] [--json FILE]
+ */
+
+const std::size_t size = 1024;
+
+/** @brief Fill a vector with pseudo random numbers of up to k bits. */
+template<int k>
+void fill(std::vector<Dune::bigunsignedint<k> >& numbers, std::size_t seed)
+{
+  for(std::size_t i=0; i<numbers.size(); ++i){
+    Dune::bigunsignedint<k> x(0);
+    for(int j=0; j<k/32; ++j){
+      seed = seed*1103515245 + 12345;
+      x = (x<<32) | Dune::bigunsignedint<k>((seed>>16)&0xFFFFFFFFu);
+    }
+    numbers[i] = x;
+  }
+}
+
+/** @brief The operands, a and b of k bits and small of about k/2 bits. */
+template<int k>
+struct Operands
+{
+  typedef Dune::bigunsignedint<k> BigInt;
+  std::vector<BigInt> a, b, small;
+
+  Operands() : a(size), b(size), small(size)
+  {
+    fill(a, 1);
+    fill(b, 2);
+    for(std::size_t i=0; i<size; ++i)
+      small[i] = (b[i]>>(k/2)) | BigInt(1);
+  }
+};
+
+template<int k>
+struct Addition
+{
+  const Operands<k>& x;
+  Addition(const Operands<k>& x_) : x(x_) {}
+  void operator() () const
+  {
+    Dune::bigunsignedint<k> result(0);
+    for(std::size_t i=0; i<size; ++i)
+      result = result + x.a[i] + x.b[i];
+    Dune::Benchmark::doNotOptimize(result);
+  }
+};
+
+template<int k>
+struct Multiplication
+{
+  const Operands<k>& x;
+  Multiplication(const Operands<k>& x_) : x(x_) {}
+  void operator() () const
+  {
+    Dune::bigunsignedint<k> result(0);
+    for(std::size_t i=0; i<size; ++i)
+      result = result ^ (x.a[i] * x.b[i]);
+    Dune::Benchmark::doNotOptimize(result);
+  }
+};
+
+template<int k>
+struct Division
+{
+  const Operands<k>& x;
+  Division(const Operands<k>& x_) : x(x_) {}
+  void operator() () const
+  {
+    Dune::bigunsignedint<k> result(0);
+    for(std::size_t i=0; i<size; ++i)
+      result = result ^ (x.a[i] / x.small[i]);
+    Dune::Benchmark::doNotOptimize(result);
+  }
+};
+
+/** @brief The remainder of the division by a number of one limb. */
+template<int k>
+struct Modulo
+{
+  const Operands<k>& x;
+  Modulo(const Operands<k>& x_) : x(x_) {}
+  void operator() () const
+  {
+    const Dune::bigunsignedint<k> divisor(std::size_t(1000003));
+    Dune::bigunsignedint<k> result(0);
+    for(std::size_t i=0; i<size; ++i)
+      result = result ^ (x.a[i] % divisor);
+    Dune::Benchmark::doNotOptimize(result);
+  }
+};
+
+template<int k>
+struct Shift
+{
+  const Operands<k>& x;
+  Shift(const Operands<k>& x_) : x(x_) {}
+  void operator() () const
+  {
+    Dune::bigunsignedint<k> result(0);
+    for(std::size_t i=0; i<size; ++i)
+      result = result ^ ((x.a[i] << (i%k)) >> 3);
+    Dune::Benchmark::doNotOptimize(result);
+  }
+};
+
+template<int k>
+struct Comparison
+{
+  const Operands<k>& x;
+  Comparison(const Operands<k>& x_) : x(x_) {}
+  void operator() () const
+  {
+    std::size_t less=0;
+    for(std::size_t i=0; i<size; ++i)
+      less += (x.a[i] < x.b[i]);
+    Dune::Benchmark::doNotOptimize(less);
+  }
+};
+
+template<int k>
+void benchmarks(Dune::Benchmark& suite)
+{
+  const Operands<k> x;
+  std::ostringstream n;
+  n<<" bigunsignedint<"<<k<<">";
+  suite.run("addition"+n.str(), Addition<k>(x), 2.0*size);
+  suite.run("multiplication"+n.str(), Multiplication<k>(x), size);
+  suite.run("division"+n.str(), Division<k>(x), size);
+  suite.run("modulo limb"+n.str(), Modulo<k>(x), size);
+  suite.run("shift"+n.str(), Shift<k>(x), 2.0*size);
+  suite.run("comparison"+n.str(), Comparison<k>(x), size);
+}
+
+int main(int argc, char** argv)
+{
+  Dune::Benchmark suite("bigunsignedint", argc, argv);
+
+  benchmarks<64>(suite);
+  benchmarks<128>(suite);
+  benchmarks<256>(suite);
+  benchmarks<1024>(suite);
+
+  return suite.finish();
+}
@@ -10,6 +10,119 @@
 #include<boost/functional/hash.hpp>
 #endif
 
+
+/** @brief A simple deterministic random number generator. */
+std::size_t nextRandom(std::size_t& state)
+{
+  state = state*6364136223846793005ull + 1442695040888963407ull;
+  return static_cast<std::size_t>(state>>32);
+}
+
+/** @brief A random number with a random number of leading zero words. */
+template<int k>
+Dune::bigunsignedint<k> randomBigUnsignedInt(std::size_t& state)
+{
+  Dune::bigunsignedint<k> x(0);
+  int words = nextRandom(state)%(k/32+2);
+  for(int i=0; i<words; ++i)
+    x = (x<<32) | Dune::bigunsignedint<k>(nextRandom(state));
+  // sometimes use numbers with long runs of ones
+  if(nextRandom(state)%4==0)
+    x = x | (x<<17);
+  return x;
+}
+
+/** @brief Check the arithmetic for consistency using random numbers. */
+template<int k>
+int checkArithmetic()
+{
+  typedef Dune::bigunsignedint<k> BigInt;
+  int ret=0;
+  std::size_t state=k;
+  const BigInt zero(0), one(1);
+
+  for(int i=0; i<10000; ++i)
+  {
+    BigInt u=randomBigUnsignedInt<k>(state), v=randomBigUnsignedInt<k>(state);
+
+    if((u+v)-v!=u || u-u!=zero || u+(~u)!=~zero || ~(~u)!=u){
+      std::cerr<<"addition/subtraction failed for "<<u<<" and "<<v<<std::endl;
+      ++ret;
+    }
+    if(u*one!=u || u*zero!=zero || u*v!=v*u || u*(v+one)!=u*v+u){
+      std::cerr<<"multiplication failed for "<<u<<" and "<<v<<std::endl;
+      ++ret;
+    }
+    int shift=nextRandom(state)%k;
+    if(((u<<shift)>>shift)!=(u&(~zero>>shift))){
+      std::cerr<<"shift by "<<shift<<" failed for "<<u<<std::endl;
+      ++ret;
+    }
+    if(v==zero)
+      continue;
+    BigInt q=u/v, r=u%v;
+    if(!(r<v) || q*v+r!=u){
+      std::cerr<<"division failed for "<<u<<"/"<<v<<": quotient "<<q
+               <<" remainder "<<r<<std::endl;
+      ++ret;
+    }
+  }
+
+  try{
+    BigInt q=one/zero;
+    std::cerr<<"division by zero did not throw but gave "<<q<<std::endl;
+    ++ret;
+  }catch(Dune::MathError&){}
+  try{
+    BigInt r=one%zero;
+    std::cerr<<"modulo zero did not throw but gave "<<r<<std::endl;
+    ++ret;
+  }catch(Dune::MathError&){}
+
+  return ret;
+}
+
+/** @brief Compare with the native unsigned 64 bit arithmetic. */
+int checkNative()
+{
+  typedef Dune::bigunsignedint<64> BigInt;
+  int ret=0;
+  std::size_t state=1;
+  for(int i=0; i<10000; ++i)
+  {
+    uint64_t a=(uint64_t(nextRandom(state))<<32)|nextRandom(state);
+    uint64_t b=uint64_t(nextRandom(state))>>(nextRandom(state)%32);
+    BigInt x=(BigInt(std::size_t(a>>32))<<32)|BigInt(std::size_t(a&0xFFFFFFFFu));
+    BigInt y=(BigInt(std::size_t(b>>32))<<32)|BigInt(std::size_t(b&0xFFFFFFFFu));
+    uint64_t expected[5]={ a+b, a-b, a*b, b ? a/b : 0, b ? a%b : 0 };
+    BigInt result[5]={ x+y, x-y, x*y, b ? x/y : BigInt(0), b ? x%y : BigInt(0) };
+    for(int j=0; j<5; ++j)
+      if((result[j]>>32).touint()!=(expected[j]>>32) || result[j].touint()!=(expected[j]&0xFFFFFFFFu)){
+        std::cerr<<"operation "<<j<<" failed for "<<x<<" and "<<y<<std::endl;
+        ++ret;
+      }
+  }
+  return ret;
+}
+
+/** @brief Check that the hash is the one of the former 16 bit digits. */
+int checkHash()
+{
+  int ret=0;
+#if HAVE_DUNE_HASH
+  typedef Dune::bigunsignedint<100> BigInt;
+  BigInt a=(BigInt(123456789)<<70)+BigInt(987654321);
+  unsigned short digits[7];
+  for(int i=0; i<7; ++i)
+    digits[i]=((a>>(16*i))&BigInt(0xFFFF)).touint();
+  if(Dune::hash<BigInt>()(a)!=Dune::hash_range(digits, digits+7)){
+    std::cerr<<"hash of "<<a<<" changed"<<std::endl;
+    ++ret;
+  }
+#endif
+  return ret;
+}
+
 int main()
 {
   
@@ -100,4 +213,14 @@ int main()
   catch(Dune::MathError e){
     std::cout<<e<<std::endl;
   }
+
+  int ret = checkNative();
+  ret += checkHash();
+  ret += checkArithmetic<16>();
+  ret += checkArithmetic<64>();
+  ret += checkArithmetic<100>();
+  ret += checkArithmetic<128>();
+  ret += checkArithmetic<256>();
+  ret += checkArithmetic<1000>();
+  return ret;
 }
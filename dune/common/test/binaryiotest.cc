@@ -0,0 +1,270 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/binaryio.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+bool exists(const std::string& filename)
+{
+  return std::ifstream(filename.c_str()).good();
+}
+
+// flips a bit of the byte at the given position of the file
+void corrupt(const std::string& filename, long position)
+{
+  std::fstream file(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  file.seekg(position);
+  char c;
+  file.get(c);
+  file.seekp(position);
+  file.put(c ^ 1);
+}
+
+int testChecksum()
+{
+  int ret = 0;
+  const std::string data = "123456789";
+  if (Dune::crc32c(data.data(), data.size()) != 0xE3069283u) {
+    std::cerr << "wrong CRC-32C of " << data << std::endl;
+    ++ret;
+  }
+  const std::string text(1000, 'x');
+  if (Dune::crc32c(text.data()+300, 700, Dune::crc32c(text.data(), 300)) != Dune::crc32c(text.data(), 1000)) {
+    std::cerr << "CRC-32C in pieces differs" << std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testRoundTrip()
+{
+  int ret = 0;
+  const std::string filename = "binaryiotest.dbin";
+  Dune::DynamicVector<double> x(1000);
+  std::vector<Dune::FieldVector<double,3> > points(100);
+  std::vector<int> small(3);
+  std::vector<std::complex<float> > z(5);
+  for (std::size_t i = 0; i < x.size(); ++i)
+    x[i] = 0.5*i;
+  for (std::size_t i = 0; i < points.size(); ++i)
+    points[i] = Dune::FieldVector<double,3>(i);
+  for (std::size_t i = 0; i < small.size(); ++i)
+    small[i] = -int(i);
+  for (std::size_t i = 0; i < z.size(); ++i)
+    z[i] = std::complex<float>(i, -1.0f*i);
+
+  {
+    // a small buffer, so that the vector is written directly
+    Dune::BinaryWriter writer(filename, 256, 1024);
+    writer.write("x", x);
+    writer.write("small", small);
+    writer.write("points", points);
+    writer.write("empty", std::vector<double>());
+    writer.write("z", z);
+    try {
+      writer.write("x", x);
+      std::cerr << "array written twice" << std::endl;
+      ++ret;
+    }
+    catch (Dune::RangeError&) {}
+    if (exists(filename)) {
+      std::cerr << "file visible before close()" << std::endl;
+      ++ret;
+    }
+    writer.close();
+  }
+
+  Dune::BinaryReader reader(filename);
+  if (reader.size() != 5 || !reader.contains("points") || reader.contains("y")) {
+    std::cerr << "wrong arrays in the file" << std::endl;
+    ++ret;
+  }
+  Dune::DenseVectorView<const double> y = reader.vector<double>("x");
+  if (y.size() != x.size() || (y - x).infinity_norm() != 0) {
+    std::cerr << "vector read wrongly" << std::endl;
+    ++ret;
+  }
+  if (reinterpret_cast<std::size_t>(&y[0]) % 256 != 0) {
+    std::cerr << "vector not aligned" << std::endl;
+    ++ret;
+  }
+  Dune::BinaryArrayView<Dune::FieldVector<double,3> > q = reader.array<Dune::FieldVector<double,3> >("points");
+  if (q.size() != points.size() || q[99] != points[99] || q[1] != points[1]) {
+    std::cerr << "FieldVectors read wrongly" << std::endl;
+    ++ret;
+  }
+  std::vector<int> s;
+  reader.read("small", s);
+  std::vector<std::complex<float> > w;
+  reader.read("z", w);
+  if (s != small || w != z || !reader.array<double>("empty").empty()) {
+    std::cerr << "arrays read wrongly" << std::endl;
+    ++ret;
+  }
+  Dune::DynamicVector<double> v;
+  reader.read("x", v);
+  if (v != x) {
+    std::cerr << "DynamicVector read wrongly" << std::endl;
+    ++ret;
+  }
+
+  try {
+    reader.array<float>("x");
+    std::cerr << "doubles read as floats" << std::endl;
+    ++ret;
+  }
+  catch (Dune::RangeError&) {}
+  try {
+    reader.array<Dune::FieldVector<double,2> >("points");
+    std::cerr << "FieldVectors read with the wrong size" << std::endl;
+    ++ret;
+  }
+  catch (Dune::RangeError&) {}
+  try {
+    reader.array<double>("y");
+    std::cerr << "array that does not exist read" << std::endl;
+    ++ret;
+  }
+  catch (Dune::RangeError&) {}
+  return ret;
+}
+
+int testCorruption()
+{
+  int ret = 0;
+  const std::string filename = "binaryiotest.dbin";
+  long offset;
+  {
+    Dune::BinaryReader reader(filename);
+    offset = reader.record("points").offset;
+  }
+  corrupt(filename, offset + 10);
+  {
+    Dune::BinaryReader reader(filename);
+    reader.array<double>("x");
+    try {
+      reader.array<Dune::FieldVector<double,3> >("points");
+      std::cerr << "corrupted array read" << std::endl;
+      ++ret;
+    }
+    catch (Dune::IOError&) {}
+    Dune::BinaryReader unverified(filename, false);
+    unverified.array<Dune::FieldVector<double,3> >("points");
+  }
+  corrupt(filename, 20);
+  try {
+    Dune::BinaryReader reader(filename);
+    std::cerr << "file with a corrupted header opened" << std::endl;
+    ++ret;
+  }
+  catch (Dune::IOError&) {}
+  std::remove(filename.c_str());
+
+  // a writer destroyed before close() leaves no file
+  {
+    Dune::BinaryWriter writer(filename);
+    writer.write("x", std::vector<double>(10));
+  }
+  if (exists(filename) || exists(filename + ".tmp")) {
+    std::cerr << "file of an unclosed writer left" << std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testDistributed()
+{
+  int ret = 0;
+  const std::string basename = "binaryiotest";
+  // three processes writing 4, 0 and 6 values, and 1 value only on the last
+  const int counts[] = { 4, 0, 6 };
+  std::vector<std::vector<Dune::BinaryRecord> > records(3);
+  int next = 0;
+  for (int p = 0; p < 3; ++p) {
+    Dune::BinaryWriter writer(Dune::binaryRankFile(basename, p));
+    std::vector<int> values;
+    for (int i = 0; i < counts[p]; ++i)
+      values.push_back(next++);
+    writer.write("values", values);
+    if (p == 2)
+      writer.write("last", std::vector<double>(1, 3.5));
+    writer.close();
+    records[p] = writer.records();
+  }
+  Dune::writeBinaryIndex(basename, records);
+
+  Dune::BinaryIndex index(basename);
+  if (index.ranks() != 3 || index.names().size() != 2 || index.total("values") != 10
+      || index.offset("values", 2) != 4 || index.count("last", 0) != 0 || index.count("last", 2) != 1) {
+    std::cerr << "wrong index of the distributed data set" << std::endl;
+    ++ret;
+  }
+  // two processes taking halves of the values
+  for (int p = 0; p < 2; ++p) {
+    std::pair<std::size_t,std::size_t> range = index.range("values", p, 2);
+    std::vector<int> values;
+    index.read("values", range.first, range.second, values);
+    for (std::size_t i = 0; i < values.size(); ++i)
+      if (values[i] != int(range.first + i)) {
+        std::cerr << "wrong values of process " << p << " of 2" << std::endl;
+        ++ret;
+        break;
+      }
+    if (values.size() != 5) {
+      std::cerr << "process " << p << " of 2 has " << values.size() << " values" << std::endl;
+      ++ret;
+    }
+  }
+  std::vector<double> last;
+  index.read("last", 0, 1, last);
+  if (last.size() != 1 || last[0] != 3.5) {
+    std::cerr << "wrong array written by one process" << std::endl;
+    ++ret;
+  }
+  try {
+    index.read("values", 3, 11, last);
+    std::cerr << "range beyond the end read" << std::endl;
+    ++ret;
+  }
+  catch (Dune::RangeError&) {}
+  for (int p = 0; p < 3; ++p)
+    std::remove(Dune::binaryRankFile(basename, p).c_str());
+
+  // the collective version, with one process
+  Dune::CollectiveCommunication<Dune::No_Comm> comm;
+  {
+    Dune::BinaryWriter writer(Dune::binaryRankFile(basename, comm.rank()));
+    writer.write("values", std::vector<int>(7, 1));
+    Dune::writeBinaryIndex(basename, writer, comm);
+  }
+  Dune::BinaryIndex single(basename);
+  std::vector<int> values;
+  single.read("values", 2, 7, values);
+  if (single.ranks() != 1 || values != std::vector<int>(5, 1)) {
+    std::cerr << "wrong data set written collectively" << std::endl;
+    ++ret;
+  }
+  std::remove(Dune::binaryRankFile(basename, 0).c_str());
+  std::remove((basename + ".dbin").c_str());
+  return ret;
+}
+
+int main()
+{
+  int ret = 0;
+  ret += testChecksum();
+  ret += testRoundTrip();
+  ret += testCorruption();
+  ret += testDistributed();
+  return ret;
+}
@@ -9,6 +9,11 @@
 
 #include<dune/common/test/iteratortest.hh>
 
+#include<algorithm>
+#include<cstdlib>
+#include<utility>
+#include<vector>
+
 template<class BBF>
 struct ConstReferenceOp
 {
@@ -177,11 +182,155 @@ void doTest() {
 #endif
 }
 
+/**
+   \brief Collects the positions of the set bits in the order visited
+ */
+struct SetBitCollector
+{
+    void operator()(std::size_t i, std::size_t j){
+        positions.push_back(std::make_pair(i,j));
+    }
+
+    std::vector<std::pair<std::size_t,std::size_t> > positions;
+};
+
+/**
+   \brief Compares the word based operations with a std::vector<bool>
+ */
+template<int block_size>
+int testOperations()
+{
+    typedef Dune::BitSetVector<block_size> BBF;
+    typedef typename BBF::value_type bitset;
+    const int n = 37;
+    int ret = 0;
+
+    std::vector<bool> bits1(n*block_size), bits2(n*block_size);
+    srand(block_size);
+    for(std::size_t i=0; i<bits1.size(); ++i){
+        bits1[i] = rand()%3==0;
+        bits2[i] = rand()%2==0;
+    }
+    // one block full, one empty
+    for(int j=0; j<block_size; ++j){
+        bits1[5*block_size+j] = true;
+        bits1[6*block_size+j] = false;
+    }
+    BBF bbf1(bits1), bbf2(n);
+    for(int i=0; i<n; ++i)
+        for(int j=0; j<block_size; ++j)
+            bbf2[i][j] = bits2[i*block_size+j];
+
+    // counting
+    std::size_t count = std::count(bits1.begin(), bits1.end(), true);
+    if(bbf1.count()!=count || bbf1.none() || !bbf1.any() || bbf1.all()){
+        std::cerr<<"count() failed for block size "<<block_size<<std::endl;
+        ++ret;
+    }
+    for(int j=0; j<block_size; ++j){
+        std::size_t masked = 0;
+        for(int i=0; i<n; ++i)
+            masked += bits1[i*block_size+j];
+        if(bbf1.countmasked(j)!=masked){
+            std::cerr<<"countmasked("<<j<<") failed for block size "<<block_size<<std::endl;
+            ++ret;
+        }
+    }
+    for(int i=0; i<n; ++i){
+        bitset b;
+        for(int j=0; j<block_size; ++j)
+            b[j] = bits1[i*block_size+j];
+        if(bbf1[i]!=b || bitset(bbf1[i])!=b || bbf1[i].count()!=b.count()
+           || bbf1[i].any()!=b.any() || bbf1[i].all()!=(b.count()==block_size)){
+            std::cerr<<"block "<<i<<" differs for block size "<<block_size<<std::endl;
+            ++ret;
+        }
+    }
+
+    // set bit iteration
+    SetBitCollector collector = bbf1.forEachSetBit(SetBitCollector());
+    std::size_t k=0;
+    for(std::size_t i=0; i<bits1.size(); ++i)
+        if(bits1[i]){
+            if(k>=collector.positions.size()
+               || collector.positions[k].first*block_size+collector.positions[k].second!=i){
+                std::cerr<<"forEachSetBit failed for block size "<<block_size<<std::endl;
+                ++ret;
+                break;
+            }
+            ++k;
+        }
+    if(k!=collector.positions.size()){
+        std::cerr<<"forEachSetBit visited too many bits for block size "<<block_size<<std::endl;
+        ++ret;
+    }
+
+    // whole vector logic and block operations
+    BBF a(bbf1), o(bbf1), x(bbf1), blockwise(bbf1);
+    a &= bbf2;
+    o |= bbf2;
+    x ^= bbf2;
+    for(int i=0; i<n; ++i){
+        for(int j=0; j<block_size; ++j){
+            std::size_t pos=i*block_size+j;
+            if(a[i][j]!=(bits1[pos]&&bits2[pos]) || o[i][j]!=(bits1[pos]||bits2[pos])
+               || x[i][j]!=(bits1[pos]!=bits2[pos])){
+                std::cerr<<"logical operation failed for block size "<<block_size<<std::endl;
+                ++ret;
+            }
+        }
+        bitset b = bbf1[i];
+        blockwise[i] ^= bbf2[i];
+        blockwise[i] <<= 1;
+        if(blockwise[i]!=((b^bitset(bbf2[i]))<<1)){
+            std::cerr<<"block operation failed for block size "<<block_size<<std::endl;
+            ++ret;
+        }
+        blockwise[i].flip();
+        blockwise[i] >>= 2;
+        if(blockwise[i]!=((~((b^bitset(bbf2[i]))<<1))>>2)){
+            std::cerr<<"block shift failed for block size "<<block_size<<std::endl;
+            ++ret;
+        }
+        blockwise[i].reset();
+    }
+    if(blockwise.any()){
+        std::cerr<<"reset failed for block size "<<block_size<<std::endl;
+        ++ret;
+    }
+
+    // growing with set bits
+    BBF grown(bbf2);
+    grown.resize(n+3, true);
+    grown.resize(n+5, false);
+    if(grown.count()!=bbf2.count()+3*block_size || grown[n+2].none() || grown[n+3].any()){
+        std::cerr<<"resize failed for block size "<<block_size<<std::endl;
+        ++ret;
+    }
+    grown.setAll();
+    if(!grown.all() || grown.count()!=(n+5)*std::size_t(block_size)){
+        std::cerr<<"setAll failed for block size "<<block_size<<std::endl;
+        ++ret;
+    }
+    return ret;
+}
+
 int main()
 {
     doTest<4, std::allocator<bool> >();
 #if defined(__GNUC__) && ! defined(__clang__)
     doTest<4, __gnu_cxx::malloc_allocator<bool> >();
 #endif
-    return 0;
+    doTest<3, std::allocator<bool> >();
+    doTest<64, std::allocator<bool> >();
+    doTest<100, std::allocator<bool> >();
+
+    int ret = testOperations<1>();
+    ret += testOperations<3>();
+    ret += testOperations<4>();
+    ret += testOperations<17>();
+    ret += testOperations<64>();
+    ret += testOperations<100>();
+    ret += testOperations<128>();
+    return ret;
 }
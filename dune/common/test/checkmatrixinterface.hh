@@ -381,7 +381,7 @@ namespace CheckMatrixInterface
       for( size_type i = size_type( 0 ); i < size; ++i )      
       {
         row_reference row = matrix[ i ];
-        row = row_type( value_type( 0 ) );
+        row = value_type( 0 );
       }
 
       const size_type rows = MatrixSizeHelper< Matrix >::rows( matrix );
@@ -400,7 +400,7 @@ namespace CheckMatrixInterface
       for( Iterator it = matrix.begin(); it != end; ++it )
       {
         row_reference row = *it;
-        row = row_type( value_type( 0 ) );
+        row = value_type( 0 );
       }
     }
   };
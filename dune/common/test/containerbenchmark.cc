@@ -0,0 +1,96 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/arraylist.hh>
+#include <dune/common/benchmark.hh>
+#include <dune/common/lru.hh>
+#include <dune/common/poolallocator.hh>
+#include <dune/common/sllist.hh>
+
+#include <cstddef>
+#include <list>
+#include <string>
+
+/**
+ * @file
+ * @brief Benchmark PoolAllocator, ArrayList, SLList and lru.
+ *
+ * Usage: containerbenchmark [--repetitions N] [--warmup N] [--min-time S]
+ *                           [--filter TEXT] [--json FILE]
+ */
+
+const int entries = 1000;
+
+/** @brief Fill a list at the back, traverse and clear it. */
+template<class List>
+struct BuildList
+{
+  void operator() () const
+  {
+    List list;
+    for(int i=0; i<entries; ++i)
+      list.push_back(i);
+    long sum=0;
+    for(typename List::const_iterator it=list.begin(); it!=list.end(); ++it)
+      sum+=*it;
+    Dune::Benchmark::doNotOptimize(sum);
+  }
+};
+
+/** @brief Traverse a filled list. */
+template<class List>
+struct TraverseList
+{
+  const List& list;
+  TraverseList(const List& list_) : list(list_) {}
+  void operator() () const
+  {
+    long sum=0;
+    for(typename List::const_iterator it=list.begin(); it!=list.end(); ++it)
+      sum+=*it;
+    Dune::Benchmark::doNotOptimize(sum);
+  }
+};
+
+/** @brief Fill an lru cache, then touch and find its entries out of order. */
+struct LRU
+{
+  void operator() () const
+  {
+    Dune::lru<int,int> cache;
+    for(int i=0; i<entries; ++i)
+      cache.insert(i, i);
+    long sum=0;
+    for(int i=0; i<entries; ++i)
+      sum+=cache.touch((i*7919)%entries);
+    for(int i=0; i<entries; ++i)
+      sum+=cache.find((i*104729)%entries)->second;
+    cache.resize(entries/2);
+    Dune::Benchmark::doNotOptimize(sum);
+  }
+};
+
+template<class List>
+void listBenchmarks(Dune::Benchmark& suite, const std::string& name)
+{
+  List list;
+  for(int i=0; i<entries; ++i)
+    list.push_back(i);
+  suite.run(name+" build", BuildList<List>(), entries);
+  suite.run(name+" traverse", TraverseList<List>(list), entries);
+}
+
+int main(int argc, char** argv)
+{
+  Dune::Benchmark suite("container", argc, argv);
+
+  listBenchmarks<std::list<int> >(suite, "std::list");
+  listBenchmarks<std::list<int, Dune::PoolAllocator<int, 4096> > >(suite, "std::list PoolAllocator");
+  listBenchmarks<Dune::SLList<int> >(suite, "SLList");
+  listBenchmarks<Dune::SLList<int, Dune::PoolAllocator<int, 4096> > >(suite, "SLList PoolAllocator");
+  listBenchmarks<Dune::ArrayList<int, 100> >(suite, "ArrayList");
+  suite.run("lru insert, touch, find", LRU(), 3*entries);
+
+  return suite.finish();
+}
@@ -0,0 +1,174 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/benchmark.hh>
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fmatrixev.hh>
+#include <dune/common/fvector.hh>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+/**
+ * @file
+ * @brief Benchmark the DenseVector and DenseMatrix kernels and fmatrixev.
+ *
+ * Usage: densebenchmark [--repetitions N] [--warmup N] [--min-time S]
+ *                       [--filter TEXT] [--json FILE]
+ */
+
+/** @brief Pseudo random numbers in [-1,1). */
+double random(std::size_t& seed)
+{
+  seed = seed*6364136223846793005ull + 1442695040888963407ull;
+  return 2*double(seed>>11)/double(1ull<<53) - 1;
+}
+
+template<class V>
+void fillVector(V& v, std::size_t seed)
+{
+  for(std::size_t i=0; i<v.N(); ++i)
+    v[i]=random(seed);
+}
+
+/** @brief Fill a diagonally dominant matrix, symmetric for the eigenvalues. */
+template<class M>
+void fillMatrix(M& A, std::size_t seed)
+{
+  for(std::size_t i=0; i<A.N(); ++i)
+    for(std::size_t j=0; j<=i; ++j)
+      A[i][j]=A[j][i]=random(seed);
+  for(std::size_t i=0; i<A.N(); ++i)
+    A[i][i]+=A.N();
+}
+
+template<class V>
+struct Axpy
+{
+  V& x; const V& y;
+  Axpy(V& x_, const V& y_) : x(x_), y(y_) {}
+  void operator() () const { x.axpy(1e-9, y); Dune::Benchmark::doNotOptimize(x); }
+};
+
+template<class V>
+struct Dot
+{
+  const V& x; const V& y;
+  Dot(const V& x_, const V& y_) : x(x_), y(y_) {}
+  void operator() () const { Dune::Benchmark::doNotOptimize(x*y); }
+};
+
+template<class V>
+struct TwoNorm
+{
+  const V& x;
+  TwoNorm(const V& x_) : x(x_) {}
+  void operator() () const { Dune::Benchmark::doNotOptimize(x.two_norm()); }
+};
+
+template<class M, class V>
+struct Mv
+{
+  const M& A; const V& x; V& y;
+  Mv(const M& A_, const V& x_, V& y_) : A(A_), x(x_), y(y_) {}
+  void operator() () const { A.mv(x, y); Dune::Benchmark::doNotOptimize(y); }
+};
+
+template<class M, class V>
+struct Solve
+{
+  const M& A; V& x; const V& b;
+  Solve(const M& A_, V& x_, const V& b_) : A(A_), x(x_), b(b_) {}
+  void operator() () const { A.solve(x, b); Dune::Benchmark::doNotOptimize(x); }
+};
+
+template<class M>
+struct Invert
+{
+  const M& A; M& B;
+  Invert(const M& A_, M& B_) : A(A_), B(B_) {}
+  void operator() () const { B=A; B.invert(); Dune::Benchmark::doNotOptimize(B); }
+};
+
+template<class M>
+struct Determinant
+{
+  const M& A;
+  Determinant(const M& A_) : A(A_) {}
+  void operator() () const { Dune::Benchmark::doNotOptimize(A.determinant()); }
+};
+
+template<int dim>
+struct EigenValues
+{
+  const Dune::FieldMatrix<double,dim,dim>& A; Dune::FieldVector<double,dim>& ev;
+  EigenValues(const Dune::FieldMatrix<double,dim,dim>& A_, Dune::FieldVector<double,dim>& ev_)
+    : A(A_), ev(ev_) {}
+  void operator() () const { Dune::FMatrixHelp::eigenValues(A, ev); Dune::Benchmark::doNotOptimize(ev); }
+};
+
+template<class V>
+void vectorBenchmarks(Dune::Benchmark& suite, const std::string& type, V x, V y)
+{
+  fillVector(x, 1);
+  fillVector(y, 2);
+  std::ostringstream n;
+  n<<" "<<type<<" n="<<x.N();
+  suite.run("axpy"+n.str(), Axpy<V>(x, y), 2.0*x.N());
+  suite.run("dot"+n.str(), Dot<V>(x, y), 2.0*x.N());
+  suite.run("two_norm"+n.str(), TwoNorm<V>(x), 2.0*x.N());
+}
+
+template<class M, class V>
+void matrixBenchmarks(Dune::Benchmark& suite, const std::string& type, M A, V x, V y)
+{
+  fillMatrix(A, 3);
+  fillVector(x, 4);
+  M B(A);
+  std::ostringstream n;
+  const double size=A.N();
+  n<<" "<<type<<" n="<<A.N();
+  suite.run("mv"+n.str(), Mv<M,V>(A, x, y), 2*size*size);
+  suite.run("solve"+n.str(), Solve<M,V>(A, y, x), 2*size*size*size/3);
+  suite.run("invert"+n.str(), Invert<M>(A, B), 2*size*size*size);
+  suite.run("determinant"+n.str(), Determinant<M>(A), 2*size*size*size/3);
+}
+
+template<int dim>
+void eigenValueBenchmark(Dune::Benchmark& suite)
+{
+  Dune::FieldMatrix<double,dim,dim> A;
+  Dune::FieldVector<double,dim> ev;
+  fillMatrix(A, 5);
+  std::ostringstream name;
+  name<<"eigenValues FieldMatrix n="<<dim;
+  suite.run(name.str(), EigenValues<dim>(A, ev));
+}
+
+int main(int argc, char** argv)
+{
+  Dune::Benchmark suite("dense", argc, argv);
+
+  vectorBenchmarks(suite, "FieldVector", Dune::FieldVector<double,3>(), Dune::FieldVector<double,3>());
+  vectorBenchmarks(suite, "DynamicVector", Dune::DynamicVector<double>(1000), Dune::DynamicVector<double>(1000));
+
+  matrixBenchmarks(suite, "FieldMatrix", Dune::FieldMatrix<double,3,3>(),
+                   Dune::FieldVector<double,3>(), Dune::FieldVector<double,3>());
+  matrixBenchmarks(suite, "FieldMatrix", Dune::FieldMatrix<double,10,10>(),
+                   Dune::FieldVector<double,10>(), Dune::FieldVector<double,10>());
+  matrixBenchmarks(suite, "DynamicMatrix", Dune::DynamicMatrix<double>(100, 100),
+                   Dune::DynamicVector<double>(100), Dune::DynamicVector<double>(100));
+
+  eigenValueBenchmark<2>(suite);
+#if HAVE_LAPACK
+  // larger matrices are passed to LAPACK
+  eigenValueBenchmark<3>(suite);
+  eigenValueBenchmark<10>(suite);
+#endif
+
+  return suite.finish();
+}
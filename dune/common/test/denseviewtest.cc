@@ -0,0 +1,150 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/denseview.hh>
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "checkmatrixinterface.hh"
+
+using namespace Dune;
+
+int testVectorViews()
+{
+  int ret=0;
+  // interleaved x and y coordinates, as received from another library
+  std::vector<double> buffer(10);
+  for(std::size_t i=0; i<buffer.size(); ++i)
+    buffer[i]=i;
+
+  DenseVectorView<double> all(&buffer[0], buffer.size());
+  DenseVectorView<double,dynamicExtent,dynamicStride> x(&buffer[0], 5, 2), y(&buffer[1], 5, 2);
+  DenseVectorView<double,5,2> ys(&buffer[1]);
+  if(all.two_norm2()!=285 || x.one_norm()!=20 || x.dot(y)!=140 || ys.size()!=5 || ys*x!=140
+     || x.infinity_norm()!=8 || std::accumulate(y.begin(), y.end(), 0.0)!=25){
+    std::cerr<<"wrong results on strided views"<<std::endl;
+    ++ret;
+  }
+
+  // the views write to the buffer
+  y*=2;
+  x=ys;
+  if(buffer[0]!=2 || buffer[1]!=2 || buffer[8]!=18 || buffer[9]!=18){
+    std::cerr<<"views do not write to the buffer"<<std::endl;
+    ++ret;
+  }
+
+  // a view of a FieldVector
+  FieldVector<double,3> f(1.0);
+  DenseVectorView<double,3> v(&f[0]);
+  v[1]=4;
+  FieldVector<double,3> g(v);
+  DynamicVector<double> h=v+f;
+  if(f[1]!=4 || g!=f || h[1]!=8 || f.two_norm2()!=18){
+    std::cerr<<"wrong view of a FieldVector"<<std::endl;
+    ++ret;
+  }
+
+  // read-only views of const data
+  const double data[4]={3, 0, -4, 0};
+  DenseVectorView<const double> c(data, 4);
+  DenseVectorView<const double> c2(all);
+  if(c.two_norm()!=5 || c.infinity_norm_real()!=4 || c[2]!=-4 || c2.size()!=10 || (c-c)[0]!=0){
+    std::cerr<<"wrong read-only view"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+// whether the entries of a view can only be read
+template<class V>
+bool isReadOnlyView(const V&)
+{
+  return false;
+}
+
+template<class K, int SIZE, int STRIDE>
+bool isReadOnlyView(const DenseVectorView<const K,SIZE,STRIDE>&)
+{
+  return true;
+}
+
+template<class K, int ROWS, int COLS>
+bool isReadOnlyView(const DenseMatrixView<const K,ROWS,COLS>&)
+{
+  return true;
+}
+
+int testMatrixViews()
+{
+  int ret=0;
+  // a 3x3 matrix stored with a leading dimension of 4, as a Fortran
+  // code might pad its arrays
+  double data[12]={4, 1, 0, -7,
+                   1, 4, 1, -7,
+                   0, 1, 4, -7};
+  DenseMatrixView<double> A(data, 3, 3, 4);
+  DenseMatrixView<double,3,3> As(data, 4);
+  checkMatrixInterface(A);
+  A[0][0]=4; A[1][1]=4; A[2][2]=4;
+  A[0][1]=1; A[1][0]=1; A[1][2]=1; A[2][1]=1;
+  A[0][2]=0; A[2][0]=0;
+
+  FieldVector<double,3> x(1.0), b, r;
+  As.mv(x, b);
+  FieldMatrix<double,3,3> F;
+  for(int i=0; i<3; ++i)
+    for(int j=0; j<3; ++j)
+      F[i][j]=As[i][j];
+  F.mmv(x, r=b);
+  if(b[0]!=5 || b[1]!=6 || b[2]!=5 || r.two_norm()!=0 || data[3]!=-7 || A.column(1).one_norm()!=6){
+    std::cerr<<"wrong matrix-vector products on views"<<std::endl;
+    ++ret;
+  }
+
+  // solve and determinant do not touch the viewed entries
+  FieldVector<double,3> y;
+  As.solve(y, b);
+  y-=x;
+  DynamicVector<double> z(3), bd(b);
+  A.solve(z, bd);
+  if(y.two_norm()>1e-14 || std::abs(z[2]-1)>1e-14 || std::abs(A.determinant()-56)>1e-12
+     || data[0]!=4 || data[5]!=4){
+    std::cerr<<"solve on views failed"<<std::endl;
+    ++ret;
+  }
+
+  // assignments copy the entries
+  DenseMatrixView<double> B=A.subMatrix(1, 1, 2, 2);
+  B=FieldMatrix<double,2,2>(0.5);
+  DenseMatrixView<const double> C(A);
+  if(data[5]!=0.5 || data[10]!=0.5 || data[0]!=4 || C[1][1]!=0.5 || C.frobenius_norm2()!=16+1+1+4*0.25){
+    std::cerr<<"assignment to a sub-matrix view failed"<<std::endl;
+    ++ret;
+  }
+
+  // a const view hands out read-only views
+  const DenseMatrixView<double,3,3>& Asref=As;
+  if(!isReadOnlyView(Asref[1]) || !isReadOnlyView(Asref.row(1)) || !isReadOnlyView(Asref.column(1))
+     || !isReadOnlyView(Asref.subMatrix(0, 0, 2, 2)) || isReadOnlyView(As[1]) || Asref.column(1)[0]!=1){
+    std::cerr<<"views of a const matrix view are not read-only"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int main()
+{
+  int ret=0;
+  ret+=testVectorViews();
+  ret+=testMatrixViews();
+  return ret;
+}
@@ -0,0 +1,179 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/doubledouble.hh>
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/float_cmp.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fmatrixev.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/timer.hh>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace Dune;
+
+/** @brief Pseudo random numbers in [0,1). */
+double random(std::size_t& seed)
+{
+  seed = seed*6364136223846793005ull + 1442695040888963407ull;
+  return double(seed>>11)/double(1ull<<53);
+}
+
+int testArithmetic()
+{
+  int ret=0;
+  const DoubleDouble eps=std::numeric_limits<DoubleDouble>::epsilon();
+  const DoubleDouble one(1), tiny(std::ldexp(1.0, -80));
+  const DoubleDouble third=one/3;
+  const DoubleDouble root=std::sqrt(DoubleDouble(2));
+  if((one+tiny)-one!=tiny || std::abs(3*third-1)>eps || std::abs(root*root-2)>4*eps
+     || std::abs(-third)!=third || std::sqrt(DoubleDouble(4))!=2 || std::floor(DoubleDouble(2.5))!=2
+     || (one+tiny)<=one || -tiny>=0 || (1-tiny).toDouble()!=1){
+    std::cerr<<"inaccurate DoubleDouble arithmetic"<<std::endl;
+    ++ret;
+  }
+
+  // decimal input and output with 32 digits
+  std::ostringstream s;
+  s.precision(32);
+  s<<third<<" "<<root<<" "<<DoubleDouble("-1.5e-7")<<" "<<DoubleDouble(100)<<" "<<std::scientific<<DoubleDouble(0.5);
+  const std::string expected="0.33333333333333333333333333333333 1.4142135623730950488016887242097"
+                             " -1.5e-07 100 5.0000000000000000000000000000000e-01";
+  DoubleDouble parsed, exact("0.1");
+  std::istringstream("1.4142135623730950488016887242097") >> parsed;
+  if(s.str()!=expected || std::abs(parsed-root)>4*eps || std::abs(10*exact-1)>2*eps || exact.toDouble()!=0.1){
+    std::cerr<<"wrong decimal conversion: "<<s.str()<<std::endl;
+    ++ret;
+  }
+
+  // malformed input fails the stream, inf and nan are read back
+  const char* malformed[] = {"abc", "", ".", "-", "1.5x", "2e", "1e+", "0x10"};
+  for(std::size_t i=0; i<sizeof(malformed)/sizeof(malformed[0]); ++i){
+    DoubleDouble value(7);
+    std::istringstream in(std::string("1 ")+malformed[i]);
+    in>>value>>value;
+    if(!in.fail() || value!=1){
+      std::cerr<<"\""<<malformed[i]<<"\" read as "<<value<<std::endl;
+      ++ret;
+    }
+  }
+  DoubleDouble infinity, notANumber;
+  std::istringstream("-inf nan")>>infinity>>notANumber;
+  if(infinity!=-std::numeric_limits<double>::infinity() || notANumber==notANumber){
+    std::cerr<<"inf and nan read as "<<infinity<<" "<<notANumber<<std::endl;
+    ++ret;
+  }
+
+  // the special cases of the division as in double
+  const DoubleDouble zero(0), inf(std::numeric_limits<double>::infinity());
+  if(one/zero!=inf || -one/zero!=-inf || one/inf!=zero || !((zero/zero)!=(zero/zero))
+     || !((inf/inf)!=(inf/inf)) || inf/one!=inf){
+    std::cerr<<"wrong division by zero or inf: "<<one/zero<<" "<<one/inf<<" "<<zero/zero<<std::endl;
+    ++ret;
+  }
+
+  if(!FloatCmp::eq(third, DoubleDouble(1)/3+eps/10) || FloatCmp::eq(third, DoubleDouble(1)/3+1e-20)
+     || !FloatCmp::lt(third, DoubleDouble(0.5))){
+    std::cerr<<"FloatCmp does not use the DoubleDouble epsilon"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testDenseMatrices()
+{
+  int ret=0;
+  const int n=30;
+  std::size_t seed=1;
+  DynamicMatrix<DoubleDouble> A(n, n);
+  DynamicMatrix<double> Ad(n, n);
+  DynamicVector<DoubleDouble> exact(n), b(n), x(n);
+  DynamicVector<double> bd(n), xd(n);
+  // a Hilbert-like matrix, too ill-conditioned for double
+  for(int i=0; i<n; ++i){
+    for(int j=0; j<n; ++j){
+      A[i][j]=1/DoubleDouble(i+j+1)+1e-9*random(seed);
+      Ad[i][j]=A[i][j].toDouble();
+    }
+    exact[i]=random(seed);
+  }
+  A.mv(exact, b);
+  for(int i=0; i<n; ++i)
+    bd[i]=b[i].toDouble();
+
+  Timer timer;
+  A.solve(x, b);
+  const double time=timer.elapsed();
+  timer.reset();
+  Ad.solve(xd, bd);
+  const double timed=timer.elapsed();
+
+  x-=exact;
+  double errord=0;
+  for(int i=0; i<n; ++i)
+    errord=std::max(errord, std::abs(xd[i]-exact[i].toDouble()));
+  std::cout<<"error of the DoubleDouble solve "<<x.infinity_norm()<<" in "<<time
+           <<" s, of the double solve "<<errord<<" in "<<timed<<" s"<<std::endl;
+  if(x.infinity_norm()>1e-18 || errord<1e3*x.infinity_norm().toDouble()){
+    std::cerr<<"the DoubleDouble solve is not more accurate"<<std::endl;
+    ++ret;
+  }
+
+  FieldVector<DoubleDouble,2> v, w;
+  v[0]=3; v[1]=4;
+  FieldMatrix<DoubleDouble,2,2> M(1.0);
+  M.mv(v, w);
+  if(v.two_norm()!=5 || v*v!=25 || v.one_norm()!=7 || M.determinant()!=0 || w[1]!=7){
+    std::cerr<<"wrong DoubleDouble FieldVector and FieldMatrix operations"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testEigenValues()
+{
+  int ret=0;
+  // Q diag(1e-20,1,2,3) Q with the Householder reflection Q = I - 2uu^T/u^Tu
+  FieldVector<DoubleDouble,4> u, lambda;
+  u[0]=1; u[1]=2; u[2]=-1; u[3]=3;
+  FieldMatrix<DoubleDouble,4,4> Q, A(0.0);
+  for(int i=0; i<4; ++i)
+    for(int j=0; j<4; ++j)
+      Q[i][j]=(i==j)-2*u[i]*u[j]/u.two_norm2();
+  const DoubleDouble d[4]={1e-20, 1, 2, 3};
+  for(int i=0; i<4; ++i)
+    for(int j=0; j<4; ++j)
+      for(int k=0; k<4; ++k)
+        A[i][j]+=Q[i][k]*d[k]*Q[k][j];
+  FMatrixHelp::eigenValues(A, lambda);
+  std::cout<<"eigenvalues "<<lambda<<std::endl;
+  if(std::abs(lambda[0]-1e-20)>1e-28 || std::abs(lambda[1]-1)>1e-28 || std::abs(lambda[3]-3)>1e-28){
+    std::cerr<<"inaccurate DoubleDouble eigenvalues"<<std::endl;
+    ++ret;
+  }
+
+  FieldMatrix<DoubleDouble,2,2> B;
+  B[0][0]=2; B[0][1]=1; B[1][0]=1; B[1][1]=2;
+  FieldVector<DoubleDouble,2> mu;
+  FMatrixHelp::eigenValues(B, mu);
+  if(mu[0]!=1 || mu[1]!=3){
+    std::cerr<<"wrong 2x2 DoubleDouble eigenvalues"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int main()
+{
+  int ret=0;
+  ret+=testArithmetic();
+  ret+=testDenseMatrices();
+  ret+=testEigenValues();
+  return ret;
+}
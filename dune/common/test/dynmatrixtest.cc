@@ -385,6 +385,116 @@ int test_determinant()
     return 0;
 }
 
+// whether the entries of a view can only be read
+template<class V>
+bool isReadOnlyView(const V&)
+{
+  return false;
+}
+
+template<class K, int SIZE, int STRIDE>
+bool isReadOnlyView(const DenseVectorView<const K,SIZE,STRIDE>&)
+{
+  return true;
+}
+
+template<class K>
+bool isReadOnlyView(const DenseMatrixView<const K>&)
+{
+  return true;
+}
+
+int test_storage()
+{
+  int ret = 0;
+  typedef DynamicMatrix<double>::size_type size_type;
+
+  DynamicMatrix<double> A(4, 5);
+  for (size_type i=0; i<A.N(); ++i)
+    for (size_type j=0; j<A.M(); ++j)
+      A[i][j] = 10*i+j;
+
+  // one contiguous row-major block
+  for (size_type i=0; i<A.N(); ++i)
+    for (size_type j=0; j<A.M(); ++j)
+      if (A.data()[i*A.leadingDimension()+j] != A[i][j])
+      {
+        std::cerr << "entry (" << i << "," << j << ") not stored row by row" << std::endl;
+        ++ret;
+      }
+
+  // the views refer to the entries of A
+  DynamicMatrix<double>::column_type column = A.column(2);
+  column *= 2;
+  DenseMatrixView<double> block = A.subMatrix(1, 1, 2, 3);
+  block[1][2] = -1;
+  if (A[3][2] != 64 || A[0][2] != 4 || A[2][3] != -1 || column.size() != 4 || block.M() != 3)
+  {
+    std::cerr << "views do not refer to the entries of the matrix" << std::endl;
+    ++ret;
+  }
+
+  // iterators of temporary rows stay valid
+  double sum = 0;
+  for (DynamicMatrix<double>::RowIterator rit = A.begin(); rit != A.end(); ++rit)
+    for (DynamicMatrix<double>::ColIterator cit = (*rit).begin(); cit != (*rit).end(); ++cit)
+      sum += *cit;
+  const DynamicMatrix<double>& Aref = A;
+  DynamicMatrix<double>::ConstRowIterator crit = Aref.begin();
+  if (sum != 384 || crit->one_norm() != 12 || A.row(1).two_norm2() != 10*10+11*11+24*24+13*13+14*14)
+  {
+    std::cerr << "wrong sum " << sum << " of the entries" << std::endl;
+    ++ret;
+  }
+
+  // a const matrix hands out read-only views
+  if (!isReadOnlyView(Aref[1]) || !isReadOnlyView(Aref.row(1)) || !isReadOnlyView(Aref.column(2))
+      || !isReadOnlyView(Aref.subMatrix(1, 1, 2, 3)) || isReadOnlyView(A[1]) || isReadOnlyView(A.subMatrix(1, 1, 2, 3)))
+  {
+    std::cerr << "views of a const matrix are not read-only" << std::endl;
+    ++ret;
+  }
+
+  // binary operators of rows do not modify the matrix
+  DynamicVector<double> difference = A[1] - A[0];
+  if (difference[0] != 10 || A[1][0] != 10)
+  {
+    std::cerr << "row difference modifies the matrix" << std::endl;
+    ++ret;
+  }
+
+  // solve on a sub-matrix works on a copy
+  DynamicMatrix<double> B(5, 5, 0.0);
+  for (size_type i=1; i<5; ++i)
+  {
+    B[i][i] = 4;
+    B[i][i-1] = 1;
+    if (i+1 < 5)
+      B[i][i+1] = 1;
+  }
+  DenseMatrixView<double> C = B.subMatrix(1, 1, 4, 4);
+  DynamicMatrix<double> Ccopy(C);
+  DynamicVector<double> x(4), b(4, 6.0);
+  b[0] = b[3] = 5;
+  C.solve(x, b);
+  DynamicVector<double> r(b);
+  Ccopy.mmv(x, r);
+  if (r.infinity_norm() > 1e-12 || std::abs(x[0]-1) > 1e-12 || B[2][2] != 4 || Ccopy[0][1] != 1)
+  {
+    std::cerr << "solve on a sub-matrix failed" << std::endl;
+    ++ret;
+  }
+
+  // resize keeps the storage contiguous
+  B.resize(3, 7, 2.0);
+  if (B.N() != 3 || B.M() != 7 || B.leadingDimension() != 7 || B.data()[20] != 2.0 || B[2].size() != 7)
+  {
+    std::cerr << "resize failed" << std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
 int main()
 {
   try {
@@ -396,6 +506,8 @@ int main()
     test_matrix<int, 10, 5>();
     test_matrix<double, 5, 10>();
     test_determinant();
+    if (test_storage() != 0)
+      return 1;
     Dune::DynamicMatrix<double> B(34, 34, 1e-15);
     for (int i=0; i<34; i++) B[i][i] = 1;
     B.invert();
@@ -3,16 +3,18 @@
 #endif
 #include <dune/common/dynvector.hh>
 #include <dune/common/exceptions.hh>
+#include <dune/common/sizeclassallocator.hh>
 #include <iostream>
 
 using Dune::DynamicVector;
 
-template<class ct>
+template<class ct, class Allocator>
 void dynamicVectorTest(int d) {
+  typedef DynamicVector<ct,Allocator> Vector;
   ct a = 1;
-  DynamicVector<ct> v(d,1);
-  DynamicVector<ct> w(d,2);
-  DynamicVector<ct> z(d,2);
+  Vector v(d,1);
+  Vector w(d,2);
+  Vector z(d,2);
   bool b DUNE_UNUSED;
     
   // Test whether the norm methods compile
@@ -26,7 +28,7 @@ void dynamicVectorTest(int d) {
   // test op(vec,vec)
   z = v + w;
   z = v - w;
-  DynamicVector<ct> z2 = v + w;
+  Vector z2 = v + w;
   w -= v;
   w += v;
 
@@ -54,7 +56,14 @@ void dynamicVectorTest(int d) {
   }
   s >> w;
   assert(v == w);
-    
+
+  // test resizing
+  v.resize(4*d, a);
+  v.reserve(8*d);
+  for (int i=0; i<d; i++)
+    assert(v[i] == i);
+  for (int i=d; i<4*d; i++)
+    assert(v[i] == a);
 }
 
 int main()
@@ -62,9 +71,11 @@ int main()
   try {
     for (int d=1; d<6; d++)
     {
-      dynamicVectorTest<int>(d);
-      dynamicVectorTest<float>(d);
-      dynamicVectorTest<double>(d);
+      dynamicVectorTest<int, std::allocator<int> >(d);
+      dynamicVectorTest<float, std::allocator<float> >(d);
+      dynamicVectorTest<double, std::allocator<double> >(d);
+      dynamicVectorTest<double, Dune::SizeClassAllocator<double> >(d);
+      dynamicVectorTest<double, Dune::SizeClassAllocator<double,64> >(d);
     }
   } catch (Dune::Exception& e) {
     std::cerr << e << std::endl;
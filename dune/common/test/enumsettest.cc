@@ -4,6 +4,27 @@
 
 #include<dune/common/enumset.hh>
 #include<iostream>
+
+template<class S>
+int checkBitmask(const S& set)
+{
+  using namespace Dune;
+  typedef typename BitmaskAttributeSetOf<S,int>::Type Bitmask;
+  int ret=0;
+
+  if(!AttributeSetBitmask<S>::isBitmask){
+    std::cerr<<"Set should be representable as a bit mask"<<std::endl;
+    ++ret;
+  }
+
+  for(int i=-2; i<70; ++i)
+    if(Bitmask::contains(i)!=S::contains(i) || bitmaskContains(set, i)!=S::contains(i)){
+      std::cerr<<"Bit mask "<<Bitmask()<<" and set differ for "<<i<<std::endl;
+      ++ret;
+    }
+  return ret;
+}
+
 int main()
 {
   using namespace Dune;
@@ -11,4 +32,32 @@ int main()
     " "<<Combine<EnumItem<int,1>,EnumItem<int,2>,int>::contains(2)<<
     " "<<Combine<Combine<EnumItem<int,1>,EnumItem<int,2>,int>,EnumItem<int,0>,int>::contains(3)<<
     " "<<EnumRange<int,1,3>::contains(3)<<std::endl;
+
+  int ret=0;
+  ret+=checkBitmask(EmptySet<int>());
+  ret+=checkBitmask(EnumItem<int,0>());
+  ret+=checkBitmask(EnumItem<int,63>());
+  ret+=checkBitmask(EnumRange<int,1,3>());
+  ret+=checkBitmask(EnumRange<int,0,63>());
+  ret+=checkBitmask(EnumRange<int,5,2>());
+  ret+=checkBitmask(Combine<Combine<EnumItem<int,1>,EnumItem<int,2>,int>,EnumRange<int,10,20>,int>());
+  ret+=checkBitmask(BitmaskAttributeSet<int,0x11>());
+
+  // sets that cannot be represented by a bit mask
+  if(AttributeSetBitmask<EnumItem<int,64> >::isBitmask ||
+     AttributeSetBitmask<EnumRange<int,-1,3> >::isBitmask ||
+     AttributeSetBitmask<AllSet<int> >::isBitmask ||
+     AttributeSetBitmask<NegateSet<EnumItem<int,1> > >::isBitmask ||
+     AttributeSetBitmask<Combine<EnumItem<int,1>,EnumItem<int,-1>,int> >::isBitmask){
+    std::cerr<<"Set wrongly considered representable as a bit mask"<<std::endl;
+    ++ret;
+  }
+
+  if(bitmaskContains(NegateSet<EnumItem<int,1> >(), 1) ||
+     !bitmaskContains(NegateSet<EnumItem<int,1> >(), 100)){
+    std::cerr<<"Fallback to contains failed"<<std::endl;
+    ++ret;
+  }
+
+  return ret;
 }
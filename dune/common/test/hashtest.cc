@@ -0,0 +1,157 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/dynvector.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/hash.hh>
+#include <dune/common/reservedvector.hh>
+#include <dune/common/timer.hh>
+#include <dune/common/tupleutility.hh>
+#include <dune/common/parallel/indexset.hh>
+#include <dune/common/parallel/localindex.hh>
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#if HAVE_DUNE_HASH
+
+template<class T>
+std::size_t hashOf(const T& t)
+{
+  Dune::hash<T> hasher;
+  return hasher(t);
+}
+
+int testEquality()
+{
+  int ret=0;
+  Dune::FieldVector<double,3> a(1.5), b(1.5);
+  a[2]=-0.0;
+  b[2]=0.0;
+  if(hashOf(a)!=hashOf(b)){
+    std::cerr<<"equal FieldVectors have different hashes"<<std::endl;
+    ++ret;
+  }
+  Dune::DynamicVector<double> c(3, 1.5);
+  c[2]=0.0;
+  if(hashOf(c)!=hashOf(a)){
+    std::cerr<<"equal DynamicVector and FieldVector have different hashes"<<std::endl;
+    ++ret;
+  }
+
+  Dune::ReservedVector<int,8> r, s;
+  for(int i=0; i<5; ++i){
+    r.push_back(i);
+    s.push_back(i);
+  }
+  if(r!=s || hashOf(r)!=hashOf(s)){
+    std::cerr<<"equal ReservedVectors have different hashes"<<std::endl;
+    ++ret;
+  }
+  s.push_back(0);
+  if(r==s || hashOf(r)==hashOf(s)){
+    std::cerr<<"appending a zero does not change the hash"<<std::endl;
+    ++ret;
+  }
+
+  typedef Dune::IndexPair<int, Dune::LocalIndex> IndexPair;
+  IndexPair p(17, Dune::LocalIndex(3)), q(17, Dune::LocalIndex(5));
+  if(hashOf(p)!=hashOf(q)){
+    std::cerr<<"IndexPairs with equal global index have different hashes"<<std::endl;
+    ++ret;
+  }
+
+  Dune::tuple<int,double,std::string> t(1, 2.0, "three"), u(1, 2.0, "three"), v(1, 2.0, "four");
+  Dune::TupleHash tupleHash;
+  if(tupleHash(t)!=tupleHash(u) || tupleHash(t)==tupleHash(v)){
+    std::cerr<<"wrong tuple hashes"<<std::endl;
+    ++ret;
+  }
+
+  const char text[] = "a string of some bytes";
+  if(Dune::hash_bytes(text, sizeof(text))!=Dune::hash_bytes(std::string(text).c_str(), sizeof(text))
+     || Dune::hash_bytes(text, 9)==Dune::hash_bytes(text, 10)
+     || Dune::hash_bytes(text, 9, 1)==Dune::hash_bytes(text, 9, 2)){
+    std::cerr<<"wrong byte hashes"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+// Hash the points of a regular grid into 4096 buckets, as a node
+// deduplication would, and count the used buckets.
+int testDistribution()
+{
+  const int n=32;
+  const std::size_t buckets=4096;
+  std::vector<char> used(buckets, 0);
+  std::vector<char> usedCombine(buckets, 0);
+  std::set<std::size_t> values;
+  for(int i=0; i<n; ++i)
+    for(int j=0; j<n; ++j)
+      for(int k=0; k<n; ++k){
+        Dune::FieldVector<double,3> x;
+        x[0]=0.125*i; x[1]=0.125*j; x[2]=0.125*k;
+        std::size_t h=hashOf(x);
+        values.insert(h);
+        used[h%buckets]=1;
+        usedCombine[Dune::hash_range(x.begin(), x.end())%buckets]=1;
+      }
+  std::size_t count=0, countCombine=0;
+  for(std::size_t b=0; b<buckets; ++b){
+    count+=used[b];
+    countCombine+=usedCombine[b];
+  }
+  std::cout<<n*n*n<<" grid points: "<<values.size()<<" distinct hashes, "
+           <<count<<" of "<<buckets<<" buckets used ("
+           <<countCombine<<" with hash_range)"<<std::endl;
+
+  int ret=0;
+  // a uniform hash of 32768 keys leaves practically no bucket empty
+  if(values.size()!=std::size_t(n*n*n) || count<buckets-8){
+    std::cerr<<"poorly distributed hash values"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+void benchmark()
+{
+  const std::size_t size=1<<16;
+  std::vector<Dune::FieldVector<double,3> > points(size);
+  for(std::size_t i=0; i<size; ++i)
+    for(int j=0; j<3; ++j)
+      points[i][j]=0.001*double((i*(j+7))%size);
+
+  Dune::Timer timer;
+  std::size_t checksum=0;
+  for(int round=0; round<20; ++round)
+    for(std::size_t i=0; i<size; ++i)
+      checksum+=hashOf(points[i]);
+  double fast=timer.elapsed();
+
+  timer.reset();
+  for(int round=0; round<20; ++round)
+    for(std::size_t i=0; i<size; ++i)
+      checksum+=Dune::hash_range(points[i].begin(), points[i].end());
+  double combine=timer.elapsed();
+
+  std::cout<<"FieldVector<double,3>: "<<1e9*fast/(20*size)<<" ns/hash, hash_range "
+           <<1e9*combine/(20*size)<<" ns/hash (checksum "<<checksum<<")"<<std::endl;
+}
+
+#endif // HAVE_DUNE_HASH
+
+int main()
+{
+  int ret=0;
+#if HAVE_DUNE_HASH
+  ret+=testEquality();
+  ret+=testDistribution();
+  benchmark();
+#endif
+  return ret;
+}
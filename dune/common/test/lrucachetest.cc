@@ -0,0 +1,179 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/lrucache.hh>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HAVE_STD_THREAD
+#include <thread>
+#endif
+
+#if HAVE_DUNE_HASH
+
+/** @brief Computes a value and counts the calls. */
+struct Square
+{
+  Square(int& calls) : calls_(calls)
+  {}
+
+  double operator()(int key)
+  {
+    ++calls_;
+    return double(key)*key;
+  }
+
+  int& calls_;
+};
+
+int testLRUCache()
+{
+  int ret=0;
+  Dune::LRUCache<int, double> cache(3);
+
+  cache.insert(10, 1.0);
+  cache.insert(11, 2.0);
+  cache.insert(12, 3.0);
+  if(cache.front().first!=12 || cache.back().first!=10 || cache.size()!=3){
+    std::cerr<<"wrong order after insertion"<<std::endl;
+    ++ret;
+  }
+
+  // a hit makes the entry the most recent one.
+  double* value = cache.find(10);
+  if(!value || *value!=1.0 || cache.front().first!=10 || cache.back().first!=11){
+    std::cerr<<"find did not update the order"<<std::endl;
+    ++ret;
+  }
+  if(cache.find(13)){
+    std::cerr<<"found a key never inserted"<<std::endl;
+    ++ret;
+  }
+
+  // the least recently used entry is evicted.
+  cache.insert(13, 4.0);
+  if(cache.find(11) || cache.size()!=3 || cache.back().first!=12){
+    std::cerr<<"wrong entry evicted"<<std::endl;
+    ++ret;
+  }
+
+  // replacing a value does not evict.
+  cache.insert(12, 5.0);
+  if(*cache.find(12)!=5.0 || cache.size()!=3){
+    std::cerr<<"replacing a value failed"<<std::endl;
+    ++ret;
+  }
+
+  if(!cache.erase(13) || cache.erase(13) || cache.size()!=2){
+    std::cerr<<"erase failed"<<std::endl;
+    ++ret;
+  }
+
+  const Dune::LRUCacheStatistics& stats = cache.statistics();
+  if(stats.hits!=2 || stats.misses!=2 || stats.evictions!=1){
+    std::cerr<<"wrong statistics "<<stats<<std::endl;
+    ++ret;
+  }
+
+  // memoisation
+  int calls=0;
+  cache.clear();
+  cache.resetStatistics();
+  for(int round=0; round<3; ++round)
+    for(int key=0; key<3; ++key)
+      if(cache.findOrInsert(key, Square(calls))!=key*key){
+        std::cerr<<"findOrInsert returned a wrong value"<<std::endl;
+        ++ret;
+      }
+  if(calls!=3 || cache.statistics().hits!=6 || cache.statistics().misses!=3){
+    std::cerr<<"findOrInsert computed "<<calls<<" values, "<<cache.statistics()<<std::endl;
+    ++ret;
+  }
+
+  // many keys sharing few buckets
+  Dune::LRUCache<std::string, int> strings(100);
+  std::vector<std::string> names(1000);
+  for(int i=0; i<1000; ++i){
+    std::ostringstream name;
+    name<<i;
+    names[i]=name.str();
+    strings.insert(names[i], i);
+  }
+  int found=0;
+  for(int i=0; i<1000; ++i){
+    int* v=strings.find(names[i]);
+    if(v){
+      ++found;
+      if(*v!=i || i<900){
+        std::cerr<<"wrong entry "<<i<<" found"<<std::endl;
+        ++ret;
+      }
+    }
+  }
+  if(found!=100 || strings.statistics().evictions!=900){
+    std::cerr<<"found "<<found<<" of the last 100 entries"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+#if HAVE_STD_THREAD
+/** @brief Computes a value without counting. */
+long cube(int key)
+{
+  return long(key)*key*key;
+}
+
+int testShardedLRUCache()
+{
+  Dune::ShardedLRUCache<int, long> cache(64, 8);
+  const int threads=4;
+  std::vector<int> errors(threads, 0);
+  std::vector<std::thread> workers;
+  for(int t=0; t<threads; ++t)
+    workers.push_back(std::thread([&cache, &errors, t](){
+          for(int i=0; i<20000; ++i){
+            int key = (i*7+t)%100;
+            if(cache.findOrInsert(key, cube)!=cube(key))
+              ++errors[t];
+            long value;
+            if(cache.find(key, value) && value!=cube(key))
+              ++errors[t];
+          }
+        }));
+  for(int t=0; t<threads; ++t)
+    workers[t].join();
+
+  int ret=0;
+  for(int t=0; t<threads; ++t)
+    ret+=errors[t];
+  if(ret)
+    std::cerr<<ret<<" wrong values in the sharded cache"<<std::endl;
+
+  Dune::LRUCacheStatistics stats = cache.statistics();
+  if(stats.hits+stats.misses!=2*threads*20000 || cache.size()>cache.capacity()){
+    std::cerr<<"wrong statistics of the sharded cache "<<stats<<std::endl;
+    ++ret;
+  }
+  std::cout<<"sharded cache: "<<stats<<std::endl;
+  return ret;
+}
+#endif // HAVE_STD_THREAD
+
+#endif // HAVE_DUNE_HASH
+
+int main()
+{
+  int ret=0;
+#if HAVE_DUNE_HASH
+  ret += testLRUCache();
+#if HAVE_STD_THREAD
+  ret += testShardedLRUCache();
+#endif
+#endif
+  return ret;
+}
@@ -0,0 +1,136 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/ftraits.hh>
+
+// store floats, accumulate in double
+namespace Dune {
+  template<>
+  struct AccumulationTraits<float>
+  {
+    typedef double accumulation_type;
+    typedef double real_accumulation_type;
+  };
+}
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/timer.hh>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Dune;
+
+/** @brief Pseudo random numbers in [0,1). */
+double random(std::size_t& seed)
+{
+  seed = seed*6364136223846793005ull + 1442695040888963407ull;
+  return double(seed>>11)/double(1ull<<53);
+}
+
+int testAccumulation()
+{
+  int ret=0;
+  // 1e8+1 is not a float
+  FieldVector<float,3> x, ones(1.0f);
+  x[0]=1e8f; x[1]=1; x[2]=-1e8f;
+  DynamicVector<float> y(3);
+  y[0]=1; y[1]=1; y[2]=1;
+  if(x*ones!=1 || x.dot(y)!=1 || ones*x!=1){
+    std::cerr<<"dot products are not accumulated in double"<<std::endl;
+    ++ret;
+  }
+
+  // the squares overflow float
+  FieldVector<float,2> big;
+  big[0]=3e20f; big[1]=4e20f;
+  if(std::abs(big.two_norm()/5e20f-1)>1e-6 || big.one_norm()!=7e20f){
+    std::cerr<<"norms are not accumulated in double: "<<big.two_norm()<<std::endl;
+    ++ret;
+  }
+
+  FieldMatrix<float,2,3> A;
+  A[0]=x;
+  A[1]=ones;
+  FieldVector<float,2> b(1.0f), c;
+  A.mv(ones, b);
+  A.mmv(ones, c=b);
+  A.usmv(2.0f, ones, b);
+  if(b[0]!=3 || b[1]!=9 || c.two_norm()!=0 || A.frobenius_norm2()!=2e16f+4){
+    std::cerr<<"matrix-vector products are not accumulated in double"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testRefinedSolve()
+{
+  int ret=0;
+  const int n=200;
+  std::size_t seed=1;
+  DynamicMatrix<double> A(n, n);
+  DynamicVector<double> exact(n), b(n), x(n), y(n);
+  for(int i=0; i<n; ++i){
+    for(int j=0; j<n; ++j)
+      A[i][j]=random(seed)-0.5;
+    A[i][i]+=4;
+    exact[i]=random(seed);
+  }
+  A.mv(exact, b);
+
+  Timer timer;
+  bool converged=A.refinedSolve<float>(x, b);
+  double refinedTime=timer.elapsed();
+  timer.reset();
+  A.solve(y, b);
+  double solveTime=timer.elapsed();
+
+  DynamicMatrix<float> Af(A);
+  DynamicVector<float> xf(n), bf(b);
+  Af.solve(xf, bf);
+  DynamicVector<double> errorf(xf);
+  errorf-=exact;
+
+  x-=exact;
+  y-=exact;
+  std::cout<<"error of refinedSolve "<<x.infinity_norm()<<" in "<<refinedTime
+           <<" s, of solve "<<y.infinity_norm()<<" in "<<solveTime
+           <<" s, in float "<<errorf.infinity_norm()<<std::endl;
+  if(!converged || x.infinity_norm()>1e-13 || errorf.infinity_norm()<1e-7){
+    std::cerr<<"refinedSolve does not reach double accuracy"<<std::endl;
+    ++ret;
+  }
+
+  // eigenvalues 1, 1, 1 and 1e-10 in another basis, too ill-conditioned for float
+  FieldMatrix<double,4,4> Q(-0.5), D(0.0), B;
+  for(int i=0; i<4; ++i){
+    Q[i][i]+=1;
+    D[i][i]=1;
+  }
+  D[3][3]=1e-10;
+  B=Q;
+  B.rightmultiply(D);
+  B.rightmultiply(Q);
+  FieldVector<double,4> e(1.0), c, z, w;
+  B.mv(e, c);
+  converged=B.refinedSolve<float>(z, c);
+  B.solve(w, c);
+  if(converged || z!=w){
+    std::cerr<<"refinedSolve does not fall back to solve"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int main()
+{
+  int ret=0;
+  ret+=testAccumulation();
+  ret+=testRefinedSolve();
+  return ret;
+}
@@ -3,11 +3,14 @@
 #endif
 
 #include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/reproduciblesum.hh>
 
 #if HAVE_MPI 
 #include<dune/common/parallel/mpicollectivecommunication.hh>
 #endif
 
+#include<cmath>
+#include<cstring>
 #include<iostream>
 int main(int argc, char** argv)
 {
@@ -45,6 +48,24 @@ int main(int argc, char** argv)
       assert( std::abs( values[i] - sum ) < 1e-8 );
       assert( std::abs( val[i]    - sum ) < 1e-8 );
     }
+
+    // a reproducible sum of terms distributed round robin is the same
+    // as the sequential one, whatever the number of processes
+    Dune::ReproducibleSum local, sequential;
+    for(int i=0; i<1000; ++i)
+    {
+      double term = std::ldexp(std::sin(i+1.0), i%40-20);
+      sequential += term;
+      if(i%mpi.size()==mpi.rank())
+        local += term;
+    }
+    double global = comm.sum(local).value();
+    double expected = sequential.value();
+    if(std::memcmp(&global, &expected, sizeof(double))!=0)
+    {
+      std::cerr << "reproducible global sum differs from the sequential one" << std::endl;
+      return 1;
+    }
   }
   
   std::cout << "We are at the end!"<<std::endl;
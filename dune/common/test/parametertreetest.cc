@@ -2,8 +2,15 @@
 #include "config.h"
 #endif
 
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
+#if HAVE_STD_THREAD
+#include <thread>
+#endif
 #include <dune/common/parametertree.hh>
 #include <dune/common/parametertreeparser.hh>
 
@@ -100,6 +107,144 @@ void testmodify(P parameterSet)
         DUNE_THROW(Dune::Exception, "Failed to write subtree entry");
 }
 
+void testcache()
+{
+    Dune::ParameterTree p;
+    p["a.b.dt"] = "0.5";
+    p["n"] = "3";
+
+    // cached values follow changes of the strings
+    if (p.get<double>("a.b.dt") != 0.5 || p.get<int>("n") != 3 || p.get<double>("n") != 3)
+        DUNE_THROW(Dune::Exception, "wrong cached values");
+    p["a.b.dt"] = "0.25";
+    p.sub("a")["b.dt"] += "5";
+    if (p.get<double>("a.b.dt") != 0.255 || p.get<std::string>("a.b.dt") != "0.255"
+        || p.get("a.b.missing", 7) != 7)
+        DUNE_THROW(Dune::Exception, "cached value not updated");
+
+    // handles
+    Dune::ParameterTree::Handle<double> dt = p.handle<double>("a.b.dt");
+    Dune::ParameterTree::Handle<std::vector<int> > v;
+    p["v"] = "1 2 3";
+    v = p.handle<std::vector<int> >("v");
+    double t = 0;
+    for (int i = 0; i < 1000; ++i)
+        t += dt.get();
+    p["v"] = "4 5";
+    if (std::abs(t - 255) > 1e-9 || v.get().size() != 2 || v.get()[1] != 5 || dt.key() != "a.b.dt")
+        DUNE_THROW(Dune::Exception, "wrong values from handles");
+
+    // assigning a subtree destroys the values the handles point to
+    Dune::ParameterTree q;
+    q["b.dt"] = "2";
+    p.sub("a") = q;
+    if (dt.get() != 2 || p.get<double>("a.b.dt") != 2)
+        DUNE_THROW(Dune::Exception, "handle not resolved again after assignment");
+    {
+        // assigning the parent may construct the subtree anew in the same storage
+        Dune::ParameterTree parent, other;
+        parent["s.x"] = "1";
+        other["s.x"] = "2";
+        Dune::ParameterTree& s = parent.sub("s");
+        Dune::ParameterTree::Handle<int> x = s.handle<int>("x");
+        parent = other;
+        if (&parent.sub("s") == &s && x.get() != 2)
+            DUNE_THROW(Dune::Exception, "handle of a subtree constructed anew not resolved again");
+    }
+    p.sub("a") = Dune::ParameterTree();
+    try {
+        dt.get();
+        DUNE_THROW(Dune::Exception, "failed to detect removed key");
+    }
+    catch (Dune::RangeError & r) {}
+    try {
+        p.handle<int>("x");
+        DUNE_THROW(Dune::Exception, "failed to detect missing key");
+    }
+    catch (Dune::RangeError & r) {}
+    p["x"] = "abc";
+    try {
+        p.get<int>("x");
+        DUNE_THROW(Dune::Exception, "failed to detect unparsable value");
+    }
+    catch (Dune::RangeError & r) {}
+
+    // copies have their own index
+    p["a.b.dt"] = "3";
+    Dune::ParameterTree copy(p);
+    copy["a.b.dt"] = "4";
+    if (copy.get<double>("a.b.dt") != 4 || p.get<double>("a.b.dt") != 3)
+        DUNE_THROW(Dune::Exception, "copy shares the cached values");
+}
+
+#if HAVE_STD_THREAD
+void readConcurrently(const Dune::ParameterTree* p, int* failures)
+{
+    for (int i = 0; i < 1000; ++i)
+        if (p->get<int>("k" + std::to_string(i % 50)) != i % 50 || p->get<double>("a.b.dt") != 0.5)
+            ++*failures;
+}
+
+void testthreads()
+{
+    // threads filling the caches of the same tree at once
+    Dune::ParameterTree p;
+    for (int i = 0; i < 50; ++i)
+        p["k" + std::to_string(i)] = std::to_string(i);
+    p["a.b.dt"] = "0.5";
+    std::vector<int> failures(4, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.push_back(std::thread(readConcurrently, &p, &failures[t]));
+    for (int t = 0; t < 4; ++t)
+        threads[t].join();
+    for (int t = 0; t < 4; ++t)
+        if (failures[t] != 0)
+            DUNE_THROW(Dune::Exception, "wrong values read by several threads");
+}
+#endif
+
+void testbinary(const Dune::ParameterTree& c)
+{
+    std::vector<char> blob;
+    Dune::ParameterTreeParser::writeBinaryTree(c, blob);
+    Dune::ParameterTree p;
+    p["x1"] = "keep";
+    Dune::ParameterTreeParser::readBinaryTree(blob, p, false);
+    std::ostringstream expected, copy;
+    c.report(expected);
+    p["x1"] = c["x1"];
+    p.report(copy);
+    if (copy.str() != expected.str() || p.getValueKeys() != c.getValueKeys()
+        || p.getSubKeys() != c.getSubKeys())
+        DUNE_THROW(Dune::Exception, "binary ParameterTree differs:\n" << copy.str());
+    blob.pop_back();
+    try {
+        Dune::ParameterTreeParser::readBinaryTree(blob, p);
+        DUNE_THROW(Dune::Exception, "failed to detect truncated binary tree");
+    }
+    catch (Dune::IOError & e) {}
+
+    // a collective read, here with the sequential communication
+    const char* file = "parametertreetest.ini";
+    {
+        std::ofstream out(file);
+        out << "a = 1\n[b]\nc = 'two\nlines'\n";
+    }
+    Dune::CollectiveCommunication<Dune::No_Comm> comm;
+    Dune::ParameterTree q;
+    q["a"] = "0";
+    Dune::ParameterTreeParser::readINITree(comm, file, q, false);
+    std::remove(file);
+    if (q["a"] != "0" || q["b.c"] != "two\nlines")
+        DUNE_THROW(Dune::Exception, "wrong collective readINITree");
+    try {
+        Dune::ParameterTreeParser::readINITree(comm, file, q);
+        DUNE_THROW(Dune::Exception, "failed to detect missing file");
+    }
+    catch (Dune::IOError & e) {}
+}
+
 int main()
 {
     try {
@@ -126,6 +271,12 @@ int main()
 
         // more const tests
         testparam<Dune::ParameterTree>(c);
+
+        testcache();
+#if HAVE_STD_THREAD
+        testthreads();
+#endif
+        testbinary(c);
     }
     catch (Dune::Exception & e)
     {
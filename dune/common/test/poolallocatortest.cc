@@ -7,6 +7,15 @@
 #include<dune/common/poolallocator.hh>
 #include<dune/common/alignment.hh>
 #include<dune/common/fmatrix.hh>
+#include<dune/common/sizeclassallocator.hh>
+#include<algorithm>
+#include<vector>
+
+#if HAVE_STD_THREAD
+#include<dune/common/threadcachingpool.hh>
+#include<chrono>
+#include<thread>
+#endif
 
 using namespace Dune;
 
@@ -119,6 +128,236 @@ int testPool()
   return ret;
 }   
 
+/**
+ * @brief Test the size classes and the use in std::vector.
+ */
+template<typename T, std::size_t m>
+int testSizeClassAllocator()
+{
+  typedef SizeClassAllocator<T,m> Allocator;
+  int ret=0;
+
+  // requests are rounded up to the next power of two.
+  for(std::size_t n=1; n<=static_cast<std::size_t>(Allocator::maxPooled); ++n){
+    std::size_t c = Allocator::sizeClass(n);
+    if((std::size_t(1)<<c)<n || (c>0 && (std::size_t(1)<<(c-1))>=n)){
+      std::cerr<<"wrong size class "<<c<<" for "<<n<<" objects"<<std::endl;
+      ++ret;
+    }
+  }
+  if((std::size_t(1)<<(Allocator::classes-1))*sizeof(T)>m ||
+     Allocator::sizeClass(Allocator::maxPooled+1)!=static_cast<std::size_t>(Allocator::classes)){
+    std::cerr<<"requests of more than "<<m<<" bytes have to be sent to malloc"<<std::endl;
+    ++ret;
+  }
+
+  // blocks of the same size class must not overlap.
+  Allocator allocator;
+  std::vector<char*> blocks;
+  const std::size_t n = 3;
+  for(int i=0; i<100; ++i)
+    blocks.push_back(reinterpret_cast<char*>(allocator.allocate(n)));
+  std::sort(blocks.begin(), blocks.end());
+  for(std::size_t i=1; i<blocks.size(); ++i)
+    if(blocks[i-1]+n*sizeof(T)>blocks[i]){
+      std::cerr<<"allocated blocks overlap!"<<std::endl;
+      ++ret;
+    }
+  for(std::size_t i=0; i<blocks.size(); ++i)
+    allocator.deallocate(reinterpret_cast<T*>(blocks[i]), n);
+
+  // growing vectors move through all size classes and into malloc.
+  std::vector<std::vector<int, typename Allocator::template rebind<int>::other> > vectors(10);
+  for(int i=0; i<1000; ++i)
+    for(std::size_t v=0; v<vectors.size(); ++v)
+      vectors[v].push_back(i*v);
+  for(std::size_t v=0; v<vectors.size(); ++v){
+    for(int i=0; i<1000; ++i)
+      if(vectors[v][i]!=static_cast<int>(i*v)){
+        std::cerr<<"wrong value in vector "<<v<<std::endl;
+        ++ret;
+        break;
+      }
+    vectors[v].resize(v);
+    std::vector<int, typename Allocator::template rebind<int>::other>(vectors[v]).swap(vectors[v]);
+  }
+  return ret;
+}
+
+#if HAVE_STD_THREAD
+
+/** @brief The pattern written into an object by a thread. */
+unsigned long stamp(int thread, int i)
+{
+  return (static_cast<unsigned long>(thread)<<32) + i;
+}
+
+/**
+ * @brief Stress a ThreadCachingPool with several threads.
+ *
+ * Each thread allocates objects and stamps them. Afterwards the objects
+ * are checked and freed by the next thread, so memory migrates between
+ * the threads. Finally each thread runs a random sequence of
+ * allocations and deallocations.
+ */
+template<typename T, std::size_t size>
+int testThreadCachingPool(int threads)
+{
+  typedef ThreadCachingPool<T,size> Pool;
+  dune_static_assert(sizeof(T)>=sizeof(unsigned long), "T is too small for the stamp");
+  const int objects=5000;
+  int ret=0;
+
+  Pool pool;
+  std::vector<std::vector<void*> > allocated(threads);
+  std::vector<int> errors(threads, 0);
+  std::vector<std::thread> workers;
+
+  for(int t=0; t<threads; ++t)
+    workers.push_back(std::thread([&pool, &allocated, t, objects](){
+          for(int i=0; i<objects; ++i){
+            void* o = pool.allocate();
+            *static_cast<unsigned long*>(o) = stamp(t, i);
+            allocated[t].push_back(o);
+          }
+        }));
+  for(int t=0; t<threads; ++t)
+    workers[t].join();
+  workers.clear();
+
+  // no object may be handed out twice.
+  std::vector<char*> all;
+  for(int t=0; t<threads; ++t)
+    for(int i=0; i<objects; ++i)
+      all.push_back(static_cast<char*>(allocated[t][i]));
+  std::sort(all.begin(), all.end());
+  for(std::size_t i=1; i<all.size(); ++i)
+    if(all[i-1]+sizeof(T)>all[i]){
+      std::cerr<<"allocated elements overlap!"<<std::endl;
+      ++ret;
+    }
+
+  for(int t=0; t<threads; ++t)
+    workers.push_back(std::thread([&pool, &allocated, &errors, t, threads, objects](){
+          int other=(t+1)%threads;
+          for(int i=0; i<objects; ++i){
+            void* o = allocated[other][i];
+            if(*static_cast<unsigned long*>(o)!=stamp(other, i))
+              ++errors[t];
+            pool.free(o);
+          }
+
+          std::vector<void*> live;
+          unsigned int seed=t+1;
+          for(int i=0; i<20*objects; ++i){
+            seed = seed*1103515245u+12345u;
+            if(live.empty() || (seed>>16)%3!=0){
+              void* o = pool.allocate();
+              *static_cast<unsigned long*>(o) = stamp(t, live.size());
+              live.push_back(o);
+            }else{
+              void* o = live.back();
+              live.pop_back();
+              if(*static_cast<unsigned long*>(o)!=stamp(t, live.size()))
+                ++errors[t];
+              pool.free(o);
+            }
+          }
+          for(; !live.empty(); live.pop_back())
+            pool.free(live.back());
+          pool.flush();
+        }));
+  for(int t=0; t<threads; ++t){
+    workers[t].join();
+    ret+=errors[t];
+  }
+
+  std::vector<ThreadCachingPoolStatistics> stats = pool.statistics();
+  std::size_t allocations=0, deallocations=0;
+  for(std::size_t i=0; i<stats.size(); ++i){
+    allocations+=stats[i].allocations;
+    deallocations+=stats[i].deallocations;
+  }
+  if(allocations!=deallocations){
+    std::cerr<<"allocations "<<allocations<<" do not match deallocations "
+             <<deallocations<<std::endl;
+    ++ret;
+  }
+  if(stats.size()!=static_cast<std::size_t>(2*threads)){
+    std::cerr<<"expected statistics for "<<2*threads<<" threads, got "
+             <<stats.size()<<std::endl;
+    ++ret;
+  }
+  if(ret)
+    for(std::size_t i=0; i<stats.size(); ++i)
+      std::cerr<<stats[i]<<std::endl;
+
+  return ret;
+}
+
+/**
+ * @brief Check that a thread using short-lived pools does not collect their caches.
+ */
+int testShortLivedThreadCachingPools()
+{
+  for(int i=0; i<1000; ++i){
+    ThreadCachingPool<double,0> pool;
+    pool.free(pool.allocate());
+  }
+  if(Detail::threadCaches().size()>2){
+    std::cerr<<"the thread keeps "<<Detail::threadCaches().size()
+             <<" entries of destroyed pools"<<std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Measure the time per allocation and deallocation.
+ */
+template<class P>
+double benchmarkPool(P& pool, int rounds)
+{
+  const int batch=1000;
+  void* objects[batch];
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(int round=0; round<rounds; ++round){
+    for(int i=0; i<batch; ++i)
+      objects[i]=pool.allocate();
+    for(int i=0; i<batch; ++i)
+      pool.free(objects[i]);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count()/(2.0*batch*rounds)*1e9;
+}
+
+/**
+ * @brief Compare the throughput of Pool and ThreadCachingPool.
+ */
+void benchmarkThreadCachingPool(int threads)
+{
+  const int rounds=1000;
+  Pool<double,1000> pool;
+  ThreadCachingPool<double,1000> tpool;
+
+  std::cout<<"Pool: "<<benchmarkPool(pool, rounds)<<" ns/op"<<std::endl;
+  std::cout<<"ThreadCachingPool, 1 thread: "<<benchmarkPool(tpool, rounds)
+           <<" ns/op"<<std::endl;
+
+  std::vector<double> times(threads);
+  std::vector<std::thread> workers;
+  for(int t=0; t<threads; ++t)
+    workers.push_back(std::thread([&tpool, &times, t, rounds](){
+          times[t]=benchmarkPool(tpool, rounds);
+        }));
+  for(int t=0; t<threads; ++t)
+    workers[t].join();
+  std::cout<<"ThreadCachingPool, "<<threads<<" threads: "
+           <<*std::max_element(times.begin(), times.end())<<" ns/op"<<std::endl;
+}
+
+#endif
+
 int main(int argc, char **argv)
 {
   int ret=0;
@@ -135,6 +374,18 @@ int main(int argc, char **argv)
   std::cout<<AlignmentOf<UnAligned>::value<<" "<<sizeof(UnAligned)<<std::endl;
 
   ret += testPool<UnAligned>();
+
+  ret += testSizeClassAllocator<double,1024>();
+  ret += testSizeClassAllocator<UnAligned,100>();
+  ret += testSizeClassAllocator<Dune::FieldMatrix<double,3,3>,4096>();
+
+#if HAVE_STD_THREAD
+  int threads = std::max(4u, std::thread::hardware_concurrency());
+  ret += testThreadCachingPool<double,0>(threads);
+  ret += testThreadCachingPool<Dune::FieldMatrix<double,3,3>,1000>(threads);
+  ret += testShortLivedThreadCachingPools();
+  benchmarkThreadCachingPool(threads);
+#endif
   
   return ret;
 }
@@ -0,0 +1,185 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/profiler.hh>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HAVE_STD_THREAD
+#include <thread>
+#endif
+
+/** @brief A row of the report: the indented name and the numbers. */
+struct Row
+{
+  std::string label;
+  double calls, wallMin, wallAvg, wallMax;
+};
+
+std::vector<Row> report()
+{
+  std::ostringstream out;
+  Dune::Profiler::report(out);
+  std::cout<<out.str();
+  std::istringstream in(out.str());
+  std::vector<Row> rows;
+  std::string line;
+  std::getline(in, line);
+  while(std::getline(in, line)){
+    Row row;
+    const std::string::size_type space=line.find(' ', line.find_first_not_of(' '));
+    row.label=line.substr(0, space);
+    std::istringstream numbers(line.substr(space));
+    numbers>>row.calls>>row.wallMin>>row.wallAvg>>row.wallMax;
+    rows.push_back(row);
+  }
+  return rows;
+}
+
+void wait(double seconds)
+{
+  const double end=Dune::Profiler::wallTime()+seconds;
+  while(Dune::Profiler::wallTime()<end);
+}
+
+void assemble()
+{
+  Dune::ScopedRegion region("assemble");
+  for(int i=0; i<3; ++i){
+    Dune::ScopedRegion region("quadrature");
+    wait(1e-3);
+  }
+}
+
+int testNesting()
+{
+  int ret=0;
+  Dune::Profiler::enable();
+  {
+    Dune::ScopedRegion region("solve");
+    assemble();
+    assemble();
+  }
+  assemble();
+  // an equal name in another variable
+  std::string name("solve");
+  {
+    Dune::ScopedRegion region(name.c_str());
+  }
+
+  const std::vector<Row> rows=report();
+  if(rows.size()!=5 || rows[0].label!="solve" || rows[0].calls!=2
+     || rows[1].label!="  assemble" || rows[1].calls!=2
+     || rows[2].label!="    quadrature" || rows[2].calls!=6
+     || rows[3].label!="assemble" || rows[3].calls!=1
+     || rows[4].label!="  quadrature" || rows[4].calls!=3){
+    std::cerr<<"wrong regions"<<std::endl;
+    return 1;
+  }
+  if(rows[2].wallAvg<6e-3 || rows[1].wallAvg<rows[2].wallAvg || rows[0].wallAvg<rows[1].wallAvg
+     || rows[0].wallMin!=rows[0].wallAvg || rows[0].wallMax!=rows[0].wallAvg){
+    std::cerr<<"wrong times"<<std::endl;
+    ++ret;
+  }
+
+  Dune::Profiler::reset();
+  if(!report().empty()){
+    std::cerr<<"reset did not remove the regions"<<std::endl;
+    ++ret;
+  }
+  Dune::Profiler::disable();
+  assemble();
+  if(!report().empty()){
+    std::cerr<<"regions recorded while disabled"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testThreads()
+{
+  int ret=0;
+#if HAVE_STD_THREAD
+  Dune::Profiler::enable(true);
+  std::vector<std::thread> threads;
+  for(int t=0; t<4; ++t)
+    threads.push_back(std::thread([t](){
+          for(int i=0; i<=t; ++i)
+            assemble();
+        }));
+  for(std::size_t t=0; t<threads.size(); ++t)
+    threads[t].join();
+
+  // calls summed, the wall time of the longest thread
+  const std::vector<Row> rows=report();
+  if(rows.size()!=2 || rows[0].label!="assemble" || rows[0].calls!=10
+     || rows[1].calls!=30 || rows[1].wallAvg<12e-3){
+    std::cerr<<"wrong aggregation over threads"<<std::endl;
+    ++ret;
+  }
+  Dune::Profiler::reset();
+  Dune::Profiler::disable();
+#endif
+  return ret;
+}
+
+int testCounters()
+{
+  int ret=0;
+  Dune::PerfCounters counters;
+  Dune::PerfCounters::Counts before, after;
+  counters.read(before);
+  wait(1e-3);
+  counters.read(after);
+  for(int e=0; e<Dune::PerfCounters::events; ++e){
+    const Dune::PerfCounters::Event event=Dune::PerfCounters::Event(e);
+    std::cout<<Dune::PerfCounters::name(event)<<": ";
+    if(counters.available(event))
+      std::cout<<after[e]-before[e]<<std::endl;
+    else
+      std::cout<<"not available"<<std::endl;
+    if(!counters.available(event) && (before[e]!=0 || after[e]!=0)){
+      std::cerr<<"unavailable counter "<<Dune::PerfCounters::name(event)<<" is not zero"<<std::endl;
+      ++ret;
+    }
+  }
+  if(counters.available(Dune::PerfCounters::instructions)
+     && after[Dune::PerfCounters::instructions]<=before[Dune::PerfCounters::instructions]){
+    std::cerr<<"no instructions counted"<<std::endl;
+    ++ret;
+  }
+
+  // the report has the derived columns, n/a where not available
+  Dune::Profiler::enable(false, true);
+  {
+    Dune::ScopedRegion region("kernel");
+    region.addFlops(1e6);
+    wait(1e-3);
+  }
+  std::ostringstream out;
+  Dune::Profiler::report(out);
+  std::cout<<out.str();
+  const bool ipc=counters.available(Dune::PerfCounters::cycles)
+    && counters.available(Dune::PerfCounters::instructions);
+  if(out.str().find("IPC")==std::string::npos || out.str().find("B/flop")==std::string::npos
+     || (!ipc && out.str().find("n/a")==std::string::npos)){
+    std::cerr<<"wrong counter columns"<<std::endl;
+    ++ret;
+  }
+  Dune::Profiler::reset();
+  Dune::Profiler::disable();
+  return ret;
+}
+
+int main()
+{
+  int ret=0;
+  ret+=testNesting();
+  ret+=testThreads();
+  ret+=testCounters();
+  return ret;
+}
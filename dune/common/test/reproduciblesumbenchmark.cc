@@ -0,0 +1,81 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/benchmark.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/reproduciblesum.hh>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Measure the overhead of reproducible dot products and reductions.
+ *
+ * Compares DenseVector::dot with reproducibleDot and the addition of doubles
+ * with the merge of ReproducibleSum accumulators, which the MPI_Op of a
+ * reproducible global sum performs once per process.
+ *
+ * Usage: reproduciblesumbenchmark [--repetitions N] [--warmup N] [--min-time S]
+ *                                 [--filter TEXT] [--json FILE]
+ */
+
+typedef Dune::DynamicVector<double> Vector;
+
+struct Dot
+{
+  const Vector& x; const Vector& y;
+  Dot(const Vector& x_, const Vector& y_) : x(x_), y(y_) {}
+  void operator() () const { Dune::Benchmark::doNotOptimize(x.dot(y)); }
+};
+
+struct ReproducibleDot
+{
+  const Vector& x; const Vector& y;
+  ReproducibleDot(const Vector& x_, const Vector& y_) : x(x_), y(y_) {}
+  void operator() () const { Dune::Benchmark::doNotOptimize(Dune::reproducibleDot(x, y).value()); }
+};
+
+/** @brief The work of the reduction operator, merging the accumulators of the processes. */
+struct Merge
+{
+  const std::vector<Dune::ReproducibleSum>& partial;
+  Merge(const std::vector<Dune::ReproducibleSum>& partial_) : partial(partial_) {}
+  void operator() () const
+  {
+    Dune::ReproducibleSum total;
+    for(std::size_t i=0; i<partial.size(); ++i)
+      total += partial[i];
+    Dune::Benchmark::doNotOptimize(total);
+  }
+};
+
+void dotBenchmarks(Dune::Benchmark& suite, std::size_t size)
+{
+  Vector x(size), y(size);
+  for(std::size_t i=0; i<size; ++i){
+    x[i] = 1.0/(i+1);
+    y[i] = (i%3) - 1.0;
+  }
+  std::ostringstream n;
+  n<<" n="<<size;
+  suite.run("dot"+n.str(), Dot(x, y), 2.0*size);
+  suite.run("reproducibleDot"+n.str(), ReproducibleDot(x, y), 2.0*size);
+}
+
+int main(int argc, char** argv)
+{
+  Dune::Benchmark suite("reproduciblesum", argc, argv);
+
+  dotBenchmarks(suite, 1000);
+  dotBenchmarks(suite, 1000000);
+
+  Vector x(1000, 0.1), y(1000, 3.0);
+  const std::vector<Dune::ReproducibleSum> partial(64, Dune::reproducibleDot(x, y));
+  suite.run("merge ReproducibleSum", Merge(partial), partial.size());
+
+  return suite.finish();
+}
@@ -0,0 +1,121 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/dynvector.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/reproduciblesum.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+/** @brief Pseudo random numbers in [0,1). */
+double random(std::size_t& seed)
+{
+  seed = seed*6364136223846793005ull + 1442695040888963407ull;
+  return double(seed>>11)/double(1ull<<53);
+}
+
+bool sameBits(double a, double b)
+{
+  return std::memcmp(&a, &b, sizeof(double))==0;
+}
+
+double sum(const double* terms, std::size_t n)
+{
+  Dune::ReproducibleSum s;
+  s.add(terms, terms+n);
+  return s.value();
+}
+
+int testRounding()
+{
+  int ret=0;
+  const double eps=std::numeric_limits<double>::epsilon();
+  const double denormMin=std::numeric_limits<double>::denorm_min();
+  const double inf=std::numeric_limits<double>::infinity();
+  double cancel[]={1e100, 1, -1e100};
+  double tie[]={1, eps/2};
+  double above[]={1, eps/2, 1e-100};
+  double oddTie[]={1+eps, eps/2};
+  double negative[]={-1.5, 0.25, -2e-300};
+  double tiny[]={denormMin, denormMin, -4*denormMin};
+  double huge[]={1e308, 1e308, -1e308};
+  double infinite[]={1, inf, 2};
+  if(sum(cancel, 3)!=1 || sum(tie, 2)!=1 || sum(above, 3)!=1+eps || sum(oddTie, 2)!=1+2*eps
+     || sum(negative, 3)!=-1.25 || sum(tiny, 3)!=-2*denormMin || sum(huge, 3)!=1e308
+     || sum(huge, 2)!=inf || sum(infinite, 3)!=inf || Dune::ReproducibleSum().value()!=0){
+    std::cerr<<"ReproducibleSum is not correctly rounded"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testOrder()
+{
+  int ret=0;
+  std::size_t seed=1;
+  std::vector<double> terms(10000);
+  for(std::size_t i=0; i<terms.size(); ++i)
+    terms[i]=std::ldexp(random(seed)-0.5, int(40*random(seed))-20);
+
+  const double expected=sum(&terms[0], terms.size());
+  double naive=0, shuffledNaive=0;
+  for(std::size_t i=0; i<terms.size(); ++i)
+    naive+=terms[i];
+  std::random_shuffle(terms.begin(), terms.end());
+  for(std::size_t i=0; i<terms.size(); ++i)
+    shuffledNaive+=terms[i];
+  if(!sameBits(sum(&terms[0], terms.size()), expected)){
+    std::cerr<<"the sum depends on the order of the terms"<<std::endl;
+    ++ret;
+  }
+
+  // sums of parts, as computed by different numbers of processes
+  for(std::size_t parts=2; parts<=64; parts*=2){
+    std::vector<Dune::ReproducibleSum> partial(parts);
+    for(std::size_t i=0; i<terms.size(); ++i)
+      partial[i*parts/terms.size()]+=terms[i];
+    Dune::ReproducibleSum total;
+    for(std::size_t p=parts; p-->0; )
+      total=partial[p]+total;
+    if(!sameBits(total.value(), expected)){
+      std::cerr<<"the sum depends on the partitioning into "<<parts<<" parts"<<std::endl;
+      ++ret;
+    }
+  }
+  std::cout<<std::setprecision(17)<<"reproducible sum "<<expected<<", naive sums "<<naive<<" and "<<shuffledNaive<<std::endl;
+  return ret;
+}
+
+int testDot()
+{
+  int ret=0;
+  Dune::DynamicVector<float> x(1000), y(1000);
+  for(int i=0; i<1000; ++i){
+    x[i]=i%2 ? 1e8f : -1e8f;
+    y[i]=1;
+  }
+  x[999]+=16;
+  Dune::FieldVector<double,3> a(0.1), b(1.0);
+  if(Dune::reproducibleDot(x, y).value()!=16 || Dune::reproducibleDot(a, b).value()!=0.1+0.1+0.1
+     || Dune::reproducibleDot(y, x).value()!=16){
+    std::cerr<<"wrong reproducible dot products"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int main()
+{
+  int ret=0;
+  ret+=testRounding();
+  ret+=testOrder();
+  ret+=testDot();
+  return ret;
+}
@@ -0,0 +1,67 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/benchmark.hh>
+#include <dune/common/reservedvector.hh>
+#include <dune/common/smallvector.hh>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Compare SmallVector, ReservedVector and std::vector as neighbour lists.
+ *
+ * Each call builds a short list of neighbour indices, copies it and
+ * sums it up, as an element loop collecting its neighbours would.
+ *
+ * Usage: smallvectorbenchmark [--repetitions N] [--warmup N] [--min-time S]
+ *                             [--filter TEXT] [--json FILE]
+ */
+
+/** @brief Build, copy and traverse a list of size entries. */
+template<class Vector>
+struct Neighbours
+{
+  std::size_t size;
+  std::size_t seed;
+  Neighbours(std::size_t size_) : size(size_), seed(0) {}
+  void operator() ()
+  {
+    Vector v;
+    for(std::size_t i=0; i<size; ++i)
+      v.push_back(int(seed+i));
+    Vector copy(v);
+    long sum=0;
+    for(typename Vector::const_iterator it=copy.begin(); it!=copy.end(); ++it)
+      sum+=*it;
+    Dune::Benchmark::doNotOptimize(sum);
+    ++seed;
+  }
+};
+
+template<class Vector>
+void benchmark(Dune::Benchmark& suite, const std::string& type, std::size_t size)
+{
+  std::ostringstream name;
+  name<<type<<" size "<<size;
+  suite.run(name.str(), Neighbours<Vector>(size), size);
+}
+
+int main(int argc, char** argv)
+{
+  Dune::Benchmark suite("smallvector", argc, argv);
+
+  // typical neighbour counts of simplicial and cube meshes in 2d and 3d
+  const std::size_t sizes[] = {3, 4, 6, 8, 12, 27};
+  for(std::size_t i=0; i<sizeof(sizes)/sizeof(sizes[0]); ++i){
+    benchmark<std::vector<int> >(suite, "std::vector", sizes[i]);
+    benchmark<Dune::ReservedVector<int,32> >(suite, "ReservedVector<32>", sizes[i]);
+    benchmark<Dune::SmallVector<int,8> >(suite, "SmallVector<8>", sizes[i]);
+  }
+
+  return suite.finish();
+}
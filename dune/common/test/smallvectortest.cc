@@ -0,0 +1,208 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/smallvector.hh>
+
+#include <iostream>
+#include <string>
+#include <utility>
+
+/** @brief Counts the living objects to detect leaks and double destruction. */
+struct Counted
+{
+  Counted(int v = 0) : value(v)
+  {
+    ++alive;
+  }
+
+  Counted(const Counted& other) : value(other.value)
+  {
+    ++alive;
+  }
+
+  ~Counted()
+  {
+    --alive;
+  }
+
+  bool operator==(const Counted& other) const
+  {
+    return value==other.value;
+  }
+
+  int value;
+  static int alive;
+};
+
+int Counted::alive = 0;
+
+std::ostream& operator<<(std::ostream& os, const Counted& c)
+{
+  return os<<c.value;
+}
+
+template<class V>
+int check(const V& v, int size, int offset, const char* what)
+{
+  if(int(v.size())!=size){
+    std::cerr<<what<<": size "<<v.size()<<" instead of "<<size<<std::endl;
+    return 1;
+  }
+  for(int i=0; i<size; ++i)
+    if(!(v[i]==typename V::value_type(i+offset))){
+      std::cerr<<what<<": wrong element "<<i<<": "<<v<<std::endl;
+      return 1;
+    }
+  return 0;
+}
+
+int testGrowth()
+{
+  int ret=0;
+  typedef Dune::SmallVector<Counted, 4> Vector;
+  {
+    Vector v;
+    if(!v.empty() || !v.isInline() || v.capacity()!=4){
+      std::cerr<<"wrong default construction"<<std::endl;
+      ++ret;
+    }
+    for(int i=0; i<4; ++i)
+      v.push_back(Counted(i));
+    if(!v.isInline()){
+      std::cerr<<"spilled before the inline capacity was exceeded"<<std::endl;
+      ++ret;
+    }
+    ret+=check(v, 4, 0, "inline push_back");
+    for(int i=4; i<100; ++i)
+      v.push_back(Counted(i));
+    if(v.isInline() || v.capacity()<100){
+      std::cerr<<"did not spill to the heap"<<std::endl;
+      ++ret;
+    }
+    ret+=check(v, 100, 0, "spilled push_back");
+
+    // pushing an element of the vector itself while reallocating
+    Vector w(4, Counted(7));
+    w.push_back(w[0]);
+    ret+=(w.size()!=5 || w.back().value!=7);
+    int emplaced=0;
+#if HAVE_VARIADIC_TEMPLATES
+    // full and on the heap, so that the old elements are freed
+    Vector e(8, Counted(8));
+    emplaced=9;
+    e.emplace_back(e[0]);
+    if(e.size()!=9 || e.back().value!=8){
+      std::cerr<<"emplace_back of an element of the vector itself failed"<<std::endl;
+      ++ret;
+    }
+#endif
+
+    v.resize(10);
+    ret+=check(v, 10, 0, "shrinking resize");
+    v.resize(12, Counted(42));
+    if(v.size()!=12 || v[11].value!=42){
+      std::cerr<<"growing resize failed"<<std::endl;
+      ++ret;
+    }
+    while(v.size()>3)
+      v.pop_back();
+    ret+=check(v, 3, 0, "pop_back");
+    if(Counted::alive!=3+5+emplaced){
+      std::cerr<<Counted::alive<<" living objects instead of "<<3+5+emplaced<<std::endl;
+      ++ret;
+    }
+    v.clear();
+    if(!v.empty() || Counted::alive!=5+emplaced){
+      std::cerr<<"clear failed"<<std::endl;
+      ++ret;
+    }
+  }
+  if(Counted::alive!=0){
+    std::cerr<<Counted::alive<<" objects leaked"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+template<int size>
+int testCopy()
+{
+  int ret=0;
+  typedef Dune::SmallVector<std::string, 8> Vector;
+  Vector v;
+  for(int i=0; i<size; ++i)
+    v.push_back(std::to_string(i));
+
+  Vector copy(v);
+  if(copy!=v || copy.isInline()!=(size<=8)){
+    std::cerr<<"copy construction of "<<size<<" elements failed"<<std::endl;
+    ++ret;
+  }
+  Vector assigned(3, "x");
+  assigned = v;
+  if(assigned!=v){
+    std::cerr<<"assignment of "<<size<<" elements failed"<<std::endl;
+    ++ret;
+  }
+
+#if HAVE_RVALUE_REFERENCES
+  const std::string* heap = copy.data();
+  Vector moved(std::move(copy));
+  if(moved!=v || !copy.empty() || !copy.isInline()){
+    std::cerr<<"move construction of "<<size<<" elements failed"<<std::endl;
+    ++ret;
+  }
+  if(size>8 && moved.data()!=heap){
+    std::cerr<<"move construction did not take the memory"<<std::endl;
+    ++ret;
+  }
+  Vector target(20, "y");
+  target = std::move(moved);
+  if(target!=v || !moved.empty()){
+    std::cerr<<"move assignment of "<<size<<" elements failed"<<std::endl;
+    ++ret;
+  }
+#endif
+
+  Vector other(2, "z");
+  Vector otherCopy(other);
+  other.swap(assigned);
+  if(other!=v || assigned!=otherCopy){
+    std::cerr<<"swap of "<<size<<" elements failed"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testHash()
+{
+  int ret=0;
+#if HAVE_DUNE_HASH
+  typedef Dune::SmallVector<int, 2> Vector;
+  Vector a, b;
+  for(int i=0; i<5; ++i){
+    a.push_back(i);
+    b.push_back(i);
+  }
+  Dune::hash<Vector> hasher;
+  if(hasher(a)!=hasher(b)){
+    std::cerr<<"equal vectors have different hashes"<<std::endl;
+    ++ret;
+  }
+  b.back()=7;
+  if(hasher(a)==hasher(b))
+    std::cerr<<"warning: different vectors have the same hash"<<std::endl;
+#endif
+  return ret;
+}
+
+int main()
+{
+  int ret=0;
+  ret+=testGrowth();
+  ret+=testCopy<5>();
+  ret+=testCopy<50>();
+  ret+=testHash();
+  return ret;
+}
@@ -0,0 +1,154 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/common/spatialhash.hh>
+#include <dune/common/timer.hh>
+
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#if HAVE_DUNE_HASH
+
+/** @brief Pseudo random numbers in [0,1). */
+double random(std::size_t& seed)
+{
+  seed = seed*6364136223846793005ull + 1442695040888963407ull;
+  return double(seed>>11)/double(1ull<<53);
+}
+
+/**
+ * @brief Points of a unit grid with every vertex repeated and perturbed.
+ *
+ * The grid vertices lie on the cell boundaries of the hash, the perturbations
+ * move them to both sides.
+ */
+std::vector<Dune::FieldVector<double,3> > perturbedGrid(int n, int copies, double perturbation)
+{
+  std::vector<Dune::FieldVector<double,3> > points;
+  std::size_t seed=1;
+  for(int c=0; c<copies; ++c)
+    for(int i=0; i<n; ++i)
+      for(int j=0; j<n; ++j)
+        for(int k=0; k<n; ++k){
+          Dune::FieldVector<double,3> x;
+          x[0]=i; x[1]=j; x[2]=k;
+          x*=1.0/n;
+          for(int d=0; d<3; ++d)
+            x[d]+=perturbation*(2*random(seed)-1);
+          points.push_back(x);
+        }
+  return points;
+}
+
+template<class Hash>
+int checkGrid(const Hash& hash, const std::vector<std::size_t>& indices, int n, const char* what)
+{
+  int ret=0;
+  if(hash.size()!=std::size_t(n*n*n)){
+    std::cerr<<what<<": "<<hash.size()<<" instead of "<<n*n*n<<" points"<<std::endl;
+    ++ret;
+  }
+  // every copy has to be mapped like the first one
+  for(std::size_t i=0; i<indices.size(); ++i)
+    if(indices[i]!=indices[i%(n*n*n)]){
+      std::cerr<<what<<": point "<<i<<" was not merged"<<std::endl;
+      ++ret;
+      break;
+    }
+  return ret;
+}
+
+int testAbsolute()
+{
+  int ret=0;
+  typedef Dune::SpatialHash<double, 3, Dune::FloatCmp::absolute> Hash;
+  Hash hash(1.0/16, 1e-6);
+  Hash::Coordinate a(0.5), b(0.5), c(0.5);
+  b[0]+=0.9e-6;
+  c[0]+=1.1e-6;
+  if(!hash.insert(a).second || hash.insert(b).second || hash.find(b)!=0
+     || !hash.insert(c).second || hash.size()!=2){
+    std::cerr<<"wrong absolute comparisons"<<std::endl;
+    ++ret;
+  }
+
+  const int n=20;
+  std::vector<Hash::Coordinate> points = perturbedGrid(n, 4, 0.4e-6);
+  std::vector<std::size_t> indices;
+  Hash grid(1.0/n, 1e-6);
+  grid.insert(points.begin(), points.end(), std::back_inserter(indices));
+  ret+=checkGrid(grid, indices, n, "absolute");
+  return ret;
+}
+
+int testRelative()
+{
+  int ret=0;
+  typedef Dune::SpatialHash<double, 2> Hash;
+  Hash hash(1e3, 1e-8);
+  Hash::Coordinate a, b, c;
+  a[0]=1e6; a[1]=-2e5;
+  b=a; b[0]*=1+0.5e-8;
+  c=a; c[1]*=1+2e-8;
+  if(!hash.insert(a).second || hash.insert(b).first!=0 || !hash.insert(c).second){
+    std::cerr<<"wrong relative comparisons"<<std::endl;
+    ++ret;
+  }
+  // a cell size far below the tolerance still gives correct results
+  Hash tiny(1e-3, 1e-8);
+  tiny.insert(a);
+  if(tiny.find(b)!=0 || tiny.find(c)!=Hash::npos){
+    std::cerr<<"wrong comparisons with tiny cells"<<std::endl;
+    ++ret;
+  }
+  return ret;
+}
+
+int testParallel()
+{
+  int ret=0;
+  typedef Dune::SpatialHash<double, 3, Dune::FloatCmp::absolute> Hash;
+  const int n=30;
+  std::vector<Hash::Coordinate> points = perturbedGrid(n, 4, 1e-7);
+
+  Dune::Timer timer;
+  Hash sequential(1.0/n, 1e-6);
+  std::vector<std::size_t> expected;
+  sequential.reserve(n*n*n);
+  sequential.insert(points.begin(), points.end(), std::back_inserter(expected));
+  double sequentialTime=timer.elapsed();
+  ret+=checkGrid(sequential, expected, n, "sequential");
+
+#if HAVE_STD_THREAD
+  for(unsigned int threads=1; threads<=4; threads*=2){
+    timer.reset();
+    Hash parallel(1.0/n, 1e-6);
+    std::vector<std::size_t> indices;
+    parallel.parallelInsert(points, indices, threads);
+    double parallelTime=timer.elapsed();
+    if(indices!=expected || parallel.points()!=sequential.points()){
+      std::cerr<<"parallel insertion with "<<threads<<" threads differs"<<std::endl;
+      ++ret;
+    }
+    std::cout<<points.size()<<" points with "<<threads<<" threads: "<<parallelTime
+             <<" s CPU time (sequential "<<sequentialTime<<" s)"<<std::endl;
+  }
+#endif
+  return ret;
+}
+
+#endif // HAVE_DUNE_HASH
+
+int main()
+{
+  int ret=0;
+#if HAVE_DUNE_HASH
+  ret+=testAbsolute();
+  ret+=testRelative();
+  ret+=testParallel();
+#endif
+  return ret;
+}
@@ -0,0 +1,771 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+// $Id$
+#ifndef DUNE_COMMON_THREADCACHINGPOOL_HH
+#define DUNE_COMMON_THREADCACHINGPOOL_HH
+
+/** \file
+ * \brief A thread-safe pool allocator with per-thread caches.
+ */
+
+#if HAVE_STD_THREAD
+
+#include"poolallocator.hh"
+#include<atomic>
+#include<mutex>
+#include<set>
+#include<thread>
+#include<vector>
+#include<iostream>
+#include<new>
+
+namespace Dune
+{
+  /**
+   * @file
+   * This file implements the classes ThreadCachingPool and
+   * ThreadCachingPoolAllocator providing thread-safe memory allocation
+   * for objects in chunks.
+   * Only available if std::thread, std::atomic and thread_local are
+   * supported (HAVE_STD_THREAD).
+   */
+  /**
+   * @addtogroup Allocators
+   *
+   * @{
+   */
+
+  /**
+   * @brief Statistics of one thread using a ThreadCachingPool.
+   */
+  struct ThreadCachingPoolStatistics
+  {
+    /** @brief The thread the statistics belong to. */
+    std::thread::id thread;
+    /** @brief The number of objects allocated by the thread. */
+    std::size_t allocations;
+    /** @brief The number of objects freed by the thread. */
+    std::size_t deallocations;
+    /** @brief The number of batches taken from the global depot. */
+    std::size_t refills;
+    /** @brief The number of batches handed back to the global depot. */
+    std::size_t returns;
+    /** @brief The number of chunks allocated by the thread. */
+    std::size_t grows;
+    /** @brief The number of free objects currently cached by the thread. */
+    std::size_t cached;
+  };
+
+  inline std::ostream& operator<<(std::ostream& os, const ThreadCachingPoolStatistics& stats)
+  {
+    os<<"thread="<<stats.thread<<" allocations="<<stats.allocations
+      <<" deallocations="<<stats.deallocations<<" refills="<<stats.refills
+      <<" returns="<<stats.returns<<" grows="<<stats.grows
+      <<" cached="<<stats.cached;
+    return os;
+  }
+
+#ifndef DOXYGEN
+  namespace Detail
+  {
+    /** @brief Maps a pool to the cache of the current thread. */
+    struct ThreadCacheEntry
+    {
+      unsigned long long pool;
+      void* cache;
+    };
+
+    /** @brief Small direct mapped table of recently used caches of this thread. */
+    inline ThreadCacheEntry* recentThreadCaches()
+    {
+      static thread_local ThreadCacheEntry table[8];
+      return table;
+    }
+
+    /** @brief All caches of this thread. */
+    inline std::vector<ThreadCacheEntry>& threadCaches()
+    {
+      static thread_local std::vector<ThreadCacheEntry> caches;
+      return caches;
+    }
+
+    /** @brief Get a unique identifier for a new pool. Never reused. */
+    inline unsigned long long nextThreadCachingPoolId()
+    {
+      static std::atomic<unsigned long long> id(0);
+      return ++id;
+    }
+
+    /** @brief The identifiers of the existing pools. */
+    struct LiveThreadCachingPools
+    {
+      LiveThreadCachingPools() : destroyed(0) {}
+
+      std::mutex mutex;
+      std::set<unsigned long long> ids;
+      /** @brief The number of pools destroyed so far. */
+      std::atomic<unsigned long long> destroyed;
+    };
+
+    /**
+     * @brief The registry of the existing pools.
+     *
+     * Constructed by the first pool, so it outlives all pools, even
+     * static ones.
+     */
+    inline LiveThreadCachingPools& liveThreadCachingPools()
+    {
+      static LiveThreadCachingPools live;
+      return live;
+    }
+
+    /**
+     * @brief Remove the entries of destroyed pools from the caches of this thread.
+     *
+     * Only searches them if a pool was destroyed since the last call,
+     * so that threads using short-lived pools do not collect entries.
+     */
+    inline void pruneThreadCaches(std::vector<ThreadCacheEntry>& caches)
+    {
+      static thread_local unsigned long long seen = 0;
+      LiveThreadCachingPools& live = liveThreadCachingPools();
+      const unsigned long long destroyed = live.destroyed.load(std::memory_order_relaxed);
+      if(destroyed==seen)
+        return;
+      seen = destroyed;
+      std::lock_guard<std::mutex> lock(live.mutex);
+      std::vector<ThreadCacheEntry>::iterator kept = caches.begin();
+      for(std::vector<ThreadCacheEntry>::iterator entry=caches.begin(); entry!=caches.end(); ++entry)
+        if(live.ids.count(entry->pool))
+          *(kept++) = *entry;
+      caches.erase(kept, caches.end());
+    }
+  }
+#endif
+
+  /**
+   * @brief A thread-safe memory pool of objects.
+   *
+   * Has the same interface and memory layout as Pool but may be used
+   * by several threads concurrently.
+   *
+   * Each thread keeps a private magazine of free objects. Allocation
+   * and deallocation only touch the magazine of the calling thread and
+   * therefore need no synchronisation. If the magazine runs empty a
+   * batch of batchSize objects is taken from a global lock-free depot,
+   * and only if the depot is empty a new chunk is allocated. If a
+   * magazine holds more than twice batchSize objects, a batch is handed
+   * back to the depot for reuse by other threads. Objects may be freed
+   * by a different thread than the one that allocated them.
+   *
+   * @warning Objects cached by a thread that terminated without calling
+   * flush() are only reclaimed when the pool is destroyed.
+   *
+   * \tparam T The type that is allocated by us.
+   * \tparam s The size of a memory chunk in bytes.
+   */
+  template<class T, std::size_t s>
+  class ThreadCachingPool
+  {
+    /** @brief Reference to next free element. */
+    struct Reference
+    {
+      Reference *next_;
+    };
+
+  public:
+
+    /** @brief The type of object we allocate memory for. */
+    typedef T MemberType;
+    enum
+    {
+      /**
+       * @brief The alignment that suits both the MemberType and
+       * the Reference (i.e. their least common multiple).
+       */
+      alignment = Pool<T,s>::alignment,
+
+      /** @brief The aligned size of the type. */
+      alignedSize = Pool<T,s>::alignedSize,
+
+      /** @brief The size of each chunk memory chunk. */
+      chunkSize = Pool<T,s>::chunkSize,
+
+      /** @brief The number of element each chunk can hold. */
+      elements = Pool<T,s>::elements,
+
+      /**
+       * @brief The number of objects exchanged between a magazine
+       * and the global depot at once.
+       */
+      batchSize = 64,
+
+      /** @brief The number of batches the global depot can hold. */
+      depotSlots = 64
+    };
+
+  private:
+    /** @brief Chunk of memory managed by the pool. */
+    struct Chunk
+    {
+      /** @brief The memory we hold. */
+      char chunk_[chunkSize];
+
+      /**
+       * @brief Adress the first properly aligned
+       * position in the chunk.
+       */
+      char* memory_;
+
+      /** @brief The next element */
+      Chunk *next_;
+
+      /**
+       * @brief Constructor.
+       */
+      Chunk()
+      {
+        unsigned long long lmemory = reinterpret_cast<unsigned long long>(chunk_);
+        if(lmemory % alignment != 0)
+          lmemory = (lmemory / alignment + 1)
+            * alignment;
+
+        memory_ = reinterpret_cast<char *>(lmemory);
+      }
+    };
+
+    /**
+     * @brief The magazine of free objects of one thread.
+     *
+     * Only the owning thread modifies it. The counters are atomic
+     * such that statistics() may be called from any thread.
+     */
+    struct Cache
+    {
+      Cache(std::size_t hint)
+        : head_(0), count_(0), allocations_(0), deallocations_(0),
+          refills_(0), returns_(0), grows_(0),
+          thread_(std::this_thread::get_id()), hint_(hint), next_(0)
+      {}
+
+      /** @brief The first free element. */
+      Reference* head_;
+      /** @brief The number of free elements. */
+      std::atomic<std::size_t> count_;
+      std::atomic<std::size_t> allocations_;
+      std::atomic<std::size_t> deallocations_;
+      std::atomic<std::size_t> refills_;
+      std::atomic<std::size_t> returns_;
+      std::atomic<std::size_t> grows_;
+      /** @brief The owning thread. */
+      std::thread::id thread_;
+      /** @brief The depot slot to start searching at. */
+      std::size_t hint_;
+      /** @brief The next cache of the pool. */
+      Cache* next_;
+      /** @brief Keep caches of different threads on different cache lines. */
+      char padding_[64];
+    };
+
+  public:
+    /** @brief Constructor. */
+    inline ThreadCachingPool();
+    /** @brief Destructor. */
+    inline ~ThreadCachingPool();
+    /**
+     * @brief Get a new or recycled object
+     * @return A pointer to the object memory.
+     */
+    inline void* allocate();
+    /**
+     * @brief Free an object.
+     * @param o The pointer to memory block of the object.
+     */
+    inline void free(void* o);
+
+    /**
+     * @brief Hand all complete batches cached by the calling thread
+     * back to the global depot.
+     *
+     * Should be called by worker threads before they terminate.
+     */
+    inline void flush();
+
+    /**
+     * @brief Get the statistics of all threads that used the pool.
+     */
+    inline std::vector<ThreadCachingPoolStatistics> statistics() const;
+
+    /**
+     * @brief Print elements in pool for debugging.
+     */
+    inline void print(std::ostream& os);
+
+  private:
+
+    // Prevent Copying!
+    ThreadCachingPool(const ThreadCachingPool<MemberType,s>&);
+
+    void operator=(const ThreadCachingPool<MemberType,s>& pool) const;
+
+    /** @brief Get the cache of the calling thread. */
+    inline Cache& localCache();
+    /** @brief Look up or create the cache of the calling thread. */
+    Cache& lookupCache();
+    /** @brief Refill the empty cache from the depot or a new chunk. */
+    void refill(Cache& cache);
+    /** @brief Hand one batch of the cache back to the depot. */
+    void returnBatch(Cache& cache);
+    /** @brief Take a batch from the depot or return 0. */
+    Reference* takeBatch(std::size_t hint);
+    /** @brief Put a batch into the depot if there is space. */
+    bool putBatch(Reference* batch, std::size_t hint);
+
+    static void increment(std::atomic<std::size_t>& counter)
+    {
+      counter.store(counter.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+    }
+
+    /** @brief The unique identifier of the pool. */
+    const unsigned long long id_;
+    /** @brief The global depot of batches of free objects. */
+    std::atomic<Reference*> depot_[depotSlots];
+    /** @brief The number of reserved slots in the depot. */
+    std::atomic<std::size_t> depotCount_;
+    /** @brief Our memory chunks. */
+    std::atomic<Chunk*> chunks_;
+    /** @brief The caches of all threads that used the pool. */
+    std::atomic<Cache*> caches_;
+    /** @brief The number of caches created. */
+    std::atomic<std::size_t> cacheCount_;
+  };
+
+  /**
+   * @brief A thread-safe allocator managing a pool of objects for reuse.
+   *
+   * Like PoolAllocator, but backed by a ThreadCachingPool such that
+   * containers using it may be used by several threads concurrently.
+   *
+   * @warning It is not suitable
+   * for the use in standard containers as it cannot allocate
+   * arrays of arbitrary size
+   *
+   * \tparam T The type that will be allocated.
+   * \tparam s The number of elements to fit into one memory chunk.
+   */
+  template<class T, std::size_t s>
+  class ThreadCachingPoolAllocator
+  {
+  public:
+    /**
+     * @brief Type of the values we construct and allocate.
+     */
+    typedef T value_type;
+
+    enum
+    {
+      /**
+       * @brief The number of objects to fit into one memory chunk
+       * allocated.
+       */
+      size=s*sizeof(value_type)
+    };
+
+    /** @brief The pointer type. */
+    typedef T* pointer;
+
+    /** @brief The constant pointer type. */
+    typedef const T* const_pointer;
+
+    /** @brief The reference type. */
+    typedef T& reference;
+
+    /** @brief The constant reference type. */
+    typedef const T& const_reference;
+
+    /** @brief The size type. */
+    typedef std::size_t size_type;
+
+    /** @brief The difference_type. */
+    typedef std::ptrdiff_t difference_type;
+
+    /** @brief Constructor. */
+    inline ThreadCachingPoolAllocator()
+    {}
+
+    /** @brief Copy Constructor. */
+    template<typename U, std::size_t u>
+    inline ThreadCachingPoolAllocator(const ThreadCachingPoolAllocator<U,u>&)
+    {}
+
+    /**
+     * @brief Allocates objects.
+     * @param n The number of objects to allocate. Has to be one!
+     * @param hint Ignored hint.
+     * @return A pointer tp the allocated elements.
+     */
+    inline pointer allocate(std::size_t n, const_pointer hint=0)
+    {
+      if(n==1)
+        return static_cast<T*>(memoryPool_.allocate());
+      else
+        throw std::bad_alloc();
+    }
+
+    /**
+     * @brief Free objects.
+     *
+     * Does not call the destructor!
+     * @param n The number of objects to free. Has to be one!
+     * @param p Pointer to the first object.
+     */
+    inline void deallocate(pointer p, std::size_t n)
+    {
+      for(size_t i=0; i<n; i++)
+        memoryPool_.free(p++);
+    }
+
+    /**
+     * @brief Construct an object.
+     * @param p Pointer to the object.
+     * @param value The value to initialize it to.
+     */
+    inline void construct(pointer p, const_reference value)
+    {
+      ::new (static_cast<void*>(p)) T(value);
+    }
+
+    /**
+     * @brief Destroy an object without freeing memory.
+     * @param p Pointer to the object.
+     */
+    inline void destroy(pointer p)
+    {
+      p->~T();
+    }
+
+    /** @brief Convert a reference to a pointer. */
+    inline pointer  address(reference x) const { return &x; }
+
+    /** @brief Convert a reference to a pointer. */
+    inline const_pointer address(const_reference x) const { return &x; }
+
+    /** @brief Only single objects can be allocated. */
+    inline int max_size() const throw(){ return 1;}
+
+    /**
+     * @brief Rebind the allocator to another type.
+     */
+    template<class U>
+    struct rebind
+    {
+      typedef ThreadCachingPoolAllocator<U,s> other;
+    };
+
+    /** @brief The type of the memory pool we use. */
+    typedef ThreadCachingPool<T,size> PoolType;
+
+    /** @brief Get the underlying memory pool, e.g. for statistics. */
+    static PoolType& pool()
+    {
+      return memoryPool_;
+    }
+
+  private:
+    /**
+     * @brief The underlying memory pool.
+     */
+    static PoolType memoryPool_;
+  };
+
+  template<typename T1, std::size_t t1, typename T2, std::size_t t2>
+  bool operator==(const ThreadCachingPoolAllocator<T1,t1>&, const ThreadCachingPoolAllocator<T2,t2>&)
+  {
+    return false;
+  }
+
+  template<typename T1, std::size_t t1, typename T2, std::size_t t2>
+  bool operator!=(const ThreadCachingPoolAllocator<T1,t1>&, const ThreadCachingPoolAllocator<T2,t2>&)
+  {
+    return true;
+  }
+
+  template<typename T, std::size_t t>
+  bool operator==(const ThreadCachingPoolAllocator<T,t>&, const ThreadCachingPoolAllocator<T,t>&)
+  {
+    return true;
+  }
+
+  template<typename T, std::size_t t>
+  bool operator!=(const ThreadCachingPoolAllocator<T,t>&, const ThreadCachingPoolAllocator<T,t>&)
+  {
+    return false;
+  }
+
+  template<class T, std::size_t S>
+  inline ThreadCachingPool<T,S>::ThreadCachingPool()
+    : id_(Detail::nextThreadCachingPoolId()), depotCount_(0), chunks_(0),
+      caches_(0), cacheCount_(0)
+  {
+    for(std::size_t i=0; i<depotSlots; ++i)
+      depot_[i].store(0, std::memory_order_relaxed);
+    Detail::LiveThreadCachingPools& live = Detail::liveThreadCachingPools();
+    std::lock_guard<std::mutex> lock(live.mutex);
+    live.ids.insert(id_);
+  }
+
+  template<class T, std::size_t S>
+  inline ThreadCachingPool<T,S>::~ThreadCachingPool()
+  {
+    // the threads drop their entries of this pool when they look up a
+    // new cache the next time
+    {
+      Detail::LiveThreadCachingPools& live = Detail::liveThreadCachingPools();
+      std::lock_guard<std::mutex> lock(live.mutex);
+      live.ids.erase(id_);
+      live.destroyed.fetch_add(1, std::memory_order_relaxed);
+    }
+    // delete the allocated chunks.
+    Chunk *current=chunks_.load();
+    while(current!=0)
+    {
+      Chunk *tmp = current;
+      current = current->next_;
+      delete tmp;
+    }
+    // delete the caches. Entries of the threads referring to them
+    // are never matched again as the identifier is unique.
+    Cache *cache=caches_.load();
+    while(cache!=0)
+    {
+      Cache *tmp = cache;
+      cache = cache->next_;
+      delete tmp;
+    }
+  }
+
+  template<class T, std::size_t S>
+  inline typename ThreadCachingPool<T,S>::Cache& ThreadCachingPool<T,S>::localCache()
+  {
+    Detail::ThreadCacheEntry& entry = Detail::recentThreadCaches()[id_ & 7];
+    if(entry.pool==id_)
+      return *static_cast<Cache*>(entry.cache);
+    return lookupCache();
+  }
+
+  template<class T, std::size_t S>
+  typename ThreadCachingPool<T,S>::Cache& ThreadCachingPool<T,S>::lookupCache()
+  {
+    std::vector<Detail::ThreadCacheEntry>& caches = Detail::threadCaches();
+    Cache* cache=0;
+    typedef std::vector<Detail::ThreadCacheEntry>::const_iterator Iterator;
+    for(Iterator entry=caches.begin(); entry!=caches.end(); ++entry)
+      if(entry->pool==id_){
+        cache = static_cast<Cache*>(entry->cache);
+        break;
+      }
+
+    if(!cache){
+      // first use by this thread: create and register a new cache.
+      cache = new Cache((cacheCount_.fetch_add(1)*7) % depotSlots);
+      Cache* head = caches_.load(std::memory_order_relaxed);
+      do{
+        cache->next_ = head;
+      }while(!caches_.compare_exchange_weak(head, cache, std::memory_order_release,
+                                            std::memory_order_relaxed));
+      Detail::pruneThreadCaches(caches);
+      Detail::ThreadCacheEntry newEntry = { id_, cache };
+      caches.push_back(newEntry);
+    }
+
+    Detail::ThreadCacheEntry& recent = Detail::recentThreadCaches()[id_ & 7];
+    recent.pool = id_;
+    recent.cache = cache;
+    return *cache;
+  }
+
+  template<class T, std::size_t S>
+  typename ThreadCachingPool<T,S>::Reference* ThreadCachingPool<T,S>::takeBatch(std::size_t hint)
+  {
+    if(depotCount_.load(std::memory_order_relaxed)==0)
+      return 0;
+
+    for(std::size_t i=0; i<depotSlots; ++i){
+      std::atomic<Reference*>& slot = depot_[(hint+i)%depotSlots];
+      if(slot.load(std::memory_order_relaxed)){
+        // Exchanging transfers the ownership of the whole batch
+        // and is therefore not subject to the ABA problem.
+        Reference* batch = slot.exchange(0, std::memory_order_acquire);
+        if(batch){
+          depotCount_.fetch_sub(1, std::memory_order_relaxed);
+          return batch;
+        }
+      }
+    }
+    return 0;
+  }
+
+  template<class T, std::size_t S>
+  bool ThreadCachingPool<T,S>::putBatch(Reference* batch, std::size_t hint)
+  {
+    // Reserve a slot first. Afterwards there is guaranteed to be a
+    // free one, as the count never falls below the number of used slots.
+    if(depotCount_.load(std::memory_order_relaxed)>=depotSlots)
+      return false;
+    if(depotCount_.fetch_add(1, std::memory_order_relaxed)>=depotSlots){
+      depotCount_.fetch_sub(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    for(std::size_t i=0;; ++i){
+      std::atomic<Reference*>& slot = depot_[(hint+i)%depotSlots];
+      Reference* expected=0;
+      if(slot.load(std::memory_order_relaxed)==0 &&
+         slot.compare_exchange_strong(expected, batch, std::memory_order_release,
+                                      std::memory_order_relaxed))
+        return true;
+    }
+  }
+
+  template<class T, std::size_t S>
+  void ThreadCachingPool<T,S>::refill(Cache& cache)
+  {
+    assert(!cache.head_);
+
+    Reference* batch = takeBatch(cache.hint_);
+    if(batch){
+      cache.head_ = batch;
+      cache.count_.store(batchSize, std::memory_order_relaxed);
+      increment(cache.refills_);
+      return;
+    }
+
+    // The depot is empty. Grow our pool.
+    Chunk *newChunk = new Chunk;
+    newChunk->next_ = chunks_.load(std::memory_order_relaxed);
+    while(!chunks_.compare_exchange_weak(newChunk->next_, newChunk,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+
+    char* start = newChunk->memory_;
+    char* last  = &start[elements*alignedSize];
+    Reference* ref = new (start) (Reference);
+
+    cache.head_ = ref;
+
+    for(char* element=start+alignedSize; element<last; element=element+alignedSize){
+      Reference* next = new (element) (Reference);
+      ref->next_ = next;
+      ref = next;
+    }
+    ref->next_=0;
+    cache.count_.store(elements, std::memory_order_relaxed);
+    increment(cache.grows_);
+  }
+
+  template<class T, std::size_t S>
+  void ThreadCachingPool<T,S>::returnBatch(Cache& cache)
+  {
+    if(depotCount_.load(std::memory_order_relaxed)>=depotSlots)
+      // The depot is full, keep the objects.
+      return;
+
+    Reference* first = cache.head_;
+    Reference* last = first;
+    for(std::size_t i=1; i<batchSize; ++i)
+      last = last->next_;
+    Reference* rest = last->next_;
+    last->next_ = 0;
+
+    if(putBatch(first, cache.hint_)){
+      cache.head_ = rest;
+      cache.count_.store(cache.count_.load(std::memory_order_relaxed)-batchSize,
+                         std::memory_order_relaxed);
+      increment(cache.returns_);
+    }else
+      last->next_ = rest;
+  }
+
+  template<class T, std::size_t S>
+  inline void* ThreadCachingPool<T,S>::allocate()
+  {
+    Cache& cache = localCache();
+    if(!cache.head_)
+      refill(cache);
+
+    Reference* p = cache.head_;
+    cache.head_ = p->next_;
+    cache.count_.store(cache.count_.load(std::memory_order_relaxed)-1,
+                       std::memory_order_relaxed);
+    increment(cache.allocations_);
+    return p;
+  }
+
+  template<class T, std::size_t S>
+  inline void ThreadCachingPool<T,S>::free(void* b)
+  {
+    if(b){
+      Cache& cache = localCache();
+      Reference* freed = static_cast<Reference*>(b);
+      freed->next_ = cache.head_;
+      cache.head_ = freed;
+      std::size_t count = cache.count_.load(std::memory_order_relaxed)+1;
+      cache.count_.store(count, std::memory_order_relaxed);
+      increment(cache.deallocations_);
+      if(count>2*batchSize)
+        returnBatch(cache);
+    }else
+      std::cerr<< "Tried to free null pointer! "<<b<<std::endl;
+  }
+
+  template<class T, std::size_t S>
+  inline void ThreadCachingPool<T,S>::flush()
+  {
+    Cache& cache = localCache();
+    std::size_t count;
+    do{
+      count = cache.count_.load(std::memory_order_relaxed);
+      if(count<batchSize)
+        break;
+      returnBatch(cache);
+    }while(cache.count_.load(std::memory_order_relaxed)<count);
+  }
+
+  template<class T, std::size_t S>
+  inline std::vector<ThreadCachingPoolStatistics> ThreadCachingPool<T,S>::statistics() const
+  {
+    std::vector<ThreadCachingPoolStatistics> stats;
+    for(Cache* cache=caches_.load(std::memory_order_acquire); cache!=0; cache=cache->next_){
+      ThreadCachingPoolStatistics stat;
+      stat.thread        = cache->thread_;
+      stat.allocations   = cache->allocations_.load(std::memory_order_relaxed);
+      stat.deallocations = cache->deallocations_.load(std::memory_order_relaxed);
+      stat.refills       = cache->refills_.load(std::memory_order_relaxed);
+      stat.returns       = cache->returns_.load(std::memory_order_relaxed);
+      stat.grows         = cache->grows_.load(std::memory_order_relaxed);
+      stat.cached        = cache->count_.load(std::memory_order_relaxed);
+      stats.push_back(stat);
+    }
+    return stats;
+  }
+
+  template<class T, std::size_t S>
+  inline void ThreadCachingPool<T,S>::print(std::ostream& os)
+  {
+    Chunk* current=chunks_.load();
+    while(current){
+      os<<current<<" ";
+      current=current->next_;
+    }
+    os<<current<<" ";
+  }
+
+  template<class T, std::size_t s>
+  typename ThreadCachingPoolAllocator<T,s>::PoolType ThreadCachingPoolAllocator<T,s>::memoryPool_;
+
+  /** @} */
+}
+
+#endif // HAVE_STD_THREAD
+
+#endif
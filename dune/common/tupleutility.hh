@@ -6,6 +6,7 @@
 
 #include <cstddef>
 
+#include <dune/common/hash.hh>
 #include <dune/common/static_assert.hh>
 #include <dune/common/typetraits.hh>
 
@@ -1844,6 +1845,68 @@ namespace Dune {
     typedef typename ReduceTuple< JoinTuples, TupleTuple>::type type;
   };
 
+#if HAVE_DUNE_HASH || defined(DOXYGEN)
+
+#ifndef DOXYGEN
+  namespace Detail {
+
+    //! Adds the first N entries of a tuple to a HashState.
+    template<class Tuple, int N=tuple_size<Tuple>::value>
+    struct HashTupleEntries
+    {
+      static void apply(HashState& state, const Tuple& t)
+      {
+        HashTupleEntries<Tuple, N-1>::apply(state, t);
+        state.add(get<N-1>(t));
+      }
+    };
+
+    template<class Tuple>
+    struct HashTupleEntries<Tuple, 0>
+    {
+      static void apply(HashState&, const Tuple&)
+      {}
+    };
+
+  } // end namespace Detail
+#endif // DOXYGEN
+
+  /**
+   * \brief Hashes all entries of a tuple with HashState
+   *
+   * All entry types have to be hashable by HashState, i.e. arithmetic
+   * or hashable by Dune::hash.
+   *
+   * \note This function is only available if the macro `HAVE_DUNE_HASH` is defined.
+   */
+  template<class Tuple>
+  inline std::size_t hash_tuple(const Tuple& t)
+  {
+    HashState state;
+    Detail::HashTupleEntries<Tuple>::apply(state, t);
+    return state.value();
+  }
+
+  /**
+   * \brief Hash functor for tuples
+   *
+   * Dune::tuple is usually std::tuple, for which we cannot specialize
+   * Dune::hash. Pass TupleHash as the hash parameter of unordered
+   * containers or LRUCache instead.
+   *
+   * \note This class is only available if the macro `HAVE_DUNE_HASH` is defined.
+   */
+  struct TupleHash
+  {
+    template<class Tuple>
+    std::size_t operator()(const Tuple& t) const
+    {
+      return hash_tuple(t);
+    }
+  };
+
+#endif // HAVE_DUNE_HASH || defined(DOXYGEN)
+
 }
 
 #endif
@@ -0,0 +1,32 @@
+AC_DEFUN([STD_THREAD_CHECK],[
+  AC_REQUIRE([AC_PROG_CXX])
+  AC_REQUIRE([GXX0X])
+  AC_REQUIRE([ACX_PTHREAD])
+  AC_CACHE_CHECK([whether std::thread, std::atomic and thread_local are supported],
+    dune_cv_std_thread_support, [
+    AC_LANG_PUSH([C++])
+    ac_save_CXXFLAGS="$CXXFLAGS"
+    ac_save_LIBS="$LIBS"
+    CXXFLAGS="$CXXFLAGS $PTHREAD_CFLAGS"
+    LIBS="$PTHREAD_LIBS $LIBS"
+    AC_LINK_IFELSE([AC_LANG_PROGRAM([
+      #include <thread>
+      #include <atomic>
+      static thread_local int counter = 0;
+      static std::atomic<int> sum(0);
+      void work() { ++counter; sum.fetch_add(counter); }
+      ],[[
+      std::thread t(work);
+      t.join();
+      return sum.load()==1 ? 0 : 1;
+      ]])],
+      dune_cv_std_thread_support=yes,
+      dune_cv_std_thread_support=no)
+    CXXFLAGS="$ac_save_CXXFLAGS"
+    LIBS="$ac_save_LIBS"
+    AC_LANG_POP
+  ])
+  if test "x$dune_cv_std_thread_support" = xyes; then
+    AC_DEFINE(HAVE_STD_THREAD, 1, [Define to 1 if std::thread, std::atomic and thread_local are supported])
+  fi
+])
@@ -21,6 +21,7 @@ AC_DEFUN([DUNE_COMMON_CHECKS],
   AC_REQUIRE([GXX0X])
   AC_REQUIRE([STATIC_ASSERT_CHECK])
   AC_REQUIRE([NULLPTR_CHECK])
+  AC_REQUIRE([STD_THREAD_CHECK])
   AC_REQUIRE([SHARED_PTR])
   AC_REQUIRE([VARIADIC_TEMPLATES_CHECK])
   AC_REQUIRE([DUNE_BOOST_BASE])
@@ -33,6 +34,7 @@ AC_DEFUN([DUNE_COMMON_CHECKS],
   AC_REQUIRE([DUNE_PATH_XDR])
   AC_REQUIRE([DUNE_MPI])
   AC_REQUIRE([DUNE_SYS_MPROTECT])
+  AC_REQUIRE([DUNE_PERF_EVENT])
   AC_REQUIRE([DUNE_TR1_HEADERS])
 
   dnl check for programs
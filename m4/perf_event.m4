@@ -0,0 +1,18 @@
+dnl checks whether the Linux perf_event_open system call
+dnl can be used to read hardware performance counters
+
+AC_DEFUN([DUNE_PERF_EVENT],[
+  AC_REQUIRE([AC_PROG_CC])
+  AC_LANG_PUSH([C])
+  AC_MSG_CHECKING([for perf_event_open])
+  AC_COMPILE_IFELSE([AC_LANG_PROGRAM([#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>],[struct perf_event_attr attr;
+attr.type = PERF_TYPE_HARDWARE;
+return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);])],
+    [AC_MSG_RESULT([yes])
+     AC_DEFINE(HAVE_PERF_EVENT, 1,
+                        [Define to 1 if the perf_event_open system call is available.])],
+    [AC_MSG_RESULT([no])])
+  AC_LANG_POP()
+])